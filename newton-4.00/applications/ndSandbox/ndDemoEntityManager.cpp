@@ -1090,7 +1090,11 @@ void ndDemoEntityManager::ShowMainMenuBar()
 			ImGui::RadioButton("default", &solverMode, ndWorld::ndStandardSolver);
 			ImGui::RadioButton("sse", &solverMode, ndWorld::ndSimdSoaSolver);
 			ImGui::RadioButton("avx2", &solverMode, ndWorld::ndSimdAvx2Solver);
+			ImGui::RadioButton("avx512", &solverMode, ndWorld::ndSimdAvx512Solver);
+			ImGui::RadioButton("best simd", &solverMode, ndWorld::ndSimdBestSolver);
 			ImGui::RadioButton("cuda", &solverMode, ndWorld::ndCudaSolver);
+			ImGui::RadioButton("colored", &solverMode, ndWorld::ndGraphColoredSolver);
+			ImGui::RadioButton("islands", &solverMode, ndWorld::ndIslandTaskSolver);
 
 			m_solverMode = ndWorld::ndSolverModes(solverMode);
 			ImGui::Separator();
@@ -30,6 +30,8 @@ class ndRegularProceduralGrid : public ndShapeStaticProceduralMesh
 		,m_gridSize(gridSize)
 		,m_invGridSize(ndFloat32 (1.0f)/ m_gridSize)
 	{
+		// the grid never changes, so faces can be generated once per region and reused.
+		SetFaceCache(m_gridSize * ndFloat32(4.0f));
 	}
 
 	virtual void DebugShape(const ndMatrix&, ndShapeDebugNotify& notify) const
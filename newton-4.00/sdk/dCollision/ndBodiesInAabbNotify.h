@@ -52,4 +52,76 @@ class ndBodiesInAabbNotify : public ndClassAlloc
 } D_GCC_NEWTON_ALIGN_32;
 
 
+// one box of a batch overlap query, the filter body is not reported.
+D_MSV_NEWTON_ALIGN_32
+class ndAabbQuery
+{
+	public:
+	ndAabbQuery()
+		:m_minBox(ndVector::m_zero)
+		,m_maxBox(ndVector::m_zero)
+		,m_ignoreBody(nullptr)
+	{
+	}
+
+	ndAabbQuery(const ndVector& minBox, const ndVector& maxBox, const ndBody* const ignoreBody = nullptr)
+		:m_minBox(minBox)
+		,m_maxBox(maxBox)
+		,m_ignoreBody(ignoreBody)
+	{
+	}
+
+	ndVector m_minBox;
+	ndVector m_maxBox;
+	const ndBody* m_ignoreBody;
+} D_GCC_NEWTON_ALIGN_32;
+
+// one shape of a batch overlap query, bodies are reported 
+// only when their shape intersects the query shape.
+D_MSV_NEWTON_ALIGN_32
+class ndShapeOverlapQuery
+{
+	public:
+	ndShapeOverlapQuery()
+		:m_matrix(ndGetIdentityMatrix())
+		,m_shape(nullptr)
+		,m_ignoreBody(nullptr)
+	{
+	}
+
+	ndShapeOverlapQuery(const ndShapeInstance* const shape, const ndMatrix& matrix, const ndBody* const ignoreBody = nullptr)
+		:m_matrix(matrix)
+		,m_shape(shape)
+		,m_ignoreBody(ignoreBody)
+	{
+	}
+
+	ndMatrix m_matrix;
+	const ndShapeInstance* m_shape;
+	const ndBody* m_ignoreBody;
+} D_GCC_NEWTON_ALIGN_32;
+
+// bodies found by a batch overlap query, all queries share one flat array
+// and query i owns the m_count entries starting at m_bodies[m_start].
+class ndOverlapBatchResult : public ndClassAlloc
+{
+	public:
+	class ndRange
+	{
+		public:
+		ndInt32 m_start;
+		ndInt32 m_count;
+	};
+
+	ndOverlapBatchResult()
+		:ndClassAlloc()
+		,m_ranges()
+		,m_bodies()
+	{
+	}
+
+	ndArray<ndRange> m_ranges;
+	ndArray<ndBodyKinematic*> m_bodies;
+};
+
 #endif
@@ -43,12 +43,16 @@ ndBody::ndBody()
 	,m_sceneForceUpdate(1)
 	,m_sceneEquilibrium(0)
 	,m_skeletonSelfCollision(0)
+	,m_islandSleep(0)
+	,m_inWakeQueue(0)
+	,m_restingSteps(0)
 	,m_matrix(ndGetIdentityMatrix())
 	,m_rotation()
 	,m_veloc(ndVector::m_zero)
 	,m_omega(ndVector::m_zero)
 	,m_localCentreOfMass(ndVector::m_wOne)
 	,m_globalCentreOfMass(ndVector::m_wOne)
+	,m_globalCentreOfMassError(ndVector::m_zero)
 	,m_minAabb(ndVector::m_wOne)
 	,m_maxAabb(ndVector::m_wOne)
 {
@@ -71,12 +75,16 @@ ndBody::ndBody(const ndBody& src)
 	,m_isConstrained(0)
 	,m_sceneForceUpdate(1)
 	,m_sceneEquilibrium(0)
+	,m_islandSleep(0)
+	,m_inWakeQueue(0)
+	,m_restingSteps(0)
 	,m_matrix(src.m_matrix)
 	,m_rotation(src.m_rotation)
 	,m_veloc(src.m_veloc)
 	,m_omega(src.m_omega)
 	,m_localCentreOfMass(src.m_localCentreOfMass)
 	,m_globalCentreOfMass(src.m_globalCentreOfMass)
+	,m_globalCentreOfMassError(src.m_globalCentreOfMassError)
 	,m_minAabb(src.m_minAabb)
 	,m_maxAabb(src.m_maxAabb)
 {
@@ -175,6 +183,7 @@ void ndBody::SetCentreOfMass(const ndVector& com)
 	m_localCentreOfMass.m_z = com.m_z;
 	m_localCentreOfMass.m_w = ndFloat32(1.0f);
 	m_globalCentreOfMass = m_matrix.TransformVector(m_localCentreOfMass);
+	m_globalCentreOfMassError = ndVector::m_zero;
 }
 
 void ndBody::SetNotifyCallback(ndBodyNotify* const notify)
@@ -222,6 +231,7 @@ void ndBody::SetMatrixNoSleep(const ndMatrix& matrix)
 
 	m_rotation = ndQuaternion(m_matrix);
 	m_globalCentreOfMass = m_matrix.TransformVector(m_localCentreOfMass);
+	m_globalCentreOfMassError = ndVector::m_zero;
 }
 
 void ndBody::SetMatrixAndCentreOfMass(const ndQuaternion& rotation, const ndVector& globalcom)
@@ -229,6 +239,7 @@ void ndBody::SetMatrixAndCentreOfMass(const ndQuaternion& rotation, const ndVect
 	m_rotation = rotation;
 	ndAssert(m_rotation.DotProduct(m_rotation).GetScalar() > ndFloat32(0.9999f));
 	m_globalCentreOfMass = globalcom;
+	m_globalCentreOfMassError = ndVector::m_zero;
 	m_matrix = ndCalculateMatrix(rotation, m_matrix.m_posit);
 	m_matrix.m_posit = m_globalCentreOfMass - m_matrix.RotateVector(m_localCentreOfMass);
 }
@@ -124,6 +124,9 @@ class ndBody : public ndContainersFreeListAlloc<ndBody>
 	ndUnsigned8 m_sceneForceUpdate;
 	ndUnsigned8 m_sceneEquilibrium;
 	ndUnsigned8 m_skeletonSelfCollision;
+	ndUnsigned8 m_islandSleep;
+	ndUnsigned8 m_inWakeQueue;
+	ndUnsigned8 m_restingSteps;
 	
 	ndMatrix m_matrix;
 	ndQuaternion m_rotation;
@@ -131,6 +134,7 @@ class ndBody : public ndContainersFreeListAlloc<ndBody>
 	ndVector m_omega;
 	ndVector m_localCentreOfMass;
 	ndVector m_globalCentreOfMass;
+	ndVector m_globalCentreOfMassError;
 	ndVector m_minAabb;
 	ndVector m_maxAabb;
 
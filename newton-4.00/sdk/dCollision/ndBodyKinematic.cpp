@@ -27,6 +27,7 @@
 #include "ndRayCastNotify.h"
 #include "ndBodyKinematic.h"
 #include "ndShapeCompound.h"
+#include "ndShapeStatic_bvh.h"
 #include "ndJointBilateralConstraint.h"
 
 #define D_MINIMUM_MASS	ndFloat32(1.0e-5f)
@@ -344,6 +345,11 @@ bool ndBodyKinematic::GetSleepState() const
 	return m_equilibrium ? true : false;
 }
 
+bool ndBodyKinematic::GetIslandSleepState() const
+{
+	return m_islandSleep ? true : false;
+}
+
 void ndBodyKinematic::RestoreSleepState(bool state)
 {
 	m_equilibrium = ndUnsigned8(state ? 1 : 0);
@@ -459,9 +465,55 @@ void ndBodyKinematic::SetAcceleration(const ndVector&, const ndVector&)
 }
 
 
+void ndBodyKinematic::WakeIsland()
+{
+	// a body in a sleeping island is out of the scene arrays, the scene wakes 
+	// the island in the same step. a static body that moved wakes the sleeping 
+	// islands it touched or now overlaps.
+	if (m_scene && (m_islandSleep || (m_invMass.m_w == ndFloat32(0.0f))))
+	{
+		m_scene->WakeBody(this);
+	}
+}
+
+void ndBodyKinematic::SetOmega(const ndVector& omega)
+{
+	const ndVector omega0(m_omega);
+	ndBody::SetOmega(omega);
+	if ((m_invMass.m_w > ndFloat32(0.0f)) || ((omega0 == m_omega).GetSignMask() != 0x0f))
+	{
+		WakeIsland();
+	}
+}
+
+void ndBodyKinematic::SetVelocity(const ndVector& veloc)
+{
+	const ndVector veloc0(m_veloc);
+	ndBody::SetVelocity(veloc);
+	if ((m_invMass.m_w > ndFloat32(0.0f)) || ((veloc0 == m_veloc).GetSignMask() != 0x0f))
+	{
+		WakeIsland();
+	}
+}
+
+void ndBodyKinematic::SetMatrix(const ndMatrix& matrix)
+{
+	const ndMatrix matrix0(m_matrix);
+	ndBody::SetMatrix(matrix);
+	const ndVector same((matrix0[0] == m_matrix[0]) & (matrix0[1] == m_matrix[1]) & (matrix0[2] == m_matrix[2]) & (matrix0[3] == m_matrix[3]));
+	if ((m_invMass.m_w > ndFloat32(0.0f)) || (same.GetSignMask() != 0x0f))
+	{
+		WakeIsland();
+	}
+}
+
 void ndBodyKinematic::SetSleepState(bool state)
 {
 	m_equilibrium = ndUnsigned8 (state ? 1 : 0);
+	if (!state)
+	{
+		WakeIsland();
+	}
 	if ((m_invMass.m_w > ndFloat32(0.0f)) && (m_veloc.DotProduct(m_veloc).GetScalar() < ndFloat32(1.0e-10f)) && (m_omega.DotProduct(m_omega).GetScalar() < ndFloat32(1.0e-10f))) 
 	{
 		ndVector invalidateVeloc(ndFloat32(10.0f));
@@ -497,6 +549,7 @@ void ndBodyKinematic::AttachContact(ndContact* const contact)
 	if (m_invMass.m_w > ndFloat32(0.0f))
 	{
 		m_equilibrium = 0;
+		WakeIsland();
 	}
 
 	m_contactList.AttachContact(contact);
@@ -510,6 +563,7 @@ void ndBodyKinematic::DetachContact(ndContact* const contact)
 	if (contact->IsActive() && m_invMass.m_w > ndFloat32(0.0f))
 	{
 		m_equilibrium = 0;
+		WakeIsland();
 	}
 	m_contactList.DetachContact(contact);
 }
@@ -517,6 +571,7 @@ void ndBodyKinematic::DetachContact(ndContact* const contact)
 ndBodyKinematic::ndJointList::ndNode* ndBodyKinematic::AttachJoint(ndJointBilateralConstraint* const joint)
 {
 	m_equilibrium = 0;
+	WakeIsland();
 	#ifdef _DEBUG
 	ndBody* const body0 = joint->GetBody0();
 	ndBody* const body1 = joint->GetBody1();
@@ -543,6 +598,7 @@ ndBodyKinematic::ndJointList::ndNode* ndBodyKinematic::AttachJoint(ndJointBilate
 void ndBodyKinematic::DetachJoint(ndJointList::ndNode* const node)
 {
 	m_equilibrium = 0;
+	WakeIsland();
 #ifdef _DEBUG
 	bool found = false;
 	for (ndJointList::ndNode* nodeptr = m_jointList.GetFirst(); nodeptr; nodeptr = nodeptr->GetNext())
@@ -708,6 +764,88 @@ bool ndBodyKinematic::RayCast(ndRayCastNotify& callback, const ndFastRay& ray, n
 	return state;
 }
 
+ndInt32 ndBodyKinematic::RayCastPacket(ndRayCastNotify** const callbacks, const ndFastRay* const rays, ndInt32 laneMask) const
+{
+	ndInt32 hitMask = 0;
+	ndShapeStatic_bvh* const mesh = ((ndShape*)m_shapeInstance.GetShape())->GetAsShapeStaticBVH();
+	if (!mesh || !m_shapeInstance.GetCollisionMode() || (m_shapeInstance.GetScaleType() != ndShapeInstance::m_unit) || !(laneMask & (laneMask - 1)))
+	{
+		for (ndInt32 mask = laneMask; mask; mask = mask & (mask - 1))
+		{
+			const ndInt32 lane = ndExp2(mask & -mask);
+			if (RayCast(*callbacks[lane], rays[lane], callbacks[lane]->m_param))
+			{
+				hitMask |= 1 << lane;
+			}
+		}
+		return hitMask;
+	}
+
+	// clip the rays to the body box and trace them in mesh space as one packet
+	ndInt32 count = 0;
+	ndInt32 lanes[D_RAY_PACKET_SIZE];
+	ndVector buffer[D_RAY_PACKET_SIZE * sizeof(ndFastRay) / sizeof(ndVector)];
+	ndFastRay* const localRays = (ndFastRay*)buffer;
+	const ndMatrix& globalMatrix = m_shapeInstance.GetGlobalMatrix();
+	for (ndInt32 mask = laneMask; mask; mask = mask & (mask - 1))
+	{
+		const ndInt32 lane = ndExp2(mask & -mask);
+		const ndFastRay& ray = rays[lane];
+		ndVector l0(ray.m_p0);
+		ndVector l1(ray.m_p0 + ray.m_diff.Scale(ndMin(callbacks[lane]->m_param, ndFloat32(1.0f))));
+		if (ndRayBoxClip(l0, l1, m_minAabb, m_maxAabb))
+		{
+			ndVector localP0(globalMatrix.UntransformVector(l0) & ndVector::m_triplexMask);
+			ndVector localP1(globalMatrix.UntransformVector(l1) & ndVector::m_triplexMask);
+			ndVector p1p0(localP1 - localP0);
+			if ((p1p0.DotProduct(p1p0).GetScalar() > ndFloat32(1.0e-12f)) && callbacks[lane]->OnRayPrecastAction(this, &m_shapeInstance))
+			{
+				::new (&localRays[count]) ndFastRay(localP0, localP1);
+				lanes[count] = lane;
+				count++;
+			}
+		}
+	}
+
+	if (count)
+	{
+		ndFloat32 param[D_RAY_PACKET_SIZE];
+		ndContactPoint contacts[D_RAY_PACKET_SIZE];
+		for (ndInt32 i = 0; i < count; ++i)
+		{
+			param[i] = ndFloat32(1.0f);
+		}
+
+		const ndFastRayPacket packet(localRays, count);
+		const ndInt32 packetHitMask = mesh->RayCast(packet, param, contacts);
+		for (ndInt32 i = 0; i < count; ++i)
+		{
+			if (packetHitMask & (1 << i))
+			{
+				const ndInt32 lane = lanes[i];
+				const ndFastRay& ray = rays[lane];
+				ndVector p(globalMatrix.TransformVector(localRays[i].m_p0 + localRays[i].m_diff.Scale(param[i])));
+				ndFloat32 t = ray.m_diff.DotProduct(p - ray.m_p0).GetScalar() / ray.m_diff.DotProduct(ray.m_diff).GetScalar();
+				if (t < callbacks[lane]->m_param)
+				{
+					ndContactPoint& contactOut = contacts[i];
+					contactOut.m_body0 = this;
+					contactOut.m_body1 = this;
+					contactOut.m_shapeInstance0 = &m_shapeInstance;
+					contactOut.m_shapeInstance1 = &m_shapeInstance;
+					contactOut.m_point = p;
+					contactOut.m_normal = globalMatrix.RotateVector(contactOut.m_normal);
+					if (callbacks[lane]->OnRayCastAction(contactOut, t) < ndFloat32(1.0f))
+					{
+						hitMask |= 1 << lane;
+					}
+				}
+			}
+		}
+	}
+	return hitMask;
+}
+
 void ndBodyKinematic::UpdateCollisionMatrix()
 {
 	m_transformIsDirty = 1;
@@ -855,11 +993,22 @@ void ndBodyKinematic::ClearMemory()
 {
 }
 
+// the compensated sum below must not be reassociated by /fp:fast
+#ifdef _MSC_VER
+#pragma float_control(precise, on, push)
+#endif
 void ndBodyKinematic::IntegrateVelocity(ndFloat32 timestep)
 {
 	ndAssert(m_veloc.m_w == ndFloat32(0.0f));
 	ndAssert(m_omega.m_w == ndFloat32(0.0f));
-	m_globalCentreOfMass += m_veloc.Scale(timestep);
+
+	// compensated sum, far from the origin the step is smaller than the
+	// precision of the position, the rounding error is carried to the next
+	// step so the body keeps moving instead of stalling in place.
+	const ndVector step(m_veloc.Scale(timestep) - m_globalCentreOfMassError);
+	const ndVector com(m_globalCentreOfMass + step);
+	m_globalCentreOfMassError = (com - m_globalCentreOfMass) - step;
+	m_globalCentreOfMass = com;
 
 	const ndFloat32 omegaMag2 = m_omega.DotProduct(m_omega).GetScalar();
 
@@ -894,6 +1043,9 @@ void ndBodyKinematic::IntegrateVelocity(ndFloat32 timestep)
 	m_matrix.m_posit = m_globalCentreOfMass - m_matrix.RotateVector(m_localCentreOfMass);
 	ndAssert(m_matrix.TestOrthogonal());
 }
+#ifdef _MSC_VER
+#pragma float_control(pop)
+#endif
 
 void ndBodyKinematic::IntegrateExternalForce(ndFloat32 timestep)
 {
@@ -1024,6 +1176,7 @@ void ndBodyKinematic::InitSurrogateBody(ndBodyKinematic* const surrogate) const
 	surrogate->m_matrix = m_matrix;
 	surrogate->m_localCentreOfMass = m_localCentreOfMass;
 	surrogate->m_globalCentreOfMass = m_globalCentreOfMass;
+	surrogate->m_globalCentreOfMassError = m_globalCentreOfMassError;
 	
 	surrogate->m_mass = m_mass;
 	surrogate->m_accel = m_accel;
@@ -102,6 +102,7 @@ class ndBodyKinematic : public ndBody
 	D_COLLISION_API bool GetSleepState() const;
 	D_COLLISION_API void RestoreSleepState(bool state);
 	D_COLLISION_API void SetSleepState(bool state);
+	D_COLLISION_API bool GetIslandSleepState() const;
 
 	D_COLLISION_API bool GetAutoSleep() const;
 	D_COLLISION_API void SetAutoSleep(bool state);
@@ -116,10 +117,15 @@ class ndBodyKinematic : public ndBody
 	D_COLLISION_API virtual ndVector GetAngularDamping() const;
 	D_COLLISION_API virtual void SetAngularDamping(const ndVector& angularDamp);
 
+	D_COLLISION_API virtual void SetOmega(const ndVector& omega);
+	D_COLLISION_API virtual void SetVelocity(const ndVector& veloc);
+	D_COLLISION_API virtual void SetMatrix(const ndMatrix& matrix);
+
 	D_COLLISION_API ndShapeInstance& GetCollisionShape();
 	D_COLLISION_API const ndShapeInstance& GetCollisionShape() const;
 	D_COLLISION_API virtual void SetCollisionShape(const ndShapeInstance& shapeInstance);
 	D_COLLISION_API virtual bool RayCast(ndRayCastNotify& callback, const ndFastRay& ray, const ndFloat32 maxT) const;
+	D_COLLISION_API ndInt32 RayCastPacket(ndRayCastNotify** const callbacks, const ndFastRay* const rays, ndInt32 laneMask) const;
 
 	D_COLLISION_API ndVector CalculateLinearMomentum() const;
 	D_COLLISION_API virtual ndVector CalculateAngularMomentum() const;
@@ -186,6 +192,7 @@ class ndBodyKinematic : public ndBody
 	D_COLLISION_API virtual void ApplyExternalForces(ndInt32 threadIndex, ndFloat32 timestep);
 	D_COLLISION_API virtual ndJacobian IntegrateForceAndToque(const ndVector& force, const ndVector& torque, const ndVector& timestep) const;
 
+	D_COLLISION_API void WakeIsland();
 	D_COLLISION_API void UpdateCollisionMatrix();
 	D_COLLISION_API void PrepareStep(ndInt32 index);
 	D_COLLISION_API void SetSceneNodes(ndScene* const scene, ndBodyListView::ndNode* const node);
@@ -238,7 +245,10 @@ class ndBodyKinematic : public ndBody
 	friend class ndSkeletonContainer;
 	friend class ndModelArticulation;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateColored;
+	friend class ndDynamicsUpdateIsland;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateSycl;
 	friend class ndDynamicsUpdateCuda;
 	friend class ndJointBilateralConstraint;
@@ -52,9 +52,15 @@ bool ndBodyListView::UpdateView()
 		m_view.SetCount(GetCount());
 		for (ndNode* node = GetFirst(); node; node = node->GetNext())
 		{
-			m_view[index] = node->GetInfo()->GetAsBodyKinematic();
-			index++;
+			// bodies in sleeping islands are left out of the view
+			ndBodyKinematic* const body = node->GetInfo()->GetAsBodyKinematic();
+			if (!body->GetIslandSleepState())
+			{
+				m_view[index] = body;
+				index++;
+			}
 		}
+		m_view.SetCount(index);
 	}
 	return ret;
 }
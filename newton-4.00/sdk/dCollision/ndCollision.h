@@ -67,6 +67,7 @@
 #include <ndBodyTriggerVolume.h>
 #include <ndBodyKinematicBase.h>
 #include <ndBodiesInAabbNotify.h>
+#include <ndSceneQuerySnapshot.h>
 #include <ndShapeConvexPolygon.h>
 #include <ndShapeChamferCylinder.h>
 #include <ndShapeUserDefinedImplicit.h>
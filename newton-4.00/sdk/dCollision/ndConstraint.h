@@ -253,7 +253,10 @@ class ndConstraint: public ndContainersFreeListAlloc<ndConstraint>
 	friend class ndDynamicsUpdate;
 	friend class ndSkeletonContainer;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateColored;
+	friend class ndDynamicsUpdateIsland;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 } D_GCC_NEWTON_ALIGN_32 ;
 
 inline ndConstraint::~ndConstraint()
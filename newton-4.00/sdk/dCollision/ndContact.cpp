@@ -49,6 +49,7 @@ ndContact::ndContact()
 	,m_isIntersetionTestOnly(0)
 	//,m_skeletonIntraCollision(1)
 	,m_skeletonSelftCollision(1)
+	,m_isParked(0)
 {
 	m_active = 0;
 }
@@ -136,6 +136,7 @@ class ndContact: public ndConstraint
 	ndUnsigned32 m_isAttached : 1;
 	ndUnsigned32 m_isIntersetionTestOnly : 1;
 	ndUnsigned32 m_skeletonSelftCollision : 1;
+	ndUnsigned32 m_isParked : 1;
 	static ndVector m_initialSeparatingVector;
 
 	friend class ndScene;
@@ -234,7 +234,7 @@ class ndStackBvhStackEntry
 		ndContactSolver::ndBoxBoxDistance2& data,
 		ndInt32& stack,
 		ndStackBvhStackEntry* const stackPool,
-		const ndShapeCompound::ndNodeBase* const compoundNode,
+		const ndShapeCompound::ndFlatNode* const compoundNode,
 		ndShapeStatic_bvh* const bvhTreeCollision,
 		ndInt32 treeNodeType,
 		const ndAabbPolygonSoup::ndNode* const treeNode)
@@ -262,7 +262,7 @@ class ndStackBvhStackEntry
 		}
 	}
 
-	const ndShapeCompound::ndNodeBase* m_compoundNode;
+	const ndShapeCompound::ndFlatNode* m_compoundNode;
 	const ndAabbPolygonSoup::ndNode* m_collisionTreeNode;
 	ndFloat32 m_dist2;
 	ndInt32 m_treeNodeIsLeaf;
@@ -275,8 +275,8 @@ class ndStackEntry
 		ndContactSolver::ndBoxBoxDistance2& data,
 		ndInt32& stack,
 		ndStackEntry* const stackPool,
-		const ndShapeCompound::ndNodeBase* const node0,
-		const ndShapeCompound::ndNodeBase* const node1)
+		const ndShapeCompound::ndFlatNode* const node0,
+		const ndShapeCompound::ndFlatNode* const node1)
 	{
 		if (stack < ((2 * D_COMPOUND_STACK_DEPTH) - 4))
 		{
@@ -297,7 +297,7 @@ class ndStackEntry
 		}
 	}
 
-	ndFloat32 CalculateHeighfieldDist2(const ndContactSolver::ndBoxBoxDistance2& data, const ndShapeCompound::ndNodeBase* const compoundNode, ndShapeInstance* const heightfieldInstance)
+	ndFloat32 CalculateHeighfieldDist2(const ndContactSolver::ndBoxBoxDistance2& data, const ndShapeCompound::ndFlatNode* const compoundNode, ndShapeInstance* const heightfieldInstance)
 	{
 		const ndVector scale(heightfieldInstance->GetScale());
 		const ndVector invScale(heightfieldInstance->GetInvScale());
@@ -317,7 +317,7 @@ class ndStackEntry
 		return dist2;
 	}
 
-	ndFloat32 CalculateProceduralDist2(const ndContactSolver::ndBoxBoxDistance2& data, const ndShapeCompound::ndNodeBase* const compoundNode, ndShapeInstance* const proceduralInstance)
+	ndFloat32 CalculateProceduralDist2(const ndContactSolver::ndBoxBoxDistance2& data, const ndShapeCompound::ndFlatNode* const compoundNode, ndShapeInstance* const proceduralInstance)
 	{
 		const ndVector scale(proceduralInstance->GetScale());
 		const ndVector invScale(proceduralInstance->GetInvScale());
@@ -327,8 +327,8 @@ class ndStackEntry
 		return dist2;
 	}
 	
-	const ndShapeCompound::ndNodeBase* m_node0;
-	const ndShapeCompound::ndNodeBase* m_node1;
+	const ndShapeCompound::ndFlatNode* m_node0;
+	const ndShapeCompound::ndFlatNode* m_node1;
 	ndFloat32 m_dist2;
 };
 
@@ -1804,6 +1804,175 @@ ndInt32 ndContactSolver::PruneContacts(ndInt32 count, ndInt32 maxCount) const
 	return 1;
 }
 
+ndInt32 ndContactSolver::ReduceManifold(ndInt32 count, ndInt32 maxPointsPerCluster, ndFloat32 clusterCosAngle) const
+{
+	// group the contacts by normal direction, then keep the points that 
+	// span the largest area of each group, starting with the deepest one.
+	ndAssert(maxPointsPerCluster >= 1);
+	if (count <= maxPointsPerCluster)
+	{
+		return count;
+	}
+
+	ndContactPoint* const contactArray = m_contactBuffer;
+	ndInt32 clusterCount = 0;
+	ndInt32 clusterIndex[D_MAX_CONTATCS];
+	ndVector clusterNormal[D_MAX_CONTATCS];
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		ndInt32 cluster = -1;
+		const ndVector& normal = contactArray[i].m_normal;
+		for (ndInt32 j = 0; j < clusterCount; ++j)
+		{
+			if (normal.DotProduct(clusterNormal[j]).GetScalar() >= clusterCosAngle)
+			{
+				cluster = j;
+				break;
+			}
+		}
+		if (cluster < 0)
+		{
+			cluster = clusterCount;
+			clusterNormal[clusterCount] = normal;
+			clusterCount++;
+		}
+		clusterIndex[i] = cluster;
+	}
+
+	ndFixSizeArray<ndContactPoint, D_MAX_CONTATCS> reduced;
+	for (ndInt32 cluster = 0; cluster < clusterCount; ++cluster)
+	{
+		ndInt32 pointCount = 0;
+		ndInt32 points[D_MAX_CONTATCS];
+		for (ndInt32 i = 0; i < count; ++i)
+		{
+			if (clusterIndex[i] == cluster)
+			{
+				points[pointCount] = i;
+				pointCount++;
+			}
+		}
+
+		if (pointCount > maxPointsPerCluster)
+		{
+			// deepest point first
+			ndInt32 index = 0;
+			for (ndInt32 i = 1; i < pointCount; ++i)
+			{
+				if (contactArray[points[i]].m_penetration > contactArray[points[index]].m_penetration)
+				{
+					index = i;
+				}
+			}
+			ndSwap(points[0], points[index]);
+			ndInt32 selected = 1;
+
+			// farthest point from the deepest one
+			if (selected < maxPointsPerCluster)
+			{
+				index = selected;
+				ndFloat32 maxDist2 = ndFloat32(-1.0f);
+				const ndVector& p0 = contactArray[points[0]].m_point;
+				for (ndInt32 i = selected; i < pointCount; ++i)
+				{
+					const ndVector dist((contactArray[points[i]].m_point - p0) & ndVector::m_triplexMask);
+					const ndFloat32 dist2 = dist.DotProduct(dist).GetScalar();
+					if (dist2 > maxDist2)
+					{
+						index = i;
+						maxDist2 = dist2;
+					}
+				}
+				ndSwap(points[selected], points[index]);
+				selected++;
+			}
+
+			// point that makes the largest triangle with the first two
+			if (selected < maxPointsPerCluster)
+			{
+				index = selected;
+				ndFloat32 maxArea2 = ndFloat32(-1.0f);
+				const ndVector& p0 = contactArray[points[0]].m_point;
+				const ndVector e0((contactArray[points[1]].m_point - p0) & ndVector::m_triplexMask);
+				for (ndInt32 i = selected; i < pointCount; ++i)
+				{
+					const ndVector e1((contactArray[points[i]].m_point - p0) & ndVector::m_triplexMask);
+					const ndVector area(e0.CrossProduct(e1));
+					const ndFloat32 area2 = area.DotProduct(area).GetScalar();
+					if (area2 > maxArea2)
+					{
+						index = i;
+						maxArea2 = area2;
+					}
+				}
+				ndSwap(points[selected], points[index]);
+				selected++;
+			}
+
+			// point that adds the largest area outside the triangle
+			if (selected < maxPointsPerCluster)
+			{
+				index = selected;
+				ndFloat32 maxArea = ndFloat32(-1.0e10f);
+				const ndVector& p0 = contactArray[points[0]].m_point;
+				const ndVector& p1 = contactArray[points[1]].m_point;
+				const ndVector& p2 = contactArray[points[2]].m_point;
+				const ndVector normal(((p1 - p0) & ndVector::m_triplexMask).CrossProduct((p2 - p0) & ndVector::m_triplexMask));
+				for (ndInt32 i = selected; i < pointCount; ++i)
+				{
+					const ndVector& q = contactArray[points[i]].m_point;
+					const ndFloat32 area0 = -normal.DotProduct(((p1 - p0) & ndVector::m_triplexMask).CrossProduct((q - p0) & ndVector::m_triplexMask)).GetScalar();
+					const ndFloat32 area1 = -normal.DotProduct(((p2 - p1) & ndVector::m_triplexMask).CrossProduct((q - p1) & ndVector::m_triplexMask)).GetScalar();
+					const ndFloat32 area2 = -normal.DotProduct(((p0 - p2) & ndVector::m_triplexMask).CrossProduct((q - p2) & ndVector::m_triplexMask)).GetScalar();
+					const ndFloat32 area = ndMax(area0, ndMax(area1, area2));
+					if (area > maxArea)
+					{
+						index = i;
+						maxArea = area;
+					}
+				}
+				ndSwap(points[selected], points[index]);
+				selected++;
+			}
+
+			// any remaining budget goes to the points farthest from the selected set
+			for (; selected < maxPointsPerCluster; ++selected)
+			{
+				index = selected;
+				ndFloat32 maxDist2 = ndFloat32(-1.0f);
+				for (ndInt32 i = selected; i < pointCount; ++i)
+				{
+					ndFloat32 minDist2 = ndFloat32(1.0e10f);
+					const ndVector& q = contactArray[points[i]].m_point;
+					for (ndInt32 j = 0; j < selected; ++j)
+					{
+						const ndVector dist((q - contactArray[points[j]].m_point) & ndVector::m_triplexMask);
+						minDist2 = ndMin(minDist2, dist.DotProduct(dist).GetScalar());
+					}
+					if (minDist2 > maxDist2)
+					{
+						index = i;
+						maxDist2 = minDist2;
+					}
+				}
+				ndSwap(points[selected], points[index]);
+			}
+			pointCount = maxPointsPerCluster;
+		}
+
+		for (ndInt32 i = 0; i < pointCount; ++i)
+		{
+			reduced.PushBack(contactArray[points[i]]);
+		}
+	}
+
+	for (ndInt32 i = 0; i < reduced.GetCount(); ++i)
+	{
+		contactArray[i] = reduced[i];
+	}
+	return reduced.GetCount();
+}
+
 ndFloat32 ndContactSolver::RayCast(const ndVector& localP0, const ndVector& localP1, ndContactPoint& contactOut)
 {
 	ndVector point(localP0);
@@ -2622,6 +2791,14 @@ ndInt32 ndContactSolver::ConvexToConvexContactsDiscrete()
 
 ndInt32 ndContactSolver::CompoundContactsDiscrete()
 {
+	// a compound with all its children removed touches nothing
+	const ndShapeCompound* const compound0 = m_instance0.GetShape()->GetAsShapeCompound();
+	const ndShapeCompound* const compound1 = m_instance1.GetShape()->GetAsShapeCompound();
+	if ((compound0 && !compound0->GetFlatRoot()) || (compound1 && !compound1->GetFlatRoot()))
+	{
+		return 0;
+	}
+
 	if (!m_instance1.GetShape()->GetAsShapeCompound())
 	{
 		ndAssert(m_instance0.GetShape()->GetAsShapeCompound());
@@ -2689,10 +2866,10 @@ ndInt32 ndContactSolver::ConvexToCompoundContactsDiscrete()
 	ndInt32 stack = 1;
 	ndInt32 contactCount = 0;
 	ndFloat32 stackDistance[D_SCENE_MAX_STACK_DEPTH];
-	const ndShapeCompound::ndNodeBase* stackPool[D_COMPOUND_STACK_DEPTH];
+	const ndShapeCompound::ndFlatNode* stackPool[D_COMPOUND_STACK_DEPTH];
 
-	stackPool[0] = compoundShape->m_root;
-	stackDistance[0] = data.CalculateDistance2(origin, size, compoundShape->m_root->m_origin, compoundShape->m_root->m_size);
+	stackPool[0] = compoundShape->GetFlatRoot();
+	stackDistance[0] = data.CalculateDistance2(origin, size, compoundShape->GetFlatRoot()->m_origin, compoundShape->GetFlatRoot()->m_size);
 	ndFloat32 closestDist = (stackDistance[0] > ndFloat32(0.0f)) ? stackDistance[0] : ndFloat32(1.0e10f);
 
 	while (stack)
@@ -2706,7 +2883,7 @@ ndInt32 ndContactSolver::ConvexToCompoundContactsDiscrete()
 			break;
 		}
 
-		const ndShapeCompound::ndNodeBase* const node = stackPool[stack];
+		const ndShapeCompound::ndFlatNode* const node = stackPool[stack];
 		ndAssert(node);
 
 		if (node->m_type == ndShapeCompound::m_leaf)
@@ -2747,7 +2924,7 @@ ndInt32 ndContactSolver::ConvexToCompoundContactsDiscrete()
 		{
 			ndAssert(node->m_type == ndShapeCompound::m_node);
 			{
-				const ndShapeCompound::ndNodeBase* const left = node->m_left;
+				const ndShapeCompound::ndFlatNode* const left = node->m_left;
 				ndAssert(left);
 				ndFloat32 subDist2 = data.CalculateDistance2(origin, size, left->m_origin, left->m_size);
 				ndInt32 j = stack;
@@ -2763,7 +2940,7 @@ ndInt32 ndContactSolver::ConvexToCompoundContactsDiscrete()
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const right = node->m_right;
+				const ndShapeCompound::ndFlatNode* const right = node->m_right;
 				ndAssert(right);
 				ndFloat32 subDist2 = data.CalculateDistance2(origin, size, right->m_origin, right->m_size);
 				ndInt32 j = stack;
@@ -2810,12 +2987,12 @@ ndInt32 ndContactSolver::CompoundToConvexContactsDiscrete()
 	ndAssert(compoundShape);
 
 	ndFloat32 stackDistance[D_SCENE_MAX_STACK_DEPTH];
-	const ndShapeCompound::ndNodeBase* stackPool[D_COMPOUND_STACK_DEPTH];
+	const ndShapeCompound::ndFlatNode* stackPool[D_COMPOUND_STACK_DEPTH];
 
 	ndInt32 stack = 1;
 	ndInt32 contactCount = 0;
-	stackPool[0] = compoundShape->m_root;
-	stackDistance[0] = data.CalculateDistance2(compoundShape->m_root->m_origin, compoundShape->m_root->m_size, origin, size);
+	stackPool[0] = compoundShape->GetFlatRoot();
+	stackDistance[0] = data.CalculateDistance2(compoundShape->GetFlatRoot()->m_origin, compoundShape->GetFlatRoot()->m_size, origin, size);
 	ndFloat32 closestDist = (stackDistance[0] > ndFloat32(0.0f)) ? stackDistance[0] : ndFloat32(1.0e10f);
 
 	while (stack)
@@ -2828,7 +3005,7 @@ ndInt32 ndContactSolver::CompoundToConvexContactsDiscrete()
 			closestDist = ndMin(closestDist, dist2);
 			break;
 		}
-		const ndShapeCompound::ndNodeBase* const node = stackPool[stack];
+		const ndShapeCompound::ndFlatNode* const node = stackPool[stack];
 		ndAssert(node);
 
 		if (node->m_type == ndShapeCompound::m_leaf)
@@ -2869,7 +3046,7 @@ ndInt32 ndContactSolver::CompoundToConvexContactsDiscrete()
 		{
 			ndAssert(node->m_type == ndShapeCompound::m_node);
 			{
-				const ndShapeCompound::ndNodeBase* const left = node->m_left;
+				const ndShapeCompound::ndFlatNode* const left = node->m_left;
 				ndAssert(left);
 				ndFloat32 subDist2 = data.CalculateDistance2(left->m_origin, left->m_size, origin, size);
 				ndInt32 j = stack;
@@ -2885,7 +3062,7 @@ ndInt32 ndContactSolver::CompoundToConvexContactsDiscrete()
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const right = node->m_right;
+				const ndShapeCompound::ndFlatNode* const right = node->m_right;
 				ndAssert(right);
 				ndFloat32 subDist2 = data.CalculateDistance2(right->m_origin, right->m_size, origin, size);
 				ndInt32 j = stack;
@@ -2934,9 +3111,9 @@ ndInt32 ndContactSolver::CompoundToCompoundContactsDiscrete()
 	ndInt32 contactCount = 0;
 	ndStackEntry stackPool[2 * D_COMPOUND_STACK_DEPTH];
 
-	stackPool[0].m_node0 = compoundShape0->m_root;
-	stackPool[0].m_node1 = compoundShape1->m_root;
-	stackPool[0].m_dist2 = data.CalculateDistance2(compoundShape0->m_root->m_origin, compoundShape0->m_root->m_size, compoundShape1->m_root->m_origin, compoundShape1->m_root->m_size);
+	stackPool[0].m_node0 = compoundShape0->GetFlatRoot();
+	stackPool[0].m_node1 = compoundShape1->GetFlatRoot();
+	stackPool[0].m_dist2 = data.CalculateDistance2(compoundShape0->GetFlatRoot()->m_origin, compoundShape0->GetFlatRoot()->m_size, compoundShape1->GetFlatRoot()->m_origin, compoundShape1->GetFlatRoot()->m_size);
 
 	ndFloat32 closestDist = (stackPool[0].m_dist2 > ndFloat32(0.0f)) ? stackPool[0].m_dist2 : ndFloat32(1.0e10f);
 
@@ -2951,8 +3128,8 @@ ndInt32 ndContactSolver::CompoundToCompoundContactsDiscrete()
 			break;
 		}
 
-		const ndShapeCompound::ndNodeBase* const node0 = stackPool[stack].m_node0;
-		const ndShapeCompound::ndNodeBase* const node1 = stackPool[stack].m_node1;
+		const ndShapeCompound::ndFlatNode* const node0 = stackPool[stack].m_node0;
+		const ndShapeCompound::ndFlatNode* const node1 = stackPool[stack].m_node1;
 		ndAssert(node0 && node1);
 
 		if ((node0->m_type == ndShapeCompound::m_leaf) && (node1->m_type == ndShapeCompound::m_leaf))
@@ -2998,14 +3175,14 @@ ndInt32 ndContactSolver::CompoundToCompoundContactsDiscrete()
 		{
 			ndAssert(node1->m_type == ndShapeCompound::m_node);
 			{
-				const ndShapeCompound::ndNodeBase* const subNode0 = node0;
-				const ndShapeCompound::ndNodeBase* const subNode1 = node1->m_left;
+				const ndShapeCompound::ndFlatNode* const subNode0 = node0;
+				const ndShapeCompound::ndFlatNode* const subNode1 = node1->m_left;
 				callback.PushStackEntry(data, stack, stackPool, subNode0, subNode1);
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const subNode0 = node0;
-				const ndShapeCompound::ndNodeBase* const subNode1 = node1->m_right;
+				const ndShapeCompound::ndFlatNode* const subNode0 = node0;
+				const ndShapeCompound::ndFlatNode* const subNode1 = node1->m_right;
 				callback.PushStackEntry(data, stack, stackPool, subNode0, subNode1);
 			}
 		}
@@ -3013,14 +3190,14 @@ ndInt32 ndContactSolver::CompoundToCompoundContactsDiscrete()
 		{
 			ndAssert(node0->m_type == ndShapeCompound::m_node);
 			{
-				const ndShapeCompound::ndNodeBase* const subNode0 = node0->m_left;
-				const ndShapeCompound::ndNodeBase* const subNode1 = node1;
+				const ndShapeCompound::ndFlatNode* const subNode0 = node0->m_left;
+				const ndShapeCompound::ndFlatNode* const subNode1 = node1;
 				callback.PushStackEntry(data, stack, stackPool, subNode0, subNode1);
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const subNode0 = node0->m_right;
-				const ndShapeCompound::ndNodeBase* const subNode1 = node1;
+				const ndShapeCompound::ndFlatNode* const subNode0 = node0->m_right;
+				const ndShapeCompound::ndFlatNode* const subNode1 = node1;
 				callback.PushStackEntry(data, stack, stackPool, subNode0, subNode1);
 			}
 		}
@@ -3029,26 +3206,26 @@ ndInt32 ndContactSolver::CompoundToCompoundContactsDiscrete()
 			ndAssert(node0->m_type == ndShapeCompound::m_node);
 			ndAssert(node1->m_type == ndShapeCompound::m_node);
 			{
-				const ndShapeCompound::ndNodeBase* const subNode0 = node0->m_left;
-				const ndShapeCompound::ndNodeBase* const subNode1 = node1->m_left;
+				const ndShapeCompound::ndFlatNode* const subNode0 = node0->m_left;
+				const ndShapeCompound::ndFlatNode* const subNode1 = node1->m_left;
 				callback.PushStackEntry(data, stack, stackPool, subNode0, subNode1);
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const subNode0 = node0->m_left;
-				const ndShapeCompound::ndNodeBase* const subNode1 = node1->m_right;
+				const ndShapeCompound::ndFlatNode* const subNode0 = node0->m_left;
+				const ndShapeCompound::ndFlatNode* const subNode1 = node1->m_right;
 				callback.PushStackEntry(data, stack, stackPool, subNode0, subNode1);
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const subNode0 = node0->m_right;
-				const ndShapeCompound::ndNodeBase* const subNode1 = node1->m_left;
+				const ndShapeCompound::ndFlatNode* const subNode0 = node0->m_right;
+				const ndShapeCompound::ndFlatNode* const subNode1 = node1->m_left;
 				callback.PushStackEntry(data, stack, stackPool, subNode0, subNode1);
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const subNode0 = node0->m_right;
-				const ndShapeCompound::ndNodeBase* const subNode1 = node1->m_right;
+				const ndShapeCompound::ndFlatNode* const subNode0 = node0->m_right;
+				const ndShapeCompound::ndFlatNode* const subNode1 = node1->m_right;
 				callback.PushStackEntry(data, stack, stackPool, subNode0, subNode1);
 			}
 		}
@@ -3094,9 +3271,9 @@ ndInt32 ndContactSolver::CompoundToShapeStaticBvhContactsDiscrete()
 	ndStackBvhStackEntry stackPool[2 * D_COMPOUND_STACK_DEPTH];
 
 	stackPool[0].m_treeNodeIsLeaf = 0;
-	stackPool[0].m_compoundNode = compoundShape->m_root;
+	stackPool[0].m_compoundNode = compoundShape->GetFlatRoot();
 	stackPool[0].m_collisionTreeNode = bvhTreeCollision->GetRootNode();
-	stackPool[0].m_dist2 = data.CalculateDistance2(compoundShape->m_root->m_origin, compoundShape->m_root->m_size, bvhOrigin, bvhSize);
+	stackPool[0].m_dist2 = data.CalculateDistance2(compoundShape->GetFlatRoot()->m_origin, compoundShape->GetFlatRoot()->m_size, bvhOrigin, bvhSize);
 
 	ndStackBvhStackEntry callback;
 	ndFloat32 closestDist = (stackPool[0].m_dist2 > ndFloat32(0.0f)) ? stackPool[0].m_dist2 : ndFloat32(1.0e10f);
@@ -3111,7 +3288,7 @@ ndInt32 ndContactSolver::CompoundToShapeStaticBvhContactsDiscrete()
 			break;
 		}
 
-		const ndShapeCompound::ndNodeBase* const compoundNode = stackPool[stack].m_compoundNode;
+		const ndShapeCompound::ndFlatNode* const compoundNode = stackPool[stack].m_compoundNode;
 		const ndAabbPolygonSoup::ndNode* const collisionTreeNode = stackPool[stack].m_collisionTreeNode;
 		const ndInt32 treeNodeIsLeaf = stackPool[stack].m_treeNodeIsLeaf;
 
@@ -3253,7 +3430,7 @@ ndInt32 ndContactSolver::CompoundToStaticHeightfieldContactsDiscrete()
 	ndShapeInstance* const heightfieldInstance = &heightfieldBody->GetCollisionShape();
 	ndShapeCompound* const compoundShape = compoundInstance->GetShape()->GetAsShapeCompound();
 
-	ndShapeCompound::ndNodeBase nodeProxi;
+	ndShapeCompound::ndFlatNode nodeProxi;
 	nodeProxi.m_left = nullptr;
 	nodeProxi.m_right = nullptr;
 	const ndVector heighFieldScale(heightfieldInstance->GetScale());
@@ -3264,13 +3441,13 @@ ndInt32 ndContactSolver::CompoundToStaticHeightfieldContactsDiscrete()
 	ndBoxBoxDistance2 data(compoundMatrix, heightfieldMatrix);
 
 	ndFloat32 stackDistance[D_SCENE_MAX_STACK_DEPTH];
-	const ndShapeCompound::ndNodeBase* stackPool[D_COMPOUND_STACK_DEPTH];
+	const ndShapeCompound::ndFlatNode* stackPool[D_COMPOUND_STACK_DEPTH];
 
 	ndStackEntry callback;
 	ndInt32 stack = 1;
 	ndInt32 contactCount = 0;
-	stackPool[0] = compoundShape->m_root;
-	stackDistance[0] = callback.CalculateHeighfieldDist2(data, compoundShape->m_root, heightfieldInstance);
+	stackPool[0] = compoundShape->GetFlatRoot();
+	stackDistance[0] = callback.CalculateHeighfieldDist2(data, compoundShape->GetFlatRoot(), heightfieldInstance);
 	ndFloat32 closestDist = (stackDistance[0] > ndFloat32(0.0f)) ? stackDistance[0] : ndFloat32(1.0e10f);
 
 	while (stack)
@@ -3284,7 +3461,7 @@ ndInt32 ndContactSolver::CompoundToStaticHeightfieldContactsDiscrete()
 			break;
 		}
 
-		const ndShapeCompound::ndNodeBase* const node = stackPool[stack];
+		const ndShapeCompound::ndFlatNode* const node = stackPool[stack];
 		ndAssert(node);
 
 		if (node->m_type == ndShapeCompound::m_leaf)
@@ -3326,7 +3503,7 @@ ndInt32 ndContactSolver::CompoundToStaticHeightfieldContactsDiscrete()
 		{
 			ndAssert(node->m_type == ndShapeCompound::m_node);
 			{
-				const ndShapeCompound::ndNodeBase* const left = node->m_left;
+				const ndShapeCompound::ndFlatNode* const left = node->m_left;
 				ndAssert(left);
 				ndFloat32 subDist2 = callback.CalculateHeighfieldDist2(data, left, heightfieldInstance);
 				ndInt32 j = stack;
@@ -3342,7 +3519,7 @@ ndInt32 ndContactSolver::CompoundToStaticHeightfieldContactsDiscrete()
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const right = node->m_right;
+				const ndShapeCompound::ndFlatNode* const right = node->m_right;
 				ndAssert(right);
 				ndFloat32 subDist2 = callback.CalculateHeighfieldDist2(data, right, heightfieldInstance);
 				ndInt32 j = stack;
@@ -3378,7 +3555,7 @@ ndInt32 ndContactSolver::CompoundToStaticProceduralMesh()
 	ndShapeInstance* const ProceduralInstance = &ProceduralBody->GetCollisionShape();
 	ndShapeCompound* const compoundShape = compoundInstance->GetShape()->GetAsShapeCompound();
 
-	ndShapeCompound::ndNodeBase nodeProxi;
+	ndShapeCompound::ndFlatNode nodeProxi;
 	nodeProxi.m_left = nullptr;
 	nodeProxi.m_right = nullptr;
 	const ndVector ProceduralScale(ProceduralInstance->GetScale());
@@ -3389,13 +3566,13 @@ ndInt32 ndContactSolver::CompoundToStaticProceduralMesh()
 	ndBoxBoxDistance2 data(compoundMatrix, ProceduralMatrix);
 
 	ndFloat32 stackDistance[D_SCENE_MAX_STACK_DEPTH];
-	const ndShapeCompound::ndNodeBase* stackPool[D_COMPOUND_STACK_DEPTH];
+	const ndShapeCompound::ndFlatNode* stackPool[D_COMPOUND_STACK_DEPTH];
 
 	ndStackEntry callback;
 	ndInt32 stack = 1;
 	ndInt32 contactCount = 0;
-	stackPool[0] = compoundShape->m_root;
-	stackDistance[0] = callback.CalculateProceduralDist2(data, compoundShape->m_root, ProceduralInstance);
+	stackPool[0] = compoundShape->GetFlatRoot();
+	stackDistance[0] = callback.CalculateProceduralDist2(data, compoundShape->GetFlatRoot(), ProceduralInstance);
 	ndFloat32 closestDist = (stackDistance[0] > ndFloat32(0.0f)) ? stackDistance[0] : ndFloat32(1.0e10f);
 
 	while (stack)
@@ -3409,7 +3586,7 @@ ndInt32 ndContactSolver::CompoundToStaticProceduralMesh()
 			break;
 		}
 
-		const ndShapeCompound::ndNodeBase* const node = stackPool[stack];
+		const ndShapeCompound::ndFlatNode* const node = stackPool[stack];
 		ndAssert(node);
 
 		if (node->m_type == ndShapeCompound::m_leaf)
@@ -3450,7 +3627,7 @@ ndInt32 ndContactSolver::CompoundToStaticProceduralMesh()
 		{
 			ndAssert(node->m_type == ndShapeCompound::m_node);
 			{
-				const ndShapeCompound::ndNodeBase* const left = node->m_left;
+				const ndShapeCompound::ndFlatNode* const left = node->m_left;
 				ndAssert(left);
 				ndFloat32 subDist2 = callback.CalculateProceduralDist2(data, left, ProceduralInstance);
 				ndInt32 j = stack;
@@ -3466,7 +3643,7 @@ ndInt32 ndContactSolver::CompoundToStaticProceduralMesh()
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const right = node->m_right;
+				const ndShapeCompound::ndFlatNode* const right = node->m_right;
 				ndAssert(right);
 				ndFloat32 subDist2 = callback.CalculateProceduralDist2(data, right, ProceduralInstance);
 				ndInt32 j = stack;
@@ -3732,21 +3909,22 @@ ndInt32 ndContactSolver::ConvexToCompoundContactsContinue()
 	const ndVector relVeloc(matrix.UnrotateVector(convexBody->GetVelocity() - compoundBody->GetVelocity()));
 	ndFastRay ray(ndVector::m_zero, relVeloc);
 
-	const ndVector rootMinBox(compoundShape->m_root->m_p0 - boxP1);
-	const ndVector rootMaxBox(compoundShape->m_root->m_p1 - boxP0);
+	const ndShapeCompound::ndFlatNode* const rootNode = compoundShape->GetFlatRoot();
+	const ndVector rootMinBox(rootNode->m_origin - rootNode->m_size - boxP1);
+	const ndVector rootMaxBox(rootNode->m_origin + rootNode->m_size - boxP0);
 
 	ndVector closestPoint0(ndVector::m_zero);
 	ndVector closestPoint1(ndVector::m_zero);
 	ndVector separatingVector(ndFloat32(0.0f), ndFloat32(1.0f), ndFloat32(0.0f), ndFloat32(0.0f));
 
 	ndFloat32 impactTime[D_SCENE_MAX_STACK_DEPTH];
-	const ndShapeCompound::ndNodeBase* stackPool[D_COMPOUND_STACK_DEPTH];
+	const ndShapeCompound::ndFlatNode* stackPool[D_COMPOUND_STACK_DEPTH];
 
 	ndInt32 stack = 1;
 	ndInt32 contactCount = 0;
 	ndFloat32 minTimeStep = m_timestep;
 
-	stackPool[0] = compoundShape->m_root;
+	stackPool[0] = rootNode;
 	impactTime[0] = ray.BoxIntersect(rootMinBox, rootMaxBox);
 	while (stack)
 	{
@@ -3758,7 +3936,7 @@ ndInt32 ndContactSolver::ConvexToCompoundContactsContinue()
 		}
 
 		ndAssert(stackPool[stack]);
-		const ndShapeCompound::ndNodeBase* const node = stackPool[stack];
+		const ndShapeCompound::ndFlatNode* const node = stackPool[stack];
 		if (node->m_type == ndShapeCompound::m_leaf)
 		{
 			ndShapeInstance* const subShape = node->GetShape();
@@ -3818,10 +3996,10 @@ ndInt32 ndContactSolver::ConvexToCompoundContactsContinue()
 		{
 			ndAssert(node->m_type == ndShapeCompound::m_node);
 			{
-				const ndShapeCompound::ndNodeBase* const left = node->m_left;
+				const ndShapeCompound::ndFlatNode* const left = node->m_left;
 				ndAssert(left);
-				const ndVector minBox(left->m_p0 - boxP1);
-				const ndVector maxBox(left->m_p1 - boxP0);
+				const ndVector minBox(left->m_origin - left->m_size - boxP1);
+				const ndVector maxBox(left->m_origin + left->m_size - boxP0);
 				ndFloat32 dist1 = ray.BoxIntersect(minBox, maxBox);
 				if (dist1 <= ndFloat32 (1.0f))
 				{
@@ -3839,10 +4017,10 @@ ndInt32 ndContactSolver::ConvexToCompoundContactsContinue()
 			}
 
 			{
-				const ndShapeCompound::ndNodeBase* const right = node->m_right;
+				const ndShapeCompound::ndFlatNode* const right = node->m_right;
 				ndAssert(right);
-				const ndVector minBox(right->m_p0 - boxP1);
-				const ndVector maxBox = right->m_p1 - boxP0;
+				const ndVector minBox(right->m_origin - right->m_size - boxP1);
+				const ndVector maxBox(right->m_origin + right->m_size - boxP0);
 				ndFloat32 dist1 = ray.BoxIntersect(minBox, maxBox);
 				if (dist1 <= ndFloat32(1.0f))
 				{
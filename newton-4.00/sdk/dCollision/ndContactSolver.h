@@ -122,6 +122,7 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 	
 	ndInt32 CalculateIntersectingPlane(ndInt32 count);
 	ndInt32 PruneContacts(ndInt32 count, ndInt32 maxCount) const;
+	ndInt32 ReduceManifold(ndInt32 count, ndInt32 maxPointsPerCluster, ndFloat32 clusterCosAngle) const;
 	ndInt32 PruneSupport(ndInt32 count, const ndVector& dir, const ndVector* const points) const;
 	ndInt32 CalculateContacts(const ndVector& point0, const ndVector& point1, const ndVector& normal);
 	ndInt32 Prune2dContacts(const ndMatrix& matrix, ndInt32 count, ndContactPoint* const contactArray, ndInt32 maxCount) const;
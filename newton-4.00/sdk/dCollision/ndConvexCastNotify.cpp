@@ -28,26 +28,35 @@
 #include "ndConvexCastNotify.h"
 
 bool ndConvexCastNotify::CastShape(const ndShapeInstance& castingInstance, const ndMatrix& globalOrigin, const ndVector& globalDest, ndBodyKinematic* const targetBody)
+{
+	if (m_castBody)
+	{
+		return CastShape(castingInstance, globalOrigin, globalDest, m_castBody, targetBody);
+	}
+	ndBodyKinematic body0;
+	return CastShape(castingInstance, globalOrigin, globalDest, &body0, targetBody);
+}
+
+bool ndConvexCastNotify::CastShape(const ndShapeInstance& castingInstance, const ndMatrix& globalOrigin, const ndVector& globalDest, ndBodyKinematic* const body0, ndBodyKinematic* const targetBody)
 {
 	ndAssert(m_cachedScene);
 	ndContact contactJoint;
-	ndBodyKinematic body0;
 	ndContactNotify notify(m_cachedScene);
 	ndFixSizeArray<ndContactPoint, D_MAX_CONTATCS> contactBuffer;
 	contactBuffer.SetCount(D_MAX_CONTATCS);
 	
-	body0.SetCollisionShape(castingInstance);
-	body0.SetMatrix(globalOrigin);
-	body0.SetMassMatrix(ndVector::m_one);
-	body0.SetVelocity(globalDest - globalOrigin.m_posit);
+	body0->SetCollisionShape(castingInstance);
+	body0->SetMatrix(globalOrigin);
+	body0->SetMassMatrix(ndVector::m_one);
+	body0->SetVelocity(globalDest - globalOrigin.m_posit);
 	
-	contactJoint.SetBodies(&body0, targetBody);
+	contactJoint.SetBodies(body0, targetBody);
 	
-	ndShapeInstance& shape0 = body0.GetCollisionShape();
-	shape0.SetGlobalMatrix(shape0.GetLocalMatrix() * body0.GetMatrix());
+	ndShapeInstance& shape0 = body0->GetCollisionShape();
+	shape0.SetGlobalMatrix(shape0.GetLocalMatrix() * body0->GetMatrix());
 	
 	m_contacts.SetCount(0);
-	ndContactSolver contactSolver(&contactJoint, &notify, ndFloat32(1.0f), 0);
+	ndContactSolver contactSolver(&contactJoint, &notify, ndFloat32(1.0f), m_threadIndex);
 	contactSolver.m_contactBuffer = &contactBuffer[0];
 	
 	m_param = ndFloat32(1.2f);
@@ -27,6 +27,7 @@
 
 class ndBody;
 class ndScene;
+class ndBodyKinematic;
 class ndShapeInstance;
 
 D_MSV_NEWTON_ALIGN_32
@@ -41,6 +42,8 @@ class ndConvexCastNotify : public ndClassAlloc
 		,m_contacts()
 		,m_param(ndFloat32 (1.2f))
 		,m_cachedScene(nullptr)
+		,m_castBody(nullptr)
+		,m_threadIndex(0)
 	{
 	}
 
@@ -52,6 +55,8 @@ class ndConvexCastNotify : public ndClassAlloc
 		,m_contacts(src.m_contacts)
 		,m_param(src.m_param)
 		,m_cachedScene(src.m_cachedScene)
+		,m_castBody(src.m_castBody)
+		,m_threadIndex(src.m_threadIndex)
 	{
 	}
 
@@ -82,6 +87,54 @@ class ndConvexCastNotify : public ndClassAlloc
 	ndFixSizeArray<ndContactPoint, 8> m_contacts;
 	ndFloat32 m_param;
 	ndScene* m_cachedScene;
+
+	// set by batched casts, the body that carries the cast shape and 
+	// the worker that owns the scene scratch buffers of the sweep
+	ndBodyKinematic* m_castBody;
+	ndInt32 m_threadIndex;
+
+	private:
+	bool CastShape(const ndShapeInstance& castingInstance, const ndMatrix& globalOrigin, const ndVector& globalDest, ndBodyKinematic* const castBody, ndBodyKinematic* const targetBody);
+} D_GCC_NEWTON_ALIGN_32;
+
+// one swept shape of a batch query, the shape moves from the origin matrix 
+// to the destination point and the filter body is skipped by the sweep.
+D_MSV_NEWTON_ALIGN_32
+class ndConvexCastQuery
+{
+	public:
+	ndConvexCastQuery()
+		:m_origin(ndGetIdentityMatrix())
+		,m_dest(ndVector::m_wOne)
+		,m_shape(nullptr)
+		,m_ignoreBody(nullptr)
+	{
+	}
+
+	ndConvexCastQuery(const ndShapeInstance* const shape, const ndMatrix& origin, const ndVector& dest, const ndBody* const ignoreBody = nullptr)
+		:m_origin(origin)
+		,m_dest(dest)
+		,m_shape(shape)
+		,m_ignoreBody(ignoreBody)
+	{
+	}
+
+	ndMatrix m_origin;
+	ndVector m_dest;
+	const ndShapeInstance* m_shape;
+	const ndBody* m_ignoreBody;
+} D_GCC_NEWTON_ALIGN_32;
+
+// closest hit of one swept shape of a batch query, a miss has a null body and a param of one or more.
+D_MSV_NEWTON_ALIGN_32
+class ndConvexCastHit
+{
+	public:
+	ndVector m_point;
+	ndVector m_normal;
+	const ndBodyKinematic* m_body;
+	const ndShapeInstance* m_shapeInstance;
+	ndFloat32 m_param;
 } D_GCC_NEWTON_ALIGN_32;
 
 #endif
@@ -33,6 +33,7 @@ ndJointBilateralConstraint::ndJointBilateralConstraint()
 	,m_body0Node(nullptr)
 	,m_body1Node(nullptr)
 	,m_deletedNode(nullptr)
+	,m_jacobianCache(nullptr)
 {
 	m_mark0 = 0;
 	m_mark1 = 0;
@@ -56,6 +57,7 @@ ndJointBilateralConstraint::ndJointBilateralConstraint(ndInt32 maxDof, ndBodyKin
 	,m_body0Node(nullptr)
 	,m_body1Node(nullptr)
 	,m_deletedNode(nullptr)
+	,m_jacobianCache(nullptr)
 {
 	m_body0 = body0;
 	m_body1 = body1;
@@ -93,6 +95,7 @@ ndJointBilateralConstraint::ndJointBilateralConstraint(ndInt32 maxDof, ndBodyKin
 	,m_body0Node(nullptr)
 	,m_body1Node(nullptr)
 	,m_deletedNode(nullptr)
+	,m_jacobianCache(nullptr)
 {
 	m_body0 = body0;
 	m_body1 = body1;
@@ -131,6 +134,10 @@ ndJointBilateralConstraint::~ndJointBilateralConstraint()
 	ndAssert(m_body0Node == nullptr);
 	ndAssert(m_body1Node == nullptr);
 	ndAssert(m_deletedNode == nullptr);
+	if (m_jacobianCache)
+	{
+		delete m_jacobianCache;
+	}
 }
 
 ndJointBilateralSolverModel ndJointBilateralConstraint::GetSolverModel() const
@@ -163,11 +170,135 @@ const ndMatrix& ndJointBilateralConstraint::GetLocalMatrix1() const
 void ndJointBilateralConstraint::SetLocalMatrix0(const ndMatrix& matrix)
 {
 	m_localMatrix0 = matrix;
+	InvalidateJacobianCache();
 }
 
 void ndJointBilateralConstraint::SetLocalMatrix1(const ndMatrix& matrix)
 {
 	m_localMatrix1 = matrix;
+	InvalidateJacobianCache();
+}
+
+void ndJointBilateralConstraint::SetJacobianReuse(bool state, ndFloat32 tolerance)
+{
+	if (state)
+	{
+		if (!m_jacobianCache)
+		{
+			m_jacobianCache = new ndJacobianCache;
+		}
+		m_jacobianCache->m_tolerance = ndMax(tolerance, ndFloat32(0.0f));
+		m_jacobianCache->m_reused = false;
+		m_jacobianCache->m_valid = false;
+	}
+	else if (m_jacobianCache)
+	{
+		delete m_jacobianCache;
+		m_jacobianCache = nullptr;
+	}
+}
+
+bool ndJointBilateralConstraint::GetJacobianReuse() const
+{
+	return m_jacobianCache ? true : false;
+}
+
+bool ndJointBilateralConstraint::GetJacobianReused() const
+{
+	return m_jacobianCache ? m_jacobianCache->m_reused : false;
+}
+
+void ndJointBilateralConstraint::InvalidateJacobianCache()
+{
+	if (m_jacobianCache)
+	{
+		m_jacobianCache->m_valid = false;
+	}
+}
+
+void ndJointBilateralConstraint::UpdateJointState()
+{
+}
+
+void ndJointBilateralConstraint::CachedJacobianDerivative(ndConstraintDescritor& desc)
+{
+	ndJacobianCache* const cache = m_jacobianCache;
+	if (!cache)
+	{
+		JacobianDerivative(desc);
+		return;
+	}
+
+	const ndVector veloc0(m_body0->GetVelocity());
+	const ndVector veloc1(m_body1->GetVelocity());
+	const ndVector omega0(m_body0->GetOmega());
+	const ndVector omega1(m_body1->GetOmega());
+	const ndVector posit0(m_body0->GetMatrix().m_posit);
+	const ndVector posit1(m_body1->GetMatrix().m_posit);
+	const ndQuaternion rotation0(m_body0->GetRotation());
+	const ndQuaternion rotation1(m_body1->GetRotation());
+
+	cache->m_reused = false;
+	if (cache->m_valid && (cache->m_timestep == desc.m_timestep))
+	{
+		// speed changes are measured as the distance they move the body in one step
+		const ndVector tol(cache->m_tolerance);
+		const ndVector timestep(desc.m_timestep);
+		const ndVector error(
+			((posit0 - cache->m_posit0).Abs() > tol) |
+			((posit1 - cache->m_posit1).Abs() > tol) |
+			((rotation0 - cache->m_rotation0).Abs() > tol) |
+			((rotation1 - cache->m_rotation1).Abs() > tol) |
+			(((veloc0 - cache->m_veloc0) * timestep).Abs() > tol) |
+			(((veloc1 - cache->m_veloc1) * timestep).Abs() > tol) |
+			(((omega0 - cache->m_omega0) * timestep).Abs() > tol) |
+			(((omega1 - cache->m_omega1) * timestep).Abs() > tol));
+		if (!error.GetSignMask())
+		{
+			const ndInt32 rows = cache->m_rowsCount;
+			for (ndInt32 i = 0; i < rows; ++i)
+			{
+				desc.m_jacobian[i] = cache->m_jacobian[i];
+				desc.m_forceBounds[i] = cache->m_forceBounds[i];
+				desc.m_jointAccel[i] = cache->m_jointAccel[i];
+				desc.m_restitution[i] = cache->m_restitution[i];
+				desc.m_penetration[i] = cache->m_penetration[i];
+				desc.m_diagonalRegularizer[i] = cache->m_diagonalRegularizer[i];
+				desc.m_penetrationStiffness[i] = cache->m_penetrationStiffness[i];
+			}
+			desc.m_rowsCount = rows;
+			cache->m_reused = true;
+			UpdateJointState();
+			return;
+		}
+	}
+
+	JacobianDerivative(desc);
+
+	const ndInt32 rows = desc.m_rowsCount;
+	ndAssert(rows <= ND_BILATERAL_CONTRAINT_DOF);
+	for (ndInt32 i = 0; i < rows; ++i)
+	{
+		cache->m_jacobian[i] = desc.m_jacobian[i];
+		cache->m_forceBounds[i] = desc.m_forceBounds[i];
+		cache->m_jointAccel[i] = desc.m_jointAccel[i];
+		cache->m_restitution[i] = desc.m_restitution[i];
+		cache->m_penetration[i] = desc.m_penetration[i];
+		cache->m_diagonalRegularizer[i] = desc.m_diagonalRegularizer[i];
+		cache->m_penetrationStiffness[i] = desc.m_penetrationStiffness[i];
+	}
+	cache->m_rowsCount = rows;
+	cache->m_timestep = desc.m_timestep;
+	cache->m_posit0 = posit0;
+	cache->m_posit1 = posit1;
+	cache->m_veloc0 = veloc0;
+	cache->m_veloc1 = veloc1;
+	cache->m_omega0 = omega0;
+	cache->m_omega1 = omega1;
+	cache->m_rotation0 = rotation0;
+	cache->m_rotation1 = rotation1;
+	// motor rows follow targets the joint does not track
+	cache->m_valid = (m_rowIsMotor == 0) && (rows <= ND_BILATERAL_CONTRAINT_DOF);
 }
 
 
@@ -78,6 +78,33 @@ class ndJointBilateralConstraint : public ndConstraint
 		ndFloat32 m_velocity;
 	};
 
+	// rows of the last jacobian derivative and the state of the bodies that made them
+	D_MSV_NEWTON_ALIGN_32
+	class ndJacobianCache : public ndClassAlloc
+	{
+		public:
+		ndJacobianPair m_jacobian[ND_BILATERAL_CONTRAINT_DOF];
+		ndBilateralBounds m_forceBounds[ND_BILATERAL_CONTRAINT_DOF];
+		ndFloat32 m_jointAccel[ND_BILATERAL_CONTRAINT_DOF];
+		ndFloat32 m_restitution[ND_BILATERAL_CONTRAINT_DOF];
+		ndFloat32 m_penetration[ND_BILATERAL_CONTRAINT_DOF];
+		ndFloat32 m_diagonalRegularizer[ND_BILATERAL_CONTRAINT_DOF];
+		ndFloat32 m_penetrationStiffness[ND_BILATERAL_CONTRAINT_DOF];
+		ndQuaternion m_rotation0;
+		ndQuaternion m_rotation1;
+		ndVector m_posit0;
+		ndVector m_posit1;
+		ndVector m_veloc0;
+		ndVector m_veloc1;
+		ndVector m_omega0;
+		ndVector m_omega1;
+		ndFloat32 m_timestep;
+		ndFloat32 m_tolerance;
+		ndInt32 m_rowsCount;
+		bool m_valid;
+		bool m_reused;
+	} D_GCC_NEWTON_ALIGN_32;
+
 	D_COLLISION_API ndJointBilateralConstraint();
 	D_COLLISION_API ndJointBilateralConstraint(ndInt32 maxDof, ndBodyKinematic* const body0, ndBodyKinematic* const body1, const ndMatrix& globalMatrix);
 	D_COLLISION_API ndJointBilateralConstraint(ndInt32 maxDof, ndBodyKinematic* const body0, ndBodyKinematic* const body1, const ndMatrix& globalMatrixBody0,  const ndMatrix& globalMatrixBody1);
@@ -134,7 +161,22 @@ class ndJointBilateralConstraint : public ndConstraint
 
 	D_COLLISION_API void ReplaceSentinel(ndBodyKinematic* const sentinel);
 
+	// opt in to reuse the rows of the last sub step while the bodies move, and change
+	// speed times the timestep, less than tolerance. Joints with motor rows are always
+	// rebuilt, joints that change their parameters must invalidate the cache.
+	// JacobianDerivative does not run on reused steps, joints that measure their 
+	// state there refresh it in UpdateJointState, hinges and sliders do. Other joints 
+	// report the state of the last rebuild, which is within the tolerance.
+	D_COLLISION_API void SetJacobianReuse(bool state, ndFloat32 tolerance = ndFloat32(1.0e-3f));
+	D_COLLISION_API bool GetJacobianReuse() const;
+	D_COLLISION_API bool GetJacobianReused() const;
+	D_COLLISION_API void InvalidateJacobianCache();
+	D_COLLISION_API void CachedJacobianDerivative(ndConstraintDescritor& desc);
+
 	protected:
+	// called instead of JacobianDerivative when the cached rows are reused
+	D_COLLISION_API virtual void UpdateJointState();
+
 	// inverse dynamics interface
 	D_COLLISION_API virtual void ClearMemory();
 	D_COLLISION_API virtual void SetIkMode(bool mode);
@@ -151,6 +193,7 @@ class ndJointBilateralConstraint : public ndConstraint
 	ndBodyKinematic::ndJointList::ndNode* m_body0Node;
 	ndBodyKinematic::ndJointList::ndNode* m_body1Node;
 	ndSpecialList<ndJointBilateralConstraint>::ndNode* m_deletedNode;
+	ndJacobianCache* m_jacobianCache;
 
 	ndFloat32 m_defualtDiagonalRegularizer;
 	ndUnsigned32 m_mark0			: 1;
@@ -167,7 +210,10 @@ class ndJointBilateralConstraint : public ndConstraint
 	friend class ndModelArticulation;
 	friend class ndSkeletonContainer;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateColored;
+	friend class ndDynamicsUpdateIsland;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateSycl;
 	friend class ndDynamicsUpdateCuda;
 };
@@ -53,6 +53,42 @@ class ndRayCastNotify : public ndClassAlloc
 	ndFloat32 m_param;
 } D_GCC_NEWTON_ALIGN_32;
 
+// one ray of a batch query, the filter body is skipped by the ray.
+D_MSV_NEWTON_ALIGN_32
+class ndRayCastQuery
+{
+	public:
+	ndRayCastQuery()
+		:m_origin(ndVector::m_wOne)
+		,m_dest(ndVector::m_wOne)
+		,m_ignoreBody(nullptr)
+	{
+	}
+
+	ndRayCastQuery(const ndVector& origin, const ndVector& dest, const ndBody* const ignoreBody = nullptr)
+		:m_origin(origin)
+		,m_dest(dest)
+		,m_ignoreBody(ignoreBody)
+	{
+	}
+
+	ndVector m_origin;
+	ndVector m_dest;
+	const ndBody* m_ignoreBody;
+} D_GCC_NEWTON_ALIGN_32;
+
+// closest hit of one ray of a batch query, a miss has a null body and a param of one or more.
+D_MSV_NEWTON_ALIGN_32
+class ndRayCastHit
+{
+	public:
+	ndVector m_point;
+	ndVector m_normal;
+	const ndBodyKinematic* m_body;
+	const ndShapeInstance* m_shapeInstance;
+	ndFloat32 m_param;
+} D_GCC_NEWTON_ALIGN_32;
+
 D_MSV_NEWTON_ALIGN_32
 class ndRayCastClosestHitCallback: public ndRayCastNotify
 {
@@ -42,6 +42,13 @@
 #define D_NARROW_PHASE_DIST			ndFloat32 (0.2f)
 #define D_CONTACT_TRANSLATION_ERROR	ndFloat32 (1.0e-3f)
 #define D_CONTACT_ANGULAR_ERROR		(ndFloat32 (0.25f * ndDegreeToRad))
+#define D_CONTACT_REDUCTION_POINTS	0
+#define D_CONTACT_REDUCTION_ANGLE	(ndFloat32 (25.0f * ndDegreeToRad))
+#define D_SPLIT_PAIR_MIN_CHILDREN	64
+#define D_SPLIT_PAIR_THREAD_CONTACTS	16
+#define D_CONTACT_MATCH_DIST2		ndFloat32 (0.05f * 0.05f)
+#define D_CONTACT_MATCH_COS			ndFloat32 (0.9f)
+#define D_CONTACT_INHERIT_DIST2		ndFloat32 (0.25f * 0.25f)
 
 ndVector ndScene::m_velocTol(ndFloat32(1.0e-16f));
 ndVector ndScene::m_angularContactError2(D_CONTACT_ANGULAR_ERROR * D_CONTACT_ANGULAR_ERROR);
@@ -58,16 +65,27 @@ ndScene::ndScene()
 	,m_activeConstraintArray(1024)
 	,m_specialUpdateList()
 	,m_newPairs(1024)
+	,m_splitPairs(16)
+	,m_parkedContacts(256)
+	,m_wakeQueue(256)
+	,m_splitPairLeafs(1024)
+	,m_splitPairContacts(256)
 	,m_lock()
+	,m_wakeLock()
 	,m_rootNode(nullptr)
 	,m_sentinelBody(nullptr)
 	,m_contactNotifyCallback(new ndContactNotify(nullptr))
 	,m_backgroundThread(nullptr)
 	,m_timestep(ndFloat32 (0.0f))
+	,m_contactReductionCos(ndCos(D_CONTACT_REDUCTION_ANGLE))
+	,m_contactReductionPoints(D_CONTACT_REDUCTION_POINTS)
+	,m_contactWarmStart(ndFloat32 (1.0f))
 	,m_lru(D_CONTACT_DELAY_FRAMES)
 	,m_frameNumber(0)
 	,m_subStepNumber(0)
 	,m_forceBalanceSceneCounter(0)
+	,m_splitPairsPhase(false)
+	,m_parkedContactsDirty(false)
 {
 	m_sentinelBody = new ndBodySentinel;
 	m_contactNotifyCallback->m_scene = this;
@@ -90,16 +108,27 @@ ndScene::ndScene(const ndScene& src)
 	,m_activeConstraintArray()
 	,m_specialUpdateList()
 	,m_newPairs(1024)
+	,m_splitPairs(16)
+	,m_parkedContacts(256)
+	,m_wakeQueue(256)
+	,m_splitPairLeafs(1024)
+	,m_splitPairContacts(256)
 	,m_lock()
+	,m_wakeLock()
 	,m_rootNode(nullptr)
 	,m_sentinelBody(nullptr)
 	,m_contactNotifyCallback(nullptr)
 	,m_backgroundThread(nullptr)
 	,m_timestep(ndFloat32(0.0f))
+	,m_contactReductionCos(src.m_contactReductionCos)
+	,m_contactReductionPoints(src.m_contactReductionPoints)
+	,m_contactWarmStart(src.m_contactWarmStart)
 	,m_lru(src.m_lru)
 	,m_frameNumber(src.m_frameNumber)
 	,m_subStepNumber(src.m_subStepNumber)
 	,m_forceBalanceSceneCounter(0)
+	,m_splitPairsPhase(false)
+	,m_parkedContactsDirty(false)
 {
 	ndScene* const stealData = (ndScene*)&src;
 
@@ -109,6 +138,10 @@ ndScene::ndScene(const ndScene& src)
 	m_scratchBuffer.Swap(stealData->m_scratchBuffer);
 	m_sceneBodyArray.Swap(stealData->m_sceneBodyArray);
 	m_activeConstraintArray.Swap(stealData->m_activeConstraintArray);
+	m_parkedContacts.Swap(stealData->m_parkedContacts);
+	m_wakeQueue.Swap(stealData->m_wakeQueue);
+	m_sleepStats = stealData->m_sleepStats;
+	m_parkedContactsDirty = stealData->m_parkedContactsDirty;
 
 	ndSwap(m_rootNode, stealData->m_rootNode);
 	ndSwap(m_sentinelBody, stealData->m_sentinelBody);
@@ -287,9 +320,32 @@ bool ndScene::RemoveBody(const ndSharedPtr<ndBody>& body)
 		while (contactMap.GetRoot())
 		{
 			ndContact* const contact = contactMap.GetRoot()->GetInfo();
+			if (contact->m_isParked)
+			{
+				UnparkContact(contact);
+			}
 			m_contactArray.DetachContact(contact);
 		}
 
+		// detaching the contacts wakes the neighbors, 
+		// the body itself leaves the wake queue.
+		if (kinematicBody->m_inWakeQueue)
+		{
+			ndScopeSpinLock lock(m_wakeLock);
+			for (ndInt32 i = ndInt32(m_wakeQueue.GetCount()) - 1; i >= 0; --i)
+			{
+				if (m_wakeQueue[i] == kinematicBody)
+				{
+					m_wakeQueue[i] = m_wakeQueue[m_wakeQueue.GetCount() - 1];
+					m_wakeQueue.SetCount(m_wakeQueue.GetCount() - 1);
+					break;
+				}
+			}
+			kinematicBody->m_inWakeQueue = 0;
+		}
+		kinematicBody->m_islandSleep = 0;
+		kinematicBody->m_restingSteps = 0;
+
 		ndBodyListView::ndNode* const sceneNode = kinematicBody->m_sceneNode;
 		if (kinematicBody->m_scene && sceneNode)
 		{
@@ -317,6 +373,8 @@ bool ndScene::RemoveBody(const ndSharedPtr<ndBody>& body)
 void ndScene::BalanceScene()
 {
 	D_TRACKTIME();
+	DeactivateRestingIslands();
+	WakeSleepingIslands();
 	UpdateBodyList();
 	if (m_bvhSceneManager.GetNodeArray().GetCount() > 2)
 	{
@@ -404,7 +462,7 @@ void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const conta
 		contactSolver.m_contactBuffer = contactBuffer;
 		contactSolver.m_intersectionTestOnly = body0->m_contactTestOnly | body1->m_contactTestOnly;
 
-		ndInt32 count = contactSolver.CalculateContactsDiscrete ();
+		ndInt32 count = (m_splitPairsPhase && IsSplitNarrowPhasePair(contact)) ? CalculateSplitPairContacts(contactSolver) : contactSolver.CalculateContactsDiscrete();
 		if (count)
 		{
 			contact->SetActive(true);
@@ -427,6 +485,10 @@ void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const conta
 			}
 			else
 			{
+				if (m_contactReductionPoints && (count > m_contactReductionPoints))
+				{
+					count = contactSolver.ReduceManifold(count, m_contactReductionPoints, m_contactReductionCos);
+				}
 				ndAssert(count <= (D_CONSTRAINT_MAX_ROWS / 3));
 				ProcessContacts(threadIndex, count, &contactSolver);
 				ndAssert(contact->m_maxDof);
@@ -458,6 +520,163 @@ void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const conta
 	}
 }
 
+bool ndScene::IsSplitNarrowPhasePair(ndContact* const contact) const
+{
+	// a compound with many children against a static mesh is too much 
+	// work for a single thread, these pairs are split into sub tasks.
+	if (GetThreadCount() < 2)
+	{
+		return false;
+	}
+
+	ndBodyKinematic* const body0 = contact->GetBody0();
+	ndBodyKinematic* const body1 = contact->GetBody1();
+	if (body0->m_contactTestOnly | body1->m_contactTestOnly)
+	{
+		return false;
+	}
+
+	ndShapeCompound* const compound = body0->GetCollisionShape().GetShape()->GetAsShapeCompound();
+	if (!compound || !body1->GetCollisionShape().GetShape()->GetAsShapeStaticMesh())
+	{
+		return false;
+	}
+	return compound->GetTree().GetCount() >= D_SPLIT_PAIR_MIN_CHILDREN;
+}
+
+ndInt32 ndScene::CalculateSplitPairContacts(ndContactSolver& contactSolver)
+{
+	D_TRACKTIME();
+	ndContact* const contact = contactSolver.m_contact;
+	ndBodyKinematic* const meshBody = contact->GetBody1();
+	ndShapeInstance* const meshInstance = &meshBody->GetCollisionShape();
+	const ndShapeCompound* const compoundShape = contactSolver.m_instance0.GetShape()->GetAsShapeCompound();
+	ndAssert(compoundShape);
+
+	m_splitPairLeafs.SetCount(0);
+	ndShapeCompound::ndTreeArray::Iterator it(compoundShape->GetTree());
+	for (it.Begin(); it; it++)
+	{
+		m_splitPairLeafs.PushBack(it.GetNode()->GetInfo()->GetShape());
+	}
+
+	const ndBvhLeafNode* const meshNode = m_bvhSceneManager.GetLeafNode(meshBody);
+	const ndVector meshMinBox(meshNode->m_minBox);
+	const ndVector meshMaxBox(meshNode->m_maxBox);
+	const ndMatrix& compoundMatrix = contactSolver.m_instance0.GetGlobalMatrix();
+
+	// each thread collides a fixed range of children and keeps its own manifold, 
+	// the manifolds are merged in thread order so the result does not depend on timing.
+	ndInt32 threadCounts[D_MAX_THREADS_COUNT];
+	ndFloat32 threadDist2[D_MAX_THREADS_COUNT];
+	m_splitPairContacts.SetCount(GetThreadCount() * D_SPLIT_PAIR_THREAD_CONTACTS);
+	auto CalculateSubShapeContacts = ndMakeObject::ndFunction([this, &threadCounts, &threadDist2, &contactSolver, &compoundMatrix, &meshMinBox, &meshMaxBox, contact, meshInstance](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateSubShapeContacts);
+		ndContactPoint contacts[D_MAX_CONTATCS];
+		ndContactSolver threadSolver(contactSolver, contactSolver.m_instance0, contactSolver.m_instance1);
+		threadSolver.m_threadId = threadIndex;
+		threadSolver.m_contactBuffer = contacts;
+
+		ndInt32 count = 0;
+		ndFloat32 dist2 = ndFloat32(1.0e10f);
+		const ndStartEnd startEnd(ndInt32(m_splitPairLeafs.GetCount()), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndShapeInstance* const subShape = m_splitPairLeafs[i];
+			if (!subShape->GetCollisionMode())
+			{
+				continue;
+			}
+
+			ndShapeInstance childInstance(*subShape, subShape->GetShape());
+			childInstance.m_globalMatrix = childInstance.GetLocalMatrix() * compoundMatrix;
+
+			ndVector minBox;
+			ndVector maxBox;
+			childInstance.CalculateAabb(childInstance.m_globalMatrix, minBox, maxBox);
+			if (!ndOverlapTest(minBox, maxBox, meshMinBox, meshMaxBox))
+			{
+				const ndVector gap((minBox - meshMaxBox).GetMax(meshMinBox - maxBox).GetMax(ndVector::m_zero) & ndVector::m_triplexMask);
+				dist2 = ndMin(dist2, gap.DotProduct(gap).GetScalar());
+				continue;
+			}
+			if (!m_contactNotifyCallback->OnCompoundSubShapeOverlap(contact, m_timestep, subShape, meshInstance))
+			{
+				continue;
+			}
+
+			ndContactSolver childSolver(threadSolver, childInstance, contactSolver.m_instance1);
+			childSolver.m_pruneContacts = 0;
+			childSolver.m_maxCount = D_MAX_CONTATCS - count;
+			childSolver.m_contactBuffer = &contacts[count];
+
+			const ndInt32 childCount = childSolver.ConvexContactsDiscrete();
+			const ndFloat32 dist = ndMax(childSolver.m_separationDistance, ndFloat32(0.0f));
+			dist2 = ndMin(dist2, dist * dist);
+			for (ndInt32 j = 0; j < childCount; ++j)
+			{
+				contacts[count + j].m_shapeInstance0 = subShape;
+			}
+			count += childCount;
+			if (count > (D_MAX_CONTATCS - 2 * (D_CONSTRAINT_MAX_ROWS / 3)))
+			{
+				count = threadSolver.PruneContacts(count, D_SPLIT_PAIR_THREAD_CONTACTS);
+			}
+		}
+
+		if (count > D_SPLIT_PAIR_THREAD_CONTACTS)
+		{
+			count = threadSolver.PruneContacts(count, D_SPLIT_PAIR_THREAD_CONTACTS);
+		}
+		for (ndInt32 i = 0; i < count; ++i)
+		{
+			m_splitPairContacts[threadIndex * D_SPLIT_PAIR_THREAD_CONTACTS + i] = contacts[i];
+		}
+		threadCounts[threadIndex] = count;
+		threadDist2[threadIndex] = dist2;
+	});
+	ParallelExecute(CalculateSubShapeContacts);
+
+	ndInt32 contactCount = 0;
+	ndFloat32 closestDist = ndFloat32(1.0e10f);
+	for (ndInt32 i = 0; i < GetThreadCount(); ++i)
+	{
+		closestDist = ndMin(closestDist, threadDist2[i]);
+		if ((contactCount + threadCounts[i]) > D_MAX_CONTATCS)
+		{
+			contactCount = contactSolver.PruneContacts(contactCount, D_SPLIT_PAIR_THREAD_CONTACTS);
+		}
+		for (ndInt32 j = 0; j < threadCounts[i]; ++j)
+		{
+			contactSolver.m_contactBuffer[contactCount + j] = m_splitPairContacts[i * D_SPLIT_PAIR_THREAD_CONTACTS + j];
+		}
+		contactCount += threadCounts[i];
+	}
+
+	if (contactCount > 1)
+	{
+		contactCount = contactSolver.PruneContacts(contactCount, D_SPLIT_PAIR_THREAD_CONTACTS);
+	}
+
+	contactSolver.m_separationDistance = ndSqrt(closestDist);
+	contact->m_timeOfImpact = m_timestep;
+	contact->m_separatingVector = contactSolver.m_separatingVector;
+	contact->m_separationDistance = contactSolver.m_separationDistance;
+	return contactCount;
+}
+
+void ndScene::SetContactReduction(ndInt32 pointsPerCluster, ndFloat32 clusterAngle)
+{
+	m_contactReductionPoints = ndClamp(pointsPerCluster, 0, D_MAX_CONTATCS);
+	m_contactReductionCos = ndCos(ndClamp(clusterAngle, ndFloat32(0.0f), ndPi));
+}
+
+void ndScene::SetContactWarmStart(ndFloat32 scale)
+{
+	m_contactWarmStart = ndClamp(scale, ndFloat32(0.0f), ndFloat32(1.0f));
+}
+
 void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* const contactSolver)
 {
 	ndContact* const contact = contactSolver->m_contact;
@@ -474,15 +693,45 @@ void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* co
 	const ndContactPoint* const contactArray = contactSolver->m_contactBuffer;
 	
 	ndInt32 count = 0;
-	ndVector cachePosition[D_MAX_CONTATCS];
 	ndContactPointList::ndNode* nodes[D_MAX_CONTATCS];
 	ndContactPointList& contactPointList = contact->m_contacPointsList;
 	for (ndContactPointList::ndNode* contactNode = contactPointList.GetFirst(); contactNode; contactNode = contactNode->GetNext()) 
 	{
 		nodes[count] = contactNode;
-		cachePosition[count] = contactNode->GetInfo().m_point;
 		count++;
 	}
+
+	// match each new point to the closest cached point of the same sub shapes 
+	// and similar normal, matched nodes keep their forces for warm starting.
+	ndContactPointList::ndNode* matchedNodes[D_MAX_CONTATCS];
+	for (ndInt32 i = 0; i < contactCount; ++i)
+	{
+		const ndContactPoint& point = contactArray[i];
+		ndInt32 index = -1;
+		ndFloat32 min = D_CONTACT_MATCH_DIST2;
+		for (ndInt32 j = 0; j < count; ++j) 
+		{
+			const ndContactMaterial& cached = nodes[j]->GetInfo();
+			if ((cached.m_shapeId0 == point.m_shapeId0) && (cached.m_shapeId1 == point.m_shapeId1) && (cached.m_normal.DotProduct(point.m_normal).GetScalar() > D_CONTACT_MATCH_COS))
+			{
+				const ndVector v(ndVector::m_triplexMask & (cached.m_point - point.m_point));
+				const ndFloat32 dist2 = v.DotProduct(v).GetScalar();
+				if (dist2 < min)
+				{
+					index = j;
+					min = dist2;
+				}
+			}
+		}
+
+		matchedNodes[i] = nullptr;
+		if (index != -1)
+		{
+			matchedNodes[i] = nodes[index];
+			count--;
+			nodes[index] = nodes[count];
+		}
+	}
 	
 	const ndVector& v0 = body0->m_veloc;
 	const ndVector& w0 = body0->m_omega;
@@ -526,32 +775,48 @@ void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* co
 	ndFloat32 maxImpulse = ndFloat32(-1.0f);
 	for (ndInt32 i = 0; i < contactCount; ++i) 
 	{
-		ndInt32 index = -1;
-		ndFloat32 min = ndFloat32(1.0e20f);
-		ndContactPointList::ndNode* contactNode = nullptr;
-		for (ndInt32 j = 0; j < count; ++j) 
+		ndContactPointList::ndNode* contactNode = matchedNodes[i];
+		if (!contactNode)
 		{
-			ndVector v(ndVector::m_triplexMask & (cachePosition[j] - contactArray[i].m_point));
-			ndAssert(v.m_w == ndFloat32(0.0f));
-			diff = v.DotProduct(v).GetScalar();
-			if (diff < min) 
+			// points that moved too far inherit the force of the closest left 
+			// over point of the same sub shapes within a short distance, since 
+			// the manifold still carries the same load, points on a new feature 
+			// start with no force.
+			ndInt32 index = -1;
+			ndFloat32 min = D_CONTACT_INHERIT_DIST2;
+			for (ndInt32 j = 0; j < count; ++j)
+			{
+				const ndContactMaterial& cached = nodes[j]->GetInfo();
+				if ((cached.m_shapeId0 == contactArray[i].m_shapeId0) && (cached.m_shapeId1 == contactArray[i].m_shapeId1))
+				{
+					const ndVector v(ndVector::m_triplexMask & (cached.m_point - contactArray[i].m_point));
+					const ndFloat32 dist2 = v.DotProduct(v).GetScalar();
+					if (dist2 < min)
+					{
+						index = j;
+						min = dist2;
+					}
+				}
+			}
+
+			if (index != -1)
 			{
-				index = j;
-				min = diff;
-				contactNode = nodes[j];
+				contactNode = nodes[index];
+				count--;
+				nodes[index] = nodes[count];
+			}
+			else if (count)
+			{
+				count--;
+				contactNode = nodes[count];
+				contactNode->GetInfo().m_dir0_Force.Clear();
+				contactNode->GetInfo().m_dir1_Force.Clear();
+				contactNode->GetInfo().m_normal_Force.Clear();
+			}
+			else
+			{
+				contactNode = contactPointList.Append();
 			}
-		}
-	
-		if (contactNode) 
-		{
-			count--;
-			ndAssert(index != -1);
-			nodes[index] = nodes[count];
-			cachePosition[index] = cachePosition[count];
-		}
-		else 
-		{
-			contactNode = contactPointList.Append();
 		}
 
 		ndContactMaterial* const contactPoint = &contactNode->GetInfo();
@@ -826,6 +1091,60 @@ void ndScene::UpdateTransform()
 	ParallelExecute(TransformUpdate);
 }
 
+void ndScene::UpdateQueryAabbs()
+{
+	D_TRACKTIME();
+	// the transform update moved the bodies but not their shapes and leaf boxes,
+	// refit them so that queries issued before the next step see the new positions
+	if (!m_rootNode)
+	{
+		return;
+	}
+
+	ndAtomic<ndInt32> iterator(0);
+	auto UpdateQueryAabb = ndMakeObject::ndFunction([this, &iterator](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(UpdateQueryAabb);
+		const ndArray<ndBodyKinematic*>& view = GetActiveBodyArray();
+		ndBvhNodeArray& array = m_bvhSceneManager.GetNodeArray();
+
+		const ndInt32 count = ndInt32(view.GetCount()) - 1;
+		for (ndInt32 i = iterator.fetch_add(D_WORKER_BATCH_SIZE); i < count; i = iterator.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((count - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : count - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				ndBodyKinematic* const body = view[i + j];
+				if (!body->m_equilibrium)
+				{
+					ndBvhLeafNode* const bodyNode = (ndBvhLeafNode*)array[body->m_bodyNodeIndex];
+					ndAssert(bodyNode->GetAsSceneBodyNode());
+					ndAssert(bodyNode->GetBody() == body);
+
+					body->UpdateCollisionMatrix();
+					if (!ndBoxInclusionTest(body->m_minAabb, body->m_maxAabb, bodyNode->m_minBox, bodyNode->m_maxBox))
+					{
+						bodyNode->SetAabb(body->m_minAabb, body->m_maxAabb);
+						for (ndBvhInternalNode* parent = (ndBvhInternalNode*)bodyNode->m_parent; parent; parent = (ndBvhInternalNode*)parent->m_parent)
+						{
+							ndAssert(parent->GetAsSceneTreeNode());
+							// only grow the parents, other threads may be growing them too
+							ndScopeSpinLock lock(parent->m_lock);
+							if (ndBoxInclusionTest(body->m_minAabb, body->m_maxAabb, parent->m_minBox, parent->m_maxBox))
+							{
+								break;
+							}
+							parent->m_minBox = parent->m_minBox.GetMin(body->m_minAabb);
+							parent->m_maxBox = parent->m_maxBox.GetMax(body->m_maxAabb);
+						}
+					}
+				}
+			}
+		}
+	});
+	ParallelExecute(UpdateQueryAabb);
+}
+
 void ndScene::CalculateContacts(ndInt32 threadIndex, ndContact* const contact)
 {
 	const ndUnsigned32 lru = m_lru - D_CONTACT_DELAY_FRAMES;
@@ -903,6 +1222,10 @@ void ndScene::CalculateContacts(ndInt32 threadIndex, ndContact* const contact)
 			{
 				body1->m_equilibrium = 0;
 			}
+			if (body0->m_islandSleep | body1->m_islandSleep)
+			{
+				WakeBody(body0->m_islandSleep ? body0 : body1);
+			}
 		}
 	}
 	else
@@ -1143,6 +1466,97 @@ bool ndScene::RayCast(ndRayCastNotify& callback, const ndBvhNode** stackPool, nd
 	return state;
 }
 
+ndInt32 ndScene::RayCastPacket(ndRayCastNotify** const callbacks, const ndFastRayPacket& packet) const
+{
+	ndFloat32 distance[D_SCENE_MAX_STACK_DEPTH];
+	const ndBvhNode* stackPool[D_SCENE_MAX_STACK_DEPTH];
+	ndVector packetDistance[D_SCENE_MAX_STACK_DEPTH];
+	const ndBvhNode* packetPool[D_SCENE_MAX_STACK_DEPTH];
+
+	ndInt32 hitMask = 0;
+	const ndInt32 laneMask = packet.GetLaneMask();
+	ndVector param(ndFloat32(-1.0f));
+	for (ndInt32 i = 0; i < packet.m_count; ++i)
+	{
+		param[i] = callbacks[i]->m_param;
+	}
+
+	ndInt32 stack = 1;
+	packetPool[0] = m_rootNode;
+	packetDistance[0] = packet.BoxIntersect(m_rootNode->m_minBox, m_rootNode->m_maxBox);
+	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+	{
+		stack--;
+		const ndInt32 activeMask = (packetDistance[stack] < param).GetSignMask() & laneMask;
+		if (!activeMask)
+		{
+			continue;
+		}
+
+		const ndBvhNode* const me = packetPool[stack];
+		ndAssert(me);
+		if (!(activeMask & (activeMask - 1)))
+		{
+			// the packet diverged, the one ray left finishes the branch alone
+			const ndInt32 lane = ndExp2(activeMask);
+			stackPool[0] = me;
+			distance[0] = packetDistance[stack][lane];
+			if (RayCast(*callbacks[lane], stackPool, distance, 1, packet.m_rays[lane]))
+			{
+				hitMask |= 1 << lane;
+			}
+			param[lane] = callbacks[lane]->m_param;
+			continue;
+		}
+
+		ndBodyKinematic* const body = me->GetBody();
+		if (body)
+		{
+			ndAssert(!me->GetLeft());
+			ndAssert(!me->GetRight());
+			hitMask |= body->RayCastPacket(callbacks, packet.m_rays, activeMask);
+			for (ndInt32 mask = activeMask; mask; mask = mask & (mask - 1))
+			{
+				const ndInt32 lane = ndExp2(mask & -mask);
+				param[lane] = callbacks[lane]->m_param;
+			}
+		}
+		else
+		{
+			const ndBvhNode* const left = me->GetLeft();
+			const ndBvhNode* const right = me->GetRight();
+			ndAssert(left);
+			ndAssert(right);
+			const ndVector leftDist(packet.BoxIntersect(left->m_minBox, left->m_maxBox));
+			const ndVector rightDist(packet.BoxIntersect(right->m_minBox, right->m_maxBox));
+			const ndInt32 leftMask = (leftDist < param).GetSignMask() & activeMask;
+			const ndInt32 rightMask = (rightDist < param).GetSignMask() & activeMask;
+
+			// the child nearer to most rays is pushed last, so it is visited first
+			ndInt32 nearCount = 0;
+			for (ndInt32 mask = (leftDist < rightDist).GetSignMask() & activeMask; mask; mask = mask & (mask - 1))
+			{
+				nearCount++;
+			}
+			const bool leftIsNear = (nearCount * 2) >= packet.m_count;
+			const ndBvhNode* const children[] = { leftIsNear ? right : left, leftIsNear ? left : right };
+			const ndVector childDist[] = { leftIsNear ? rightDist : leftDist, leftIsNear ? leftDist : rightDist };
+			const ndInt32 childMask[] = { leftIsNear ? rightMask : leftMask, leftIsNear ? leftMask : rightMask };
+			for (ndInt32 i = 0; i < 2; ++i)
+			{
+				if (childMask[i])
+				{
+					packetPool[stack] = children[i];
+					packetDistance[stack] = childDist[i];
+					stack++;
+					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+				}
+			}
+		}
+	}
+	return hitMask;
+}
+
 void ndScene::BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const
 {
 	callback.Reset();
@@ -1209,6 +1623,20 @@ void ndScene::Cleanup()
 	m_bvhSceneManager.CleanUp();
 	m_contactArray.DeleteAllContacts();
 
+	for (ndInt32 i = ndInt32(m_parkedContacts.GetCount()) - 1; i >= 0; --i)
+	{
+		ndContact* const contact = m_parkedContacts[i];
+		if (contact->m_isParked)
+		{
+			m_contactArray.DetachContact(contact);
+			delete contact;
+		}
+	}
+	m_wakeQueue.SetCount(0);
+	m_parkedContacts.SetCount(0);
+	m_parkedContactsDirty = false;
+	m_sleepStats = ndSleepStats();
+
 	ndFreeListAlloc::Flush();
 	m_sceneBodyArray.Resize(1024);
 	m_activeConstraintArray.Resize(1024);
@@ -1245,57 +1673,545 @@ bool ndScene::RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, c
 	return state;
 }
 
-bool ndScene::ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const
+void ndScene::RayCastBatch(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count)
 {
-	bool state = false;
-	callback.m_param = ndFloat32(1.2f);
-	if (m_rootNode)
+	D_TRACKTIME();
+	// closest hit notify of the batch, the only callbacks in the batch
+	class ndBatchRayCastNotify : public ndRayCastNotify
 	{
-		ndVector boxP0;
-		ndVector boxP1;
-		ndAssert(globalOrigin.TestOrthogonal());
-		convexShape.CalculateAabb(globalOrigin, boxP0, boxP1);
+		public:
+		ndBatchRayCastNotify()
+			:ndRayCastNotify()
+			,m_ignoreBody(nullptr)
+		{
+		}
 
-		ndFloat32 distance[D_SCENE_MAX_STACK_DEPTH];
-		const ndBvhNode* stackPool[D_SCENE_MAX_STACK_DEPTH];
+		ndUnsigned32 OnRayPrecastAction(const ndBody* const body, const ndShapeInstance* const)
+		{
+			return ndUnsigned32(body != m_ignoreBody);
+		}
 
-		const ndVector velocB(ndVector::m_zero);
-		const ndVector velocA((globalDest - globalOrigin.m_posit) & ndVector::m_triplexMask);
-		const ndVector minBox(m_rootNode->m_minBox - boxP1);
-		const ndVector maxBox(m_rootNode->m_maxBox - boxP0);
-		ndFastRay ray(ndVector::m_zero, velocA);
+		ndFloat32 OnRayCastAction(const ndContactPoint& contact, ndFloat32 intersetParam)
+		{
+			if (intersetParam < m_param)
+			{
+				m_contact = contact;
+				m_param = intersetParam;
+			}
+			return intersetParam;
+		}
 
-		stackPool[0] = m_rootNode;
-		distance[0] = ray.BoxIntersect(minBox, maxBox);
-		state = ConvexCast(callback, stackPool, distance, 1, ray, convexShape, globalOrigin, globalDest);
-	}
-	return state;
-}
+		const ndBody* m_ignoreBody;
+	};
 
-void ndScene::SendBackgroundTask(ndBackgroundTask* const job)
-{
-	if (m_backgroundThread)
+	class ndRayKey
 	{
-		m_backgroundThread->SendTask(job);
-	}
-	else
+		public:
+		ndUnsigned32 m_key;
+		ndInt32 m_index;
+	};
+
+	class ndEvaluateKey
 	{
-		ndAssert(0);
-		delete job;
-	}
-}
+		public:
+		ndEvaluateKey(const void* const shift)
+		{
+			m_shift = *((ndInt32*)shift);
+		}
 
-void ndScene::AddPair(ndBodyKinematic* const body0, ndBodyKinematic* const body1, ndInt32 threadId)
-{
-	const ndBodyKinematic::ndContactMap& contactMap0 = body0->GetContactMap();
-	const ndBodyKinematic::ndContactMap& contactMap1 = body1->GetContactMap();
+		ndInt32 GetKey(const ndRayKey& entry) const
+		{
+			return ndInt32((entry.m_key >> m_shift) & 0x3ff);
+		}
 
-	ndContact* const contact = (contactMap0.GetCount() <= contactMap1.GetCount()) ? contactMap0.FindContact(body0, body1) : contactMap1.FindContact(body1, body0);
-	if (!contact)
+		ndInt32 m_shift;
+	};
+
+	if (count <= 0)
 	{
-		const ndJointBilateralConstraint* const bilateral = FindBilateralJoint(body0, body1);
-		const bool isCollidable = bilateral ? bilateral->IsCollidable() : true;
-		if (isCollidable)
+		return;
+	}
+
+	if (!m_rootNode)
+	{
+		for (ndInt32 i = 0; i < count; ++i)
+		{
+			hits[i].m_body = nullptr;
+			hits[i].m_shapeInstance = nullptr;
+			hits[i].m_param = ndFloat32(1.2f);
+		}
+		return;
+	}
+
+	// morton code of the ray origins in the root box, 10 bits per axis
+	ndArray<ndRayKey> keys;
+	ndArray<ndRayKey> keysScratch;
+	keys.SetCount(count);
+	const ndVector boxOrigin(m_rootNode->m_minBox);
+	const ndVector boxSize(m_rootNode->m_maxBox - m_rootNode->m_minBox);
+	const ndVector scale(ndVector::m_triplexMask & (ndVector(ndFloat32(1023.0f)) * boxSize.GetMax(ndVector(ndFloat32(1.0e-3f))).Reciproc()));
+	ndAtomic<ndInt32> iterator0(0);
+	auto CalculateRayKeys = ndMakeObject::ndFunction([&iterator0, &keys, rays, count, &boxOrigin, &scale](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(CalculateRayKeys);
+		auto SpreadBits = [](ndUnsigned32 x)
+		{
+			x = (x | (x << 16)) & 0x030000ff;
+			x = (x | (x << 8)) & 0x0300f00f;
+			x = (x | (x << 4)) & 0x030c30c3;
+			x = (x | (x << 2)) & 0x09249249;
+			return x;
+		};
+
+		const ndVector maxCell(ndFloat32(1023.0f));
+		for (ndInt32 i = iterator0.fetch_add(D_WORKER_BATCH_SIZE); i < count; i = iterator0.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((count - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : count - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				const ndInt32 index = i + j;
+				const ndVector cell((((rays[index].m_origin - boxOrigin) * scale).GetMax(ndVector::m_zero).GetMin(maxCell)).GetInt());
+				keys[index].m_key = SpreadBits(ndUnsigned32(cell.m_ix)) | (SpreadBits(ndUnsigned32(cell.m_iy)) << 1) | (SpreadBits(ndUnsigned32(cell.m_iz)) << 2);
+				keys[index].m_index = index;
+			}
+		}
+	});
+	ParallelExecute(CalculateRayKeys);
+
+	for (ndInt32 shift = 0; shift < 30; shift += 10)
+	{
+		ndCountingSort<ndRayKey, ndEvaluateKey, 10>(*this, keys, keysScratch, nullptr, &shift);
+	}
+
+	ndAtomic<ndInt32> iterator1(0);
+	auto RayCastRays = ndMakeObject::ndFunction([this, &iterator1, &keys, rays, hits, count](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(RayCastRays);
+		ndFloat32 distance[D_SCENE_MAX_STACK_DEPTH];
+		const ndBvhNode* stackPool[D_SCENE_MAX_STACK_DEPTH];
+
+		ndInt32 packetSign = 0;
+		ndInt32 packetCount = 0;
+		ndInt32 packetIndex[D_RAY_PACKET_SIZE];
+		ndBatchRayCastNotify callbacks[D_RAY_PACKET_SIZE];
+		ndRayCastNotify* callbackPtrs[D_RAY_PACKET_SIZE];
+		ndVector rayBuffer[D_RAY_PACKET_SIZE * sizeof(ndFastRay) / sizeof(ndVector)];
+		ndFastRay* const packetRays = (ndFastRay*)rayBuffer;
+		for (ndInt32 i = 0; i < D_RAY_PACKET_SIZE; ++i)
+		{
+			callbackPtrs[i] = &callbacks[i];
+		}
+
+		auto WriteMiss = [](ndRayCastHit& hit)
+		{
+			hit.m_body = nullptr;
+			hit.m_shapeInstance = nullptr;
+			hit.m_param = ndFloat32(1.2f);
+		};
+
+		// neighbor rays going the same way are traced as one packet, a lone ray goes alone
+		auto TracePacket = [this, hits, &stackPool, &distance, &packetCount, &packetIndex, &callbacks, &callbackPtrs, packetRays, &WriteMiss]()
+		{
+			if (packetCount > 1)
+			{
+				const ndFastRayPacket packet(packetRays, packetCount);
+				RayCastPacket(callbackPtrs, packet);
+			}
+			else
+			{
+				stackPool[0] = m_rootNode;
+				distance[0] = packetRays[0].BoxIntersect(m_rootNode->m_minBox, m_rootNode->m_maxBox);
+				RayCast(callbacks[0], stackPool, distance, 1, packetRays[0]);
+			}
+
+			for (ndInt32 k = 0; k < packetCount; ++k)
+			{
+				const ndBatchRayCastNotify& callback = callbacks[k];
+				ndRayCastHit& hit = hits[packetIndex[k]];
+				if (callback.m_param < ndFloat32(1.0f))
+				{
+					hit.m_point = callback.m_contact.m_point;
+					hit.m_normal = callback.m_contact.m_normal;
+					hit.m_body = callback.m_contact.m_body0;
+					hit.m_shapeInstance = callback.m_contact.m_shapeInstance0;
+					hit.m_param = callback.m_param;
+				}
+				else
+				{
+					WriteMiss(hit);
+				}
+			}
+			packetCount = 0;
+		};
+
+		for (ndInt32 i = iterator1.fetch_add(D_WORKER_BATCH_SIZE); i < count; i = iterator1.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((count - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : count - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				const ndInt32 index = keys[i + j].m_index;
+				const ndRayCastQuery& query = rays[index];
+				const ndVector p0(query.m_origin & ndVector::m_triplexMask);
+				const ndVector p1(query.m_dest & ndVector::m_triplexMask);
+				const ndVector segment(p1 - p0);
+				if (segment.DotProduct(segment).GetScalar() <= ndFloat32(1.0e-8f))
+				{
+					WriteMiss(hits[index]);
+					continue;
+				}
+
+				const ndInt32 sign = segment.GetSignMask() & 0x07;
+				if (packetCount && ((sign != packetSign) || (packetCount == D_RAY_PACKET_SIZE)))
+				{
+					TracePacket();
+				}
+
+				packetSign = sign;
+				::new (&packetRays[packetCount]) ndFastRay(p0, p1);
+				callbacks[packetCount].m_param = ndFloat32(1.2f);
+				callbacks[packetCount].m_ignoreBody = query.m_ignoreBody;
+				packetIndex[packetCount] = index;
+				packetCount++;
+			}
+			if (packetCount)
+			{
+				TracePacket();
+			}
+		}
+	});
+	ParallelExecute(RayCastRays);
+}
+
+bool ndScene::ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const
+{
+	bool state = false;
+	callback.m_param = ndFloat32(1.2f);
+	if (m_rootNode)
+	{
+		ndVector boxP0;
+		ndVector boxP1;
+		ndAssert(globalOrigin.TestOrthogonal());
+		convexShape.CalculateAabb(globalOrigin, boxP0, boxP1);
+
+		ndFloat32 distance[D_SCENE_MAX_STACK_DEPTH];
+		const ndBvhNode* stackPool[D_SCENE_MAX_STACK_DEPTH];
+
+		const ndVector velocB(ndVector::m_zero);
+		const ndVector velocA((globalDest - globalOrigin.m_posit) & ndVector::m_triplexMask);
+		const ndVector minBox(m_rootNode->m_minBox - boxP1);
+		const ndVector maxBox(m_rootNode->m_maxBox - boxP0);
+		ndFastRay ray(ndVector::m_zero, velocA);
+
+		stackPool[0] = m_rootNode;
+		distance[0] = ray.BoxIntersect(minBox, maxBox);
+		state = ConvexCast(callback, stackPool, distance, 1, ray, convexShape, globalOrigin, globalDest);
+	}
+	return state;
+}
+
+void ndScene::ConvexCastBatch(const ndConvexCastQuery* const queries, ndConvexCastHit* const hits, ndInt32 count)
+{
+	D_TRACKTIME();
+	// closest hit notify of the batch, skips the filter body of the query
+	class ndBatchConvexCastNotify : public ndConvexCastNotify
+	{
+		public:
+		ndBatchConvexCastNotify(const ndBody* const ignoreBody)
+			:ndConvexCastNotify()
+			,m_ignoreBody(ignoreBody)
+		{
+		}
+
+		ndUnsigned32 OnRayPrecastAction(const ndBody* const body, const ndShapeInstance* const)
+		{
+			return ndUnsigned32(body != m_ignoreBody);
+		}
+
+		const ndBody* m_ignoreBody;
+	};
+
+	ndFixSizeArray<ndBodyKinematic*, D_MAX_THREADS_COUNT> castBodies;
+	CreateQueryBodies(castBodies, GetThreadCount());
+
+	ndAtomic<ndInt32> iterator(0);
+	auto CastShapes = ndMakeObject::ndFunction([this, &iterator, &castBodies, queries, hits, count](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(CastShapes);
+		for (ndInt32 i = iterator.fetch_add(D_WORKER_BATCH_SIZE); i < count; i = iterator.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((count - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : count - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				const ndConvexCastQuery& query = queries[i + j];
+				ndConvexCastHit& hit = hits[i + j];
+
+				ndBatchConvexCastNotify callback(query.m_ignoreBody);
+				callback.m_castBody = castBodies[threadIndex];
+				callback.m_threadIndex = threadIndex;
+				if (ConvexCast(callback, *query.m_shape, query.m_origin, query.m_dest) && callback.m_contacts.GetCount())
+				{
+					const ndContactPoint& contact = callback.m_contacts[0];
+					hit.m_point = contact.m_point;
+					hit.m_normal = callback.m_normal;
+					hit.m_body = contact.m_body1;
+					hit.m_shapeInstance = contact.m_shapeInstance1;
+					hit.m_param = callback.m_param;
+				}
+				else
+				{
+					hit.m_body = nullptr;
+					hit.m_shapeInstance = nullptr;
+					hit.m_param = ndFloat32(1.2f);
+				}
+			}
+		}
+	});
+	ParallelExecute(CastShapes);
+	DestroyQueryBodies(castBodies);
+}
+
+void ndScene::BodiesInAabb(ndArray<ndBodyKinematic*>& bodies, const ndVector& minBox, const ndVector& maxBox, const ndBody* const ignoreBody) const
+{
+	if (m_rootNode)
+	{
+		const ndBvhNode* stackPool[D_SCENE_MAX_STACK_DEPTH];
+		stackPool[0] = m_rootNode;
+		ndInt32 stack = 1;
+		while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+		{
+			stack--;
+			const ndBvhNode* const rootNode = stackPool[stack];
+			if (ndOverlapTest(rootNode->m_minBox, rootNode->m_maxBox, minBox, maxBox))
+			{
+				ndBodyKinematic* const body = rootNode->GetBody();
+				if (body)
+				{
+					if ((body != ignoreBody) && ndOverlapTest(body->m_minAabb, body->m_maxAabb, minBox, maxBox))
+					{
+						bodies.PushBack(body);
+					}
+				}
+				else
+				{
+					stackPool[stack] = rootNode->GetLeft();
+					stack++;
+					stackPool[stack] = rootNode->GetRight();
+					stack++;
+					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+				}
+			}
+		}
+	}
+}
+
+bool ndScene::ShapeIntersect(ndBodyKinematic* const queryBody, ndBodyKinematic* const body, ndContactNotify* const notify, ndInt32 threadIndex) const
+{
+	if (body->GetCollisionShape().GetShape()->GetAsShapeNull())
+	{
+		return false;
+	}
+
+	// same intersection test path the narrow phase uses for trigger volumes
+	ndContact contact;
+	ndContactPoint contactBuffer[D_MAX_CONTATCS];
+	contact.SetBodies(queryBody, body);
+	ndContactSolver contactSolver(&contact, notify, ndFloat32(1.0f), threadIndex);
+	contactSolver.m_contactBuffer = contactBuffer;
+	contactSolver.m_intersectionTestOnly = 1;
+	return contactSolver.CalculateContactsDiscrete() > 0;
+}
+
+void ndScene::CreateQueryBodies(ndFixSizeArray<ndBodyKinematic*, D_MAX_THREADS_COUNT>& queryBodies, ndInt32 count) const
+{
+	// query bodies carry the shape of a query, they are not part of the scene 
+	// and give back their unique ids so application bodies keep their numbering
+	const ndUnsigned32 uniqueIdCount = ndBody::m_uniqueIdCount;
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		queryBodies.PushBack(new ndBodyKinematic());
+	}
+	ndBody::m_uniqueIdCount = uniqueIdCount;
+}
+
+void ndScene::DestroyQueryBodies(ndFixSizeArray<ndBodyKinematic*, D_MAX_THREADS_COUNT>& queryBodies) const
+{
+	for (ndInt32 i = 0; i < queryBodies.GetCount(); ++i)
+	{
+		delete queryBodies[i];
+	}
+	queryBodies.SetCount(0);
+}
+
+void ndScene::ShapeOverlap(ndBodiesInAabbNotify& callback, const ndShapeInstance& shape, const ndMatrix& matrix) const
+{
+	callback.Reset();
+
+	ndVector minBox;
+	ndVector maxBox;
+	ndArray<ndBodyKinematic*> bodies;
+	shape.CalculateAabb(matrix, minBox, maxBox);
+	BodiesInAabb(bodies, minBox, maxBox, nullptr);
+	if (bodies.GetCount())
+	{
+		ndFixSizeArray<ndBodyKinematic*, D_MAX_THREADS_COUNT> queryBodies;
+		CreateQueryBodies(queryBodies, 1);
+		ndBodyKinematic* const queryBody = queryBodies[0];
+		ndContactNotify notify((ndScene*)this);
+		queryBody->SetCollisionShape(shape);
+		queryBody->SetMatrix(matrix);
+		queryBody->SetMassMatrix(ndVector::m_one);
+		ndShapeInstance& queryShape = queryBody->GetCollisionShape();
+		queryShape.SetGlobalMatrix(queryShape.GetLocalMatrix() * matrix);
+		for (ndInt32 i = 0; i < ndInt32(bodies.GetCount()); ++i)
+		{
+			if (ShapeIntersect(queryBody, bodies[i], &notify, 0))
+			{
+				callback.OnOverlap(bodies[i]);
+			}
+		}
+		DestroyQueryBodies(queryBodies);
+	}
+}
+
+void ndScene::OverlapBatch(const ndAabbQuery* const boxQueries, const ndShapeOverlapQuery* const shapeQueries, ndInt32 count, ndOverlapBatchResult& result)
+{
+	D_TRACKTIME();
+	result.m_bodies.SetCount(0);
+	result.m_ranges.SetCount(count);
+
+	// each thread appends to its own array, the arrays are packed after the queries
+	ndArray<ndInt32> owners;
+	ndArray<ndBodyKinematic*> threadBodies[D_MAX_THREADS_COUNT];
+	owners.SetCount(count);
+
+	ndFixSizeArray<ndBodyKinematic*, D_MAX_THREADS_COUNT> queryBodies;
+	if (shapeQueries)
+	{
+		CreateQueryBodies(queryBodies, GetThreadCount());
+	}
+
+	ndAtomic<ndInt32> iterator(0);
+	auto FindOverlaps = ndMakeObject::ndFunction([this, &iterator, &threadBodies, &owners, &queryBodies, &result, boxQueries, shapeQueries, count](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(FindOverlaps);
+		ndContactNotify notify(this);
+		ndArray<ndBodyKinematic*> candidates;
+		ndArray<ndBodyKinematic*>& bodies = threadBodies[threadIndex];
+		for (ndInt32 i = iterator.fetch_add(D_WORKER_BATCH_SIZE); i < count; i = iterator.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((count - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : count - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				const ndInt32 index = i + j;
+				ndOverlapBatchResult::ndRange& range = result.m_ranges[index];
+				range.m_start = ndInt32(bodies.GetCount());
+				owners[index] = threadIndex;
+				if (shapeQueries)
+				{
+					ndVector minBox;
+					ndVector maxBox;
+					const ndShapeOverlapQuery& query = shapeQueries[index];
+					query.m_shape->CalculateAabb(query.m_matrix, minBox, maxBox);
+					candidates.SetCount(0);
+					BodiesInAabb(candidates, minBox, maxBox, query.m_ignoreBody);
+					if (candidates.GetCount())
+					{
+						ndBodyKinematic* const queryBody = queryBodies[threadIndex];
+						queryBody->SetCollisionShape(*query.m_shape);
+						queryBody->SetMatrix(query.m_matrix);
+						queryBody->SetMassMatrix(ndVector::m_one);
+						ndShapeInstance& queryShape = queryBody->GetCollisionShape();
+						queryShape.SetGlobalMatrix(queryShape.GetLocalMatrix() * query.m_matrix);
+						for (ndInt32 k = 0; k < ndInt32(candidates.GetCount()); ++k)
+						{
+							if (ShapeIntersect(queryBody, candidates[k], &notify, threadIndex))
+							{
+								bodies.PushBack(candidates[k]);
+							}
+						}
+					}
+				}
+				else
+				{
+					const ndAabbQuery& query = boxQueries[index];
+					BodiesInAabb(bodies, query.m_minBox, query.m_maxBox, query.m_ignoreBody);
+				}
+				range.m_count = ndInt32(bodies.GetCount()) - range.m_start;
+			}
+		}
+	});
+	ParallelExecute(FindOverlaps);
+	DestroyQueryBodies(queryBodies);
+
+	ndInt32 sum = 0;
+	ndInt32 offsets[D_MAX_THREADS_COUNT];
+	for (ndInt32 i = 0; i < D_MAX_THREADS_COUNT; ++i)
+	{
+		offsets[i] = sum;
+		sum += ndInt32(threadBodies[i].GetCount());
+	}
+
+	result.m_bodies.SetCount(sum);
+	for (ndInt32 i = 0; i < D_MAX_THREADS_COUNT; ++i)
+	{
+		if (threadBodies[i].GetCount())
+		{
+			ndMemCpy(&result.m_bodies[offsets[i]], &threadBodies[i][0], threadBodies[i].GetCount());
+		}
+	}
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		result.m_ranges[i].m_start += offsets[owners[i]];
+	}
+}
+
+void ndScene::BodiesInAabbBatch(const ndAabbQuery* const queries, ndInt32 count, ndOverlapBatchResult& result)
+{
+	OverlapBatch(queries, nullptr, count, result);
+}
+
+void ndScene::ShapeOverlapBatch(const ndShapeOverlapQuery* const queries, ndInt32 count, ndOverlapBatchResult& result)
+{
+	OverlapBatch(nullptr, queries, count, result);
+}
+
+void ndScene::SendBackgroundTask(ndBackgroundTask* const job)
+{
+	if (m_backgroundThread)
+	{
+		m_backgroundThread->SendTask(job);
+	}
+	else
+	{
+		ndAssert(0);
+		delete job;
+	}
+}
+
+void ndScene::AddPair(ndBodyKinematic* const body0, ndBodyKinematic* const body1, ndInt32 threadId)
+{
+	const ndBodyKinematic::ndContactMap& contactMap0 = body0->GetContactMap();
+	const ndBodyKinematic::ndContactMap& contactMap1 = body1->GetContactMap();
+
+	ndContact* const contact = (contactMap0.GetCount() <= contactMap1.GetCount()) ? contactMap0.FindContact(body0, body1) : contactMap1.FindContact(body1, body0);
+	if (!contact && (body0->m_islandSleep | body1->m_islandSleep))
+	{
+		// bodies in a sleeping island are not in the active array, the island 
+		// wakes after the narrow phase and the pair is found again that step.
+		if (body0->m_islandSleep)
+		{
+			WakeBody(body0);
+		}
+		if (body1->m_islandSleep)
+		{
+			WakeBody(body1);
+		}
+	}
+	else if (!contact)
+	{
+		const ndJointBilateralConstraint* const bilateral = FindBilateralJoint(body0, body1);
+		const bool isCollidable = bilateral ? bilateral->IsCollidable() : true;
+		if (isCollidable)
 		{
 			bool selfSkelCollidable = body0->GetSeletonSelfCollision() && body1->GetSeletonSelfCollision();
 			if (!selfSkelCollidable)
@@ -1402,8 +2318,303 @@ void ndScene::UpdateBodyList()
 	if (m_bodyList.UpdateView())
 	{
 		ndArray<ndBodyKinematic*>& view = GetActiveBodyArray();
+		m_sleepStats.m_activeBodies = ndInt32(view.GetCount());
+		m_sleepStats.m_sleepingBodies = ndInt32(m_bodyList.GetCount()) - m_sleepStats.m_activeBodies;
 		view.PushBack(m_sentinelBody);
 	}
+	m_sleepStats.m_parkedContacts = ndInt32(m_parkedContacts.GetCount());
+}
+
+void ndScene::WakeBody(ndBodyKinematic* const body)
+{
+	ndScopeSpinLock lock(m_wakeLock);
+	if (!body->m_inWakeQueue)
+	{
+		body->m_inWakeQueue = 1;
+		m_wakeQueue.PushBack(body);
+	}
+}
+
+void ndScene::UnparkContact(ndContact* const contact)
+{
+	ndAssert(contact->m_isParked);
+	contact->m_isParked = 0;
+	contact->m_sceneLru = m_lru;
+	m_contactArray.PushBack(contact);
+	m_parkedContactsDirty = true;
+}
+
+void ndScene::WakeSleepingIslands()
+{
+	if (m_wakeQueue.GetCount())
+	{
+		D_TRACKTIME();
+		// the queue grows as the wake up propagates through 
+		// contacts and joints, until the whole island is awake.
+		ndInt32 wokenBodies = 0;
+		ndArray<ndBodyKinematic*> overlaps;
+		for (ndInt32 i = 0; i < ndInt32(m_wakeQueue.GetCount()); ++i)
+		{
+			ndBodyKinematic* const body = m_wakeQueue[i];
+			if (body->m_islandSleep)
+			{
+				body->m_islandSleep = 0;
+				body->m_equilibrium = 0;
+				body->m_restingSteps = 0;
+				body->m_sceneForceUpdate = 1;
+				wokenBodies++;
+			}
+			else if (body->m_invMass.m_w > ndFloat32(0.0f))
+			{
+				// an awake dynamic body has no sleeping neighbors
+				continue;
+			}
+			else
+			{
+				// a static body that moved only changes the contacts it was 
+				// touching and the ones it overlaps at the new position.
+				ndBodyKinematic::ndContactMap::Iterator it(body->m_contactList);
+				for (it.Begin(); it; it++)
+				{
+					const ndContact* const contact = it.GetNode()->GetInfo();
+					ndBodyKinematic* const other = (contact->GetBody0() == body) ? contact->GetBody1() : contact->GetBody0();
+					if (contact->IsActive() && contact->m_maxDof && other->m_islandSleep && !other->m_inWakeQueue)
+					{
+						other->m_inWakeQueue = 1;
+						m_wakeQueue.PushBack(other);
+					}
+				}
+
+				overlaps.SetCount(0);
+				body->UpdateCollisionMatrix();
+				BodiesInAabb(overlaps, body->m_minAabb, body->m_maxAabb, body);
+				for (ndInt32 j = 0; j < ndInt32(overlaps.GetCount()); ++j)
+				{
+					ndBodyKinematic* const other = overlaps[j];
+					if (other->m_islandSleep && !other->m_inWakeQueue)
+					{
+						other->m_inWakeQueue = 1;
+						m_wakeQueue.PushBack(other);
+					}
+				}
+				continue;
+			}
+
+			ndBodyKinematic::ndContactMap::Iterator it(body->m_contactList);
+			for (it.Begin(); it; it++)
+			{
+				ndContact* const contact = it.GetNode()->GetInfo();
+				if (contact->m_isParked)
+				{
+					UnparkContact(contact);
+				}
+				ndBodyKinematic* const other = (contact->GetBody0() == body) ? contact->GetBody1() : contact->GetBody0();
+				if (other->m_islandSleep && !other->m_inWakeQueue)
+				{
+					other->m_inWakeQueue = 1;
+					m_wakeQueue.PushBack(other);
+				}
+			}
+
+			for (ndBodyKinematic::ndJointList::ndNode* node = body->m_jointList.GetFirst(); node; node = node->GetNext())
+			{
+				ndJointBilateralConstraint* const joint = node->GetInfo();
+				ndBodyKinematic* const other = (joint->GetBody0() == body) ? joint->GetBody1() : joint->GetBody0();
+				if (other->m_islandSleep && !other->m_inWakeQueue)
+				{
+					other->m_inWakeQueue = 1;
+					m_wakeQueue.PushBack(other);
+				}
+			}
+		}
+
+		for (ndInt32 i = ndInt32(m_wakeQueue.GetCount()) - 1; i >= 0; --i)
+		{
+			m_wakeQueue[i]->m_inWakeQueue = 0;
+		}
+		m_wakeQueue.SetCount(0);
+
+		if (wokenBodies)
+		{
+			m_bodyList.m_listIsDirty = 1;
+			m_sleepStats.m_wokenBodies += wokenBodies;
+		}
+	}
+
+	if (m_parkedContactsDirty)
+	{
+		ndInt32 count = 0;
+		for (ndInt32 i = 0; i < ndInt32(m_parkedContacts.GetCount()); ++i)
+		{
+			ndContact* const contact = m_parkedContacts[i];
+			if (contact->m_isParked)
+			{
+				m_parkedContacts[count] = contact;
+				count++;
+			}
+		}
+		m_parkedContacts.SetCount(count);
+		m_parkedContactsDirty = false;
+	}
+}
+
+void ndScene::DeactivateRestingIslands()
+{
+	// the body indices are only valid if the list did not change since last step
+	const ndArray<ndBodyKinematic*>& view = GetActiveBodyArray();
+	const ndInt32 bodyCount = ndInt32(view.GetCount()) - 1;
+	if (m_bodyList.IsListDirty() || (bodyCount <= 0))
+	{
+		return;
+	}
+
+	D_TRACKTIME();
+	ndInt32 candidates = 0;
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		ndBodyKinematic* const body = view[i];
+		ndAssert(body->m_index == i);
+		ndUnsigned8 resting = ndUnsigned8(body->m_equilibrium & body->m_autoSleep & !body->m_isStatic);
+		if (resting)
+		{
+			// skeletons and special bodies manage their own sleep state
+			resting = ndUnsigned8(!body->m_skeletonContainer && body->GetAsBodyDynamic() && !body->GetAsBodyKinematicSpecial());
+		}
+		body->m_restingSteps = resting ? ndUnsigned8(ndMin(ndInt32(body->m_restingSteps) + 1, 255)) : ndUnsigned8(0);
+		candidates += (body->m_restingSteps >= D_ISLAND_SLEEP_STEPS) ? 1 : 0;
+	}
+	if (!candidates)
+	{
+		return;
+	}
+
+	m_scratchBuffer.SetCount(ndInt32(2 * bodyCount * sizeof(ndInt32)));
+	ndInt32* const parent = (ndInt32*)&m_scratchBuffer[0];
+	ndInt32* const asleep = &parent[bodyCount];
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		parent[i] = i;
+		asleep[i] = (view[i]->m_restingSteps >= D_ISLAND_SLEEP_STEPS) ? 1 : 0;
+	}
+
+	auto FindRoot = [parent](ndInt32 node)
+	{
+		while (parent[node] != node)
+		{
+			parent[node] = parent[parent[node]];
+			node = parent[node];
+		}
+		return node;
+	};
+
+	auto IsMoving = [](const ndBodyKinematic* const body)
+	{
+		const ndVector veloc(body->m_veloc.DotProduct(body->m_veloc) + body->m_omega.DotProduct(body->m_omega));
+		return veloc.GetScalar() > ndFloat32(0.0f);
+	};
+
+	// static bodies and sleeping islands do not join an island, 
+	// but a moving static body keeps the island awake
+	auto Connect = [parent, asleep, &FindRoot, &IsMoving](ndInt32 index, ndBodyKinematic* const other)
+	{
+		if (other->m_isStatic || other->m_islandSleep)
+		{
+			if (IsMoving(other))
+			{
+				asleep[index] = 0;
+			}
+		}
+		else
+		{
+			const ndInt32 root0 = FindRoot(index);
+			const ndInt32 root1 = FindRoot(other->m_index);
+			if (root0 != root1)
+			{
+				parent[root0] = root1;
+			}
+		}
+	};
+
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		ndBodyKinematic* const body = view[i];
+		if (!body->m_isStatic)
+		{
+			ndBodyKinematic::ndContactMap::Iterator it(body->m_contactList);
+			for (it.Begin(); it; it++)
+			{
+				const ndContact* const contact = it.GetNode()->GetInfo();
+				if (contact->IsActive() && !contact->m_isDead)
+				{
+					Connect(i, (contact->GetBody0() == body) ? contact->GetBody1() : contact->GetBody0());
+				}
+			}
+
+			for (ndBodyKinematic::ndJointList::ndNode* node = body->m_jointList.GetFirst(); node; node = node->GetNext())
+			{
+				const ndJointBilateralConstraint* const joint = node->GetInfo();
+				if (joint->IsActive())
+				{
+					Connect(i, (joint->GetBody0() == body) ? joint->GetBody1() : joint->GetBody0());
+				}
+			}
+		}
+	}
+
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		if (!view[i]->m_isStatic && !asleep[i])
+		{
+			asleep[FindRoot(i)] = 0;
+		}
+	}
+
+	ndInt32 deactivatedBodies = 0;
+	const ndVector zero(ndVector::m_zero);
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		ndBodyKinematic* const body = view[i];
+		if (!body->m_isStatic && asleep[FindRoot(i)])
+		{
+			body->m_islandSleep = 1;
+			body->m_equilibrium = 1;
+			body->m_sceneEquilibrium = 1;
+			body->m_islandParent = body;
+			body->m_veloc = zero;
+			body->m_omega = zero;
+			body->m_accel = zero;
+			body->m_alpha = zero;
+			deactivatedBodies++;
+		}
+	}
+
+	if (deactivatedBodies)
+	{
+		// contacts with both sides asleep or static leave the contact array
+		ndScopeSpinLock lock(m_contactArray.GetLock());
+		ndInt32 count = 0;
+		for (ndInt32 i = 0; i < ndInt32(m_contactArray.GetCount()); ++i)
+		{
+			ndContact* const contact = m_contactArray[i];
+			const ndBodyKinematic* const body0 = contact->GetBody0();
+			const ndBodyKinematic* const body1 = contact->GetBody1();
+			const bool rest0 = body0->m_islandSleep || (body0->m_isStatic && !IsMoving(body0));
+			const bool rest1 = body1->m_islandSleep || (body1->m_isStatic && !IsMoving(body1));
+			if (rest0 && rest1 && (body0->m_islandSleep | body1->m_islandSleep) && !contact->m_isDead)
+			{
+				contact->m_isParked = 1;
+				m_parkedContacts.PushBack(contact);
+			}
+			else
+			{
+				m_contactArray[count] = contact;
+				count++;
+			}
+		}
+		m_contactArray.SetCount(count);
+		m_bodyList.m_listIsDirty = 1;
+		m_sleepStats.m_deactivatedBodies += deactivatedBodies;
+	}
 }
 
 void ndScene::ApplyExtForce()
@@ -1626,16 +2837,21 @@ void ndScene::CalculateContacts()
 	ndScopeSpinLock lock(m_contactArray.GetLock());
 	const ndInt32 contactCount = ndInt32(m_contactArray.GetCount() + m_newPairs.GetCount());
 	m_contactArray.SetCount(contactCount);
-	if (contactCount)
+	CalculateContactBatch(0, contactCount);
+}
+
+void ndScene::CalculateContactBatch(ndInt32 start, ndInt32 count)
+{
+	if (count)
 	{
-		ndContact** const tmpJointsArray = (ndContact**)&m_scratchBuffer[0];
+		ndContact** const tmpJointsArray = (ndContact**)&m_scratchBuffer[start * ndInt32(sizeof(ndContact*))];
 
 		ndAtomic<ndInt32> iterator(0);
-		auto CalculateContactPoints = ndMakeObject::ndFunction([this, &iterator, tmpJointsArray](ndInt32 threadIndex, ndInt32)
+		auto CalculateContactPoints = ndMakeObject::ndFunction([this, &iterator, tmpJointsArray, count](ndInt32 threadIndex, ndInt32)
 		{
 			D_TRACKTIME_NAMED(CalculateContactPoints);
 
-			const ndInt32 jointCount = ndInt32(m_contactArray.GetCount());
+			const ndInt32 jointCount = count;
 			for (ndInt32 i = iterator.fetch_add(D_WORKER_BATCH_SIZE); i < jointCount; i = iterator.fetch_add(D_WORKER_BATCH_SIZE))
 			{
 				const ndInt32 maxSpan = ((jointCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : jointCount - i;
@@ -1645,12 +2861,99 @@ void ndScene::CalculateContacts()
 					ndAssert(contact);
 					if (!contact->m_isDead)
 					{
-						CalculateContacts(threadIndex, contact);
+						if (IsSplitNarrowPhasePair(contact))
+						{
+							ndScopeSpinLock lock(m_lock);
+							m_splitPairs.PushBack(contact);
+						}
+						else
+						{
+							CalculateContacts(threadIndex, contact);
+						}
 					}
 				}
 			}
 		});
+		m_splitPairs.SetCount(0);
 		ParallelExecute(CalculateContactPoints);
+
+		// heavy pairs run one at a time, each one using all the threads.
+		// the pairs are pushed in thread timing order, sort them by body id.
+		class ndCompareSplitPairs
+		{
+			public:
+			ndCompareSplitPairs(void*)
+			{
+			}
+
+			ndInt32 Compare(const ndContact* const contactA, const ndContact* const contactB) const
+			{
+				const ndUnsigned64 keyA = (ndUnsigned64(contactA->GetBody0()->m_uniqueId) << 32) + contactA->GetBody1()->m_uniqueId;
+				const ndUnsigned64 keyB = (ndUnsigned64(contactB->GetBody0()->m_uniqueId) << 32) + contactB->GetBody1()->m_uniqueId;
+				if (keyA < keyB)
+				{
+					return -1;
+				}
+				else if (keyA > keyB)
+				{
+					return 1;
+				}
+				return 0;
+			}
+		};
+		if (m_splitPairs.GetCount() > 1)
+		{
+			ndSort<ndContact*, ndCompareSplitPairs>(&m_splitPairs[0], ndInt32(m_splitPairs.GetCount()), nullptr);
+		}
+		m_splitPairsPhase = true;
+		for (ndInt32 i = 0; i < ndInt32(m_splitPairs.GetCount()); ++i)
+		{
+			CalculateContacts(0, m_splitPairs[i]);
+		}
+		m_splitPairsPhase = false;
+	}
+}
+
+void ndScene::WakeTouchedIslands()
+{
+	// the narrow phase queues the sleeping islands touched by awake bodies, 
+	// they wake here and only their contacts and new pairs are calculated, 
+	// the contacts calculated earlier in the step are still valid.
+	while (m_wakeQueue.GetCount())
+	{
+		D_TRACKTIME();
+		const ndInt32 wokenBodies = m_sleepStats.m_wokenBodies;
+		const ndInt32 validContacts = ndInt32(m_contactArray.GetCount());
+		WakeSleepingIslands();
+		if (wokenBodies == m_sleepStats.m_wokenBodies)
+		{
+			break;
+		}
+		UpdateBodyList();
+
+		// the woken bodies are flagged for a scene update
+		const ndArray<ndBodyKinematic*>& view = GetActiveBodyArray();
+		for (ndInt32 i = ndInt32(view.GetCount()) - 2; i >= 0; --i)
+		{
+			ndBodyKinematic* const body = view[i];
+			if (body->m_sceneForceUpdate)
+			{
+				body->ApplyExternalForces(0, m_timestep);
+			}
+		}
+		InitBodyArray();
+		FindCollidingPairs();
+		CreateNewContacts();
+
+		{
+			ndScopeSpinLock lock(m_contactArray.GetLock());
+			const ndInt32 newPairs = ndInt32(m_newPairs.GetCount());
+			const ndInt32 contactCount = ndInt32(m_contactArray.GetCount()) + newPairs;
+			m_contactArray.SetCount(contactCount);
+			CalculateContactBatch(0, newPairs);
+			CalculateContactBatch(newPairs + validContacts, contactCount - newPairs - validContacts);
+		}
+		DeleteDeadContacts();
 	}
 }
 
@@ -1677,7 +2980,9 @@ void ndScene::DeleteDeadContacts()
 		ndInt32 GetKey(const ndContact* const contact) const
 		{
 			//const ndUnsigned32 inactive = ndUnsigned32(!contact->IsActive() | (contact->m_maxDOF ? 0 : 1));
-			const ndUnsigned32 inactive = ndUnsigned32(!contact->IsActive() | (contact->m_maxDof ? 0 : 1));
+			// a touching contact wakes its island, the ones left are not touching
+			const ndUnsigned32 islandSleep = ndUnsigned32(contact->GetBody0()->m_islandSleep | contact->GetBody1()->m_islandSleep);
+			const ndUnsigned32 inactive = ndUnsigned32(!contact->IsActive() | (contact->m_maxDof ? 0 : 1) | islandSleep);
 			const ndUnsigned32 idDead = contact->m_isDead;
 			return m_code[idDead * 2 + inactive];
 		}
@@ -1740,6 +3045,96 @@ void ndScene::ParticleUpdate(ndFloat32 timestep)
 	}
 }
 
+ndVector ndScene::ShiftOrigin(const ndVector& offset)
+{
+	D_TRACKTIME();
+	// a shift on the quantization grid moves the node boxes exactly,
+	// every parent still encloses its children and the tree stays valid.
+	const ndVector shift(ndVector::m_triplexMask & ((offset * ndBvhNode::m_aabbQuantization + ndVector::m_half).Floor() * ndBvhNode::m_aabbInvQuantization));
+	if (!(shift.m_x || shift.m_y || shift.m_z))
+	{
+		return ndVector::m_zero;
+	}
+
+	ndAtomic<ndInt32> iterator0(0);
+	ndAtomic<ndInt32> iterator1(0);
+	ndBvhNodeArray& nodeArray = m_bvhSceneManager.GetNodeArray();
+	auto ShiftSceneOrigin = ndMakeObject::ndFunction([this, &iterator0, &iterator1, &nodeArray, &shift](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(ShiftSceneOrigin);
+		// dead nodes may still be linked until the next tree update, 
+		// their boxes move too, but their bodies may be gone.
+		const ndInt32 nodeCount = ndInt32(nodeArray.GetCount());
+		for (ndInt32 i = iterator0.fetch_add(D_WORKER_BATCH_SIZE); i < nodeCount; i = iterator0.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((nodeCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : nodeCount - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				ndBvhNode* const node = nodeArray[i + j];
+				node->m_minBox -= shift;
+				node->m_maxBox -= shift;
+				ndBodyKinematic* const body = node->GetBody();
+				if (body && !node->m_isDead)
+				{
+					body->m_matrix.m_posit -= shift;
+					body->m_globalCentreOfMass -= shift;
+					// the carried rounding error belongs to the old position
+					body->m_globalCentreOfMassError = ndVector::m_zero;
+					body->m_minAabb -= shift;
+					body->m_maxAabb -= shift;
+					body->m_shapeInstance.SetGlobalMatrix(body->m_shapeInstance.GetLocalMatrix() * body->m_matrix);
+					body->m_transformIsDirty = 1;
+				}
+			}
+		}
+
+		// contacts of sleeping islands are parked out of the contact array
+		const ndInt32 activeCount = ndInt32(m_contactArray.GetCount());
+		const ndInt32 contactCount = activeCount + ndInt32(m_parkedContacts.GetCount());
+		for (ndInt32 i = iterator1.fetch_add(D_WORKER_BATCH_SIZE); i < contactCount; i = iterator1.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((contactCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : contactCount - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				const ndInt32 index = i + j;
+				ndContact* const contact = (index < activeCount) ? m_contactArray[index] : m_parkedContacts[index - activeCount];
+				if ((index < activeCount) || contact->m_isParked)
+				{
+					for (ndContactPointList::ndNode* pointNode = contact->m_contacPointsList.GetFirst(); pointNode; pointNode = pointNode->GetNext())
+					{
+						ndContactMaterial& point = pointNode->GetInfo();
+						point.m_point -= shift;
+					}
+				}
+			}
+		}
+	});
+	ParallelExecute(ShiftSceneOrigin);
+
+	// joints attached to the world are pinned to the sentinel body
+	if (m_sentinelBody)
+	{
+		ndMatrix sentinelMatrix(m_sentinelBody->GetMatrix());
+		sentinelMatrix.m_posit -= shift;
+		m_sentinelBody->SetMatrixNoSleep(sentinelMatrix);
+	}
+
+	for (ndBodyList::ndNode* node = m_particleSetList.GetFirst(); node; node = node->GetNext())
+	{
+		ndBodyParticleSet* const particleSet = node->GetInfo()->GetAsBodyParticleSet();
+		ndMatrix matrix(particleSet->GetMatrix());
+		matrix.m_posit -= shift;
+		particleSet->SetMatrixNoSleep(matrix);
+
+		ndArray<ndVector>& posit = particleSet->GetPositions();
+		for (ndInt32 i = 0; i < ndInt32(posit.GetCount()); ++i)
+		{
+			posit[i] -= shift;
+		}
+	}
+	return shift;
+}
+
 bool ndScene::ValidateScene()
 {
 	m_bodyList.m_listIsDirty = true;
@@ -1756,11 +3151,15 @@ bool ndScene::ValidateScene()
 	for (ndBodyListView::ndNode* node = m_bodyList.GetFirst(); node; node = node->GetNext())
 	{
 		const ndBodyKinematic* const body = node->GetInfo()->GetAsBodyKinematic();
+		filter.Insert(body, body);
+		if (body->m_islandSleep)
+		{
+			continue;
+		}
 		if (body != view[index])
 		{
 			return false;
 		}
-		filter.Insert(body, body);
 		index++;
 	}
 
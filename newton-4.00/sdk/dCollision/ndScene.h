@@ -29,14 +29,22 @@
 #include "ndPolygonMeshDesc.h"
 
 #define D_SCENE_MAX_STACK_DEPTH		256
+#define D_ISLAND_SLEEP_STEPS		16
 
 class ndWorld;
 class ndScene;
 class ndContact;
+class ndRayCastHit;
 class ndRayCastNotify;
+class ndRayCastQuery;
+class ndAabbQuery;
 class ndContactNotify;
+class ndConvexCastHit;
+class ndConvexCastQuery;
 class ndConvexCastNotify;
+class ndShapeOverlapQuery;
 class ndBodiesInAabbNotify;
+class ndOverlapBatchResult;
 class ndJointBilateralConstraint;
 
 D_MSV_NEWTON_ALIGN_32
@@ -72,6 +80,28 @@ class ndScene : public ndThreadPool
 	};
 
 	public:
+	// body counts after the last update, bodies in sleeping islands 
+	// are out of the active arrays and cost nothing per step. 
+	// the update writes them, read them after Sync.
+	class ndSleepStats
+	{
+		public:
+		ndSleepStats()
+			:m_activeBodies(0)
+			,m_sleepingBodies(0)
+			,m_parkedContacts(0)
+			,m_wokenBodies(0)
+			,m_deactivatedBodies(0)
+		{
+		}
+
+		ndInt32 m_activeBodies;
+		ndInt32 m_sleepingBodies;
+		ndInt32 m_parkedContacts;
+		ndInt32 m_wokenBodies;
+		ndInt32 m_deactivatedBodies;
+	};
+
 	D_COLLISION_API virtual ~ndScene();
 	D_COLLISION_API bool ValidateScene();
 
@@ -96,10 +126,28 @@ class ndScene : public ndThreadPool
 
 	D_COLLISION_API virtual void BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const;
 	D_COLLISION_API virtual bool RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, const ndVector& globalDest) const;
+
+	// closest hit of each ray written to hits, the rays are sorted by origin and traced by 
+	// all the threads. Uses the thread pool, do not call while the scene is updating.
+	D_COLLISION_API virtual void RayCastBatch(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count);
 	D_COLLISION_API virtual bool ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
 
+	// reports the bodies whose shape intersects the query shape, not just its box
+	D_COLLISION_API virtual void ShapeOverlap(ndBodiesInAabbNotify& callback, const ndShapeInstance& shape, const ndMatrix& matrix) const;
+
+	// batched sweep and overlap queries traced by all the threads, the overlaps of every 
+	// query are a range of one flat array. Use the thread pool, do not call while the scene is updating.
+	D_COLLISION_API virtual void ConvexCastBatch(const ndConvexCastQuery* const queries, ndConvexCastHit* const hits, ndInt32 count);
+	D_COLLISION_API virtual void BodiesInAabbBatch(const ndAabbQuery* const queries, ndInt32 count, ndOverlapBatchResult& result);
+	D_COLLISION_API virtual void ShapeOverlapBatch(const ndShapeOverlapQuery* const queries, ndInt32 count, ndOverlapBatchResult& result);
+
 	D_COLLISION_API void SendBackgroundTask(ndBackgroundTask* const job);
 
+	// moves the scene origin to offset, bodies, broad phase boxes and contacts
+	// are shifted in place without rebuilding the tree. The offset is rounded
+	// to the broad phase box quantization, returns the shift applied.
+	D_COLLISION_API virtual ndVector ShiftOrigin(const ndVector& offset);
+
 	ndInt32 GetThreadCount() const;
 
 	virtual ndWorld* GetWorld() const;
@@ -116,7 +164,21 @@ class ndScene : public ndThreadPool
 
 	ndFloat32 GetTimestep() const;
 	void SetTimestep(ndFloat32 timestep);
+
+	// contacts with normals within clusterAngle of each other are reduced to at 
+	// most pointsPerCluster points before they become solver rows. 
+	// it is off by default, zero points disables it
+	D_COLLISION_API void SetContactReduction(ndInt32 pointsPerCluster, ndFloat32 clusterAngle);
+	ndInt32 GetContactReductionPoints() const;
+	ndFloat32 GetContactReductionAngle() const;
+
+	// contact points are matched to the previous frame points by sub shape id, 
+	// normal and distance, matched points seed the solver with their last 
+	// force times this scale, zero disables warm starting
+	D_COLLISION_API void SetContactWarmStart(ndFloat32 scale);
+	ndFloat32 GetContactWarmStart() const;
 	ndBodyKinematic* GetSentinelBody() const;
+	const ndSleepStats& GetSleepStats() const;
 
 	protected:
 	D_COLLISION_API ndScene();
@@ -132,10 +194,22 @@ class ndScene : public ndThreadPool
 
 	void CalculateJointContacts(ndInt32 threadIndex, ndContact* const contact);
 	void ProcessContacts(ndInt32 threadIndex, ndInt32 contactCount, ndContactSolver* const contactSolver);
+	bool IsSplitNarrowPhasePair(ndContact* const contact) const;
+	ndInt32 CalculateSplitPairContacts(ndContactSolver& contactSolver);
+
+	void WakeBody(ndBodyKinematic* const body);
+	void UnparkContact(ndContact* const contact);
+	void CalculateContactBatch(ndInt32 start, ndInt32 count);
 
 	ndJointBilateralConstraint* FindBilateralJoint(ndBodyKinematic* const body0, ndBodyKinematic* const body1) const;
 	bool RayCast(ndRayCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const distance, ndInt32 stack, const ndFastRay& ray) const;
+	ndInt32 RayCastPacket(ndRayCastNotify** const callbacks, const ndFastRayPacket& packet) const;
 	bool ConvexCast(ndConvexCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const distance, ndInt32 stack, const ndFastRay& ray, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
+	void BodiesInAabb(ndArray<ndBodyKinematic*>& bodies, const ndVector& minBox, const ndVector& maxBox, const ndBody* const ignoreBody) const;
+	bool ShapeIntersect(ndBodyKinematic* const queryBody, ndBodyKinematic* const body, ndContactNotify* const notify, ndInt32 threadIndex) const;
+	void CreateQueryBodies(ndFixSizeArray<ndBodyKinematic*, D_MAX_THREADS_COUNT>& queryBodies, ndInt32 count) const;
+	void DestroyQueryBodies(ndFixSizeArray<ndBodyKinematic*, D_MAX_THREADS_COUNT>& queryBodies) const;
+	void OverlapBatch(const ndAabbQuery* const boxQueries, const ndShapeOverlapQuery* const shapeQueries, ndInt32 count, ndOverlapBatchResult& result);
 
 	// call from sub steps update
 	D_COLLISION_API virtual void ApplyExtForce();
@@ -144,10 +218,14 @@ class ndScene : public ndThreadPool
 	D_COLLISION_API virtual void UpdateSpecial();
 	D_COLLISION_API virtual void UpdateBodyList();
 	D_COLLISION_API virtual void UpdateTransform();
+	D_COLLISION_API virtual void UpdateQueryAabbs();
 	D_COLLISION_API virtual void CreateNewContacts();
 	D_COLLISION_API virtual void CalculateContacts();
 	D_COLLISION_API virtual void FindCollidingPairs();
 	D_COLLISION_API virtual void DeleteDeadContacts();
+	D_COLLISION_API virtual void WakeTouchedIslands();
+	D_COLLISION_API virtual void WakeSleepingIslands();
+	D_COLLISION_API virtual void DeactivateRestingIslands();
 
 	D_COLLISION_API virtual void CalculateContacts(ndInt32 threadIndex, ndContact* const contact);
 	D_COLLISION_API virtual void UpdateTransformNotify(ndInt32 threadIndex, ndBodyKinematic* const body);
@@ -165,21 +243,33 @@ class ndScene : public ndThreadPool
 	ndArray<ndConstraint*> m_activeConstraintArray;
 	ndSpecialList<ndBodyKinematic> m_specialUpdateList;
 	ndArray<ndContactPairs> m_newPairs;
+	ndArray<ndContact*> m_splitPairs;
+	ndArray<ndContact*> m_parkedContacts;
+	ndArray<ndBodyKinematic*> m_wakeQueue;
+	ndArray<ndShapeInstance*> m_splitPairLeafs;
+	ndArray<ndContactPoint> m_splitPairContacts;
 	ndArray<ndContactPairs> m_partialNewPairs[D_MAX_THREADS_COUNT];
 	ndPolygonMeshDesc::ndStaticMeshFaceQuery m_staticMeshQuery[D_MAX_THREADS_COUNT];
 	ndPolygonMeshDesc::ndProceduralStaticMeshFaceQuery m_proceduralStaticMeshQuery[D_MAX_THREADS_COUNT];
 
 	ndSpinLock m_lock;
+	ndSpinLock m_wakeLock;
 	ndBvhNode* m_rootNode;
 	ndBodyKinematic* m_sentinelBody;
 	ndContactNotify* m_contactNotifyCallback;
 	ndThreadBackgroundWorker* m_backgroundThread;
 	
 	ndFloat32 m_timestep;
+	ndFloat32 m_contactReductionCos;
+	ndInt32 m_contactReductionPoints;
+	ndFloat32 m_contactWarmStart;
+	ndSleepStats m_sleepStats;
 	ndUnsigned32 m_lru;
 	ndUnsigned32 m_frameNumber;
 	ndUnsigned32 m_subStepNumber;
 	ndUnsigned32 m_forceBalanceSceneCounter;
+	bool m_splitPairsPhase;
+	bool m_parkedContactsDirty;
 
 	static ndVector m_velocTol;
 	static ndVector m_linearContactError2;
@@ -191,6 +281,7 @@ class ndScene : public ndThreadPool
 	friend class ndPolygonMeshDesc;
 	friend class ndConvexCastNotify;
 	friend class ndSkeletonContainer;
+	friend class ndSceneQuerySnapshot;
 } D_GCC_NEWTON_ALIGN_32 ;
 
 inline void ndScene::PrepareCleanup()
@@ -268,9 +359,29 @@ inline void ndScene::SetTimestep(ndFloat32 timestep)
 	m_timestep = timestep;
 }
 
+inline ndInt32 ndScene::GetContactReductionPoints() const
+{
+	return m_contactReductionPoints;
+}
+
+inline ndFloat32 ndScene::GetContactReductionAngle() const
+{
+	return ndAcos(m_contactReductionCos);
+}
+
+inline ndFloat32 ndScene::GetContactWarmStart() const
+{
+	return m_contactWarmStart;
+}
+
 inline ndBodyKinematic* ndScene::GetSentinelBody() const
 {
 	return m_sentinelBody;
 }
 
+inline const ndScene::ndSleepStats& ndScene::GetSleepStats() const
+{
+	return m_sleepStats;
+}
+
 #endif
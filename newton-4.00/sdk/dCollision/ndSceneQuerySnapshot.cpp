@@ -0,0 +1,293 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndCollisionStdafx.h"
+#include "ndScene.h"
+#include "ndBvhNode.h"
+#include "ndBodyKinematic.h"
+#include "ndRayCastNotify.h"
+#include "ndSceneQuerySnapshot.h"
+#include "ndBodiesInAabbNotify.h"
+
+ndSceneQuerySnapshot::ndSceneQuerySnapshot()
+	:ndClassAlloc()
+	,m_nodes(256)
+	,m_entries(256)
+	,m_retiredBodies()
+	,m_readers(0)
+	,m_version(0)
+{
+}
+
+ndSceneQuerySnapshot::~ndSceneQuerySnapshot()
+{
+	ndAssert(!m_readers.load());
+}
+
+void ndSceneQuerySnapshot::Build(ndScene* const scene, ndUnsigned64 version)
+{
+	D_TRACKTIME();
+	ndAssert(!m_readers.load());
+	m_version = version;
+	m_nodes.SetCount(0);
+	m_entries.SetCount(0);
+	m_retiredBodies.RemoveAll();
+	if (!scene->m_rootNode)
+	{
+		return;
+	}
+
+	// flatten the tree in pre order, the children of a node always 
+	// come after it, and each item remembers which slot of its parent it fills.
+	class ndStackEntry
+	{
+		public:
+		const ndBvhNode* m_node;
+		ndInt32 m_parentSlot;
+	};
+
+	ndStackEntry stackPool[D_SCENE_MAX_STACK_DEPTH];
+	stackPool[0].m_node = scene->m_rootNode;
+	stackPool[0].m_parentSlot = -1;
+	ndInt32 stack = 1;
+	while (stack)
+	{
+		stack--;
+		const ndStackEntry item(stackPool[stack]);
+		const ndInt32 index = ndInt32(m_nodes.GetCount());
+		if (item.m_parentSlot >= 0)
+		{
+			ndNode& parent = m_nodes[item.m_parentSlot >> 1];
+			if (item.m_parentSlot & 1)
+			{
+				parent.m_right = index;
+			}
+			else
+			{
+				parent.m_left = index;
+			}
+		}
+
+		// the boxes are filled in after the transforms are copied
+		ndNode node;
+		node.m_minBox = ndVector::m_zero;
+		node.m_maxBox = ndVector::m_zero;
+		ndBodyKinematic* const body = item.m_node->GetBody();
+		if (body)
+		{
+			ndEntry entry;
+			entry.m_matrix = ndGetIdentityMatrix();
+			entry.m_minBox = ndVector::m_zero;
+			entry.m_maxBox = ndVector::m_zero;
+			entry.m_body = body;
+			node.m_left = -1;
+			node.m_right = ndInt32(m_entries.GetCount());
+			m_entries.PushBack(entry);
+		}
+		else
+		{
+			node.m_left = 0;
+			node.m_right = 0;
+
+			stackPool[stack].m_node = item.m_node->GetRight();
+			stackPool[stack].m_parentSlot = index * 2 + 1;
+			stack++;
+			stackPool[stack].m_node = item.m_node->GetLeft();
+			stackPool[stack].m_parentSlot = index * 2;
+			stack++;
+			ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+		}
+		m_nodes.PushBack(node);
+	}
+
+	// the body boxes and the shape matrices of the scene are only updated at the 
+	// start of the next step, recalculate them from the transforms of this step.
+	ndAtomic<ndInt32> iterator(0);
+	auto CopyTransforms = ndMakeObject::ndFunction([this, &iterator](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(CopyTransforms);
+		const ndInt32 count = ndInt32(m_entries.GetCount());
+		for (ndInt32 i = iterator.fetch_add(D_WORKER_BATCH_SIZE); i < count; i = iterator.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((count - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : count - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				ndEntry& entry = m_entries[i + j];
+				const ndShapeInstance& shapeInstance = entry.m_body->GetCollisionShape();
+				entry.m_matrix = entry.m_body->GetMatrix();
+				shapeInstance.CalculateAabb(shapeInstance.GetLocalMatrix() * entry.m_matrix, entry.m_minBox, entry.m_maxBox);
+			}
+		}
+	});
+	scene->ParallelExecute(CopyTransforms);
+
+	for (ndInt32 i = ndInt32(m_nodes.GetCount()) - 1; i >= 0; --i)
+	{
+		ndNode& node = m_nodes[i];
+		if (node.m_left < 0)
+		{
+			node.m_minBox = m_entries[node.m_right].m_minBox;
+			node.m_maxBox = m_entries[node.m_right].m_maxBox;
+		}
+		else
+		{
+			const ndNode& left = m_nodes[node.m_left];
+			const ndNode& right = m_nodes[node.m_right];
+			node.m_minBox = left.m_minBox.GetMin(right.m_minBox);
+			node.m_maxBox = left.m_maxBox.GetMax(right.m_maxBox);
+		}
+	}
+}
+
+bool ndSceneQuerySnapshot::RayCast(ndRayCastNotify& callback, const ndEntry& entry, const ndFastRay& ray, ndFloat32 maxT) const
+{
+	ndVector l0(ray.m_p0);
+	ndVector l1(ray.m_p0 + ray.m_diff.Scale(ndMin(maxT, ndFloat32(1.0f))));
+
+	bool state = false;
+	if (ndRayBoxClip(l0, l1, entry.m_minBox, entry.m_maxBox))
+	{
+		// the shape instance global matrix belongs to the running step, use the copied transform
+		const ndShapeInstance& shapeInstance = entry.m_body->GetCollisionShape();
+		const ndMatrix globalMatrix(shapeInstance.GetLocalMatrix() * entry.m_matrix);
+		ndVector localP0(globalMatrix.UntransformVector(l0) & ndVector::m_triplexMask);
+		ndVector localP1(globalMatrix.UntransformVector(l1) & ndVector::m_triplexMask);
+		ndVector p1p0(localP1 - localP0);
+		if (p1p0.DotProduct(p1p0).GetScalar() > ndFloat32(1.0e-12f))
+		{
+			if (shapeInstance.GetCollisionMode())
+			{
+				ndContactPoint contactOut;
+				ndFloat32 t = shapeInstance.RayCast(callback, localP0, localP1, entry.m_body, contactOut);
+				if (t < ndFloat32(1.0f))
+				{
+					ndVector p(globalMatrix.TransformVector(localP0 + (localP1 - localP0).Scale(t)));
+					t = ray.m_diff.DotProduct(p - ray.m_p0).GetScalar() / ray.m_diff.DotProduct(ray.m_diff).GetScalar();
+					if (t < maxT)
+					{
+						contactOut.m_body0 = entry.m_body;
+						contactOut.m_body1 = entry.m_body;
+						contactOut.m_point = p;
+						contactOut.m_normal = globalMatrix.RotateVector(contactOut.m_normal);
+						state = callback.OnRayCastAction(contactOut, t) < ndFloat32(1.0f);
+					}
+				}
+			}
+		}
+	}
+	return state;
+}
+
+bool ndSceneQuerySnapshot::RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, const ndVector& globalDest) const
+{
+	const ndVector p0(globalOrigin & ndVector::m_triplexMask);
+	const ndVector p1(globalDest & ndVector::m_triplexMask);
+
+	bool state = false;
+	callback.m_param = ndFloat32(1.2f);
+	const ndVector segment(p1 - p0);
+	if (m_nodes.GetCount() && (segment.DotProduct(segment).GetScalar() > ndFloat32(1.0e-8f)))
+	{
+		ndFloat32 stackDistance[D_SCENE_MAX_STACK_DEPTH];
+		ndInt32 stackPool[D_SCENE_MAX_STACK_DEPTH];
+
+		const ndFastRay ray(p0, p1);
+		stackPool[0] = 0;
+		stackDistance[0] = ray.BoxIntersect(m_nodes[0].m_minBox, m_nodes[0].m_maxBox);
+		ndInt32 stack = 1;
+		while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+		{
+			stack--;
+			if (stackDistance[stack] > callback.m_param)
+			{
+				break;
+			}
+
+			const ndNode& node = m_nodes[stackPool[stack]];
+			if (node.m_left < 0)
+			{
+				if (RayCast(callback, m_entries[node.m_right], ray, callback.m_param))
+				{
+					state = true;
+					if (callback.m_param < ndFloat32(1.0e-8f))
+					{
+						break;
+					}
+				}
+			}
+			else
+			{
+				const ndInt32 children[] = { node.m_left, node.m_right };
+				for (ndInt32 i = 0; i < 2; ++i)
+				{
+					const ndNode& child = m_nodes[children[i]];
+					const ndFloat32 dist = ray.BoxIntersect(child.m_minBox, child.m_maxBox);
+					if (dist < callback.m_param)
+					{
+						ndInt32 j = stack;
+						for (; j && (dist > stackDistance[j - 1]); j--)
+						{
+							stackPool[j] = stackPool[j - 1];
+							stackDistance[j] = stackDistance[j - 1];
+						}
+						stackPool[j] = children[i];
+						stackDistance[j] = dist;
+						stack++;
+						ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+					}
+				}
+			}
+		}
+	}
+	return state;
+}
+
+void ndSceneQuerySnapshot::BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const
+{
+	callback.Reset();
+	if (m_nodes.GetCount())
+	{
+		ndInt32 stackPool[D_SCENE_MAX_STACK_DEPTH];
+		stackPool[0] = 0;
+		ndInt32 stack = 1;
+		while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+		{
+			stack--;
+			const ndNode& node = m_nodes[stackPool[stack]];
+			if (ndOverlapTest(node.m_minBox, node.m_maxBox, minBox, maxBox))
+			{
+				if (node.m_left < 0)
+				{
+					callback.OnOverlap(m_entries[node.m_right].m_body);
+				}
+				else
+				{
+					stackPool[stack] = node.m_left;
+					stack++;
+					stackPool[stack] = node.m_right;
+					stack++;
+					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,105 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_SCENE_QUERY_SNAPSHOT_H__
+#define __ND_SCENE_QUERY_SNAPSHOT_H__
+
+#include "ndCollisionStdafx.h"
+#include "ndBodyListView.h"
+
+class ndScene;
+class ndRayCastNotify;
+class ndBodyKinematic;
+class ndBodiesInAabbNotify;
+
+// a read only copy of the broad phase boxes and the body transforms of a scene.
+// The world publishes one at the end of each step, game threads can query it 
+// while the next step runs. Hits report the body pointer, but the body itself 
+// is owned by the running step and should only be used as an identifier.
+D_MSV_NEWTON_ALIGN_32
+class ndSceneQuerySnapshot : public ndClassAlloc
+{
+	class ndNode
+	{
+		public:
+		ndVector m_minBox;
+		ndVector m_maxBox;
+		// a leaf has no left child and the right is the index of its body
+		ndInt32 m_left;
+		ndInt32 m_right;
+	};
+
+	class ndEntry
+	{
+		public:
+		ndMatrix m_matrix;
+		ndVector m_minBox;
+		ndVector m_maxBox;
+		ndBodyKinematic* m_body;
+	};
+
+	public:
+	D_COLLISION_API ndSceneQuerySnapshot();
+	D_COLLISION_API ~ndSceneQuerySnapshot();
+
+	D_COLLISION_API void Build(ndScene* const scene, ndUnsigned64 version);
+
+	D_COLLISION_API bool RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, const ndVector& globalDest) const;
+	D_COLLISION_API void BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const;
+
+	ndUnsigned64 GetVersion() const;
+	ndInt32 GetBodyCount() const;
+	const ndBodyKinematic* GetBody(ndInt32 index) const;
+	const ndMatrix& GetMatrix(ndInt32 index) const;
+
+	private:
+	bool RayCast(ndRayCastNotify& callback, const ndEntry& entry, const ndFastRay& ray, ndFloat32 maxT) const;
+
+	ndArray<ndNode> m_nodes;
+	ndArray<ndEntry> m_entries;
+	ndSharedList<ndBody> m_retiredBodies;
+	mutable ndAtomic<ndInt32> m_readers;
+	ndUnsigned64 m_version;
+
+	friend class ndWorld;
+} D_GCC_NEWTON_ALIGN_32;
+
+inline ndUnsigned64 ndSceneQuerySnapshot::GetVersion() const
+{
+	return m_version;
+}
+
+inline ndInt32 ndSceneQuerySnapshot::GetBodyCount() const
+{
+	return ndInt32(m_entries.GetCount());
+}
+
+inline const ndBodyKinematic* ndSceneQuerySnapshot::GetBody(ndInt32 index) const
+{
+	return m_entries[index].m_body;
+}
+
+inline const ndMatrix& ndSceneQuerySnapshot::GetMatrix(ndInt32 index) const
+{
+	return m_entries[index].m_matrix;
+}
+
+#endif
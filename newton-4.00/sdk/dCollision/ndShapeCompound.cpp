@@ -255,6 +255,7 @@ void ndShapeCompound::ndTreeArray::AddNode(ndNodeBase* const node, ndInt32 index
 ndShapeCompound::ndShapeCompound()
 	:ndShape(m_compound)
 	,m_array()
+	,m_flatTree()
 	,m_treeEntropy(ndFloat32(0.0f))
 	,m_boxMinRadius(ndFloat32(0.0f))
 	,m_boxMaxRadius(ndFloat32(0.0f))
@@ -267,6 +268,7 @@ ndShapeCompound::ndShapeCompound()
 ndShapeCompound::ndShapeCompound(const ndShapeCompound& source)
 	:ndShape(source)
 	,m_array()
+	,m_flatTree()
 	,m_treeEntropy(ndFloat32(0.0f))
 	,m_boxMinRadius(ndFloat32(0.0f))
 	,m_boxMaxRadius(ndFloat32(0.0f))
@@ -358,6 +360,7 @@ ndShapeCompound::ndShapeCompound(const ndShapeCompound& source)
 				ndAssert(stack < D_COMPOUND_STACK_DEPTH);
 			}
 		}
+		BuildFlatTree();
 	}
 	ndAssert(ndMemory::CheckMemory(this));
 }
@@ -1020,13 +1023,114 @@ void ndShapeCompound::EndAddRemove()
 		m_boxSize = m_root->m_size;
 		m_boxOrigin = m_root->m_origin;
 		MassProperties();
+		BuildFlatTree();
+	}
+	else
+	{
+		// every child was removed, the flat nodes point to deleted instances
+		m_flatTree.SetCount(0);
 	}
 }
 
-//void ndShapeCompound::RemoveNode(ndTreeArray::ndNode* const node)
-void ndShapeCompound::RemoveNode(ndTreeArray::ndNode* const)
+void ndShapeCompound::BuildFlatTree()
 {
-	ndAssert(0);
+	ndAssert(m_root);
+	// a binary tree with n leaves has 2n - 1 nodes
+	const ndInt32 nodeCount = 2 * ndInt32(m_array.GetCount()) - 1;
+	m_flatTree.SetCount(nodeCount);
+
+	ndInt32 stack = 1;
+	ndInt32 index = 0;
+	const ndNodeBase* stackPool[D_COMPOUND_STACK_DEPTH];
+	ndInt32 parentIndex[D_COMPOUND_STACK_DEPTH];
+	stackPool[0] = m_root;
+	parentIndex[0] = -1;
+	while (stack)
+	{
+		stack--;
+		const ndNodeBase* const node = stackPool[stack];
+		const ndInt32 parent = parentIndex[stack];
+
+		ndFlatNode& flatNode = m_flatTree[index];
+		flatNode.m_origin = node->m_origin;
+		flatNode.m_size = node->m_size;
+		flatNode.m_area = node->m_area;
+		flatNode.m_type = node->m_type;
+		flatNode.m_left = nullptr;
+		flatNode.m_right = nullptr;
+		flatNode.m_shapeInstance = node->m_shapeInstance;
+		if (parent >= 0)
+		{
+			ndFlatNode& parentNode = m_flatTree[parent];
+			if (parentNode.m_left)
+			{
+				parentNode.m_right = &flatNode;
+			}
+			else
+			{
+				parentNode.m_left = &flatNode;
+			}
+		}
+
+		if (node->m_type == m_node)
+		{
+			// push the right first, so that the left is the next node in the array
+			stackPool[stack] = node->m_right;
+			parentIndex[stack] = index;
+			stack++;
+			stackPool[stack] = node->m_left;
+			parentIndex[stack] = index;
+			stack++;
+			ndAssert(stack < D_COMPOUND_STACK_DEPTH);
+		}
+		index++;
+	}
+	ndAssert(index == nodeCount);
+}
+
+void ndShapeCompound::RemoveNode(ndTreeArray::ndNode* const node)
+{
+	if (node)
+	{
+		ndNodeBase* const treeNode = node->GetInfo();
+		ndNodeBase* const parent = treeNode->m_parent;
+		if (!parent)
+		{
+			ndAssert(treeNode == m_root);
+			delete m_root;
+			m_root = nullptr;
+		}
+		else
+		{
+			// the sibling takes the place of the parent, deleting the parent deletes the leaf and its instance
+			ndNodeBase* const sibling = (parent->m_left == treeNode) ? parent->m_right : parent->m_left;
+			ndNodeBase* const grandParent = parent->m_parent;
+			if (parent->m_left == sibling)
+			{
+				parent->m_left = nullptr;
+			}
+			else
+			{
+				parent->m_right = nullptr;
+			}
+			sibling->m_parent = grandParent;
+			if (!grandParent)
+			{
+				ndAssert(parent == m_root);
+				m_root = sibling;
+			}
+			else if (grandParent->m_left == parent)
+			{
+				grandParent->m_left = sibling;
+			}
+			else
+			{
+				grandParent->m_right = sibling;
+			}
+			delete parent;
+		}
+		m_array.Remove(node);
+	}
 }
 
 ndShapeInstance* ndShapeCompound::GetShapeInstance(ndTreeArray::ndNode* const node)
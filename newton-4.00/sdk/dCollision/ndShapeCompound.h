@@ -40,6 +40,24 @@ class ndShapeCompound: public ndShape
 	};
 
 	class ndNodeBase;
+
+	// read only copy of the node hierarchy packed in depth first order, 
+	// one cache line per node. the left child always follows its parent.
+	D_MSV_NEWTON_ALIGN_32
+	class ndFlatNode
+	{
+		public:
+		ndShapeInstance* GetShape() const;
+
+		ndVector m_origin;
+		ndVector m_size;
+		ndFloat32 m_area;
+		ndInt32 m_type;
+		const ndFlatNode* m_left;
+		const ndFlatNode* m_right;
+		ndShapeInstance* m_shapeInstance;
+	} D_GCC_NEWTON_ALIGN_32;
+
 	class ndTreeArray : public ndTree<ndNodeBase*, ndInt32, ndContainersFreeListAlloc<ndNodeBase*>>
 	{
 		public:
@@ -94,9 +112,12 @@ class ndShapeCompound: public ndShape
 	ndNodeBase* BuildTopDownBig(ndNodeBase** const leafArray, ndInt32 firstBox, ndInt32 lastBox, ndNodeBase** rootNodesMemory, ndInt32& rootIndex);
 	ndFloat32 CalculateSurfaceArea(ndNodeBase* const node0, ndNodeBase* const node1, ndVector& minBox, ndVector& maxBox) const;
 	ndMatrix CalculateInertiaAndCenterOfMass(const ndMatrix& alignMatrix, const ndVector& localScale, const ndMatrix& matrix) const;
+	void BuildFlatTree();
+	const ndFlatNode* GetFlatRoot() const;
 	ndFloat32 CalculateMassProperties(const ndMatrix& offset, ndVector& inertia, ndVector& crossInertia, ndVector& centerOfMass) const;
 
 	ndTreeArray m_array;
+	ndArray<ndFlatNode> m_flatTree;
 	ndFloat64 m_treeEntropy;
 	ndFloat32 m_boxMinRadius;
 	ndFloat32 m_boxMaxRadius;
@@ -142,6 +163,17 @@ class ndShapeCompound::ndNodeBase: public ndClassAlloc
 	friend class ndStackBvhStackEntry;
 } D_GCC_NEWTON_ALIGN_32;
 
+inline ndShapeInstance* ndShapeCompound::ndFlatNode::GetShape() const
+{
+	return m_shapeInstance;
+}
+
+inline const ndShapeCompound::ndFlatNode* ndShapeCompound::GetFlatRoot() const
+{
+	// a compound with no children has no root
+	return m_flatTree.GetCount() ? &m_flatTree[0] : nullptr;
+}
+
 #endif 
 
 
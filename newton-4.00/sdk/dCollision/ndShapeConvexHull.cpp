@@ -26,6 +26,8 @@
 
 #define D_CONVEX_VERTEX_SPLIT_BOX			8
 #define D_CONVEX_VERTEX_BRUTE_FORCE_SPLIT	(3 * D_CONVEX_VERTEX_SPLIT_BOX)
+#define D_CONVEX_VERTEX_HILL_CLIMB_SPLIT	128
+#define D_CONVEX_SUPPORT_CUBE_GRID			4
 
 D_MSV_NEWTON_ALIGN_32
 class ndShapeConvexHull::ndConvexBox
@@ -50,6 +52,9 @@ ndShapeConvexHull::ndShapeConvexHull (ndInt32 count, ndInt32 strideInBytes, ndFl
 	,m_soa_z(nullptr)
 	,m_soa_index(nullptr)
 	,m_vertexToEdgeMapping(nullptr)
+	,m_adjacencyStart(nullptr)
+	,m_adjacency(nullptr)
+	,m_supportStartVertex(nullptr)
 	,m_faceCount(0)
 	,m_soaVertexCount(0)
 	,m_supportTreeCount(0)
@@ -86,6 +91,13 @@ ndShapeConvexHull::~ndShapeConvexHull()
 		ndMemory::Free(m_supportTree);
 	}
 	
+	if (m_adjacency)
+	{
+		ndMemory::Free(m_adjacency);
+		ndMemory::Free(m_adjacencyStart);
+		ndMemory::Free(m_supportStartVertex);
+	}
+
 	if (m_soa_index)
 	{
 		ndMemory::Free(m_soa_x);
@@ -641,6 +653,11 @@ bool ndShapeConvexHull::Create(ndInt32 count, ndInt32 strideInBytes, const ndFlo
 		m_vertexToEdgeMapping[edge->m_vertex] = edge;
 	}
 
+	if (m_vertexCount > D_CONVEX_VERTEX_HILL_CLIMB_SPLIT)
+	{
+		BuildSupportAdjacency();
+	}
+
 	SetVolumeAndCG();
 
 	return true;
@@ -787,29 +804,7 @@ bool ndShapeConvexHull::RemoveCoplanarEdge(ndPolyhedra& polyhedra, const ndBigVe
 
 ndVector ndShapeConvexHull::SupportVertexBruteForce(const ndVector& dir, ndInt32* const vertexIndex) const
 {
-	const ndVector dirX(dir.m_x);
-	const ndVector dirY(dir.m_y);
-	const ndVector dirZ(dir.m_z);
-
-	ndVector support(m_soa_index[0]);
-	ndVector maxProj(m_soa_x[0] * dirX + m_soa_y[0] * dirY + m_soa_z[0] * dirZ);
-	for (ndInt32 i = 1; i < m_soaVertexCount; ++i)
-	{
-		ndVector dot(m_soa_x[i] * dirX + m_soa_y[i] * dirY + m_soa_z[i] * dirZ);
-		support = support.Select(m_soa_index[i], dot > maxProj);
-		maxProj = maxProj.GetMax(dot);
-	}
-
-	ndVector dot(maxProj.ShiftRight().ShiftRight());
-	ndVector support1(support.ShiftRight().ShiftRight());
-	support = support.Select(support1, dot > maxProj);
-	maxProj = maxProj.GetMax(dot);
-		
-	dot = maxProj.ShiftRight();
-	support1 = support.ShiftRight();
-	support = support.Select(support1, dot > maxProj);
-
-	const ndInt32 index = ndInt32(support.GetScalar());
+	const ndInt32 index = ndGetSimdKernels().m_supportVertex(m_soa_x, m_soa_y, m_soa_z, m_soa_index, m_soaVertexCount, dir);
 	if (vertexIndex)
 	{
 		*vertexIndex = index;
@@ -937,10 +932,110 @@ ndVector ndShapeConvexHull::SupportVertexhierarchical(const ndVector& dir, ndInt
 	return m_vertex[index];
 }
 
+void ndShapeConvexHull::BuildSupportAdjacency()
+{
+	// compact vertex adjacency, one entry per half edge
+	m_adjacencyStart = (ndInt32*)ndMemory::Malloc(size_t((m_vertexCount + 1) * sizeof(ndInt32)));
+	m_adjacency = (ndInt32*)ndMemory::Malloc(size_t(m_edgeCount * sizeof(ndInt32)));
+	ndMemSet(m_adjacencyStart, 0, m_vertexCount + 1);
+	for (ndInt32 i = 0; i < m_edgeCount; ++i)
+	{
+		m_adjacencyStart[m_simplex[i].m_vertex + 1] ++;
+	}
+	for (ndInt32 i = 0; i < m_vertexCount; ++i)
+	{
+		m_adjacencyStart[i + 1] += m_adjacencyStart[i];
+	}
+
+	ndStack<ndInt32> scan(m_vertexCount);
+	ndMemCpy(&scan[0], m_adjacencyStart, m_vertexCount);
+	for (ndInt32 i = 0; i < m_edgeCount; ++i)
+	{
+		const ndConvexSimplexEdge* const edge = &m_simplex[i];
+		const ndInt32 index = scan[edge->m_vertex];
+		m_adjacency[index] = edge->m_twin->m_vertex;
+		scan[edge->m_vertex] = index + 1;
+	}
+
+	// seed vertex for each cell of a cube map of directions, 
+	// so that hill climbing starts a few steps away from the answer.
+	const ndInt32 cellsPerFace = D_CONVEX_SUPPORT_CUBE_GRID * D_CONVEX_SUPPORT_CUBE_GRID;
+	m_supportStartVertex = (ndInt32*)ndMemory::Malloc(size_t(6 * cellsPerFace * sizeof(ndInt32)));
+	const ndFloat32 cellSize = ndFloat32(2.0f) / ndFloat32(D_CONVEX_SUPPORT_CUBE_GRID);
+	for (ndInt32 face = 0; face < 6; ++face)
+	{
+		const ndInt32 axis = face >> 1;
+		const ndFloat32 sign = (face & 1) ? ndFloat32(1.0f) : ndFloat32(-1.0f);
+		for (ndInt32 iv = 0; iv < D_CONVEX_SUPPORT_CUBE_GRID; ++iv)
+		{
+			for (ndInt32 iu = 0; iu < D_CONVEX_SUPPORT_CUBE_GRID; ++iu)
+			{
+				ndVector dir(ndVector::m_zero);
+				dir[axis] = sign;
+				dir[(axis + 1) % 3] = ndFloat32(-1.0f) + (ndFloat32(iu) + ndFloat32(0.5f)) * cellSize;
+				dir[(axis + 2) % 3] = ndFloat32(-1.0f) + (ndFloat32(iv) + ndFloat32(0.5f)) * cellSize;
+
+				ndInt32 bestIndex = 0;
+				ndFloat32 maxProj = m_vertex[0].DotProduct(dir).GetScalar();
+				for (ndInt32 i = 1; i < m_vertexCount; ++i)
+				{
+					const ndFloat32 proj = m_vertex[i].DotProduct(dir).GetScalar();
+					if (proj > maxProj)
+					{
+						maxProj = proj;
+						bestIndex = i;
+					}
+				}
+				m_supportStartVertex[face * cellsPerFace + iv * D_CONVEX_SUPPORT_CUBE_GRID + iu] = bestIndex;
+			}
+		}
+	}
+}
+
+ndVector ndShapeConvexHull::SupportVertexHillClimb(const ndVector& dir, ndInt32* const vertexIndex) const
+{
+	const ndVector mag(dir.Abs());
+	const ndInt32 axis = (mag.m_x >= mag.m_y) ? ((mag.m_x >= mag.m_z) ? 0 : 2) : ((mag.m_y >= mag.m_z) ? 1 : 2);
+	const ndInt32 face = axis * 2 + ((dir[axis] > ndFloat32(0.0f)) ? 1 : 0);
+	const ndFloat32 scale = ndFloat32(0.5f * D_CONVEX_SUPPORT_CUBE_GRID) / ndMax(mag[axis], ndFloat32(1.0e-6f));
+	const ndInt32 iu = ndClamp(ndInt32((dir[(axis + 1) % 3] + mag[axis]) * scale), 0, D_CONVEX_SUPPORT_CUBE_GRID - 1);
+	const ndInt32 iv = ndClamp(ndInt32((dir[(axis + 2) % 3] + mag[axis]) * scale), 0, D_CONVEX_SUPPORT_CUBE_GRID - 1);
+
+	ndInt32 index = m_supportStartVertex[(face * D_CONVEX_SUPPORT_CUBE_GRID + iv) * D_CONVEX_SUPPORT_CUBE_GRID + iu];
+	ndFloat32 maxProj = m_vertex[index].DotProduct(dir).GetScalar();
+
+	// the support function is linear, so any local maximum on the vertex graph is the global one.
+	for (ndInt32 bestIndex = -1; bestIndex != index; )
+	{
+		bestIndex = index;
+		const ndInt32 end = m_adjacencyStart[bestIndex + 1];
+		for (ndInt32 i = m_adjacencyStart[bestIndex]; i < end; ++i)
+		{
+			const ndInt32 neighbor = m_adjacency[i];
+			const ndFloat32 proj = m_vertex[neighbor].DotProduct(dir).GetScalar();
+			if (proj > maxProj)
+			{
+				maxProj = proj;
+				index = neighbor;
+			}
+		}
+	}
+
+	if (vertexIndex)
+	{
+		*vertexIndex = index;
+	}
+	return m_vertex[index];
+}
+
 ndVector ndShapeConvexHull::SupportVertex(const ndVector& dir) const
 {
 	ndAssert(dir.m_w == ndFloat32(0.0f));
-	if (m_vertexCount > D_CONVEX_VERTEX_BRUTE_FORCE_SPLIT)
+	if (m_adjacency)
+	{
+		return SupportVertexHillClimb(dir, nullptr);
+	}
+	else if (m_vertexCount > D_CONVEX_VERTEX_BRUTE_FORCE_SPLIT)
 	{
 		//return SupportVertexhierarchical(dir, vertexIndex);
 		return SupportVertexhierarchical(dir, nullptr);
@@ -955,7 +1050,11 @@ ndVector ndShapeConvexHull::SupportVertex(const ndVector& dir) const
 ndVector ndShapeConvexHull::SupportFeatureVertex(const ndVector& dir, ndInt32* const vertexIndex) const
 {
 	ndAssert(dir.m_w == ndFloat32(0.0f));
-	if (m_vertexCount > D_CONVEX_VERTEX_BRUTE_FORCE_SPLIT)
+	if (m_adjacency)
+	{
+		return SupportVertexHillClimb(dir, vertexIndex);
+	}
+	else if (m_vertexCount > D_CONVEX_VERTEX_BRUTE_FORCE_SPLIT)
 	{
 		return SupportVertexhierarchical(dir, vertexIndex);
 	}
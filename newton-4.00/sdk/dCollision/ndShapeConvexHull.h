@@ -48,6 +48,8 @@ class ndShapeConvexHull : public ndShapeConvex
 	private:
 	ndVector SupportVertexBruteForce(const ndVector& dir, ndInt32* const vertexIndex) const;
 	ndVector SupportVertexhierarchical(const ndVector& dir, ndInt32* const vertexIndex) const;
+	ndVector SupportVertexHillClimb(const ndVector& dir, ndInt32* const vertexIndex) const;
+	void BuildSupportAdjacency();
 	
 	void DebugShape(const ndMatrix& matrix, ndShapeDebugNotify& debugCallback) const;
 
@@ -58,6 +60,9 @@ class ndShapeConvexHull : public ndShapeConvex
 	ndVector* m_soa_z;
 	ndVector* m_soa_index;
 	const ndConvexSimplexEdge** m_vertexToEdgeMapping;
+	ndInt32* m_adjacencyStart;
+	ndInt32* m_adjacency;
+	ndInt32* m_supportStartVertex;
 	ndInt32 m_faceCount;
 	ndInt32 m_soaVertexCount;
 	ndInt32 m_supportTreeCount;
@@ -29,6 +29,12 @@
 
 ndShapeStaticProceduralMesh::ndShapeStaticProceduralMesh(ndFloat32 sizex, ndFloat32 sizey, ndFloat32 sizez)
 	:ndShapeStaticMesh(m_staticProceduralMesh)
+	,m_faceCache()
+	,m_faceCacheLock()
+	,m_faceCacheStamp(0)
+	,m_faceCacheGeneration(0)
+	,m_faceCacheCellSize(ndFloat32(0.0f))
+	,m_faceCacheMaxEntries(0)
 {
 	m_boxOrigin = ndVector::m_zero;
 	m_boxSize = ndVector(sizex, sizey, sizez, ndFloat32 (0.0f)) * ndVector::m_half;
@@ -36,6 +42,7 @@ ndShapeStaticProceduralMesh::ndShapeStaticProceduralMesh(ndFloat32 sizex, ndFloa
 
 ndShapeStaticProceduralMesh::~ndShapeStaticProceduralMesh(void)
 {
+	FlushFaceCache();
 }
 
 ndShapeInfo ndShapeStaticProceduralMesh::GetShapeInfo() const
@@ -45,29 +52,74 @@ ndShapeInfo ndShapeStaticProceduralMesh::GetShapeInfo() const
 	return info;
 }
 
-void ndShapeStaticProceduralMesh::GetCollidingFaces(ndPolygonMeshDesc* const data) const
+void ndShapeStaticProceduralMesh::SetFaceCache(ndFloat32 cellSize, ndInt32 maxEntries)
 {
-	ndPolygonMeshDesc::ndStaticMeshFaceQuery& query = *data->m_staticMeshQuery;
-	ndPolygonMeshDesc::ndProceduralStaticMeshFaceQuery& meshPatch = *data->m_proceduralStaticMeshFaceQuery;
+	ndScopeWriteSpinLock lock(m_faceCacheLock);
+	FlushFaceCache();
+	m_faceCacheCellSize = ndMax(cellSize, ndFloat32(0.0f));
+	m_faceCacheMaxEntries = ndMax(maxEntries, 1);
+}
 
-	ndArray<ndVector>& vertex = meshPatch.m_vertex;
-	ndArray<ndInt32>& faceList = query.m_faceIndexCount;
-	ndArray<ndInt32>& indexList = meshPatch.m_indexListList;
-	ndArray<ndInt32>& faceMaterialList = meshPatch.m_faceMaterial;
-	GetCollidingFaces(data->GetOrigin(), data->GetTarget(), vertex, faceList, faceMaterialList, indexList);
+ndFloat32 ndShapeStaticProceduralMesh::GetFaceCacheCellSize() const
+{
+	return m_faceCacheCellSize;
+}
+
+ndInt32 ndShapeStaticProceduralMesh::GetFaceCacheCount() const
+{
+	return m_faceCache.GetCount();
+}
+
+void ndShapeStaticProceduralMesh::FlushFaceCache()
+{
+	// regions being built when the cache is flushed are not inserted
+	m_faceCacheGeneration++;
+	ndFaceCache::Iterator it(m_faceCache);
+	for (it.Begin(); it; it++)
+	{
+		delete *it;
+	}
+	m_faceCache.RemoveAll();
+}
+
+void ndShapeStaticProceduralMesh::InvalidateFaceCache()
+{
+	ndScopeWriteSpinLock lock(m_faceCacheLock);
+	FlushFaceCache();
+}
+
+void ndShapeStaticProceduralMesh::InvalidateFaceCache(const ndVector& minBox, const ndVector& maxBox)
+{
+	ndScopeWriteSpinLock lock(m_faceCacheLock);
+	m_faceCacheGeneration++;
+	ndFaceCache::Iterator it(m_faceCache);
+	for (it.Begin(); it; )
+	{
+		ndFaceCache::ndNode* const node = it.GetNode();
+		it++;
+		ndFaceCacheEntry* const entry = node->GetInfo();
+		if (ndOverlapTest(entry->m_minBox, entry->m_maxBox, minBox, maxBox))
+		{
+			delete entry;
+			m_faceCache.Remove(node);
+		}
+	}
+}
 
-	if (faceList.GetCount() == 0)
+void ndShapeStaticProceduralMesh::GenerateFaces(
+	const ndVector& minBox, const ndVector& maxBox, 
+	ndArray<ndVector>& vertex, ndArray<ndInt32>& faceIndexCount, ndArray<ndInt32>& indices, 
+	ndArray<ndInt32>& faceMaterialList, ndArray<ndInt32>& indexList) const
+{
+	GetCollidingFaces(minBox, maxBox, vertex, faceIndexCount, faceMaterialList, indexList);
+	if (faceIndexCount.GetCount() == 0)
 	{
 		return;
 	}
 
 	ndEdgeMap edgeMap;
-	//ndInt32 index = 0;
 	ndInt32 faceStart = 0;
-	ndArray<ndInt32>& indices = query.m_faceVertexIndex;
-	ndArray<ndInt32>& faceIndexCount = query.m_faceIndexCount;
-	
-	for (ndInt32 i = 0; i < faceList.GetCount(); ++i)
+	for (ndInt32 i = 0; i < faceIndexCount.GetCount(); ++i)
 	{
 		ndInt32 i0 = indexList[faceStart + 0];
 		ndInt32 i1 = indexList[faceStart + 1];
@@ -75,7 +127,7 @@ void ndShapeStaticProceduralMesh::GetCollidingFaces(ndPolygonMeshDesc* const dat
 		ndVector edge0(vertex[i1] - vertex[i0]);
 
 		ndFloat32 maxDiagonal2 = edge0.DotProduct(edge0).GetScalar();
-		for (ndInt32 j = 2; j < faceList[i]; ++j)
+		for (ndInt32 j = 2; j < faceIndexCount[i]; ++j)
 		{
 			ndInt32 i2 = indexList[faceStart + j];
 			const ndVector edge1(vertex[i2] - vertex[i0]);
@@ -93,15 +145,14 @@ void ndShapeStaticProceduralMesh::GetCollidingFaces(ndPolygonMeshDesc* const dat
 		const ndPlane plane(normal, -normal.DotProduct(vertex[i0]).GetScalar());
 
 		ndInt32 index = ndInt32(indices.GetCount());
-		indices.SetCount(index + faceList[i] * 2 + 3);
-		indices[index + faceList[i] + 0] = faceMaterialList[i];
-		indices[index + faceList[i] + 1] = normalIndex;
-		indices[index + 2 * faceList[i] + 2] = quantizedDiagSize;
+		indices.SetCount(index + faceIndexCount[i] * 2 + 3);
+		indices[index + faceIndexCount[i] + 0] = faceMaterialList[i];
+		indices[index + faceIndexCount[i] + 1] = normalIndex;
+		indices[index + 2 * faceIndexCount[i] + 2] = quantizedDiagSize;
 
-		ndInt32 j0 = faceList[i] - 1;
+		ndInt32 j0 = faceIndexCount[i] - 1;
 		ndInt32 testIndex = j0 - 1;
-		const ndInt32 faceVectexCount = faceList[i];
-		faceIndexCount[i] = faceVectexCount;
+		const ndInt32 faceVectexCount = faceIndexCount[i];
 		for (ndInt32 j1 = 0; j1 < faceVectexCount; ++j1)
 		{
 			ndInt32 k0 = indexList[faceStart + j0];
@@ -144,22 +195,33 @@ void ndShapeStaticProceduralMesh::GetCollidingFaces(ndPolygonMeshDesc* const dat
 		}
 		edgeNode->GetInfo() = -1;
 	}
+}
+
+void ndShapeStaticProceduralMesh::ClipFaces(ndPolygonMeshDesc* const data, const ndInt32* const faceIndexCountSrc, ndInt32 faceCount, const ndInt32* const indicesSrc) const
+{
+	// faces not touching the query box are discarded, the source 
+	// arrays can alias the query arrays since writes never overtake reads.
+	ndPolygonMeshDesc::ndStaticMeshFaceQuery& query = *data->m_staticMeshQuery;
+	ndPolygonMeshDesc::ndProceduralStaticMeshFaceQuery& meshPatch = *data->m_proceduralStaticMeshFaceQuery;
+
+	ndArray<ndVector>& vertex = meshPatch.m_vertex;
+	ndArray<ndInt32>& indices = query.m_faceVertexIndex;
+	ndArray<ndInt32>& faceIndexCount = query.m_faceIndexCount;
 
 	ndInt32 faceCount0 = 0;
 	ndInt32 faceIndexCount0 = 0;
 	ndInt32 faceIndexCount1 = 0;
 	ndInt32 stride = sizeof(ndVector) / sizeof(ndFloat32);
 	
-	//ndInt32* const address = data->m_meshData.m_globalFaceIndexStart;
 	ndArray<ndInt32>& address = query.m_faceIndexStart;
 	ndArray<ndFloat32>& hitDistance = query.m_hitDistance;
 	if (data->m_doContinueCollisionTest) 
 	{
 		ndFastRay ray(ndVector::m_zero, data->m_boxDistanceTravelInMeshSpace);
-		for (ndInt32 i = 0; i < faceList.GetCount(); ++i)
+		for (ndInt32 i = 0; i < faceCount; ++i)
 		{
-			const ndInt32 vertexCount = faceIndexCount[i];
-			const ndInt32* const indexArray = &indices[faceIndexCount1];
+			const ndInt32 vertexCount = faceIndexCountSrc[i];
+			const ndInt32* const indexArray = &indicesSrc[faceIndexCount1];
 			const ndVector& faceNormal = vertex[indexArray[4]];
 			ndFloat32 dist = data->PolygonBoxRayDistance(faceNormal, 3, indexArray, stride, &vertex[0].m_x, ray);
 			if (dist < ndFloat32(1.0f)) 
@@ -167,6 +229,7 @@ void ndShapeStaticProceduralMesh::GetCollidingFaces(ndPolygonMeshDesc* const dat
 				hitDistance.PushBack(dist);
 				address.PushBack(faceIndexCount0);
 				ndMemCpy(&indices[faceIndexCount0], indexArray, vertexCount * 2 + 3);
+				faceIndexCount[faceCount0] = vertexCount;
 				faceCount0++;
 				faceIndexCount0 += vertexCount * 2 + 3;
 			}
@@ -175,10 +238,10 @@ void ndShapeStaticProceduralMesh::GetCollidingFaces(ndPolygonMeshDesc* const dat
 	}
 	else 
 	{
-		for (ndInt32 i = 0; i < faceList.GetCount(); ++i)
+		for (ndInt32 i = 0; i < faceCount; ++i)
 		{
-			const ndInt32 vertexCount = faceIndexCount[i];
-			const ndInt32* const indexArray = &indices[faceIndexCount1];
+			const ndInt32 vertexCount = faceIndexCountSrc[i];
+			const ndInt32* const indexArray = &indicesSrc[faceIndexCount1];
 			const ndVector& faceNormal = vertex[indexArray[vertexCount + 1]];
 			ndFloat32 dist = data->PolygonBoxDistance(faceNormal, vertexCount, indexArray, stride, &vertex[0].m_x);
 			if (dist > ndFloat32(0.0f)) 
@@ -186,6 +249,7 @@ void ndShapeStaticProceduralMesh::GetCollidingFaces(ndPolygonMeshDesc* const dat
 				hitDistance.PushBack(dist);
 				address.PushBack(faceIndexCount0);
 				ndMemCpy(&indices[faceIndexCount0], indexArray, vertexCount * 2 + 3);
+				faceIndexCount[faceCount0] = vertexCount;
 				faceCount0++;
 				faceIndexCount0 += vertexCount * 2 + 3;
 			}
@@ -199,6 +263,127 @@ void ndShapeStaticProceduralMesh::GetCollidingFaces(ndPolygonMeshDesc* const dat
 	data->m_vertexStrideInBytes = sizeof(ndVector);
 }
 
+void ndShapeStaticProceduralMesh::GetCachedFaces(ndPolygonMeshDesc* const data) const
+{
+	ndPolygonMeshDesc::ndStaticMeshFaceQuery& query = *data->m_staticMeshQuery;
+	ndPolygonMeshDesc::ndProceduralStaticMeshFaceQuery& meshPatch = *data->m_proceduralStaticMeshFaceQuery;
+
+	// snap the query box to the cache grid, 
+	// so that nearby queries share the same face batch.
+	const ndVector cellSize(m_faceCacheCellSize);
+	const ndVector invCellSize(ndFloat32(1.0f) / m_faceCacheCellSize);
+	const ndVector p0((data->GetOrigin() * invCellSize).Floor() & ndVector::m_triplexMask);
+	const ndVector p1(((data->GetTarget() * invCellSize).Floor() + ndVector::m_one) & ndVector::m_triplexMask);
+	const ndFaceCacheKey key(p0, p1);
+
+	ndUnsigned32 generation = 0;
+	const ndUnsigned32 stamp = m_faceCacheStamp.fetch_add(1);
+	{
+		ndScopeReadSpinLock lock(m_faceCacheLock);
+		generation = m_faceCacheGeneration;
+		ndFaceCache::ndNode* const node = m_faceCache.Find(key);
+		if (node)
+		{
+			ndFaceCacheEntry* const entry = node->GetInfo();
+			entry->m_lastUsed.store(stamp);
+			if (entry->m_faceIndexCount.GetCount() == 0)
+			{
+				query.m_faceIndexCount.SetCount(0);
+				return;
+			}
+			meshPatch.m_vertex.SetCount(entry->m_vertex.GetCount());
+			ndMemCpy(&meshPatch.m_vertex[0], &entry->m_vertex[0], entry->m_vertex.GetCount());
+
+			const ndInt32 faceCount = ndInt32(entry->m_faceIndexCount.GetCount());
+			query.m_faceIndexCount.SetCount(faceCount);
+			query.m_faceVertexIndex.SetCount(entry->m_faceVertexIndex.GetCount());
+			ClipFaces(data, &entry->m_faceIndexCount[0], faceCount, &entry->m_faceVertexIndex[0]);
+			return;
+		}
+	}
+
+	// the user callback runs outside the lock, so several threads may build 
+	// the same region concurrently, or an invalidate may happen meanwhile.
+	ndFaceCacheEntry* const entry = new ndFaceCacheEntry;
+	entry->m_minBox = p0 * cellSize;
+	entry->m_maxBox = p1 * cellSize;
+	entry->m_lastUsed.store(stamp);
+	meshPatch.m_faceMaterial.SetCount(0);
+	meshPatch.m_indexListList.SetCount(0);
+	GenerateFaces(entry->m_minBox, entry->m_maxBox, entry->m_vertex, entry->m_faceIndexCount, entry->m_faceVertexIndex, meshPatch.m_faceMaterial, meshPatch.m_indexListList);
+
+	const ndInt32 faceCount = ndInt32(entry->m_faceIndexCount.GetCount());
+	if (faceCount)
+	{
+		meshPatch.m_vertex.SetCount(entry->m_vertex.GetCount());
+		ndMemCpy(&meshPatch.m_vertex[0], &entry->m_vertex[0], entry->m_vertex.GetCount());
+		query.m_faceIndexCount.SetCount(faceCount);
+		query.m_faceVertexIndex.SetCount(entry->m_faceVertexIndex.GetCount());
+		ClipFaces(data, &entry->m_faceIndexCount[0], faceCount, &entry->m_faceVertexIndex[0]);
+	}
+	else
+	{
+		query.m_faceIndexCount.SetCount(0);
+	}
+
+	ndScopeWriteSpinLock lock(m_faceCacheLock);
+	if (generation != m_faceCacheGeneration)
+	{
+		// the cache was invalidated while the faces were built, 
+		// they served this query but may already be stale.
+		delete entry;
+		return;
+	}
+	bool wasFound = false;
+	ndFaceCache::ndNode* const node = m_faceCache.Insert(entry, key, wasFound);
+	if (wasFound)
+	{
+		delete entry;
+	}
+	else if (m_faceCache.GetCount() > m_faceCacheMaxEntries)
+	{
+		// evict the least recently used region
+		ndFaceCache::ndNode* oldestNode = nullptr;
+		ndUnsigned32 oldestAge = 0;
+		ndFaceCache::Iterator it(m_faceCache);
+		for (it.Begin(); it; it++)
+		{
+			ndFaceCache::ndNode* const cacheNode = it.GetNode();
+			const ndUnsigned32 age = stamp - cacheNode->GetInfo()->m_lastUsed.load();
+			if ((cacheNode != node) && (!oldestNode || (age > oldestAge)))
+			{
+				oldestAge = age;
+				oldestNode = cacheNode;
+			}
+		}
+		if (oldestNode)
+		{
+			delete oldestNode->GetInfo();
+			m_faceCache.Remove(oldestNode);
+		}
+	}
+}
+
+void ndShapeStaticProceduralMesh::GetCollidingFaces(ndPolygonMeshDesc* const data) const
+{
+	if (m_faceCacheCellSize > ndFloat32(0.0f))
+	{
+		GetCachedFaces(data);
+		return;
+	}
+
+	ndPolygonMeshDesc::ndStaticMeshFaceQuery& query = *data->m_staticMeshQuery;
+	ndPolygonMeshDesc::ndProceduralStaticMeshFaceQuery& meshPatch = *data->m_proceduralStaticMeshFaceQuery;
+
+	ndArray<ndInt32>& faceIndexCount = query.m_faceIndexCount;
+	ndArray<ndInt32>& indices = query.m_faceVertexIndex;
+	GenerateFaces(data->GetOrigin(), data->GetTarget(), meshPatch.m_vertex, faceIndexCount, indices, meshPatch.m_faceMaterial, meshPatch.m_indexListList);
+	if (faceIndexCount.GetCount())
+	{
+		ClipFaces(data, &faceIndexCount[0], ndInt32(faceIndexCount.GetCount()), &indices[0]);
+	}
+}
+
 ndUnsigned64 ndShapeStaticProceduralMesh::GetHash(ndUnsigned64 hash) const
 {
 	return hash + 1;
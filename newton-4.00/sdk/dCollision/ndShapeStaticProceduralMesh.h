@@ -57,6 +57,39 @@ class ndShapeStaticProceduralMesh: public ndShapeStaticMesh
 		ndEdgeMap();
 	};
 
+	// faces in a cached region, already processed with normals and edge adjacency
+	class ndFaceCacheEntry : public ndClassAlloc
+	{
+		public:
+		ndFaceCacheEntry();
+
+		ndVector m_minBox;
+		ndVector m_maxBox;
+		ndArray<ndVector> m_vertex;
+		ndArray<ndInt32> m_faceIndexCount;
+		ndArray<ndInt32> m_faceVertexIndex;
+		ndAtomic<ndUnsigned32> m_lastUsed;
+	};
+
+	// integer grid region used to look up cached faces
+	class ndFaceCacheKey
+	{
+		public:
+		ndFaceCacheKey();
+		ndFaceCacheKey(const ndVector& p0, const ndVector& p1);
+
+		bool operator< (const ndFaceCacheKey& key) const;
+		bool operator> (const ndFaceCacheKey& key) const;
+
+		ndInt32 m_box[6];
+	};
+
+	class ndFaceCache : public ndTree<ndFaceCacheEntry*, ndFaceCacheKey, ndContainersFreeListAlloc<ndFaceCacheEntry*>>
+	{
+		public:
+		ndFaceCache();
+	};
+
 	D_CLASS_REFLECTION(ndShapeStaticProceduralMesh, ndShapeStaticMesh)
 	D_COLLISION_API ndShapeStaticProceduralMesh(ndFloat32 sizex, ndFloat32 sizey, ndFloat32 sizez);
 	D_COLLISION_API virtual ~ndShapeStaticProceduralMesh();
@@ -64,6 +97,17 @@ class ndShapeStaticProceduralMesh: public ndShapeStaticMesh
 	virtual ndShapeStaticProceduralMesh* GetAsShapeStaticProceduralMesh() { return this; }
 	virtual void GetCollidingFaces(const ndVector& minBox, const ndVector& maxBox, ndArray<ndVector>& vertex, ndArray<ndInt32>& faceList, ndArray<ndInt32>& faceMaterial, ndArray<ndInt32>& indexListList) const;
 
+	// face cache: when enabled, queries are snapped to a grid of cellSize and 
+	// the faces of each snapped region are generated once and reused until invalidated.
+	// a cellSize of zero disables the cache.
+	D_COLLISION_API void SetFaceCache(ndFloat32 cellSize, ndInt32 maxEntries = 1024);
+	D_COLLISION_API ndFloat32 GetFaceCacheCellSize() const;
+	D_COLLISION_API ndInt32 GetFaceCacheCount() const;
+
+	// call after the procedural geometry changes, the box is in shape local space.
+	D_COLLISION_API void InvalidateFaceCache();
+	D_COLLISION_API void InvalidateFaceCache(const ndVector& minBox, const ndVector& maxBox);
+
 	protected:
 	D_COLLISION_API virtual ndShapeInfo GetShapeInfo() const;
 	D_COLLISION_API virtual ndUnsigned64 GetHash(ndUnsigned64 hash) const;
@@ -71,6 +115,18 @@ class ndShapeStaticProceduralMesh: public ndShapeStaticMesh
 	D_COLLISION_API virtual void GetCollidingFaces(ndPolygonMeshDesc* const data) const;
 
 	private:
+	void GenerateFaces(const ndVector& minBox, const ndVector& maxBox, ndArray<ndVector>& vertex, ndArray<ndInt32>& faceIndexCount, ndArray<ndInt32>& indices, ndArray<ndInt32>& faceMaterial, ndArray<ndInt32>& indexList) const;
+	void ClipFaces(ndPolygonMeshDesc* const data, const ndInt32* const faceIndexCount, ndInt32 faceCount, const ndInt32* const indices) const;
+	void GetCachedFaces(ndPolygonMeshDesc* const data) const;
+	void FlushFaceCache();
+
+	mutable ndFaceCache m_faceCache;
+	mutable ndReadWriteSpinLock m_faceCacheLock;
+	mutable ndAtomic<ndUnsigned32> m_faceCacheStamp;
+	ndUnsigned32 m_faceCacheGeneration;
+	ndFloat32 m_faceCacheCellSize;
+	ndInt32 m_faceCacheMaxEntries;
+
 	friend class ndContactSolver;
 } D_GCC_NEWTON_ALIGN_32;
 
@@ -107,4 +163,51 @@ inline ndShapeStaticProceduralMesh::ndEdgeMap::ndEdgeMap()
 {
 }
 
+inline ndShapeStaticProceduralMesh::ndFaceCacheEntry::ndFaceCacheEntry()
+	:ndClassAlloc()
+	,m_minBox(ndVector::m_zero)
+	,m_maxBox(ndVector::m_zero)
+	,m_vertex()
+	,m_faceIndexCount()
+	,m_faceVertexIndex()
+	,m_lastUsed(0)
+{
+}
+
+inline ndShapeStaticProceduralMesh::ndFaceCacheKey::ndFaceCacheKey()
+{
+}
+
+inline ndShapeStaticProceduralMesh::ndFaceCacheKey::ndFaceCacheKey(const ndVector& p0, const ndVector& p1)
+{
+	m_box[0] = ndInt32(p0.m_x);
+	m_box[1] = ndInt32(p0.m_y);
+	m_box[2] = ndInt32(p0.m_z);
+	m_box[3] = ndInt32(p1.m_x);
+	m_box[4] = ndInt32(p1.m_y);
+	m_box[5] = ndInt32(p1.m_z);
+}
+
+inline bool ndShapeStaticProceduralMesh::ndFaceCacheKey::operator< (const ndFaceCacheKey& key) const
+{
+	for (ndInt32 i = 0; i < 6; ++i)
+	{
+		if (m_box[i] != key.m_box[i])
+		{
+			return m_box[i] < key.m_box[i];
+		}
+	}
+	return false;
+}
+
+inline bool ndShapeStaticProceduralMesh::ndFaceCacheKey::operator> (const ndFaceCacheKey& key) const
+{
+	return key < *this;
+}
+
+inline ndShapeStaticProceduralMesh::ndFaceCache::ndFaceCache()
+	:ndTree<ndFaceCacheEntry*, ndFaceCacheKey, ndContainersFreeListAlloc<ndFaceCacheEntry*>>()
+{
+}
+
 #endif
@@ -53,6 +53,16 @@ class ndBvhRay: public ndFastRay
 	const ndShapeStatic_bvh* m_me;
 } D_GCC_NEWTON_ALIGN_32;
 
+D_MSV_NEWTON_ALIGN_32
+class ndBvhRayPacket
+{
+	public:
+	ndVector m_normal[D_RAY_PACKET_SIZE];
+	ndUnsigned32 m_id[D_RAY_PACKET_SIZE];
+	ndFloat32 m_t[D_RAY_PACKET_SIZE];
+	const ndFastRayPacket* m_packet;
+	const ndShapeStatic_bvh* m_me;
+} D_GCC_NEWTON_ALIGN_32;
 
 ndShapeStatic_bvh::ndShapeStatic_bvh()
 	:ndShapeStaticMesh(m_boundingBoxHierachy)
@@ -194,6 +204,52 @@ ndFloat32 ndShapeStatic_bvh::RayCast(ndRayCastNotify& callback, const ndVector&
 	return t;
 }
 
+ndFloat32 ndShapeStatic_bvh::RayPacketHit(void* const context, ndInt32 lane, const ndFloat32* const polygon, ndInt32 strideInBytes, const ndInt32* const indexArray, ndInt32 indexCount)
+{
+	ndBvhRayPacket& me = *((ndBvhRayPacket*)context);
+	ndVector normal(&polygon[indexArray[indexCount + 1] * (strideInBytes / sizeof(ndFloat32))]);
+	normal = normal & ndVector::m_triplexMask;
+	const ndFastRay& ray = me.m_packet->m_rays[lane];
+	ndFloat32 t = ray.PolygonIntersect(normal, me.m_t[lane], polygon, strideInBytes, indexArray, indexCount);
+	if (t <= (me.m_t[lane] * ndFloat32(1.0001f)))
+	{
+		me.m_t[lane] = t;
+		me.m_normal[lane] = normal;
+		me.m_id[lane] = me.m_me->GetTagId(indexArray, indexCount);
+	}
+	return t;
+}
+
+ndInt32 ndShapeStatic_bvh::RayCast(const ndFastRayPacket& packet, ndFloat32* const maxT, ndContactPoint* const contactsOut) const
+{
+	ndBvhRayPacket rays;
+	ndFloat32 param[D_RAY_PACKET_SIZE];
+	for (ndInt32 i = 0; i < packet.m_count; ++i)
+	{
+		rays.m_t[i] = ndFloat32(1.0f);
+		param[i] = maxT[i];
+	}
+	rays.m_me = this;
+	rays.m_packet = &packet;
+	ForAllSectorsRayPacketHit(packet, param, RayPacketHit, &rays);
+
+	ndInt32 hitMask = 0;
+	for (ndInt32 i = 0; i < packet.m_count; ++i)
+	{
+		if (rays.m_t[i] < maxT[i])
+		{
+			maxT[i] = rays.m_t[i];
+			ndAssert(rays.m_normal[i].m_w == ndFloat32(0.0f));
+			ndAssert(rays.m_normal[i].DotProduct(rays.m_normal[i]).GetScalar() > ndFloat32(0.0f));
+			contactsOut[i].m_normal = rays.m_normal[i].Normalize();
+			contactsOut[i].m_shapeId0 = rays.m_id[i];
+			contactsOut[i].m_shapeId1 = rays.m_id[i];
+			hitMask |= 1 << i;
+		}
+	}
+	return hitMask;
+}
+
 ndIntersectStatus ndShapeStatic_bvh::GetPolygon(void* const context, const ndFloat32* const, ndInt32, const ndInt32* const indexArray, ndInt32 indexCount, ndFloat32 hitDistance)
 {
 	ndPolygonMeshDesc& data = (*(ndPolygonMeshDesc*)context);
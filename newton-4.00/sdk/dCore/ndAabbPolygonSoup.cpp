@@ -1065,6 +1065,76 @@ void ndAabbPolygonSoup::ForAllSectorsRayHit (const ndFastRay& raySrc, ndFloat32
 	}
 }
 
+void ndAabbPolygonSoup::ForAllSectorsRayPacketHit(const ndFastRayPacket& packet, ndFloat32* const maxParam, ndRayPacketIntersectCallback callback, void* const context) const
+{
+	const ndNode* stackPool[DG_STACK_DEPTH];
+	ndVector distance[DG_STACK_DEPTH];
+
+	const ndInt32 laneMask = packet.GetLaneMask();
+	const ndTriplex* const vertexArray = (ndTriplex*)m_localVertex;
+
+	ndVector param(ndFloat32(-1.0f));
+	for (ndInt32 i = 0; i < packet.m_count; ++i)
+	{
+		param[i] = maxParam[i];
+	}
+
+	ndInt32 stack = 1;
+	stackPool[0] = m_aabb;
+	distance[0] = m_aabb->RayDistance(packet, vertexArray);
+	while (stack)
+	{
+		stack--;
+		const ndInt32 activeMask = (distance[stack] < param).GetSignMask() & laneMask;
+		if (!activeMask)
+		{
+			continue;
+		}
+
+		const ndNode* const me = stackPool[stack];
+		const ndNode::ndLeafNodePtr children[] = { me->m_left, me->m_right };
+		for (ndInt32 i = 0; i < 2; ++i)
+		{
+			const ndNode::ndLeafNodePtr child(children[i]);
+			if (child.IsLeaf())
+			{
+				ndInt32 vCount = ndInt32(child.GetCount());
+				if (vCount > 0)
+				{
+					ndInt32 index = ndInt32(child.GetIndex());
+					for (ndInt32 mask = activeMask; mask; mask = mask & (mask - 1))
+					{
+						const ndInt32 lane = ndExp2(mask & -mask);
+						if (param[lane] > ndFloat32(0.0f))
+						{
+							ndFloat32 t = callback(context, lane, &vertexArray[0].m_x, sizeof(ndTriplex), &m_indices[index], vCount);
+							ndAssert(t >= ndFloat32(0.0f));
+							param[lane] = ndMin(param[lane], t);
+						}
+					}
+				}
+			}
+			else
+			{
+				const ndNode* const node = child.GetNode(m_aabb);
+				const ndVector dist(node->RayDistance(packet, vertexArray));
+				if ((dist < param).GetSignMask() & laneMask)
+				{
+					ndAssert(stack < DG_STACK_DEPTH);
+					stackPool[stack] = node;
+					distance[stack] = dist;
+					stack++;
+				}
+			}
+		}
+	}
+
+	for (ndInt32 i = 0; i < packet.m_count; ++i)
+	{
+		maxParam[i] = param[i];
+	}
+}
+
 void ndAabbPolygonSoup::ForAllSectors (const ndFastAabb& obbAabbInfo, const ndVector& boxDistanceTravel, ndFloat32, ndAaabbIntersectCallback callback, void* const context) const
 {
 	ndAssert (ndAbs(ndAbs(obbAabbInfo[0][0]) - obbAabbInfo.m_absDir[0][0]) < ndFloat32 (1.0e-4f));
@@ -50,6 +50,10 @@ typedef ndFloat32(*ndRayIntersectCallback) (void* const context,
 	const ndFloat32* const polygon, ndInt32 strideInBytes,
 	const ndInt32* const indexArray, ndInt32 indexCount);
 
+typedef ndFloat32(*ndRayPacketIntersectCallback) (void* const context, ndInt32 lane,
+	const ndFloat32* const polygon, ndInt32 strideInBytes,
+	const ndInt32* const indexArray, ndInt32 indexCount);
+
 /// Base class for creating a leafless bounding box hierarchy for queering a polygon list index list mesh.
 class ndAabbPolygonSoup: public ndPolygonSoupDatabase
 {
@@ -127,6 +131,15 @@ class ndAabbPolygonSoup: public ndPolygonSoupDatabase
 			return ray.BoxIntersect(minBox, maxBox);
 		}
 
+		inline ndVector RayDistance (const ndFastRayPacket& packet, const ndTriplex* const vertexArray) const
+		{
+			ndVector minBox (&vertexArray[m_indexBox0].m_x);
+			ndVector maxBox (&vertexArray[m_indexBox1].m_x);
+			minBox = minBox & ndVector::m_triplexMask;
+			maxBox = maxBox & ndVector::m_triplexMask;
+			return packet.BoxIntersect(minBox, maxBox);
+		}
+
 		inline ndFloat32 BoxPenetration (const ndFastAabb& obb, const ndTriplex* const vertexArray) const
 		{
 			ndVector p0 (&vertexArray[m_indexBox0].m_x);
@@ -227,6 +240,7 @@ class ndAabbPolygonSoup: public ndPolygonSoupDatabase
 	D_CORE_API void CalculateAdjacent ();
 	D_CORE_API virtual ndVector ForAllSectorsSupportVertex(const ndVector& dir) const;
 	D_CORE_API virtual void ForAllSectorsRayHit (const ndFastRay& ray, ndFloat32 maxT, ndRayIntersectCallback callback, void* const context) const;
+	D_CORE_API void ForAllSectorsRayPacketHit (const ndFastRayPacket& packet, ndFloat32* const maxT, ndRayPacketIntersectCallback callback, void* const context) const;
 	D_CORE_API virtual void ForAllSectors (const ndFastAabb& obbAabb, const ndVector& boxDistanceTravel, ndFloat32 maxT, ndAaabbIntersectCallback callback, void* const context) const;
 	D_CORE_API virtual void ForThisSector(const ndAabbPolygonSoup::ndNode* const node, const ndFastAabb& obbAabb, const ndVector& boxDistanceTravel, ndFloat32 maxT, ndAaabbIntersectCallback callback, void* const context) const;
 
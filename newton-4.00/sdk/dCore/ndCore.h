@@ -47,6 +47,7 @@
 #include <ndPolyhedra.h>
 #include <ndSyncMutex.h>
 #include <ndSemaphore.h>
+#include <ndSimdDispatch.h>
 #include <ndSharedPtr.h>
 #include <ndClassAlloc.h>
 #include <ndThreadPool.h>
@@ -69,6 +69,26 @@ class ndFastRay: public ndRay
 	ndVector m_isParallel;
 } D_GCC_NEWTON_ALIGN_32 ;
 
+#define D_RAY_PACKET_SIZE 4
+
+// up to four rays in structure of arrays form, each node box is tested 
+// against all the rays of the packet with one vector operation.
+D_MSV_NEWTON_ALIGN_32
+class ndFastRayPacket: public ndClassAlloc
+{
+	public:
+	ndFastRayPacket(const ndFastRay* const rays, ndInt32 count);
+
+	ndInt32 GetLaneMask() const;
+	ndVector BoxIntersect(const ndVector& minBox, const ndVector& maxBox) const;
+
+	ndVector m_p0[3];
+	ndVector m_dpInv[3];
+	ndVector m_isParallel[3];
+	const ndFastRay* m_rays;
+	ndInt32 m_count;
+} D_GCC_NEWTON_ALIGN_32;
+
 inline ndFastRay::ndFastRay(const ndVector& l0, const ndVector& l1)
 	:ndRay(l0, l1)
 	,m_diff(m_p1 - m_p0)
@@ -176,5 +196,50 @@ inline ndFloat32 ndFastRay::BoxIntersect(const ndVector& minBox, const ndVector&
 	return t0.GetScalar();
 }
 
+inline ndFastRayPacket::ndFastRayPacket(const ndFastRay* const rays, ndInt32 count)
+	:ndClassAlloc()
+	,m_rays(rays)
+	,m_count(count)
+{
+	ndAssert(count > 0);
+	ndAssert(count <= D_RAY_PACKET_SIZE);
+
+	// unused lanes repeat the first ray, they are masked out by the lane mask
+	const ndFastRay* lanes[D_RAY_PACKET_SIZE];
+	for (ndInt32 i = 0; i < D_RAY_PACKET_SIZE; ++i)
+	{
+		lanes[i] = &rays[(i < count) ? i : 0];
+	}
+
+	ndVector tmp;
+	ndVector::Transpose4x4(m_p0[0], m_p0[1], m_p0[2], tmp, lanes[0]->m_p0, lanes[1]->m_p0, lanes[2]->m_p0, lanes[3]->m_p0);
+	ndVector::Transpose4x4(m_dpInv[0], m_dpInv[1], m_dpInv[2], tmp, lanes[0]->m_dpInv, lanes[1]->m_dpInv, lanes[2]->m_dpInv, lanes[3]->m_dpInv);
+	ndVector::Transpose4x4(m_isParallel[0], m_isParallel[1], m_isParallel[2], tmp, lanes[0]->m_isParallel, lanes[1]->m_isParallel, lanes[2]->m_isParallel, lanes[3]->m_isParallel);
+}
+
+inline ndInt32 ndFastRayPacket::GetLaneMask() const
+{
+	return (1 << m_count) - 1;
+}
+
+inline ndVector ndFastRayPacket::BoxIntersect(const ndVector& minBox, const ndVector& maxBox) const
+{
+	ndVector t0(ndVector::m_zero);
+	ndVector t1(ndVector::m_one);
+	ndVector outside(ndVector::m_zero);
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		const ndVector boxP0(minBox[i]);
+		const ndVector boxP1(maxBox[i]);
+		outside = outside | (((m_p0[i] <= boxP0) | (m_p0[i] >= boxP1)) & m_isParallel[i]);
+		const ndVector tt0(m_dpInv[i] * (boxP0 - m_p0[i]));
+		const ndVector tt1(m_dpInv[i] * (boxP1 - m_p0[i]));
+		t0 = t0.GetMax(tt0.GetMin(tt1));
+		t1 = t1.GetMin(tt0.GetMax(tt1));
+	}
+	const ndVector mask((t0 < t1).AndNot(outside));
+	return ndVector(ndFloat32(1.2f)).Select(t0, mask);
+}
+
 #endif
 
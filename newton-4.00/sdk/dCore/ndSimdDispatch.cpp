@@ -0,0 +1,199 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndUtils.h"
+#include "ndSimdDispatch.h"
+
+// the wide kernels are compiled with per function target attributes,
+// so the rest of the library can still be built for plain sse3.
+#if !defined(D_NEWTON_USE_DOUBLE) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+	#define D_SIMD_DISPATCH_X86
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#define D_TARGET_AVX2
+		#define D_TARGET_AVX512
+	#else
+		#define D_TARGET_AVX2 __attribute__((target("avx2")))
+		#define D_TARGET_AVX512 __attribute__((target("avx512f,avx2")))
+	#endif
+#endif
+
+// the lane with the largest projection, ties go to the lowest vertex index
+// so every kernel returns the same vertex, whatever its lane count.
+static inline ndInt32 ndSupportVertexReduce(const ndFloat32* const proj, const ndFloat32* const support, ndInt32 lanes)
+{
+	ndInt32 best = 0;
+	for (ndInt32 i = 1; i < lanes; ++i)
+	{
+		if ((proj[i] > proj[best]) || ((proj[i] == proj[best]) && (support[i] < support[best])))
+		{
+			best = i;
+		}
+	}
+	return ndInt32(support[best]);
+}
+
+static ndInt32 ndSupportVertexSse(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 soaCount, const ndVector& dir)
+{
+	const ndVector dirX(dir.m_x);
+	const ndVector dirY(dir.m_y);
+	const ndVector dirZ(dir.m_z);
+
+	ndVector support(index[0]);
+	ndVector maxProj(x[0] * dirX + y[0] * dirY + z[0] * dirZ);
+	for (ndInt32 i = 1; i < soaCount; ++i)
+	{
+		ndVector dot(x[i] * dirX + y[i] * dirY + z[i] * dirZ);
+		support = support.Select(index[i], dot > maxProj);
+		maxProj = maxProj.GetMax(dot);
+	}
+
+	return ndSupportVertexReduce(&maxProj.m_x, &support.m_x, 4);
+}
+
+#ifdef D_SIMD_DISPATCH_X86
+
+D_TARGET_AVX2 static ndInt32 ndSupportVertexAvx2(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 soaCount, const ndVector& dir)
+{
+	const __m256 dirX(_mm256_set1_ps(dir.m_x));
+	const __m256 dirY(_mm256_set1_ps(dir.m_y));
+	const __m256 dirZ(_mm256_set1_ps(dir.m_z));
+
+	__m256 support(_mm256_set1_ps(index[0].m_x));
+	__m256 maxProj(_mm256_set1_ps(-ndFloat32(1.0e30f)));
+
+	ndInt32 i = 0;
+	for (; (i + 2) <= soaCount; i += 2)
+	{
+		const __m256 dot(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&x[i].m_x), dirX), _mm256_mul_ps(_mm256_loadu_ps(&y[i].m_x), dirY)), _mm256_mul_ps(_mm256_loadu_ps(&z[i].m_x), dirZ)));
+		const __m256 mask(_mm256_cmp_ps(dot, maxProj, _CMP_GT_OQ));
+		support = _mm256_blendv_ps(support, _mm256_loadu_ps(&index[i].m_x), mask);
+		maxProj = _mm256_max_ps(maxProj, dot);
+	}
+	if (i < soaCount)
+	{
+		// odd block, both halves test the same four vertices
+		const __m256 dot(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_broadcast_ps((const __m128*)&x[i].m_x), dirX), _mm256_mul_ps(_mm256_broadcast_ps((const __m128*)&y[i].m_x), dirY)), _mm256_mul_ps(_mm256_broadcast_ps((const __m128*)&z[i].m_x), dirZ)));
+		const __m256 mask(_mm256_cmp_ps(dot, maxProj, _CMP_GT_OQ));
+		support = _mm256_blendv_ps(support, _mm256_broadcast_ps((const __m128*)&index[i].m_x), mask);
+		maxProj = _mm256_max_ps(maxProj, dot);
+	}
+
+	ndFloat32 proj[8];
+	ndFloat32 ids[8];
+	_mm256_storeu_ps(proj, maxProj);
+	_mm256_storeu_ps(ids, support);
+	return ndSupportVertexReduce(proj, ids, 8);
+}
+
+D_TARGET_AVX512 static ndInt32 ndSupportVertexAvx512(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 soaCount, const ndVector& dir)
+{
+	const __m512 dirX(_mm512_set1_ps(dir.m_x));
+	const __m512 dirY(_mm512_set1_ps(dir.m_y));
+	const __m512 dirZ(_mm512_set1_ps(dir.m_z));
+
+	__m512 support(_mm512_set1_ps(index[0].m_x));
+	__m512 maxProj(_mm512_set1_ps(-ndFloat32(1.0e30f)));
+
+	ndInt32 i = 0;
+	for (; (i + 4) <= soaCount; i += 4)
+	{
+		const __m512 dot(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(&x[i].m_x), dirX), _mm512_mul_ps(_mm512_loadu_ps(&y[i].m_x), dirY)), _mm512_mul_ps(_mm512_loadu_ps(&z[i].m_x), dirZ)));
+		const __mmask16 mask = _mm512_cmp_ps_mask(dot, maxProj, _CMP_GT_OQ);
+		support = _mm512_mask_mov_ps(support, mask, _mm512_loadu_ps(&index[i].m_x));
+		maxProj = _mm512_mask_mov_ps(maxProj, mask, dot);
+	}
+	if (i < soaCount)
+	{
+		// masked loads for the last one to three blocks
+		const __mmask16 load = __mmask16((1 << ((soaCount - i) * 4)) - 1);
+		const __m512 dot(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_maskz_loadu_ps(load, &x[i].m_x), dirX), _mm512_mul_ps(_mm512_maskz_loadu_ps(load, &y[i].m_x), dirY)), _mm512_mul_ps(_mm512_maskz_loadu_ps(load, &z[i].m_x), dirZ)));
+		const __mmask16 mask = _mm512_mask_cmp_ps_mask(load, dot, maxProj, _CMP_GT_OQ);
+		support = _mm512_mask_mov_ps(support, mask, _mm512_maskz_loadu_ps(load, &index[i].m_x));
+		maxProj = _mm512_mask_mov_ps(maxProj, mask, dot);
+	}
+
+	ndFloat32 proj[16];
+	ndFloat32 ids[16];
+	_mm512_storeu_ps(proj, maxProj);
+	_mm512_storeu_ps(ids, support);
+	return ndSupportVertexReduce(proj, ids, 16);
+}
+#endif
+
+static ndSimdKernels ndBuildSimdKernels(ndSimdLevel level)
+{
+	ndSimdKernels kernels;
+	kernels.m_level = ndSimdSse;
+	kernels.m_supportVertex = ndSupportVertexSse;
+
+	#ifdef D_SIMD_DISPATCH_X86
+	switch (level)
+	{
+		case ndSimdAvx512:
+			kernels.m_level = ndSimdAvx512;
+			kernels.m_supportVertex = ndSupportVertexAvx512;
+			break;
+
+		case ndSimdAvx2:
+			kernels.m_level = ndSimdAvx2;
+			kernels.m_supportVertex = ndSupportVertexAvx2;
+			break;
+
+		default:
+			break;
+	}
+	#else
+	(void)level;
+	#endif
+	return kernels;
+}
+
+static ndSimdKernels ndSimdKernelTable(ndBuildSimdKernels(ndGetBestSimdLevel()));
+
+ndSimdLevel ndGetBestSimdLevel()
+{
+	#ifdef D_SIMD_DISPATCH_X86
+		const ndUnsigned32 features = ndGetCpuSimdFeatures();
+		if (features & ndCpuAvx512)
+		{
+			return ndSimdAvx512;
+		}
+		if (features & ndCpuAvx2)
+		{
+			return ndSimdAvx2;
+		}
+	#endif
+	return ndSimdSse;
+}
+
+const ndSimdKernels& ndGetSimdKernels()
+{
+	return ndSimdKernelTable;
+}
+
+ndSimdLevel ndSetSimdKernels(ndSimdLevel level)
+{
+	const ndSimdLevel best = ndGetBestSimdLevel();
+	ndSimdKernelTable = ndBuildSimdKernels((level > best) ? best : level);
+	return ndSimdKernelTable.m_level;
+}
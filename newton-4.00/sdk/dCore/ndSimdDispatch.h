@@ -0,0 +1,62 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_SIMD_DISPATCH_H__
+#define __ND_SIMD_DISPATCH_H__
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndVector.h"
+
+/// instruction set of a kernel table
+enum ndSimdLevel
+{
+	ndSimdSse,		// the 4 wide ndVector, sse3 on x86 and neon on arm
+	ndSimdAvx2,
+	ndSimdAvx512,
+};
+
+/// index of the vertex with the largest projection along dir,
+/// vertices are stored transposed in blocks of four, the index block holds the vertex ids as floats.
+typedef ndInt32 (*ndSupportVertexKernel)(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 soaCount, const ndVector& dir);
+
+/// kernels compiled for each instruction set, all variants live in the same binary.
+/// only the convex hull support search is dispatched here, the wide solvers are 
+/// separate libraries picked by ndWorld::SelectSolver.
+class ndSimdKernels
+{
+	public:
+	ndSimdLevel m_level;
+	ndSupportVertexKernel m_supportVertex;
+};
+
+/// Returns the widest instruction set that the cpu supports and that has kernels in this build
+D_CORE_API ndSimdLevel ndGetBestSimdLevel();
+
+/// Returns the kernel table in use, the best level is selected at startup
+D_CORE_API const ndSimdKernels& ndGetSimdKernels();
+
+/// Select the kernel table, the level is clamped to the best level.
+/// Not thread safe, do not call while a world is updating.
+/// \return the level selected
+D_CORE_API ndSimdLevel ndSetSimdKernels(ndSimdLevel level);
+
+#endif
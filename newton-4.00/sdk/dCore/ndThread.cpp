@@ -37,7 +37,7 @@ ndThread::ndThread()
 #ifndef D_USE_THREAD_EMULATION
 	,ndAtomic<bool>(true)
 	,std::condition_variable()
-	,std::thread(&ndThread::ThreadFunctionCallback, this)
+	,std::thread(&ndThread::ThreadEntry, this)
 #endif
 {
 	strcpy (m_name.m_name, "newtonWorker");
@@ -106,15 +106,23 @@ void ndThread::Release()
 {
 }
 
-void ndThread::ThreadFunctionCallback()
+void ndThread::ThreadEntry(ndThread* const thread)
 {
 #ifndef D_USE_THREAD_EMULATION
-	// wait until constructor was fully initialized.
-	while (load())
+	// the thread starts before the vtable of the object is set, 
+	// so wait until constructor was fully initialized before 
+	// making any virtual call.
+	while (thread->load())
 	{
 		ndThreadYield();
 	}
+	thread->ThreadFunctionCallback();
+#endif
+}
 
+void ndThread::ThreadFunctionCallback()
+{
+#ifndef D_USE_THREAD_EMULATION
 	D_SET_TRACK_NAME(m_name);
 	ndFloatExceptions exception;
 
@@ -77,6 +77,10 @@ class ndThread
 	D_CORE_API virtual void Release();
 	D_CORE_API virtual void ThreadFunctionCallback();
 
+	private:
+	static void ThreadEntry(ndThread* const thread);
+
+	protected:
 	ndThreadName m_name;
 };
 
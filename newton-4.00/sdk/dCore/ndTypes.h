@@ -182,12 +182,18 @@
 
 	#define	D_GCC_NEWTON_ALIGN_32 
 	#define	D_MSV_NEWTON_ALIGN_32	__declspec(align(32))
+
+	#define	D_GCC_NEWTON_ALIGN_64 
+	#define	D_MSV_NEWTON_ALIGN_64	__declspec(align(64))
 #else
 	#define	D_GCC_NEWTON_ALIGN_16     __attribute__((aligned (16)))
 	#define	D_MSV_NEWTON_ALIGN_16
 
 	#define	D_GCC_NEWTON_ALIGN_32     __attribute__((aligned (32)))
 	#define	D_MSV_NEWTON_ALIGN_32
+
+	#define	D_GCC_NEWTON_ALIGN_64     __attribute__((aligned (64)))
+	#define	D_MSV_NEWTON_ALIGN_64
 #endif
 
 #if defined(_MSC_VER)
@@ -55,6 +55,95 @@ ndUnsigned64 ndGetTimeInMicroseconds()
 	return timeStamp;
 }
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+
+static void ndCpuId(ndUnsigned32 leaf, ndUnsigned32 subLeaf, ndUnsigned32 regs[4])
+{
+	#if defined(_MSC_VER)
+		__cpuidex((int*)regs, ndInt32(leaf), ndInt32(subLeaf));
+	#else
+		__cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+	#endif
+}
+
+static ndUnsigned64 ndGetXcr0()
+{
+	#if defined(_MSC_VER)
+		return _xgetbv(0);
+	#else
+		ndUnsigned32 eax;
+		ndUnsigned32 edx;
+		__asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (ndUnsigned64(edx) << 32) | eax;
+	#endif
+}
+
+static ndUnsigned32 ndQueryCpuSimdFeatures()
+{
+	ndUnsigned32 regs[4];
+	ndCpuId(0, 0, regs);
+	const ndUnsigned32 maxLeaf = regs[0];
+	if (maxLeaf < 1)
+	{
+		return 0;
+	}
+
+	ndUnsigned32 features = 0;
+	ndCpuId(1, 0, regs);
+	const ndUnsigned32 ecx1 = regs[2];
+	if (ecx1 & (1 << 0))
+	{
+		features |= ndCpuSse3;
+	}
+
+	// the os must save the wide registers on context switch (osxsave + xcr0)
+	const bool osxsave = (ecx1 & (1 << 27)) != 0;
+	const bool avx = (ecx1 & (1 << 28)) != 0;
+	const bool fma = (ecx1 & (1 << 12)) != 0;
+	if (!(osxsave && avx && fma) || (maxLeaf < 7))
+	{
+		return features;
+	}
+
+	const ndUnsigned64 xcr0 = ndGetXcr0();
+	if ((xcr0 & 0x06) != 0x06)
+	{
+		return features;
+	}
+
+	ndCpuId(7, 0, regs);
+	const ndUnsigned32 ebx7 = regs[1];
+	if (ebx7 & (1 << 5))
+	{
+		features |= ndCpuAvx2;
+	}
+
+	// avx512 f and dq, plus opmask and upper zmm state enabled
+	const ndUnsigned32 avx512Mask = (1 << 16) | (1 << 17);
+	if (((ebx7 & avx512Mask) == avx512Mask) && ((xcr0 & 0xe6) == 0xe6))
+	{
+		features |= ndCpuAvx512;
+	}
+	return features;
+}
+#else
+static ndUnsigned32 ndQueryCpuSimdFeatures()
+{
+	return 0;
+}
+#endif
+
+ndUnsigned32 ndGetCpuSimdFeatures()
+{
+	static ndUnsigned32 features = ndQueryCpuSimdFeatures();
+	return features;
+}
+
 class ndSortCluster
 {
 	public:
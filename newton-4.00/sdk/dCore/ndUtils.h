@@ -209,6 +209,17 @@ inline void strtolwr(char* const string)
 /// Returns the time in micro seconds since application started 
 D_CORE_API ndUnsigned64 ndGetTimeInMicroseconds();
 
+/// simd instruction sets reported by the cpu and enabled by the operating system
+enum ndCpuSimdFeatures
+{
+	ndCpuSse3 = 1 << 0,
+	ndCpuAvx2 = 1 << 1,
+	ndCpuAvx512 = 1 << 2,
+};
+
+/// Returns a mask of ndCpuSimdFeatures, queried with cpuid once per process 
+D_CORE_API ndUnsigned32 ndGetCpuSimdFeatures();
+
 /// Round a 64 bit float to a 32 bit float by truncating the mantissa to 24 bits 
 /// \param ndFloat64 val: 64 bit float 
 /// \return a 64 bit double precision with a 32 bit mantissa
@@ -24,6 +24,11 @@
 
 #include <arm_neon.h>
 
+// aarch64 adds horizontal reductions, division, square root and rounding
+#if defined(__aarch64__) || defined(__ARM_ARCH_ISA_A64)
+	#define D_NEON_A64
+#endif
+
 D_MSV_NEWTON_ALIGN_32
 class ndBigVector
 {
@@ -552,6 +557,11 @@ public:
 	{
 	}
 
+	inline ndVector(const uint32x4_t type)
+		:m_typeInt(type)
+	{
+	}
+
 	inline ndVector(const ndFloat32* const ptr)
 		:m_type(vld1q_f32(ptr))
 	{
@@ -722,23 +732,35 @@ public:
 	inline ndVector MulAdd(const ndVector& A, const ndVector& B) const
 	{
 		//return *this + A * B;
-		return vmlaq_f32(m_type, A.m_type, B.m_type);
+		#ifdef D_NEON_A64
+			return vfmaq_f32(m_type, A.m_type, B.m_type);
+		#else
+			return vmlaq_f32(m_type, A.m_type, B.m_type);
+		#endif
 	}
 
 	inline ndVector MulSub(const ndVector& A, const ndVector& B) const
 	{
 		//return *this - A * B;
-		return vmlsq_f32(m_type, A.m_type, B.m_type);
+		#ifdef D_NEON_A64
+			return vfmsq_f32(m_type, A.m_type, B.m_type);
+		#else
+			return vmlsq_f32(m_type, A.m_type, B.m_type);
+		#endif
 	}
 
 	inline ndVector AddHorizontal() const
 	{
-		return ndVector(m_x + m_y + m_z + m_w);
+		#ifdef D_NEON_A64
+			return vdupq_n_f32(vaddvq_f32(m_type));
+		#else
+			return ndVector(m_x + m_y + m_z + m_w);
+		#endif
 	}
 
 	inline ndVector Scale(ndFloat32 scale) const
 	{
-		return ndVector(m_x * scale, m_y * scale, m_z * scale, m_w * scale);
+		return vmulq_n_f32(m_type, scale);
 	}
 
 	// return cross product
@@ -809,7 +831,11 @@ public:
 
 	inline ndVector Floor() const
 	{
-		return ndVector(ndFloor(m_x), ndFloor(m_y), ndFloor(m_z), ndFloor(m_w));
+		#ifdef D_NEON_A64
+			return vrndmq_f32(m_type);
+		#else
+			return ndVector(ndFloor(m_x), ndFloor(m_y), ndFloor(m_z), ndFloor(m_w));
+		#endif
 	}
 
 	inline ndVector DotProduct(const ndVector& A) const
@@ -820,17 +846,29 @@ public:
 
 	inline ndVector Divide(const ndVector& denominator) const
 	{
-		return ndVector(m_x / denominator.m_x, m_y / denominator.m_y, m_z / denominator.m_z, m_w / denominator.m_w);
+		#ifdef D_NEON_A64
+			return vdivq_f32(m_type, denominator.m_type);
+		#else
+			return ndVector(m_x / denominator.m_x, m_y / denominator.m_y, m_z / denominator.m_z, m_w / denominator.m_w);
+		#endif
 	}
 
 	inline ndVector Reciproc() const
 	{
-		return ndVector(ndFloat32(1.0f) / m_x, ndFloat32(1.0f) / m_y, ndFloat32(1.0f) / m_z, ndFloat32(1.0f) / m_w);
+		#ifdef D_NEON_A64
+			return vdivq_f32(vdupq_n_f32(ndFloat32(1.0f)), m_type);
+		#else
+			return ndVector(ndFloat32(1.0f) / m_x, ndFloat32(1.0f) / m_y, ndFloat32(1.0f) / m_z, ndFloat32(1.0f) / m_w);
+		#endif
 	}
 
 	inline ndVector Sqrt() const
 	{
-		return ndVector(ndSqrt(m_x), ndSqrt(m_y), ndSqrt(m_z), ndSqrt(m_w));
+		#ifdef D_NEON_A64
+			return vsqrtq_f32(m_type);
+		#else
+			return ndVector(ndSqrt(m_x), ndSqrt(m_y), ndSqrt(m_z), ndSqrt(m_w));
+		#endif
 	}
 
 	inline ndVector InvSqrt() const
@@ -856,7 +894,11 @@ public:
 
 	inline ndVector GetMax() const
 	{
-		return ndVector(ndMax(ndMax(m_x, m_y), ndMax(m_z, m_w)));
+		#ifdef D_NEON_A64
+			return vdupq_n_f32(vmaxvq_f32(m_type));
+		#else
+			return ndVector(ndMax(ndMax(m_x, m_y), ndMax(m_z, m_w)));
+		#endif
 	}
 
 	inline ndVector GetMax(const ndVector& data) const
@@ -869,30 +911,30 @@ public:
 		return vminq_f32(m_type, data.m_type);
 	}
 
-	// relational operators
+	// relational operators, the compares are on the float lanes and return all bits masks
 	inline ndVector operator== (const ndVector& data) const
 	{
-		return vceqq_f32(m_typeInt, data.m_typeInt);
+		return vceqq_f32(m_type, data.m_type);
 	}
 
 	inline ndVector operator> (const ndVector& data) const
 	{
-		return vcgtq_f32(m_typeInt, data.m_typeInt);
+		return vcgtq_f32(m_type, data.m_type);
 	}
 
 	inline ndVector operator< (const ndVector& data) const
 	{
-		return vcltq_f32(m_typeInt, data.m_typeInt);
+		return vcltq_f32(m_type, data.m_type);
 	}
 
 	inline ndVector operator>= (const ndVector& data) const
 	{
-		return vcgeq_f32(m_typeInt, data.m_typeInt);
+		return vcgeq_f32(m_type, data.m_type);
 	}
 
 	inline ndVector operator<= (const ndVector& data) const
 	{
-		return vcleq_f32(m_typeInt, data.m_typeInt);
+		return vcleq_f32(m_type, data.m_type);
 	}
 
 	// logical operations
@@ -918,8 +960,8 @@ public:
 
 	inline ndVector Select(const ndVector& data, const ndVector& mask) const
 	{
-		// (((b ^ a) & mask)^a)
-		return  (*this) ^ (mask & (data ^ (*this)));
+		// bit select, take data where the mask is set
+		return vbslq_f32(mask.m_typeInt, data.m_type, m_type);
 	}
 
 	inline ndInt32 GetSignMask() const
@@ -930,7 +972,7 @@ public:
 
 	inline ndVector ShiftRight() const
 	{
-		return ndVector(m_w, m_x, m_y, m_z);
+		return vextq_f32(m_type, m_type, 3);
 	}
 
 	inline ndVector ShiftTripleRight() const
@@ -945,7 +987,7 @@ public:
 
 	inline ndVector ShiftRightLogical(ndInt32 bits) const
 	{
-		return ndVector(ndInt32(ndUnsigned32(m_ix) >> bits), ndInt32(ndUnsigned32(m_iy) >> bits), ndInt32(ndUnsigned32(m_iz) >> bits), ndInt32(ndUnsigned32(m_iw) >> bits));
+		return vshlq_u32(m_typeInt, vdupq_n_s32(-bits));
 	}
 
 	inline ndVector OptimizedVectorUnrotate(const ndVector& front, const ndVector& up, const ndVector& right) const
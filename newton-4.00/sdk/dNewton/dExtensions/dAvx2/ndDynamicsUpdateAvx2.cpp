@@ -24,6 +24,15 @@
 #define D_AVX_WORK_GROUP			8 
 #define D_AVX_DEFAULT_BUFFER_SIZE	1024
 
+// the library is built for plain sse, only the code below is compiled for 
+// avx2. It runs after the cpuid check, and nothing in it runs at load time.
+#if defined(__clang__)
+	#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+	#pragma GCC push_options
+	#pragma GCC target("avx2,fma")
+#endif
+
 #ifdef D_NEWTON_USE_DOUBLE
 	D_MSV_NEWTON_ALIGN_32
 	class ndAvxFloat
@@ -252,11 +261,6 @@
 			ndJacobian m_vector8;
 			ndInt64 m_int[D_AVX_WORK_GROUP];
 		};
-
-		static ndAvxFloat m_one;
-		static ndAvxFloat m_zero;
-		static ndAvxFloat m_mask;
-		static ndAvxFloat m_ordinals;
 	} D_GCC_NEWTON_ALIGN_32;
 
 #else
@@ -470,18 +474,14 @@
 			ndJacobian m_vector8;
 			ndInt32 m_int[D_AVX_WORK_GROUP];
 		};
-
-		static ndAvxFloat m_one;
-		static ndAvxFloat m_zero;
-		static ndAvxFloat m_mask;
-		static ndAvxFloat m_ordinals;
 	} D_GCC_NEWTON_ALIGN_32;
 #endif
 
-ndAvxFloat ndAvxFloat::m_one(ndFloat32(1.0f));
-ndAvxFloat ndAvxFloat::m_zero(ndFloat32 (0.0f));
-ndAvxFloat ndAvxFloat::m_ordinals(ndVector(0, 1, 2, 3), ndVector(4, 5, 6, 7));
-ndAvxFloat ndAvxFloat::m_mask(ndVector(-1, -1, -1, -1), ndVector(-1, -1, -1, -1));
+// integer lane indices, used as the base of the friction normal gathers
+static inline ndAvxFloat ndAvxOrdinals()
+{
+	return ndAvxFloat(ndVector(0, 1, 2, 3), ndVector(4, 5, 6, 7));
+}
 
 D_MSV_NEWTON_ALIGN_32
 class ndAvxVector3
@@ -1038,7 +1038,16 @@ void ndDynamicsUpdateAvx2::GetJacobianDerivatives(ndConstraint* const joint)
 	constraintParam.m_rowsCount = 0;
 	constraintParam.m_timestep = m_timestep;
 	constraintParam.m_invTimestep = m_invTimestep;
-	joint->JacobianDerivative(constraintParam);
+	ndJointBilateralConstraint* const bilateralJoint = joint->GetAsBilateral();
+	if (bilateralJoint)
+	{
+		// resting joints may reuse the rows of the last sub step
+		bilateralJoint->CachedJacobianDerivative(constraintParam);
+	}
+	else
+	{
+		joint->JacobianDerivative(constraintParam);
+	}
 	const ndInt32 dof = constraintParam.m_rowsCount;
 	ndAssert(dof <= joint->m_rowCount);
 
@@ -1126,12 +1135,14 @@ void ndDynamicsUpdateAvx2::InitJacobianMatrix()
 	ndBodyKinematic** const bodyArray = &scene->GetActiveBodyArray()[0];
 	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
+	const ndFloat32 warmStart = scene->GetContactWarmStart();
+
 	ndAtomic<ndInt32> iterator(0);
-	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &iterator, &jointArray](ndInt32, ndInt32)
+	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &iterator, &jointArray, warmStart](ndInt32, ndInt32)
 	{
 		D_TRACKTIME_NAMED(InitJacobianMatrix);
 		ndAvxFloat* const internalForces = (ndAvxFloat*)&GetTempInternalForces()[0];
-		auto BuildJacobianMatrix = [this, &internalForces](ndConstraint* const joint, ndInt32 jointIndex)
+		auto BuildJacobianMatrix = [this, &internalForces, warmStart](ndConstraint* const joint, ndInt32 jointIndex)
 		{
 			ndAssert(joint->GetBody0());
 			ndAssert(joint->GetBody1());
@@ -1151,8 +1162,8 @@ void ndDynamicsUpdateAvx2::InitJacobianMatrix()
 			const ndVector invMass0(body0->m_invMass[3]);
 			const ndVector invMass1(body1->m_invMass[3]);
 
-			ndAvxFloat forceAcc0(ndAvxFloat::m_zero);
-			ndAvxFloat forceAcc1(ndAvxFloat::m_zero);
+			ndAvxFloat forceAcc0(ndFloat32(0.0f));
+			ndAvxFloat forceAcc1(ndFloat32(0.0f));
 			const ndAvxFloat weigh0(body0->m_weigh);
 			const ndAvxFloat weigh1(body1->m_weigh);
 
@@ -1177,7 +1188,7 @@ void ndDynamicsUpdateAvx2::InitJacobianMatrix()
 				ndAssert(rhs->m_jointFeebackForce);
 				const ndFloat32 force = rhs->m_jointFeebackForce->GetInitialGuess();
 
-				rhs->m_force = isBilateral ? ndClamp(force, rhs->m_lowerBoundFrictionCoefficent, rhs->m_upperBoundFrictionCoefficent) : force;
+				rhs->m_force = isBilateral ? ndClamp(force, rhs->m_lowerBoundFrictionCoefficent, rhs->m_upperBoundFrictionCoefficent) : force * warmStart;
 				rhs->m_maxImpact = ndFloat32(0.0f);
 
 				const ndAvxFloat& JtM0 = (ndAvxFloat&)row->m_Jt.m_jacobianM0;
@@ -1269,8 +1280,8 @@ void ndDynamicsUpdateAvx2::InitJacobianMatrix()
 		const ndRightHandSide* const rightHandSide = &GetRightHandSide()[0];
 		ndAvxMatrixArray& massMatrix = *m_avxMassMatrixArray;
 
-		const ndAvxFloat zero(ndAvxFloat::m_zero);
-		const ndAvxFloat ordinals(ndAvxFloat::m_ordinals);
+		const ndAvxFloat zero(ndFloat32(0.0f));
+		const ndAvxFloat ordinals(ndAvxOrdinals());
 		const ndInt32 mask = -ndInt32(D_AVX_WORK_GROUP);
 		const ndInt32 soaJointCount = ((jointCount + D_AVX_WORK_GROUP - 1) & mask) / D_AVX_WORK_GROUP;
 
@@ -1621,13 +1632,14 @@ void ndDynamicsUpdateAvx2::InitSkeletons()
 		for (ndInt32 i = iterator++; i < count; i = iterator++)
 		{
 			ndSkeletonContainer* const skeleton = activeSkeletons[i];
-			skeleton->InitMassMatrix(&leftHandSide[0], &rightHandSide[0]);
+			skeleton->InitMassMatrix(&leftHandSide[0], &rightHandSide[0], true);
 		}
 	});
 
 	if (activeSkeletons.GetCount())
 	{
 		scene->ParallelExecute(InitSkeletons);
+		InitLargeLoopSkeletons();
 	}
 }
 
@@ -1823,7 +1835,8 @@ void ndDynamicsUpdateAvx2::CalculateJointsForce()
 	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
 	ndAtomic<ndInt32> iterator0(0);
-	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &iterator0, &jointArray](ndInt32, ndInt32)
+	ndFloat32 residualArray[D_MAX_THREADS_COUNT];
+	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &iterator0, &jointArray, &residualArray](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(CalculateJointsForce);
 		const ndInt32 jointCount = ndInt32 (jointArray.GetCount());
@@ -2038,7 +2051,7 @@ void ndDynamicsUpdateAvx2::CalculateJointsForce()
 				}
 			}
 
-			ndAvxFloat mask(ndAvxFloat::m_mask);
+			ndAvxFloat mask(ndInt32(-1));
 			for (ndInt32 i = 0; i < D_AVX_WORK_GROUP; ++i)
 			{
 				const ndConstraint* const joint = jointGroup[i];
@@ -2055,6 +2068,7 @@ void ndDynamicsUpdateAvx2::CalculateJointsForce()
 					}
 				}
 			}
+			const ndAvxFloat residual(accNorm & mask);
 
 			forceM0.m_linear.m_x = zero;
 			forceM0.m_linear.m_y = zero;
@@ -2182,8 +2196,10 @@ void ndDynamicsUpdateAvx2::CalculateJointsForce()
 					outBody1 = force1[i];
 				}
 			}
+			return residual.GetMax();
 		};
 
+		ndFloat32 residual = ndFloat32(0.0f);
 		const ndInt32 mask = -ndInt32(D_AVX_WORK_GROUP);
 		const ndInt32 soaJointCount = ((jointCount + D_AVX_WORK_GROUP - 1) & mask) / D_AVX_WORK_GROUP;
 		for (ndInt32 i = iterator0.fetch_add(D_WORKER_BATCH_SIZE); i < soaJointCount; i = iterator0.fetch_add(D_WORKER_BATCH_SIZE))
@@ -2192,16 +2208,17 @@ void ndDynamicsUpdateAvx2::CalculateJointsForce()
 			for (ndInt32 j = 0; j < maxSpan; ++j)
 			{
 				const ndInt32 m = i + j;
-				JointForce(m, &soaMassMatrix[soaJointRows[m]]);
+				residual = ndMax(residual, JointForce(m, &soaMassMatrix[soaJointRows[m]]));
 			}
 		}
+		residualArray[threadIndex] = residual;
 	});
 
 	ndAtomic<ndInt32> iterator1(0);
 	auto ApplyJacobianAccumulatePartialForces = ndMakeObject::ndFunction([this, &iterator1, &bodyArray](ndInt32, ndInt32)
 	{
 		D_TRACKTIME_NAMED(ApplyJacobianAccumulatePartialForces);
-		const ndAvxFloat zero(ndAvxFloat::m_zero);
+		const ndAvxFloat zero(ndFloat32(0.0f));
 		const ndInt32* const bodyIndex = &GetJointForceIndexBuffer()[0];
 		ndAvxFloat* const internalForces = (ndAvxFloat*)&GetInternalForces()[0];
 		const ndAvxFloat* const jointInternalForces = (ndAvxFloat*)&GetTempInternalForces()[0];
@@ -2231,12 +2248,24 @@ void ndDynamicsUpdateAvx2::CalculateJointsForce()
 		}
 	});
 
-	for (ndInt32 i = 0; i < ndInt32(passes); ++i)
+	AddSolverPassBudget(ndInt32(passes));
+	const ndInt32 threadCount = scene->GetThreadCount();
+	for (ndUnsigned32 i = 0; i < passes; ++i)
 	{
 		iterator0 = 0;
 		iterator1 = 0;
 		scene->ParallelExecute(CalculateJointsForce);
 		scene->ParallelExecute(ApplyJacobianAccumulatePartialForces);
+
+		ndFloat32 residual = ndFloat32(0.0f);
+		for (ndInt32 j = 0; j < threadCount; ++j)
+		{
+			residual = ndMax(residual, residualArray[j]);
+		}
+		if (SolverPassConverged(residual))
+		{
+			break;
+		}
 	}
 }
 
@@ -2274,3 +2303,9 @@ void ndDynamicsUpdateAvx2::Update()
 	IntegrateBodies();
 	DetermineSleepStates();
 }
+
+#if defined(__clang__)
+	#pragma clang attribute pop
+#elif defined(__GNUC__)
+	#pragma GCC pop_options
+#endif
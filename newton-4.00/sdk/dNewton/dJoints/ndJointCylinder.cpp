@@ -118,6 +118,7 @@ void ndJointCylinder::SetLimitStateAngle(bool state)
 	{
 		SetLimitsAngle(m_minLimitAngle, m_maxLimitAngle);
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointCylinder::SetLimitsAngle(ndFloat32 minLimit, ndFloat32 maxLimit)
@@ -148,6 +149,7 @@ void ndJointCylinder::SetLimitsAngle(ndFloat32 minLimit, ndFloat32 maxLimit)
 		//m_angle = m_minLimitAngle + deltaAngle;
 		m_angle = m_minLimitAngle;
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointCylinder::GetLimitsAngle(ndFloat32& minLimit, ndFloat32& maxLimit) const
@@ -164,6 +166,7 @@ ndFloat32 ndJointCylinder::GetOffsetAngle() const
 void ndJointCylinder::SetOffsetAngle(ndFloat32 angle)
 {
 	m_offsetAngle = angle;
+	InvalidateJacobianCache();
 }
 
 void ndJointCylinder::SetAsSpringDamperAngle(ndFloat32 regularizer, ndFloat32 spring, ndFloat32 damper)
@@ -171,6 +174,7 @@ void ndJointCylinder::SetAsSpringDamperAngle(ndFloat32 regularizer, ndFloat32 sp
 	m_springKAngle = ndAbs(spring);
 	m_damperCAngle = ndAbs(damper);
 	m_springDamperRegularizerAngle = ndClamp(regularizer, ndFloat32(1.0e-2f), ndFloat32(0.99f));
+	InvalidateJacobianCache();
 }
 
 void ndJointCylinder::GetSpringDamperAngle(ndFloat32& regularizer, ndFloat32& spring, ndFloat32& damper) const
@@ -193,6 +197,7 @@ ndFloat32 ndJointCylinder::GetTargetPosit() const
 void ndJointCylinder::SetTargetPosit(ndFloat32 offset)
 {
 	m_offsetPosit = offset;
+	InvalidateJacobianCache();
 }
 
 bool ndJointCylinder::GetLimitStatePosit() const
@@ -207,6 +212,7 @@ void ndJointCylinder::SetLimitStatePosit(bool state)
 	{
 		SetLimitsPosit(m_minLimitPosit, m_maxLimitPosit);
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointCylinder::SetLimitsPosit(ndFloat32 minLimit, ndFloat32 maxLimit)
@@ -235,6 +241,7 @@ void ndJointCylinder::SetLimitsPosit(ndFloat32 minLimit, ndFloat32 maxLimit)
 	{
 		m_posit = m_minLimitPosit;
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointCylinder::GetLimitsPosit(ndFloat32& minLimit, ndFloat32& maxLimit) const
@@ -248,6 +255,7 @@ void ndJointCylinder::SetAsSpringDamperPosit(ndFloat32 regularizer, ndFloat32 sp
 	m_springKPosit = ndAbs(spring);
 	m_damperCPosit = ndAbs(damper);
 	m_springDamperRegularizerPosit = ndClamp(regularizer, ndFloat32(1.0e-2f), ndFloat32(0.99f));
+	InvalidateJacobianCache();
 }
 
 void ndJointCylinder::GetSpringDamperPosit(ndFloat32& regularizer, ndFloat32& spring, ndFloat32& damper) const
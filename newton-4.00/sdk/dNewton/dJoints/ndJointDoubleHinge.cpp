@@ -60,6 +60,7 @@ void ndJointDoubleHinge::SetLimits0(ndFloat32 minLimit, ndFloat32 maxLimit)
 	ndAssert(maxLimit >= 0.0f);
 	m_axis0.m_minLimit = minLimit;
 	m_axis0.m_maxLimit = maxLimit;
+	InvalidateJacobianCache();
 }
 
 void ndJointDoubleHinge::GetLimits0(ndFloat32& minLimit, ndFloat32& maxLimit)
@@ -76,6 +77,7 @@ ndFloat32 ndJointDoubleHinge::GetOffsetAngle0() const
 void ndJointDoubleHinge::SetOffsetAngle0(ndFloat32 angle)
 {
 	m_axis0.m_offsetAngle = angle;
+	InvalidateJacobianCache();
 }
 
 void ndJointDoubleHinge::SetAsSpringDamper0(ndFloat32 regularizer, ndFloat32 spring, ndFloat32 damper)
@@ -83,6 +85,7 @@ void ndJointDoubleHinge::SetAsSpringDamper0(ndFloat32 regularizer, ndFloat32 spr
 	m_axis0.m_springK = ndAbs(spring);
 	m_axis0.m_damperC = ndAbs(damper);
 	m_axis0.m_springDamperRegularizer = ndClamp(regularizer, ND_SPRING_DAMP_MIN_REG, ndFloat32(0.99f));
+	InvalidateJacobianCache();
 }
 
 void ndJointDoubleHinge::GetSpringDamper0(ndFloat32& regularizer, ndFloat32& spring, ndFloat32& damper) const
@@ -108,6 +111,7 @@ void ndJointDoubleHinge::SetLimits1(ndFloat32 minLimit, ndFloat32 maxLimit)
 	ndAssert(maxLimit >= 0.0f);
 	m_axis1.m_minLimit = minLimit;
 	m_axis1.m_maxLimit = maxLimit;
+	InvalidateJacobianCache();
 }
 
 void ndJointDoubleHinge::GetLimits1(ndFloat32& minLimit, ndFloat32& maxLimit)
@@ -124,6 +128,7 @@ ndFloat32 ndJointDoubleHinge::GetOffsetAngle1() const
 void ndJointDoubleHinge::SetOffsetAngle1(ndFloat32 angle)
 {
 	m_axis1.m_offsetAngle = angle;
+	InvalidateJacobianCache();
 }
 
 void ndJointDoubleHinge::SetAsSpringDamper1(ndFloat32 regularizer, ndFloat32 spring, ndFloat32 damper)
@@ -131,6 +136,7 @@ void ndJointDoubleHinge::SetAsSpringDamper1(ndFloat32 regularizer, ndFloat32 spr
 	m_axis1.m_springK = ndAbs(spring);
 	m_axis1.m_damperC = ndAbs(damper);
 	m_axis1.m_springDamperRegularizer = ndClamp(regularizer, ND_SPRING_DAMP_MIN_REG, ndFloat32(0.99f));
+	InvalidateJacobianCache();
 }
 
 void ndJointDoubleHinge::GetSpringDamper1(ndFloat32& regularizer, ndFloat32& spring, ndFloat32& damper) const
@@ -39,11 +39,13 @@ ndJointDryRollingFriction::~ndJointDryRollingFriction()
 void ndJointDryRollingFriction::SetContactTrail(ndFloat32 trail)
 {
 	m_contactTrail = ndClamp(trail, ndFloat32(0.1f), ndFloat32(1.0f));
+	InvalidateJacobianCache();
 }
 
 void ndJointDryRollingFriction::SetFrictionCoefficient(ndFloat32 friction)
 {
 	m_coefficient = ndClamp(friction, ndFloat32(0.0f), ndFloat32(1.0f));
+	InvalidateJacobianCache();
 }
 
 ndFloat32 ndJointDryRollingFriction::GetContactTrail() const
@@ -46,11 +46,13 @@ void ndJointFix6dof::SetAsSoftJoint(bool)
 {
 	ndAssert(0);
 	//SetSolverModel(mode ? m_secundaryCloseLoop : m_primaryOpenLoop);
+	InvalidateJacobianCache();
 }
 
 void ndJointFix6dof::SetRegularizer(ndFloat32 regularizer)
 {
 	m_softness = ndClamp(regularizer, ndFloat32(0.0f), ndFloat32(1.0f));
+	InvalidateJacobianCache();
 }
 
 ndFloat32 ndJointFix6dof::GetRegularizer() const
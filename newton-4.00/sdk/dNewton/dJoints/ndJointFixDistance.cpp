@@ -43,6 +43,7 @@ ndFloat32 ndJointFixDistance::GetDistance() const
 void ndJointFixDistance::SetDistance(ndFloat32 dist)
 {
 	m_distance = dist;
+	InvalidateJacobianCache();
 }
 
 void ndJointFixDistance::JacobianDerivative(ndConstraintDescritor& desc)
@@ -55,6 +55,7 @@ ndFloat32 ndJointGear::GetRatio() const
 void ndJointGear::SetRatio(ndFloat32 ratio)
 {
 	m_gearRatio = ratio;
+	InvalidateJacobianCache();
 }
 
 void ndJointGear::JacobianDerivative(ndConstraintDescritor& desc)
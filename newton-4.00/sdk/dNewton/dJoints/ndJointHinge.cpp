@@ -88,6 +88,7 @@ void ndJointHinge::SetLimitState(bool state)
 	{
 		SetLimits(m_minLimit, m_maxLimit);
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointHinge::SetLimits(ndFloat32 minLimit, ndFloat32 maxLimit)
@@ -117,6 +118,7 @@ void ndJointHinge::SetLimits(ndFloat32 minLimit, ndFloat32 maxLimit)
 		//m_angle = m_minLimit + deltaAngle;
 		m_angle = m_minLimit;
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointHinge::GetLimits(ndFloat32& minLimit, ndFloat32& maxLimit) const
@@ -133,6 +135,7 @@ ndFloat32 ndJointHinge::GetTargetAngle() const
 void ndJointHinge::SetTargetAngle(ndFloat32 angle)
 {
 	m_targetAngle = angle;
+	InvalidateJacobianCache();
 }
 
 void ndJointHinge::SetAsSpringDamper(ndFloat32 regularizer, ndFloat32 spring, ndFloat32 damper)
@@ -140,6 +143,7 @@ void ndJointHinge::SetAsSpringDamper(ndFloat32 regularizer, ndFloat32 spring, nd
 	m_springK = ndAbs(spring);
 	m_damperC = ndAbs(damper);
 	m_springDamperRegularizer = ndClamp(regularizer, ND_SPRING_DAMP_MIN_REG, ndFloat32(0.99f));
+	InvalidateJacobianCache();
 }
 
 void ndJointHinge::GetSpringDamper(ndFloat32& regularizer, ndFloat32& spring, ndFloat32& damper) const
@@ -208,6 +212,11 @@ void ndJointHinge::ApplyBaseRows(ndConstraintDescritor& desc, const ndMatrix& ma
 	const ndFloat32 angle1 = CalculateAngle(matrix0.m_front, matrix1.m_front, matrix1.m_right);
 	AddAngularRowJacobian(desc, matrix1.m_right, angle1);
 
+	UpdateAngle(matrix0, matrix1);
+}
+
+void ndJointHinge::UpdateAngle(const ndMatrix& matrix0, const ndMatrix& matrix1)
+{
 	// save the current joint Omega
 	const ndVector omega0(m_body0->GetOmega());
 	const ndVector omega1(m_body1->GetOmega());
@@ -218,6 +227,14 @@ void ndJointHinge::ApplyBaseRows(ndConstraintDescritor& desc, const ndMatrix& ma
 	m_omega = matrix1.m_front.DotProduct(omega0 - omega1).GetScalar();
 }
 
+void ndJointHinge::UpdateJointState()
+{
+	ndMatrix matrix0;
+	ndMatrix matrix1;
+	CalculateGlobalMatrix(matrix0, matrix1);
+	UpdateAngle(matrix0, matrix1);
+}
+
 ndFloat32 ndJointHinge::PenetrationOmega(ndFloat32 penetration) const
 {
 	ndFloat32 param = ndClamp(penetration, ndFloat32(0.0f), D_MAX_HINGE_PENETRATION) / D_MAX_HINGE_PENETRATION;
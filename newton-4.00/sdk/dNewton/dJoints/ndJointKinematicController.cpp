@@ -283,32 +283,38 @@ void ndJointKinematicController::CheckSleep() const
 void ndJointKinematicController::SetControlMode(ndControlModes mode)
 {
 	m_controlMode = mode;
+	InvalidateJacobianCache();
 }
 
 void ndJointKinematicController::SetMaxSpeed(ndFloat32 speedInMetersPerSeconds)
 {
 	m_maxSpeed = ndAbs(speedInMetersPerSeconds);
+	InvalidateJacobianCache();
 }
 
 void ndJointKinematicController::SetMaxLinearFriction(ndFloat32 frictionForce)
 {
 	m_maxLinearFriction = ndAbs(frictionForce);
+	InvalidateJacobianCache();
 }
 
 void ndJointKinematicController::SetMaxAngularFriction(ndFloat32 frictionTorque)
 {
 	m_maxAngularFriction = ndAbs(frictionTorque);
+	InvalidateJacobianCache();
 }
 
 void ndJointKinematicController::SetMaxOmega(ndFloat32 speedInRadiansPerSeconds)
 {
 	m_maxOmega = ndAbs(speedInRadiansPerSeconds);
+	InvalidateJacobianCache();
 }
 
 void ndJointKinematicController::SetAngularViscousFrictionCoefficient(ndFloat32 coefficient)
 {
 	ndVector mass(GetBody0()->GetMassMatrix());
 	m_angularFrictionCoefficient = ndAbs(coefficient) * ndMax(mass.m_x, ndMax(mass.m_y, mass.m_z));
+	InvalidateJacobianCache();
 }
 
 void ndJointKinematicController::SetTargetPosit(const ndVector& posit)
@@ -375,6 +381,7 @@ void ndJointKinematicController::SetTargetMatrix(const ndMatrix& matrix)
 	m_localMatrix1 = matrix;
 	m_localMatrix1.m_posit = posit;
 	CheckSleep();
+	InvalidateJacobianCache();
 }
 
 void ndJointKinematicController::JacobianDerivative(ndConstraintDescritor& desc)
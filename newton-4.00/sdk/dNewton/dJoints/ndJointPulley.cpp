@@ -55,6 +55,7 @@ ndFloat32 ndJointPulley::GetRatio() const
 void ndJointPulley::SetRatio(ndFloat32 ratio)
 {
 	m_gearRatio = ratio;
+	InvalidateJacobianCache();
 }
 
 void ndJointPulley::JacobianDerivative(ndConstraintDescritor& desc)
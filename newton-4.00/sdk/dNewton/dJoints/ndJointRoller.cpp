@@ -118,6 +118,7 @@ void ndJointRoller::SetLimitStateAngle(bool state)
 	{
 		SetLimitsAngle(m_minLimitAngle, m_maxLimitAngle);
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointRoller::SetLimitsAngle(ndFloat32 minLimit, ndFloat32 maxLimit)
@@ -150,6 +151,7 @@ void ndJointRoller::SetLimitsAngle(ndFloat32 minLimit, ndFloat32 maxLimit)
 		//m_angle = m_minLimitAngle + deltaAngle;
 		m_angle = m_minLimitAngle;
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointRoller::GetLimitsAngle(ndFloat32& minLimit, ndFloat32& maxLimit) const
@@ -166,6 +168,7 @@ ndFloat32 ndJointRoller::GetOffsetAngle() const
 void ndJointRoller::SetOffsetAngle(ndFloat32 angle)
 {
 	m_offsetAngle = angle;
+	InvalidateJacobianCache();
 }
 
 void ndJointRoller::SetAsSpringDamperAngle(ndFloat32 regularizer, ndFloat32 spring, ndFloat32 damper)
@@ -173,6 +176,7 @@ void ndJointRoller::SetAsSpringDamperAngle(ndFloat32 regularizer, ndFloat32 spri
 	m_springKAngle = ndAbs(spring);
 	m_damperCAngle = ndAbs(damper);
 	m_springDamperRegularizerAngle = ndClamp(regularizer, ndFloat32(1.0e-2f), ndFloat32(0.99f));
+	InvalidateJacobianCache();
 }
 
 void ndJointRoller::GetSpringDamperAngle(ndFloat32& regularizer, ndFloat32& spring, ndFloat32& damper) const
@@ -195,6 +199,7 @@ ndFloat32 ndJointRoller::GetTargetPosit() const
 void ndJointRoller::SetTargetPosit(ndFloat32 offset)
 {
 	m_offsetPosit = offset;
+	InvalidateJacobianCache();
 }
 
 bool ndJointRoller::GetLimitStatePosit() const
@@ -209,6 +214,7 @@ void ndJointRoller::SetLimitStatePosit(bool state)
 	{
 		SetLimitsPosit(m_minLimitPosit, m_maxLimitPosit);
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointRoller::SetLimitsPosit(ndFloat32 minLimit, ndFloat32 maxLimit)
@@ -236,6 +242,7 @@ void ndJointRoller::SetLimitsPosit(ndFloat32 minLimit, ndFloat32 maxLimit)
 	{
 		m_posit = m_minLimitPosit;
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointRoller::GetLimitsPosit(ndFloat32& minLimit, ndFloat32& maxLimit) const
@@ -249,6 +256,7 @@ void ndJointRoller::SetAsSpringDamperPosit(ndFloat32 regularizer, ndFloat32 spri
 	m_springKPosit = ndAbs(spring);
 	m_damperCPosit = ndAbs(damper);
 	m_springDamperRegularizerPosit = ndClamp(regularizer, ndFloat32(1.0e-2f), ndFloat32(0.99f));
+	InvalidateJacobianCache();
 }
 
 void ndJointRoller::GetSpringDamperPosit(ndFloat32& regularizer, ndFloat32& spring, ndFloat32& damper) const
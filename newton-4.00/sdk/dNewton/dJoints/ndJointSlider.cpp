@@ -84,6 +84,7 @@ ndFloat32 ndJointSlider::GetTargetPosit() const
 void ndJointSlider::SetTargetPosit(ndFloat32 offset)
 {
 	m_positOffset = offset;
+	InvalidateJacobianCache();
 }
 
 bool ndJointSlider::GetLimitState() const
@@ -98,6 +99,7 @@ void ndJointSlider::SetLimitState(bool state)
 	{
 		SetLimits(m_minLimit, m_maxLimit);
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointSlider::SetLimits(ndFloat32 minLimit, ndFloat32 maxLimit)
@@ -123,6 +125,7 @@ void ndJointSlider::SetLimits(ndFloat32 minLimit, ndFloat32 maxLimit)
 	{
 		m_posit = m_minLimit;
 	}
+	InvalidateJacobianCache();
 }
 
 void ndJointSlider::GetLimits(ndFloat32& minLimit, ndFloat32& maxLimit) const
@@ -136,6 +139,7 @@ void ndJointSlider::SetAsSpringDamper(ndFloat32 regularizer, ndFloat32 spring, n
 	m_springK = ndAbs(spring);
 	m_damperC = ndAbs(damper);
 	m_springDamperRegularizer = ndClamp(regularizer, ND_SPRING_DAMP_MIN_REG, ndFloat32(0.99f));
+	InvalidateJacobianCache();
 }
 
 void ndJointSlider::GetSpringDamper(ndFloat32& regularizer, ndFloat32& spring, ndFloat32& damper) const
@@ -234,19 +238,34 @@ void ndJointSlider::SubmitSpringDamper(ndConstraintDescritor& desc, const ndMatr
 	SetMassSpringDamperAcceleration(desc, m_springDamperRegularizer, m_springK, m_damperC);
 }
 
-void ndJointSlider::ApplyBaseRows(ndConstraintDescritor& desc, const ndMatrix& matrix0, const ndMatrix& matrix1)
+void ndJointSlider::UpdatePosit(const ndMatrix& matrix0, const ndMatrix& matrix1)
 {
 	const ndVector veloc0(m_body0->GetVelocityAtPoint(matrix0.m_posit));
 	const ndVector veloc1(m_body1->GetVelocityAtPoint(matrix1.m_posit));
 
+	const ndVector prel(matrix0.m_posit - matrix1.m_posit);
+	const ndVector vrel(veloc0 - veloc1);
+
+	m_speed = vrel.DotProduct(matrix1.m_front).GetScalar();
+	m_posit = prel.DotProduct(matrix1.m_front).GetScalar();
+}
+
+void ndJointSlider::UpdateJointState()
+{
+	ndMatrix matrix0;
+	ndMatrix matrix1;
+	CalculateGlobalMatrix(matrix0, matrix1);
+	UpdatePosit(matrix0, matrix1);
+}
+
+void ndJointSlider::ApplyBaseRows(ndConstraintDescritor& desc, const ndMatrix& matrix0, const ndMatrix& matrix1)
+{
 	const ndVector& pin = matrix1[0];
 	const ndVector& p0 = matrix0.m_posit;
 	const ndVector& p1 = matrix1.m_posit;
 	const ndVector prel(p0 - p1);
-	const ndVector vrel(veloc0 - veloc1);
 
-	m_speed = vrel.DotProduct(matrix1.m_front).GetScalar();
-	m_posit = prel.DotProduct(matrix1.m_front).GetScalar();
+	UpdatePosit(matrix0, matrix1);
 	const ndVector projectedPoint = p1 + pin.Scale(pin.DotProduct(prel).GetScalar());
 
 	AddLinearRowJacobian(desc, p0, projectedPoint, matrix1[1]);
@@ -46,6 +46,8 @@ class ndJointSlider: public ndJointBilateralConstraint
 	D_NEWTON_API void JacobianDerivative(ndConstraintDescritor& desc);
 	D_NEWTON_API ndInt32 GetKinematicState(ndKinematicState* const state) const;
 	D_NEWTON_API void ApplyBaseRows(ndConstraintDescritor& desc, const ndMatrix& matrix0, const ndMatrix& matrix1);
+	D_NEWTON_API void UpdateJointState();
+	D_NEWTON_API void UpdatePosit(const ndMatrix& matrix0, const ndMatrix& matrix1);
 	
 	ndFloat32 m_posit;
 	ndFloat32 m_speed;
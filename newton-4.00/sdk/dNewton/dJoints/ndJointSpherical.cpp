@@ -57,6 +57,7 @@ ndMatrix ndJointSpherical::GetOffsetRotation() const
 void ndJointSpherical::SetOffsetRotation(const ndMatrix& rotation)
 {
 	m_rotation = rotation;
+	InvalidateJacobianCache();
 }
 
 void ndJointSpherical::SetAsSpringDamper(ndFloat32 regularizer, ndFloat32 spring, ndFloat32 damper)
@@ -64,6 +65,7 @@ void ndJointSpherical::SetAsSpringDamper(ndFloat32 regularizer, ndFloat32 spring
 	m_springK = ndAbs(spring);
 	m_damperC = ndAbs(damper);
 	m_springDamperRegularizer = ndClamp(regularizer, ndFloat32(1.0e-3f), ndFloat32(0.99f));
+	InvalidateJacobianCache();
 }
 
 void ndJointSpherical::GetSpringDamper(ndFloat32& regularizer, ndFloat32& spring, ndFloat32& damper) const
@@ -77,6 +79,7 @@ void ndJointSpherical::SetTwistLimits(ndFloat32 minAngle, ndFloat32 maxAngle)
 {
 	m_minTwistAngle = ndMin(minAngle, ndFloat32 (0.0f));
 	m_maxTwistAngle = ndMax(maxAngle, ndFloat32(0.0f));
+	InvalidateJacobianCache();
 }
 
 void ndJointSpherical::GetTwistLimits(ndFloat32& minAngle, ndFloat32& maxAngle) const
@@ -94,6 +97,7 @@ void ndJointSpherical::SetConeLimit(ndFloat32 maxConeAngle)
 {
 	//m_maxConeAngle = ndClamp (maxConeAngle, ndFloat32 (0.0f), D_BALL_AND_SOCKED_MAX_ANGLE);
 	m_maxConeAngle = ndClamp(maxConeAngle, ndFloat32(0.0f), ndFloat32(1.0e10f));
+	InvalidateJacobianCache();
 }
 
 void ndJointSpherical::DebugJoint(ndConstraintDebugCallback& debugCallback) const
@@ -36,6 +36,7 @@ ndJointUpVector::~ndJointUpVector()
 void ndJointUpVector::SetPinDir (const ndVector& pin)
 {
 	m_localMatrix1 = ndGramSchmidtMatrix(pin);
+	InvalidateJacobianCache();
 }
 
 void ndJointUpVector::JacobianDerivative(ndConstraintDescritor& desc)
@@ -56,6 +56,7 @@ const ndWheelDescriptor& ndJointWheel::GetInfo() const
 void ndJointWheel::SetInfo(const ndWheelDescriptor& info)
 {
 	m_info = info;
+	InvalidateJacobianCache();
 }
 
 ndFloat32 ndJointWheel::GetPosit() const
@@ -86,16 +87,19 @@ ndFloat32 ndJointWheel::GetHandBreak() const
 void ndJointWheel::SetBreak(ndFloat32 normalizedBrake)
 {
 	m_normalizedBrake = ndClamp (normalizedBrake, ndFloat32 (0.0f), ndFloat32 (1.0f));
+	InvalidateJacobianCache();
 }
 
 void ndJointWheel::SetHandBreak(ndFloat32 normalizedBrake)
 {
 	m_normalizedHandBrake = ndClamp(normalizedBrake, ndFloat32(0.0f), ndFloat32(1.0f));
+	InvalidateJacobianCache();
 }
 
 void ndJointWheel::SetSteering(ndFloat32 normalidedSteering)
 {
 	m_normalidedSteering = ndClamp(normalidedSteering, ndFloat32(-1.0f), ndFloat32(1.0f));
+	InvalidateJacobianCache();
 }
 
 void ndJointWheel::UpdateTireSteeringAngleMatrix()
@@ -66,6 +66,10 @@ void ndBodyDynamic::SetForce(const ndVector& force)
 		ndAssert(deltaAccel.m_w == ndFloat32(0.0f));
 		ndFloat32 deltaAccel2 = deltaAccel.DotProduct(deltaAccel).GetScalar();
 		m_equilibrium = ndUnsigned8(deltaAccel2 < D_ERR_TOLERANCE2);
+		if (!m_equilibrium && m_islandSleep)
+		{
+			WakeIsland();
+		}
 	}
 }
 
@@ -83,6 +87,10 @@ void ndBodyDynamic::SetTorque(const ndVector& torque)
 		ndAssert(deltaAlpha.m_w == ndFloat32(0.0f));
 		ndFloat32 deltaAlpha2 = deltaAlpha.DotProduct(deltaAlpha).GetScalar();
 		m_equilibrium = ndUnsigned8(deltaAlpha2 < D_ERR_TOLERANCE2);
+		if (!m_equilibrium && m_islandSleep)
+		{
+			WakeIsland();
+		}
 	}
 }
 
@@ -157,7 +165,7 @@ void ndBodyDynamic::AddImpulse(const ndVector& pointDeltaVeloc, const ndVector&
 		m_impulseTorque += globalContact.CrossProduct(m_impulseForce);
 
 		m_equilibrium = false;
-		//Unfreeze();
+		WakeIsland();
 	}
 }
 
@@ -174,6 +182,7 @@ void ndBodyDynamic::ApplyImpulsePair(const ndVector& linearImpulseIn, const ndVe
 		m_impulseTorque += angularImpulse.Scale(1.0f / timestep);
 
 		m_equilibrium = false;
+		WakeIsland();
 	}
 }
 
@@ -203,6 +212,7 @@ void ndBodyDynamic::ApplyImpulsesAtPoint(ndInt32 count, const ndVector* const im
 		m_impulseTorque += angularImpulse.Scale(1.0f / timestep);
 
 		m_equilibrium = false;
+		WakeIsland();
 	}
 }
 
@@ -364,16 +374,20 @@ void ndBodyDynamic::EvaluateSleepState(ndFloat32 freezeSpeed2, ndFloat32 freezeA
 
 		#ifdef _DEBUG
 		ndInt32 checkConnection = 0;
+		// constraints to bodies in a sleeping island are not in the solver
 		for (ndJointList::ndNode* node = m_jointList.GetFirst(); node; node = node->GetNext())
 		{
-			checkConnection += node->GetInfo()->IsActive() ? 1 : 0;
+			const ndJointBilateralConstraint* const joint = node->GetInfo();
+			const bool islandSleep = joint->GetBody0()->GetIslandSleepState() || joint->GetBody1()->GetIslandSleepState();
+			checkConnection += (joint->IsActive() && !islandSleep) ? 1 : 0;
 		}
 
 		ndContactMap::Iterator it(m_contactList);
 		for (it.Begin(); it; it++)
 		{
 			ndContact* const contact = it.GetNode()->GetInfo();
-			if (contact->IsActive() && !contact->IsTestOnly())
+			const bool islandSleep = contact->GetBody0()->GetIslandSleepState() || contact->GetBody1()->GetIslandSleepState();
+			if (contact->IsActive() && !contact->IsTestOnly() && !islandSleep)
 			{
 				checkConnection++;
 			}
@@ -50,6 +50,7 @@ ndDynamicsUpdate::ndDynamicsUpdate(ndWorld* const world)
 	,m_solverPasses(0)
 	,m_activeJointCount(0)
 	,m_unConstrainedBodyCount(0)
+	,m_useBodyState(false)
 {
 }
 
@@ -73,6 +74,14 @@ void ndDynamicsUpdate::Clear()
 	m_tempInternalForces.Resize(D_DEFAULT_BUFFER_SIZE);
 	m_jointForcesIndex.Resize(D_DEFAULT_BUFFER_SIZE);
 	m_jointBodyPairIndexBuffer.Resize(D_DEFAULT_BUFFER_SIZE);
+
+	m_bodyState.m_invInertia.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_bodyState.m_force.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_bodyState.m_torque.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_bodyState.m_invMass.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_bodyState.m_weigh.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_bodyState.m_equilibrium0.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_bodyState.m_jointBodies.Resize(D_DEFAULT_BUFFER_SIZE * 2);
 }
 
 void ndDynamicsUpdate::SortBodyJointScan()
@@ -161,26 +170,25 @@ void ndDynamicsUpdate::SortBodyJointScan()
 	ndArray<ndInt32>& bodyJointIndex = GetJointForceIndexBuffer();
 	const ndInt32 bodyJointIndexCount = ndInt32 (scene->GetActiveBodyArray().GetCount()) + 1;
 	bodyJointIndex.SetCount(bodyJointIndexCount);
-	ndMemSet(&bodyJointIndex[0], 0, bodyJointIndexCount);
 
-	for (ndInt32 i = 0; i < ndInt32 (jointArray.GetCount()); ++i)
+	// the pairs are sorted by body, each entry where the body changes 
+	// is the start of all the bodies from the previous key to this one.
+	const ndInt32 pairCount = ndInt32(bodyJointPairs.GetCount()) - 1;
+	auto SetBodyJointStart = ndMakeObject::ndFunction([&bodyJointPairs, &bodyJointIndex, pairCount, bodyJointIndexCount](ndInt32 threadIndex, ndInt32 threadCount)
 	{
-		const ndConstraint* const joint = jointArray[i];
-		const ndBodyKinematic* const body0 = joint->GetBody0();
-		const ndBodyKinematic* const body1 = joint->GetBody1();
-		const ndInt32 m0 = body0->m_index;
-		const ndInt32 m1 = body1->m_index;
-		bodyJointIndex[m0] ++;
-		bodyJointIndex[m1] ++;
-	}
-
-	ndInt32 bodyJointIndexAcc = 0;
-	for (ndInt32 i = 0; i < bodyJointIndexCount; ++i)
-	{
-		ndInt32 count = bodyJointIndex[i];
-		bodyJointIndex[i] = bodyJointIndexAcc;
-		bodyJointIndexAcc += count;
-	}
+		D_TRACKTIME_NAMED(SetBodyJointStart);
+		const ndStartEnd startEnd(pairCount + 1, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndInt32 body0 = i ? bodyJointPairs[i - 1].m_body + 1 : 0;
+			const ndInt32 body1 = (i < pairCount) ? bodyJointPairs[i].m_body : bodyJointIndexCount - 1;
+			for (ndInt32 j = body0; j <= body1; ++j)
+			{
+				bodyJointIndex[j] = i;
+			}
+		}
+	});
+	scene->ParallelExecute(SetBodyJointStart);
 
 #ifdef _DEBUG
 	const ndArray<ndJointBodyPairIndex>& jointBodyPairIndexBuffer = GetJointBodyPairIndexBuffer();
@@ -250,7 +258,8 @@ void ndDynamicsUpdate::SortJointsScan()
 	for (ndJointList::ndNode* node = jointList.GetFirst(); node; node = node->GetNext())
 	{
 		ndJointBilateralConstraint* const joint = *node->GetInfo();
-		if (joint->IsActive())
+		const ndUnsigned8 islandSleep = ndUnsigned8(joint->GetBody0()->m_islandSleep | joint->GetBody1()->m_islandSleep);
+		if (joint->IsActive() && !islandSleep)
 		{
 			jointArray[jointCount] = joint;
 			jointCount++;
@@ -716,6 +725,53 @@ void ndDynamicsUpdate::InitBodyArray()
 		}
 	});
 	scene->ParallelExecute(InitBodyArray);
+
+	m_useBodyState = m_world->m_bodyStateBuffer;
+	if (m_useBodyState)
+	{
+		BuildBodyState();
+	}
+}
+
+void ndDynamicsUpdate::BuildBodyState()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	const ndInt32 bodyCount = ndInt32(bodyArray.GetCount());
+
+	m_bodyState.m_invInertia.SetCount(bodyCount);
+	m_bodyState.m_force.SetCount(bodyCount);
+	m_bodyState.m_torque.SetCount(bodyCount);
+	m_bodyState.m_invMass.SetCount(bodyCount);
+	m_bodyState.m_weigh.SetCount(bodyCount);
+	m_bodyState.m_equilibrium0.SetCount(bodyCount);
+	m_bodyState.m_jointBodies.SetCount(scene->GetActiveContactArray().GetCount() * 2);
+
+	// gather once, so that the joint loops do not chase body pointers.
+	ndAtomic<ndInt32> iterator(0);
+	auto GatherBodyState = ndMakeObject::ndFunction([this, &iterator, &bodyArray, bodyCount](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(GatherBodyState);
+		ndBodyState& state = m_bodyState;
+		for (ndInt32 i = iterator.fetch_add(D_WORKER_BATCH_SIZE); i < bodyCount; i = iterator.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((bodyCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : bodyCount - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				const ndInt32 index = i + j;
+				ndBodyKinematic* const body = bodyArray[index];
+				ndAssert(body->m_index == index);
+				state.m_invInertia[index] = body->m_invWorldInertiaMatrix;
+				state.m_force[index] = body->GetForce();
+				state.m_torque[index] = body->GetTorque();
+				state.m_invMass[index] = body->m_invMass.m_w;
+				state.m_weigh[index] = body->m_weigh;
+				state.m_equilibrium0[index] = body->m_equilibrium0;
+			}
+		}
+	});
+	scene->ParallelExecute(GatherBodyState);
 }
 
 void ndDynamicsUpdate::GetJacobianDerivatives(ndConstraint* const joint)
@@ -733,7 +789,16 @@ void ndDynamicsUpdate::GetJacobianDerivatives(ndConstraint* const joint)
 	constraintParam.m_rowsCount = 0;
 	constraintParam.m_timestep = m_timestep;
 	constraintParam.m_invTimestep = m_invTimestep;
-	joint->JacobianDerivative(constraintParam);
+	ndJointBilateralConstraint* const bilateralJoint = joint->GetAsBilateral();
+	if (bilateralJoint)
+	{
+		// resting joints may reuse the rows of the last sub step
+		bilateralJoint->CachedJacobianDerivative(constraintParam);
+	}
+	else
+	{
+		joint->JacobianDerivative(constraintParam);
+	}
 	const ndInt32 dof = constraintParam.m_rowsCount;
 	ndAssert(dof <= joint->m_rowCount);
 
@@ -824,29 +889,41 @@ void ndDynamicsUpdate::InitJacobianMatrix()
 	ndBodyKinematic** const bodyArray = &scene->GetActiveBodyArray()[0];
 	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
+	const ndFloat32 warmStart = scene->GetContactWarmStart();
+
 	ndAtomic<ndInt32> iterator(0);
-	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &iterator, &jointArray](ndInt32, ndInt32)
+	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &iterator, &jointArray, warmStart](ndInt32, ndInt32)
 	{
 		D_TRACKTIME_NAMED(InitJacobianMatrix);
 		ndJacobian* const internalForces = &GetTempInternalForces()[0];
-		auto BuildJacobianMatrix = [this, &internalForces](ndConstraint* const joint, ndInt32 jointIndex)
+		auto BuildJacobianMatrix = [this, &internalForces, warmStart](ndConstraint* const joint, ndInt32 jointIndex)
 		{
 			ndAssert(joint->GetBody0());
 			ndAssert(joint->GetBody1());
 			const ndBodyKinematic* const body0 = joint->GetBody0();
 			const ndBodyKinematic* const body1 = joint->GetBody1();
+			const ndInt32 m0 = body0->m_index;
+			const ndInt32 m1 = body1->m_index;
+
+			ndBodyState& state = m_bodyState;
+			const bool useBodyState = m_useBodyState;
+			if (useBodyState)
+			{
+				state.m_jointBodies[jointIndex * 2 + 0] = m0;
+				state.m_jointBodies[jointIndex * 2 + 1] = m1;
+			}
 
-			const ndVector force0(body0->GetForce());
-			const ndVector torque0(body0->GetTorque());
-			const ndVector force1(body1->GetForce());
-			const ndVector torque1(body1->GetTorque());
+			const ndVector force0(useBodyState ? state.m_force[m0] : body0->GetForce());
+			const ndVector torque0(useBodyState ? state.m_torque[m0] : body0->GetTorque());
+			const ndVector force1(useBodyState ? state.m_force[m1] : body1->GetForce());
+			const ndVector torque1(useBodyState ? state.m_torque[m1] : body1->GetTorque());
 
 			const ndInt32 index = joint->m_rowStart;
 			const ndInt32 count = joint->m_rowCount;
-			const ndMatrix& invInertia0 = body0->m_invWorldInertiaMatrix;
-			const ndMatrix& invInertia1 = body1->m_invWorldInertiaMatrix;
-			const ndVector invMass0(body0->m_invMass[3]);
-			const ndVector invMass1(body1->m_invMass[3]);
+			const ndMatrix& invInertia0 = useBodyState ? state.m_invInertia[m0] : body0->m_invWorldInertiaMatrix;
+			const ndMatrix& invInertia1 = useBodyState ? state.m_invInertia[m1] : body1->m_invWorldInertiaMatrix;
+			const ndVector invMass0(useBodyState ? state.m_invMass[m0] : body0->m_invMass[3]);
+			const ndVector invMass1(useBodyState ? state.m_invMass[m1] : body1->m_invMass[3]);
 
 			const ndVector zero(ndVector::m_zero);
 			ndVector forceAcc0(zero);
@@ -854,8 +931,8 @@ void ndDynamicsUpdate::InitJacobianMatrix()
 			ndVector forceAcc1(zero);
 			ndVector torqueAcc1(zero);
 
-			const ndVector weigh0(body0->m_weigh);
-			const ndVector weigh1(body1->m_weigh);
+			const ndVector weigh0(useBodyState ? state.m_weigh[m0] : body0->m_weigh);
+			const ndVector weigh1(useBodyState ? state.m_weigh[m1] : body1->m_weigh);
 
 			const bool isBilateral = joint->IsBilateral();
 			for (ndInt32 i = 0; i < count; ++i)
@@ -880,7 +957,7 @@ void ndDynamicsUpdate::InitJacobianMatrix()
 				ndAssert(rhs->m_jointFeebackForce);
 				const ndFloat32 force = rhs->m_jointFeebackForce->GetInitialGuess();
 
-				rhs->m_force = isBilateral ? ndClamp(force, rhs->m_lowerBoundFrictionCoefficent, rhs->m_upperBoundFrictionCoefficent) : force;
+				rhs->m_force = isBilateral ? ndClamp(force, rhs->m_lowerBoundFrictionCoefficent, rhs->m_upperBoundFrictionCoefficent) : force * warmStart;
 				rhs->m_maxImpact = ndFloat32(0.0f);
 
 				const ndJacobian& JtM0 = row->m_Jt.m_jacobianM0;
@@ -1024,6 +1101,8 @@ void ndDynamicsUpdate::IntegrateBodiesVelocity()
 	auto IntegrateBodiesVelocity = ndMakeObject::ndFunction([this, &iterator](ndInt32, ndInt32)
 	{
 		D_TRACKTIME_NAMED(IntegrateBodiesVelocity);
+		ndBodyState& state = m_bodyState;
+		const bool useBodyState = m_useBodyState;
 		ndArray<ndBodyKinematic*>& bodyArray = GetBodyIslandOrder();
 		const ndArray<ndJacobian>& internalForces = GetInternalForces();
 
@@ -1045,11 +1124,12 @@ void ndDynamicsUpdate::IntegrateBodiesVelocity()
 
 				const ndInt32 index = body->m_index;
 				const ndJacobian& forceAndTorque = internalForces[index];
-				const ndVector force(body->GetForce() + forceAndTorque.m_linear);
-				const ndVector torque(body->GetTorque() + forceAndTorque.m_angular - body->GetGyroTorque());
+				const ndVector force((useBodyState ? state.m_force[index] : body->GetForce()) + forceAndTorque.m_linear);
+				const ndVector torque((useBodyState ? state.m_torque[index] : body->GetTorque()) + forceAndTorque.m_angular - body->GetGyroTorque());
 				const ndJacobian velocStep(body->IntegrateForceAndToque(force, torque, timestep4));
 
-				if (!body->m_equilibrium0)
+				const ndUnsigned8 equilibrium0 = useBodyState ? state.m_equilibrium0[index] : ndUnsigned8(body->m_equilibrium0);
+				if (!equilibrium0)
 				{
 					body->m_veloc += velocStep.m_linear;
 					body->m_omega += velocStep.m_angular;
@@ -1062,6 +1142,11 @@ void ndDynamicsUpdate::IntegrateBodiesVelocity()
 					const ndVector test(((velocStep2 > speedFreeze2) | (omegaStep2 > speedFreeze2)) & ndVector::m_negOne);
 					const ndInt8 equilibrium = test.GetSignMask() ? 0 : 1;
 					body->m_equilibrium0 = ndUnsigned8(equilibrium);
+					if (useBodyState)
+					{
+						// the joint loops read the copy, the body keeps the flag for the sleep test.
+						state.m_equilibrium0[index] = ndUnsigned8(equilibrium);
+					}
 				}
 				ndAssert(body->m_veloc.m_w == ndFloat32(0.0f));
 				ndAssert(body->m_omega.m_w == ndFloat32(0.0f));
@@ -1251,13 +1336,29 @@ void ndDynamicsUpdate::InitSkeletons()
 		for (ndInt32 i = iterator++; i < count; i = iterator++)
 		{
 			ndSkeletonContainer* const skeleton = activeSkeletons[i];
-			skeleton->InitMassMatrix(&leftHandSide[0], &rightHandSide[0]);
+			skeleton->InitMassMatrix(&leftHandSide[0], &rightHandSide[0], true);
 		}
 	});
 
 	if (activeSkeletons.GetCount())
 	{
 		scene->ParallelExecute(InitSkeletons);
+		InitLargeLoopSkeletons();
+	}
+}
+
+void ndDynamicsUpdate::InitLargeLoopSkeletons()
+{
+	// skeletons with many loop rows are factored one at the time by all threads
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndSkeletonContainer*>& activeSkeletons = m_world->m_activeSkeletons;
+	for (ndInt32 i = 0; i < ndInt32(activeSkeletons.GetCount()); ++i)
+	{
+		ndSkeletonContainer* const skeleton = activeSkeletons[i];
+		if (skeleton->HasLargeLoopSystem())
+		{
+			skeleton->InitLoopMassMatrix(scene);
+		}
 	}
 }
 
@@ -1287,154 +1388,198 @@ void ndDynamicsUpdate::UpdateSkeletons()
 	}
 }
 
-void ndDynamicsUpdate::CalculateJointsForce()
+ndFloat32 ndDynamicsUpdate::SolveJointForce(ndConstraint* const joint, ndInt32 jointIndex)
 {
-	D_TRACKTIME();
-	const ndUnsigned32 passes = m_solverPasses;
-	ndScene* const scene = m_world->GetScene();
-
-	ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
-	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+	ndJacobian* const jointPartialForces = &m_tempInternalForces[0];
+	const ndVector zero(ndVector::m_zero);
+	ndVector accNorm(zero);
+
+	ndInt32 m0;
+	ndInt32 m1;
+	ndInt32 resting;
+	ndFloat32 weigh0;
+	ndFloat32 weigh1;
+	if (m_useBodyState)
+	{
+		// the joint rows and the state copy are all this loop reads
+		const ndBodyState& state = m_bodyState;
+		m0 = state.m_jointBodies[jointIndex * 2 + 0];
+		m1 = state.m_jointBodies[jointIndex * 2 + 1];
+		ndAssert(m0 == joint->GetBody0()->m_index);
+		ndAssert(m1 == joint->GetBody1()->m_index);
+		resting = state.m_equilibrium0[m0] & state.m_equilibrium0[m1];
+		weigh0 = state.m_weigh[m0];
+		weigh1 = state.m_weigh[m1];
+	}
+	else
+	{
+		const ndBodyKinematic* const body0 = joint->GetBody0();
+		const ndBodyKinematic* const body1 = joint->GetBody1();
+		ndAssert(body0);
+		ndAssert(body1);
+		m0 = body0->m_index;
+		m1 = body1->m_index;
+		resting = body0->m_equilibrium0 & body1->m_equilibrium0;
+		weigh0 = body0->m_weigh;
+		weigh1 = body1->m_weigh;
+	}
+	const ndInt32 rowStart = joint->m_rowStart;
+	const ndInt32 rowsCount = joint->m_rowCount;
 
-	ndAtomic<ndInt32> iterator0(0);
-	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &iterator0, &jointArray](ndInt32, ndInt32)
+	if (!resting)
 	{
-		D_TRACKTIME_NAMED(CalculateJointsForce);
-		ndJacobian* const jointPartialForces = &GetTempInternalForces()[0];
+		const ndVector preconditioner0(weigh0);
+		const ndVector preconditioner1(weigh1);
+
+		ndVector forceM0(m_internalForces[m0].m_linear);
+		ndVector torqueM0(m_internalForces[m0].m_angular);
+		ndVector forceM1(m_internalForces[m1].m_linear);
+		ndVector torqueM1(m_internalForces[m1].m_angular);
 
-		auto JointForce = [this, &jointPartialForces](ndConstraint* const joint, ndInt32 jointIndex)
+		for (ndInt32 j = 0; j < rowsCount; ++j)
 		{
-			D_TRACKTIME_NAMED(JointForce);
-			const ndVector zero(ndVector::m_zero);
-			ndVector accNorm(zero);
-			ndBodyKinematic* const body0 = joint->GetBody0();
-			ndBodyKinematic* const body1 = joint->GetBody1();
-			ndAssert(body0);
-			ndAssert(body1);
+			ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+			const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+			const ndVector force(rhs->m_force);
+
+			ndVector a(lhs->m_JMinv.m_jacobianM0.m_linear * forceM0);
+			a = a.MulAdd(lhs->m_JMinv.m_jacobianM0.m_angular, torqueM0);
+			a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_linear, forceM1);
+			a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
+			a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
+
+			ndAssert(rhs->m_normalForceIndexFlat >= 0);
+			ndVector f(force + a.Scale(rhs->m_invJinvMJt));
+			const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
+			const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
+			const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
+			const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
+
+			a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
+			accNorm = accNorm.MulAdd(a, a);
+
+			f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
+			rhs->m_force = f.GetScalar();
+
+			const ndVector deltaForce(f - force);
+			const ndVector deltaForce0(deltaForce * preconditioner0);
+			const ndVector deltaForce1(deltaForce * preconditioner1);
+			forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, deltaForce0);
+			torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, deltaForce0);
+			forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce1);
+			torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce1);
+		}
 
-			const ndInt32 m0 = body0->m_index;
-			const ndInt32 m1 = body1->m_index;
-			const ndInt32 rowStart = joint->m_rowStart;
-			const ndInt32 rowsCount = joint->m_rowCount;
+		const ndFloat32 tol = ndFloat32(0.125f);
+		const ndFloat32 tol2 = tol * tol;
 
-			const ndInt32 resting = body0->m_equilibrium0 & body1->m_equilibrium0;
-			if (!resting)
+		ndVector maxAccel(accNorm);
+		for (ndInt32 k = 0; (k < 4) && (maxAccel.GetScalar() > tol2); ++k)
+		{
+			maxAccel = zero;
+			for (ndInt32 j = 0; j < rowsCount; ++j)
 			{
-				const ndVector preconditioner0(body0->m_weigh);
-				const ndVector preconditioner1(body1->m_weigh);
+				ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+				const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+				const ndVector force(rhs->m_force);
+
+				ndVector a(lhs->m_JMinv.m_jacobianM0.m_linear * forceM0);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM0.m_angular, torqueM0);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_linear, forceM1);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
+				a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
+
+				ndVector f(force + a.Scale(rhs->m_invJinvMJt));
+				ndAssert(rhs->m_normalForceIndexFlat >= 0);
+				const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
+				const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
+
+				const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
+				const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
+
+				a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
+				maxAccel = maxAccel.MulAdd(a, a);
+
+				f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
+				rhs->m_force = f.GetScalar();
+
+				const ndVector deltaForce(f - force);
+				const ndVector deltaForce0(deltaForce * preconditioner0);
+				const ndVector deltaForce1(deltaForce * preconditioner1);
+				forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, deltaForce0);
+				torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, deltaForce0);
+				forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce1);
+				torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce1);
+			}
+		}
+	}
 
-				ndVector forceM0(m_internalForces[m0].m_linear);
-				ndVector torqueM0(m_internalForces[m0].m_angular);
-				ndVector forceM1(m_internalForces[m1].m_linear);
-				ndVector torqueM1(m_internalForces[m1].m_angular);
+	ndVector forceM0(zero);
+	ndVector torqueM0(zero);
+	ndVector forceM1(zero);
+	ndVector torqueM1(zero);
 
-				for (ndInt32 j = 0; j < rowsCount; ++j)
-				{
-					ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
-					const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
-					const ndVector force(rhs->m_force);
-
-					ndVector a(lhs->m_JMinv.m_jacobianM0.m_linear * forceM0);
-					a = a.MulAdd(lhs->m_JMinv.m_jacobianM0.m_angular, torqueM0);
-					a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_linear, forceM1);
-					a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
-					a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
-
-					ndAssert(rhs->m_normalForceIndexFlat >= 0);
-					ndVector f(force + a.Scale(rhs->m_invJinvMJt));
-					const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
-					const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
-					const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
-					const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
-
-					a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
-					accNorm = accNorm.MulAdd(a, a);
-
-					f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
-					rhs->m_force = f.GetScalar();
-
-					const ndVector deltaForce(f - force);
-					const ndVector deltaForce0(deltaForce * preconditioner0);
-					const ndVector deltaForce1(deltaForce * preconditioner1);
-					forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, deltaForce0);
-					torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, deltaForce0);
-					forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce1);
-					torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce1);
-				}
+	for (ndInt32 j = 0; j < rowsCount; ++j)
+	{
+		ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+		const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+
+		const ndVector f(rhs->m_force);
+		forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, f);
+		torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, f);
+		forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, f);
+		torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, f);
+		rhs->m_maxImpact = ndMax(ndAbs(f.GetScalar()), rhs->m_maxImpact);
+	}
 
-				const ndFloat32 tol = ndFloat32(0.125f);
-				const ndFloat32 tol2 = tol * tol;
+	const ndInt32 index0 = jointIndex * 2 + 0;
+	ndJacobian& outBody0 = jointPartialForces[index0];
+	outBody0.m_linear = forceM0;
+	outBody0.m_angular = torqueM0;
 
-				ndVector maxAccel(accNorm);
-				for (ndInt32 k = 0; (k < 4) && (maxAccel.GetScalar() > tol2); ++k)
-				{
-					maxAccel = zero;
-					for (ndInt32 j = 0; j < rowsCount; ++j)
-					{
-						ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
-						const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
-						const ndVector force(rhs->m_force);
-
-						ndVector a(lhs->m_JMinv.m_jacobianM0.m_linear * forceM0);
-						a = a.MulAdd(lhs->m_JMinv.m_jacobianM0.m_angular, torqueM0);
-						a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_linear, forceM1);
-						a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
-						a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
-
-						ndVector f(force + a.Scale(rhs->m_invJinvMJt));
-						ndAssert(rhs->m_normalForceIndexFlat >= 0);
-						const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
-						const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
-
-						const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
-						const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
-
-						a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
-						maxAccel = maxAccel.MulAdd(a, a);
-
-						f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
-						rhs->m_force = f.GetScalar();
-
-						const ndVector deltaForce(f - force);
-						const ndVector deltaForce0(deltaForce * preconditioner0);
-						const ndVector deltaForce1(deltaForce * preconditioner1);
-						forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, deltaForce0);
-						torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, deltaForce0);
-						forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce1);
-						torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce1);
-					}
-				}
-			}
+	const ndInt32 index1 = jointIndex * 2 + 1;
+	ndJacobian& outBody1 = jointPartialForces[index1];
+	outBody1.m_linear = forceM1;
+	outBody1.m_angular = torqueM1;
 
-			ndVector forceM0(zero);
-			ndVector torqueM0(zero);
-			ndVector forceM1(zero);
-			ndVector torqueM1(zero);
+	return accNorm.GetScalar();
+}
 
-			for (ndInt32 j = 0; j < rowsCount; ++j)
-			{
-				ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
-				const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+void ndDynamicsUpdate::AddSolverPassBudget(ndInt32 passes)
+{
+	m_world->m_solverStats.m_maxPasses += passes;
+}
 
-				const ndVector f(rhs->m_force);
-				forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, f);
-				torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, f);
-				forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, f);
-				torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, f);
-				rhs->m_maxImpact = ndMax(ndAbs(f.GetScalar()), rhs->m_maxImpact);
-			}
+void ndDynamicsUpdate::AddSolverPasses(ndInt32 passes, ndFloat32 residual2)
+{
+	// residual2 is the largest joint acceleration error squared of the last pass.
+	ndWorld::ndSolverStats& stats = m_world->m_solverStats;
+	stats.m_passes += passes;
+	stats.m_residual = ndSqrt(residual2);
+}
 
-			const ndInt32 index0 = jointIndex * 2 + 0;
-			ndJacobian& outBody0 = jointPartialForces[index0];
-			outBody0.m_linear = forceM0;
-			outBody0.m_angular = torqueM0;
+bool ndDynamicsUpdate::SolverPassConverged(ndFloat32 residual2)
+{
+	AddSolverPasses(1, residual2);
+	const ndFloat32 tolerance = m_world->m_solverTolerance;
+	return residual2 < (tolerance * tolerance);
+}
 
-			const ndInt32 index1 = jointIndex * 2 + 1;
-			ndJacobian& outBody1 = jointPartialForces[index1];
-			outBody1.m_linear = forceM1;
-			outBody1.m_angular = torqueM1;
-		};
+void ndDynamicsUpdate::CalculateJointsForce()
+{
+	D_TRACKTIME();
+	const ndUnsigned32 passes = m_solverPasses;
+	ndScene* const scene = m_world->GetScene();
+
+	ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
+	ndFloat32 residualArray[D_MAX_THREADS_COUNT];
+	ndAtomic<ndInt32> iterator0(0);
+	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &iterator0, &jointArray, &residualArray](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(CalculateJointsForce);
+		ndFloat32 residual = ndFloat32(0.0f);
 		const ndInt32 jointCount = ndInt32 (jointArray.GetCount());
 		for (ndInt32 i = iterator0.fetch_add(D_WORKER_BATCH_SIZE); i < jointCount; i = iterator0.fetch_add(D_WORKER_BATCH_SIZE))
 		{
@@ -1442,9 +1587,10 @@ void ndDynamicsUpdate::CalculateJointsForce()
 			for (ndInt32 j = 0; j < maxSpan; ++j)
 			{
 				ndConstraint* const joint = jointArray[i + j];
-				JointForce(joint, i + j);
+				residual = ndMax(residual, SolveJointForce(joint, i + j));
 			}
 		}
+		residualArray[threadIndex] = residual;
 	});
 
 	ndAtomic<ndInt32> iterator1(0);
@@ -1485,12 +1631,24 @@ void ndDynamicsUpdate::CalculateJointsForce()
 		}
 	});
 
+	AddSolverPassBudget(ndInt32(passes));
+	const ndInt32 threadCount = scene->GetThreadCount();
 	for (ndInt32 i = 0; i < ndInt32(passes); ++i)
 	{
 		iterator0 = 0;
 		iterator1 = 0;
 		scene->ParallelExecute(CalculateJointsForce);
 		scene->ParallelExecute(ApplyJacobianAccumulatePartialForces);
+
+		ndFloat32 residual = ndFloat32(0.0f);
+		for (ndInt32 j = 0; j < threadCount; ++j)
+		{
+			residual = ndMax(residual, residualArray[j]);
+		}
+		if (SolverPassConverged(residual))
+		{
+			break;
+		}
 	}
 }
 
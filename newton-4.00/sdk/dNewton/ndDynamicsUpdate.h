@@ -58,6 +58,20 @@ class ndDynamicsUpdate : public ndClassAlloc
 		ndBodyKinematic* m_root;
 	};
 
+	// structure of arrays copy of the body data read by the joint loops,
+	// indexed by the body index in the scene active body array.
+	class ndBodyState
+	{
+		public:
+		ndArray<ndMatrix> m_invInertia;
+		ndArray<ndVector> m_force;
+		ndArray<ndVector> m_torque;
+		ndArray<ndFloat32> m_invMass;
+		ndArray<ndFloat32> m_weigh;
+		ndArray<ndUnsigned8> m_equilibrium0;
+		ndArray<ndInt32> m_jointBodies;
+	};
+
 	class ndIsland
 	{
 		public:
@@ -91,27 +105,32 @@ class ndDynamicsUpdate : public ndClassAlloc
 	ndArray<ndBodyKinematic*>& GetBodyIslandOrder();
 	ndArray<ndJointBodyPairIndex>& GetJointBodyPairIndexBuffer();
 
-	private:
+	protected:
 	void SortJoints();
 	void SortIslands();
 	void BuildIsland();
 	void InitWeights();
 	void InitBodyArray();
 	void InitSkeletons();
+	void BuildBodyState();
 	void CalculateForces();
 	void IntegrateBodies();
 	void UpdateSkeletons();
 	void InitJacobianMatrix();
 	void UpdateForceFeedback();
 	void CalculateJointsForce();
+	void InitLargeLoopSkeletons();
 	void IntegrateBodiesVelocity();
 	void CalculateJointsAcceleration();
 	void IntegrateUnconstrainedBodies();
 
 	void DetermineSleepStates();
 	void GetJacobianDerivatives(ndConstraint* const joint);
+	ndFloat32 SolveJointForce(ndConstraint* const joint, ndInt32 jointIndex);
+	bool SolverPassConverged(ndFloat32 residual2);
+	void AddSolverPassBudget(ndInt32 passes);
+	void AddSolverPasses(ndInt32 passes, ndFloat32 residual2);
 
-	protected:
 	void Clear();
 	virtual void Update();
 	void SortJointsScan();
@@ -127,6 +146,7 @@ class ndDynamicsUpdate : public ndClassAlloc
 	ndArray<ndJacobian> m_tempInternalForces;
 	ndArray<ndBodyKinematic*> m_bodyIslandOrder;
 	ndArray<ndJointBodyPairIndex> m_jointBodyPairIndexBuffer;
+	ndBodyState m_bodyState;
 
 	ndWorld* m_world;
 	ndFloat32 m_timestep;
@@ -138,6 +158,7 @@ class ndDynamicsUpdate : public ndClassAlloc
 	ndUnsigned32 m_solverPasses;
 	ndInt32 m_activeJointCount;
 	ndInt32 m_unConstrainedBodyCount;
+	bool m_useBodyState;
 
 	friend class ndWorld;
 	friend class ndSkeletonContainer;
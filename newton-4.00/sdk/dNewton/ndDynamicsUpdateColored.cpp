@@ -0,0 +1,383 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "ndCoreStdafx.h"
+#include "ndNewtonStdafx.h"
+#include "ndWorld.h"
+#include "ndBodyDynamic.h"
+#include "ndSkeletonList.h"
+#include "ndDynamicsUpdateColored.h"
+#include "ndJointBilateralConstraint.h"
+
+#define D_COLORED_DEFAULT_BUFFER_SIZE	1024
+
+ndDynamicsUpdateColored::ndDynamicsUpdateColored(ndWorld* const world)
+	:ndDynamicsUpdate(world)
+	,m_colorStart(D_MAX_GRAPH_COLORS + 2)
+	,m_jointColor(D_COLORED_DEFAULT_BUFFER_SIZE)
+	,m_bodyColorMask(D_COLORED_DEFAULT_BUFFER_SIZE)
+	,m_coloredJoints(D_COLORED_DEFAULT_BUFFER_SIZE)
+	,m_overflowStart(0)
+{
+}
+
+ndDynamicsUpdateColored::~ndDynamicsUpdateColored()
+{
+	Clear();
+
+	m_jointColor.Resize(D_COLORED_DEFAULT_BUFFER_SIZE);
+	m_bodyColorMask.Resize(D_COLORED_DEFAULT_BUFFER_SIZE);
+	m_coloredJoints.Resize(D_COLORED_DEFAULT_BUFFER_SIZE);
+}
+
+const char* ndDynamicsUpdateColored::GetStringId() const
+{
+	return "colored gauss seidel";
+}
+
+void ndDynamicsUpdateColored::InitWeights()
+{
+	D_TRACKTIME();
+	ndDynamicsUpdate::InitWeights();
+
+	// a Gauss-Seidel sweep converges without the extra passes 
+	// the jacobi solver needs to propagate the split masses.
+	if (m_world->GetScene()->GetActiveContactArray().GetCount())
+	{
+		m_solverPasses = ndUnsigned32(m_world->GetSolverIterations() + 2);
+	}
+}
+
+void ndDynamicsUpdateColored::InitJacobianDiagonals()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	// the base class scales the diagonal by the body weights, 
+	// joints here see the full body mass so the diagonal is rebuilt.
+	ndAtomic<ndInt32> iterator(0);
+	auto InitJacobianDiagonals = ndMakeObject::ndFunction([this, &iterator, &jointArray](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(InitJacobianDiagonals);
+		const ndInt32 jointCount = ndInt32(jointArray.GetCount());
+		for (ndInt32 i = iterator.fetch_add(D_WORKER_BATCH_SIZE); i < jointCount; i = iterator.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((jointCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : jointCount - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				const ndConstraint* const joint = jointArray[i + j];
+				const ndInt32 index = joint->m_rowStart;
+				const ndInt32 count = joint->m_rowCount;
+				for (ndInt32 k = 0; k < count; ++k)
+				{
+					const ndLeftHandSide* const row = &m_leftHandSide[index + k];
+					ndRightHandSide* const rhs = &m_rightHandSide[index + k];
+
+					const ndJacobian& JMinvM0 = row->m_JMinv.m_jacobianM0;
+					const ndJacobian& JMinvM1 = row->m_JMinv.m_jacobianM1;
+					const ndJacobian& JtM0 = row->m_Jt.m_jacobianM0;
+					const ndJacobian& JtM1 = row->m_Jt.m_jacobianM1;
+					const ndVector tmpDiag(
+						JMinvM0.m_linear * JtM0.m_linear + JMinvM0.m_angular * JtM0.m_angular +
+						JMinvM1.m_linear * JtM1.m_linear + JMinvM1.m_angular * JtM1.m_angular);
+
+					ndFloat32 diag = tmpDiag.AddHorizontal().GetScalar();
+					ndAssert(diag > ndFloat32(0.0f));
+					rhs->m_diagDamp = diag * rhs->m_diagonalRegularizer;
+					diag *= (ndFloat32(1.0f) + rhs->m_diagonalRegularizer);
+					rhs->m_invJinvMJt = ndFloat32(1.0f) / diag;
+				}
+			}
+		}
+	});
+
+	if (jointArray.GetCount())
+	{
+		scene->ParallelExecute(InitJacobianDiagonals);
+	}
+}
+
+void ndDynamicsUpdateColored::BuildColors()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+	const ndInt32 jointCount = ndInt32(jointArray.GetCount());
+
+	m_jointColor.SetCount(jointCount);
+	m_coloredJoints.SetCount(jointCount);
+	m_bodyColorMask.SetCount(scene->GetActiveBodyArray().GetCount());
+	ndMemSet(&m_bodyColorMask[0], ndUnsigned64(0), m_bodyColorMask.GetCount());
+
+	// greedy coloring, each joint takes the lowest color 
+	// not yet used by any of its dynamic bodies.
+	ndInt32 histogram[D_MAX_GRAPH_COLORS + 1];
+	ndMemSet(histogram, 0, D_MAX_GRAPH_COLORS + 1);
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndConstraint* const joint = jointArray[i];
+		const ndBodyKinematic* const body0 = joint->GetBody0();
+		const ndBodyKinematic* const body1 = joint->GetBody1();
+		const ndInt32 m0 = body0->m_index;
+		const ndInt32 m1 = body1->m_index;
+		const ndUnsigned64 mask0 = body0->m_isStatic ? ndUnsigned64(0) : m_bodyColorMask[m0];
+		const ndUnsigned64 mask1 = body1->m_isStatic ? ndUnsigned64(0) : m_bodyColorMask[m1];
+		const ndUnsigned64 usedColors = mask0 | mask1;
+
+		ndInt32 color = 0;
+		while ((color < D_MAX_GRAPH_COLORS) && (usedColors & (ndUnsigned64(1) << color)))
+		{
+			color++;
+		}
+
+		if (color < D_MAX_GRAPH_COLORS)
+		{
+			const ndUnsigned64 bit = ndUnsigned64(1) << color;
+			if (!body0->m_isStatic)
+			{
+				m_bodyColorMask[m0] |= bit;
+			}
+			if (!body1->m_isStatic)
+			{
+				m_bodyColorMask[m1] |= bit;
+			}
+		}
+		m_jointColor[i] = color;
+		histogram[color]++;
+	}
+
+	m_colorStart.SetCount(0);
+	m_overflowStart = jointCount - histogram[D_MAX_GRAPH_COLORS];
+
+	ndInt32 sum = 0;
+	for (ndInt32 i = 0; i <= D_MAX_GRAPH_COLORS; ++i)
+	{
+		if (histogram[i])
+		{
+			const ndInt32 count = histogram[i];
+			m_colorStart.PushBack(sum);
+			histogram[i] = sum;
+			sum += count;
+		}
+	}
+	m_colorStart.PushBack(sum);
+
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndInt32 color = m_jointColor[i];
+		const ndInt32 index = histogram[color];
+		m_coloredJoints[index] = jointArray[i];
+		histogram[color] = index + 1;
+	}
+}
+
+ndFloat32 ndDynamicsUpdateColored::JointForce(ndConstraint* const joint)
+{
+	const ndVector zero(ndVector::m_zero);
+	ndFloat32 residual = ndFloat32(0.0f);
+	ndBodyKinematic* const body0 = joint->GetBody0();
+	ndBodyKinematic* const body1 = joint->GetBody1();
+	ndAssert(body0);
+	ndAssert(body1);
+
+	const ndInt32 m0 = body0->m_index;
+	const ndInt32 m1 = body1->m_index;
+	const ndInt32 rowStart = joint->m_rowStart;
+	const ndInt32 rowsCount = joint->m_rowCount;
+
+	const ndInt32 resting = body0->m_equilibrium0 & body1->m_equilibrium0;
+	if (!resting)
+	{
+		ndVector forceM0(m_internalForces[m0].m_linear);
+		ndVector torqueM0(m_internalForces[m0].m_angular);
+		ndVector forceM1(m_internalForces[m1].m_linear);
+		ndVector torqueM1(m_internalForces[m1].m_angular);
+
+		const ndFloat32 tol = ndFloat32(0.125f);
+		const ndFloat32 tol2 = tol * tol;
+		ndVector maxAccel(tol2 * ndFloat32(2.0f));
+		for (ndInt32 k = 0; (k < 5) && (maxAccel.GetScalar() > tol2); ++k)
+		{
+			maxAccel = zero;
+			for (ndInt32 j = 0; j < rowsCount; ++j)
+			{
+				ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+				const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+				const ndVector force(rhs->m_force);
+
+				ndVector a(lhs->m_JMinv.m_jacobianM0.m_linear * forceM0);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM0.m_angular, torqueM0);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_linear, forceM1);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
+				a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
+
+				ndAssert(rhs->m_normalForceIndexFlat >= 0);
+				ndVector f(force + a.Scale(rhs->m_invJinvMJt));
+				const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
+				const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
+				const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
+				const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
+
+				a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
+				maxAccel = maxAccel.MulAdd(a, a);
+
+				f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
+				rhs->m_force = f.GetScalar();
+
+				const ndVector deltaForce(f - force);
+				forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, deltaForce);
+				torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, deltaForce);
+				forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce);
+				torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce);
+			}
+			if (!k)
+			{
+				residual = maxAccel.GetScalar();
+			}
+		}
+
+		// static bodies are shared by joints of the same color, 
+		// but their internal forces are always zero.
+		if (!body0->m_isStatic)
+		{
+			m_internalForces[m0].m_linear = forceM0;
+			m_internalForces[m0].m_angular = torqueM0;
+		}
+		if (!body1->m_isStatic)
+		{
+			m_internalForces[m1].m_linear = forceM1;
+			m_internalForces[m1].m_angular = torqueM1;
+		}
+	}
+
+	for (ndInt32 j = 0; j < rowsCount; ++j)
+	{
+		ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+		rhs->m_maxImpact = ndMax(ndAbs(rhs->m_force), rhs->m_maxImpact);
+	}
+	return residual;
+}
+
+void ndDynamicsUpdateColored::CalculateJointsForce()
+{
+	D_TRACKTIME();
+	const ndUnsigned32 passes = m_solverPasses;
+	ndScene* const scene = m_world->GetScene();
+
+	ndInt32 colorStart = 0;
+	ndInt32 colorCount = 0;
+	ndFloat32 residualArray[D_MAX_THREADS_COUNT];
+	ndAtomic<ndInt32> iterator(0);
+	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &iterator, &colorStart, &colorCount, &residualArray](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(CalculateJointsForce);
+		ndFloat32 residual = residualArray[threadIndex];
+		ndConstraint** const jointArray = &m_coloredJoints[colorStart];
+		for (ndInt32 i = iterator.fetch_add(D_WORKER_BATCH_SIZE); i < colorCount; i = iterator.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((colorCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : colorCount - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				residual = ndMax(residual, JointForce(jointArray[i + j]));
+			}
+		}
+		residualArray[threadIndex] = residual;
+	});
+
+	AddSolverPassBudget(ndInt32(passes));
+	const ndInt32 colors = GetColorCount();
+	const ndInt32 threadCount = scene->GetThreadCount();
+	for (ndInt32 i = 0; i < ndInt32(passes); ++i)
+	{
+		ndFloat32 residual = ndFloat32(0.0f);
+		for (ndInt32 j = 0; j < threadCount; ++j)
+		{
+			residualArray[j] = ndFloat32(0.0f);
+		}
+
+		for (ndInt32 color = 0; color < colors; ++color)
+		{
+			colorStart = m_colorStart[color];
+			colorCount = m_colorStart[color + 1] - colorStart;
+
+			if ((colorStart >= m_overflowStart) || (colorCount <= D_WORKER_BATCH_SIZE))
+			{
+				// small colors and joints that could not be colored run on this thread.
+				for (ndInt32 j = 0; j < colorCount; ++j)
+				{
+					residual = ndMax(residual, JointForce(m_coloredJoints[colorStart + j]));
+				}
+			}
+			else
+			{
+				iterator = 0;
+				scene->ParallelExecute(CalculateJointsForce);
+			}
+		}
+
+		for (ndInt32 j = 0; j < threadCount; ++j)
+		{
+			residual = ndMax(residual, residualArray[j]);
+		}
+		if (SolverPassConverged(residual))
+		{
+			break;
+		}
+	}
+}
+
+void ndDynamicsUpdateColored::CalculateForces()
+{
+	D_TRACKTIME();
+	if (m_world->GetScene()->GetActiveContactArray().GetCount())
+	{
+		m_firstPassCoef = ndFloat32(0.0f);
+
+		BuildColors();
+		InitSkeletons();
+		for (ndInt32 step = 0; step < 4; step++)
+		{
+			CalculateJointsAcceleration();
+			CalculateJointsForce();
+			UpdateSkeletons();
+			IntegrateBodiesVelocity();
+		}
+		UpdateForceFeedback();
+	}
+}
+
+void ndDynamicsUpdateColored::Update()
+{
+	D_TRACKTIME();
+	m_timestep = m_world->GetScene()->GetTimestep();
+
+	BuildIsland();
+	IntegrateUnconstrainedBodies();
+	InitWeights();
+	InitBodyArray();
+	InitJacobianMatrix();
+	InitJacobianDiagonals();
+	CalculateForces();
+	IntegrateBodies();
+	DetermineSleepStates();
+}
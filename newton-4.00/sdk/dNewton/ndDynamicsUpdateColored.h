@@ -0,0 +1,71 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef __ND_WORLD_DYNAMICS_UPDATE_COLORED_H__
+#define __ND_WORLD_DYNAMICS_UPDATE_COLORED_H__
+
+#include "ndNewtonStdafx.h"
+#include "ndDynamicsUpdate.h"
+
+// each color is a set of joints that do not share any dynamic body, 
+// joints in the overflow color are solved by a single thread.
+#define D_MAX_GRAPH_COLORS	64
+
+// Gauss-Seidel solver that colors the constraint graph, joints of 
+// the same color are solved in parallel and each one applies its 
+// impulses to the bodies directly, so every joint sees the latest 
+// forces of its neighbors in the same pass.
+D_MSV_NEWTON_ALIGN_32
+class ndDynamicsUpdateColored: public ndDynamicsUpdate
+{
+	public:
+	ndDynamicsUpdateColored(ndWorld* const world);
+	virtual ~ndDynamicsUpdateColored();
+
+	virtual const char* GetStringId() const;
+	ndInt32 GetColorCount() const;
+
+	protected:
+	virtual void Update();
+
+	private:
+	void BuildColors();
+	void InitWeights();
+	void InitJacobianDiagonals();
+	void CalculateForces();
+	void CalculateJointsForce();
+	ndFloat32 JointForce(ndConstraint* const joint);
+
+	ndArray<ndInt32> m_colorStart;
+	ndArray<ndInt32> m_jointColor;
+	ndArray<ndUnsigned64> m_bodyColorMask;
+	ndArray<ndConstraint*> m_coloredJoints;
+	ndInt32 m_overflowStart;
+} D_GCC_NEWTON_ALIGN_32;
+
+inline ndInt32 ndDynamicsUpdateColored::GetColorCount() const
+{
+	return ndMax(ndInt32(m_colorStart.GetCount()) - 1, 0);
+}
+
+#endif
+
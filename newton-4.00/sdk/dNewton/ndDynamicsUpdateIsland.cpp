@@ -0,0 +1,667 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "ndCoreStdafx.h"
+#include "ndNewtonStdafx.h"
+#include "ndWorld.h"
+#include "ndBodyDynamic.h"
+#include "ndSkeletonList.h"
+#include "ndDynamicsUpdateIsland.h"
+#include "ndJointBilateralConstraint.h"
+
+#define D_ISLAND_DEFAULT_BUFFER_SIZE	1024
+
+ndDynamicsUpdateIsland::ndDynamicsUpdateIsland(ndWorld* const world)
+	:ndDynamicsUpdate(world)
+	,m_islandTasks(D_ISLAND_DEFAULT_BUFFER_SIZE)
+	,m_islandParent(D_ISLAND_DEFAULT_BUFFER_SIZE)
+	,m_islandJoints(D_ISLAND_DEFAULT_BUFFER_SIZE)
+	,m_islandBodies(D_ISLAND_DEFAULT_BUFFER_SIZE)
+	,m_islandIndex(D_ISLAND_DEFAULT_BUFFER_SIZE)
+	,m_islandSkeletons(256)
+	,m_freeSkeletonStart(0)
+{
+}
+
+ndDynamicsUpdateIsland::~ndDynamicsUpdateIsland()
+{
+	Clear();
+
+	m_islandTasks.Resize(D_ISLAND_DEFAULT_BUFFER_SIZE);
+	m_islandParent.Resize(D_ISLAND_DEFAULT_BUFFER_SIZE);
+	m_islandJoints.Resize(D_ISLAND_DEFAULT_BUFFER_SIZE);
+	m_islandBodies.Resize(D_ISLAND_DEFAULT_BUFFER_SIZE);
+	m_islandIndex.Resize(D_ISLAND_DEFAULT_BUFFER_SIZE);
+	m_islandSkeletons.Resize(256);
+}
+
+const char* ndDynamicsUpdateIsland::GetStringId() const
+{
+	return "island tasks";
+}
+
+void ndDynamicsUpdateIsland::BuildIslandTasks()
+{
+	D_TRACKTIME();
+	class ndEvaluateKey0
+	{
+		public:
+		ndEvaluateKey0(void* const)
+		{
+		}
+
+		ndInt32 GetKey(const ndIslandEntry& entry) const
+		{
+			return entry.m_island & ((1 << D_MAX_BODY_RADIX_BIT) - 1);
+		}
+	};
+
+	class ndEvaluateKey1
+	{
+		public:
+		ndEvaluateKey1(void* const)
+		{
+		}
+
+		ndInt32 GetKey(const ndIslandEntry& entry) const
+		{
+			return (entry.m_island >> D_MAX_BODY_RADIX_BIT) & ((1 << D_MAX_BODY_RADIX_BIT) - 1);
+		}
+	};
+
+	// largest islands first, so that the batched ones balance at the end.
+	class CompareIslands
+	{
+		public:
+		CompareIslands(void*)
+		{
+		}
+
+		ndInt32 Compare(const ndIslandTask& islandA, const ndIslandTask& islandB) const
+		{
+			if (islandA.m_jointCount < islandB.m_jointCount)
+			{
+				return 1;
+			}
+			if (islandA.m_jointCount > islandB.m_jointCount)
+			{
+				return -1;
+			}
+			return 0;
+		}
+	};
+
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	const ndArray<ndInt32>& bodyJointIndex = GetJointForceIndexBuffer();
+	const ndInt32 jointCount = ndInt32(jointArray.GetCount());
+	const ndInt32 bodyCount = ndInt32(bodyArray.GetCount());
+
+	m_islandTasks.SetCount(0);
+	m_islandSkeletons.SetCount(0);
+	m_freeSkeletonStart = 0;
+	if (!jointCount)
+	{
+		return;
+	}
+
+	ndAssert(bodyCount < (1 << (2 * D_MAX_BODY_RADIX_BIT)));
+	m_islandParent.SetCount(bodyCount);
+	m_islandIndex.SetCount(bodyCount);
+	m_islandJoints.SetCount(jointCount);
+	m_islandBodies.SetCount(bodyCount);
+
+	scene->GetScratchBuffer().SetCount(2 * (jointCount + bodyCount) * ndInt32(sizeof(ndIslandEntry)));
+	ndIslandEntry* const entries = (ndIslandEntry*)&scene->GetScratchBuffer()[0];
+	ndIslandEntry* const tempEntries = &entries[jointCount + bodyCount];
+
+	ndInt32 islandStart[D_MAX_THREADS_COUNT];
+	auto ResetIslands = ndMakeObject::ndFunction([this, bodyCount](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(ResetIslands);
+		const ndStartEnd startEnd(bodyCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			m_islandParent[i] = i;
+		}
+	});
+
+	// static bodies do not connect islands.
+	ndAtomic<ndInt32> iterator(0);
+	auto LinkJointIslands = ndMakeObject::ndFunction([this, &iterator, &jointArray, jointCount](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(LinkJointIslands);
+		for (ndInt32 i = iterator.fetch_add(D_WORKER_BATCH_SIZE); i < jointCount; i = iterator.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((jointCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : jointCount - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				const ndConstraint* const joint = jointArray[i + j];
+				const ndBodyKinematic* const body0 = joint->GetBody0();
+				const ndBodyKinematic* const body1 = joint->GetBody1();
+				if (!(body0->m_isStatic | body1->m_isStatic))
+				{
+					LinkIslands(body0->m_index, body1->m_index);
+				}
+			}
+		}
+	});
+
+	// each island is counted by the thread that owns its root.
+	auto CountIslands = ndMakeObject::ndFunction([this, &bodyArray, &bodyJointIndex, &islandStart, bodyCount](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CountIslands);
+		ndInt32 count = 0;
+		const ndStartEnd startEnd(bodyCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndInt32 root = -1;
+			const ndBodyKinematic* const body = bodyArray[i];
+			if (!body->m_isStatic && (bodyJointIndex[i + 1] > bodyJointIndex[i]))
+			{
+				root = FindIslandRoot(i);
+				count += (root == i) ? 1 : 0;
+			}
+			m_islandIndex[i] = root;
+		}
+		islandStart[threadIndex] = count;
+	});
+
+	// the union find array is no longer needed, the roots use it to store their island.
+	auto EnumerateIslands = ndMakeObject::ndFunction([this, &islandStart, bodyCount](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(EnumerateIslands);
+		ndInt32 islandIndex = islandStart[threadIndex];
+		const ndStartEnd startEnd(bodyCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			if (m_islandIndex[i] == i)
+			{
+				ndIslandTask& island = m_islandTasks[islandIndex];
+				island.m_jointStart = 0;
+				island.m_jointCount = 0;
+				island.m_bodyStart = 0;
+				island.m_bodyCount = 0;
+				island.m_skeletonStart = 0;
+				island.m_skeletonCount = 0;
+				island.m_maxPasses = 0;
+				island.m_stepPasses = 0;
+				island.m_passes = 0;
+				island.m_residual = ndFloat32(0.0f);
+				m_islandParent[i] = islandIndex;
+				islandIndex++;
+			}
+		}
+	});
+
+	// bodies that are not in any island get key zero and sort to the front.
+	auto BuildIslandEntries = ndMakeObject::ndFunction([this, &jointArray, entries, jointCount, bodyCount](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(BuildIslandEntries);
+		const ndStartEnd jointStartEnd(jointCount, threadIndex, threadCount);
+		for (ndInt32 i = jointStartEnd.m_start; i < jointStartEnd.m_end; ++i)
+		{
+			const ndConstraint* const joint = jointArray[i];
+			const ndBodyKinematic* const body = joint->GetBody0()->m_isStatic ? joint->GetBody1() : joint->GetBody0();
+			ndAssert(!body->m_isStatic);
+			entries[i].m_island = m_islandParent[m_islandIndex[body->m_index]].load();
+			entries[i].m_index = i;
+		}
+
+		ndIslandEntry* const bodyEntries = &entries[jointCount];
+		const ndStartEnd bodyStartEnd(bodyCount, threadIndex, threadCount);
+		for (ndInt32 i = bodyStartEnd.m_start; i < bodyStartEnd.m_end; ++i)
+		{
+			const ndInt32 root = m_islandIndex[i];
+			bodyEntries[i].m_island = (root >= 0) ? m_islandParent[root].load() + 1 : 0;
+			bodyEntries[i].m_index = i;
+		}
+	});
+
+	// after the sort, each island is a contiguous run of entries.
+	auto BuildIslandRuns = ndMakeObject::ndFunction([this, entries, jointCount, bodyCount](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(BuildIslandRuns);
+		const ndStartEnd jointStartEnd(jointCount, threadIndex, threadCount);
+		for (ndInt32 i = jointStartEnd.m_start; i < jointStartEnd.m_end; ++i)
+		{
+			const ndInt32 island = entries[i].m_island;
+			m_islandJoints[i] = entries[i].m_index;
+			if (!i || (entries[i - 1].m_island != island))
+			{
+				m_islandTasks[island].m_jointStart = i;
+			}
+			if ((i == jointCount - 1) || (entries[i + 1].m_island != island))
+			{
+				m_islandTasks[island].m_jointCount = i + 1;
+			}
+		}
+
+		const ndIslandEntry* const bodyEntries = &entries[jointCount];
+		const ndStartEnd bodyStartEnd(bodyCount, threadIndex, threadCount);
+		for (ndInt32 i = bodyStartEnd.m_start; i < bodyStartEnd.m_end; ++i)
+		{
+			const ndInt32 island = bodyEntries[i].m_island - 1;
+			m_islandBodies[i] = bodyEntries[i].m_index;
+			if (island >= 0)
+			{
+				if (!i || (bodyEntries[i - 1].m_island != bodyEntries[i].m_island))
+				{
+					m_islandTasks[island].m_bodyStart = i;
+				}
+				if ((i == bodyCount - 1) || (bodyEntries[i + 1].m_island != bodyEntries[i].m_island))
+				{
+					m_islandTasks[island].m_bodyCount = i + 1;
+				}
+			}
+		}
+	});
+
+	// same pass budget as the global solver, but from the island connectivity.
+	const ndInt32 iterations = m_world->GetSolverIterations();
+	ndAtomic<ndInt32> islandIterator(0);
+	auto CalculateIslandPasses = ndMakeObject::ndFunction([this, &islandIterator, &bodyArray, iterations](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(CalculateIslandPasses);
+		const ndInt32 islandCount = ndInt32(m_islandTasks.GetCount());
+		for (ndInt32 i = islandIterator.fetch_add(D_WORKER_BATCH_SIZE); i < islandCount; i = islandIterator.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((islandCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : islandCount - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				ndIslandTask& island = m_islandTasks[i + j];
+				island.m_jointCount -= island.m_jointStart;
+				island.m_bodyCount -= island.m_bodyStart;
+				ndAssert(island.m_jointCount > 0);
+				ndAssert(island.m_bodyCount > 0);
+
+				ndInt32 maxPasses = 0;
+				const ndInt32* const bodies = &m_islandBodies[island.m_bodyStart];
+				for (ndInt32 k = 0; k < island.m_bodyCount; ++k)
+				{
+					const ndInt32 conectivity = 7;
+					const ndBodyKinematic* const body = bodyArray[bodies[k]];
+					const ndInt32 passes = iterations + 2 * ndInt32(body->m_weigh) / conectivity + 2;
+					maxPasses = ndMax(maxPasses, passes);
+				}
+				island.m_maxPasses = maxPasses;
+			}
+		}
+	});
+
+	scene->ParallelExecute(ResetIslands);
+	scene->ParallelExecute(LinkJointIslands);
+	scene->ParallelExecute(CountIslands);
+
+	ndInt32 islandCount = 0;
+	const ndInt32 threadCount = scene->GetThreadCount();
+	for (ndInt32 i = 0; i < threadCount; ++i)
+	{
+		const ndInt32 count = islandStart[i];
+		islandStart[i] = islandCount;
+		islandCount += count;
+	}
+	m_islandTasks.SetCount(islandCount);
+
+	scene->ParallelExecute(EnumerateIslands);
+	scene->ParallelExecute(BuildIslandEntries);
+
+	ndCountingSort<ndIslandEntry, ndEvaluateKey0, D_MAX_BODY_RADIX_BIT>(*scene, entries, tempEntries, jointCount, nullptr, nullptr);
+	ndCountingSort<ndIslandEntry, ndEvaluateKey1, D_MAX_BODY_RADIX_BIT>(*scene, tempEntries, entries, jointCount, nullptr, nullptr);
+	ndCountingSort<ndIslandEntry, ndEvaluateKey0, D_MAX_BODY_RADIX_BIT>(*scene, &entries[jointCount], &tempEntries[jointCount], bodyCount, nullptr, nullptr);
+	ndCountingSort<ndIslandEntry, ndEvaluateKey1, D_MAX_BODY_RADIX_BIT>(*scene, &tempEntries[jointCount], &entries[jointCount], bodyCount, nullptr, nullptr);
+
+	scene->ParallelExecute(BuildIslandRuns);
+	scene->ParallelExecute(CalculateIslandPasses);
+	BuildSkeletonTasks();
+
+	ndSort<ndIslandTask, CompareIslands>(&m_islandTasks[0], islandCount, nullptr);
+}
+
+// each skeleton becomes part of the task of the island that owns its bodies, 
+// so it is solved right after the island joints and overlaps with other islands.
+// this runs before the tasks are sorted, while the island ids still index the tasks.
+void ndDynamicsUpdateIsland::BuildSkeletonTasks()
+{
+	D_TRACKTIME();
+	const ndArray<ndSkeletonContainer*>& activeSkeletons = m_world->m_activeSkeletons;
+	const ndInt32 skeletonCount = ndInt32(activeSkeletons.GetCount());
+	if (!skeletonCount)
+	{
+		return;
+	}
+
+	ndInt32* const skeletonIsland = ndAlloca(ndInt32, skeletonCount);
+	for (ndInt32 i = 0; i < skeletonCount; ++i)
+	{
+		ndInt32 island = -1;
+		const ndSkeletonContainer* const skeleton = activeSkeletons[i];
+		if (!skeleton->m_isResting)
+		{
+			const ndInt32 nodeCount = skeleton->m_nodeList.GetCount();
+			for (ndInt32 j = 0; (j < nodeCount) && (island < 0); ++j)
+			{
+				const ndBodyKinematic* const body = skeleton->m_nodesOrder[j]->m_body;
+				if (!body->m_isStatic)
+				{
+					const ndInt32 root = m_islandIndex[body->m_index];
+					island = (root >= 0) ? m_islandParent[root].load() : -1;
+				}
+			}
+			if (island >= 0)
+			{
+				m_islandTasks[island].m_skeletonCount++;
+			}
+		}
+		skeletonIsland[i] = island;
+	}
+
+	ndInt32 start = 0;
+	const ndInt32 islandCount = ndInt32(m_islandTasks.GetCount());
+	for (ndInt32 i = 0; i < islandCount; ++i)
+	{
+		ndIslandTask& island = m_islandTasks[i];
+		island.m_skeletonStart = start;
+		start += island.m_skeletonCount;
+		island.m_skeletonCount = 0;
+	}
+
+	// skeletons that are not in any island go at the end, and are solved after the islands.
+	m_freeSkeletonStart = start;
+	m_islandSkeletons.SetCount(skeletonCount);
+	for (ndInt32 i = 0; i < skeletonCount; ++i)
+	{
+		const ndInt32 index = skeletonIsland[i];
+		if (index >= 0)
+		{
+			ndIslandTask& island = m_islandTasks[index];
+			m_islandSkeletons[island.m_skeletonStart + island.m_skeletonCount] = activeSkeletons[i];
+			island.m_skeletonCount++;
+		}
+		else
+		{
+			m_islandSkeletons[start] = activeSkeletons[i];
+			start++;
+		}
+	}
+}
+
+void ndDynamicsUpdateIsland::AccumulateBodyForce(ndInt32 bodyIndex)
+{
+	const ndVector zero(ndVector::m_zero);
+	ndVector force(zero);
+	ndVector torque(zero);
+
+	const ndInt32* const bodyJointIndex = &m_jointForcesIndex[0];
+	const ndJacobian* const jointInternalForces = &m_tempInternalForces[0];
+	const ndJointBodyPairIndex* const jointBodyPairIndexBuffer = &m_jointBodyPairIndexBuffer[0];
+
+	const ndInt32 startIndex = bodyJointIndex[bodyIndex];
+	const ndInt32 count = bodyJointIndex[bodyIndex + 1] - startIndex;
+	for (ndInt32 k = 0; k < count; ++k)
+	{
+		const ndInt32 index = jointBodyPairIndexBuffer[startIndex + k].m_joint;
+		force += jointInternalForces[index].m_linear;
+		torque += jointInternalForces[index].m_angular;
+	}
+	m_internalForces[bodyIndex].m_linear = force;
+	m_internalForces[bodyIndex].m_angular = torque;
+}
+
+ndFloat32 ndDynamicsUpdateIsland::GetIslandTolerance() const
+{
+	// a zero world tolerance never converges, so the island runs all its passes
+	const ndFloat32 tolerance = m_world->GetSolverTolerance();
+	return tolerance * tolerance;
+}
+
+void ndDynamicsUpdateIsland::SolveIsland(ndIslandTask& island)
+{
+	const ndArray<ndConstraint*>& jointArray = m_world->GetScene()->GetActiveContactArray();
+	const ndInt32* const joints = &m_islandJoints[island.m_jointStart];
+	const ndInt32* const bodies = &m_islandBodies[island.m_bodyStart];
+
+	ndInt32 passes = 0;
+	const ndFloat32 tolerance = GetIslandTolerance();
+	ndFloat32 residual = ndFloat32(1.0e10f);
+	while ((passes < island.m_maxPasses) && (residual >= tolerance))
+	{
+		residual = ndFloat32(0.0f);
+		for (ndInt32 i = 0; i < island.m_jointCount; ++i)
+		{
+			const ndInt32 index = joints[i];
+			residual = ndMax(residual, SolveJointForce(jointArray[index], index));
+		}
+		for (ndInt32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			AccumulateBodyForce(bodies[i]);
+		}
+		passes++;
+	}
+	island.m_stepPasses = passes;
+	island.m_passes += passes;
+	island.m_residual = residual;
+	SolveIslandSkeletons(island);
+}
+
+void ndDynamicsUpdateIsland::SolveIslandSkeletons(const ndIslandTask& island)
+{
+	ndJacobian* const internalForces = &GetInternalForces()[0];
+	ndSkeletonContainer** const skeletons = &m_islandSkeletons[island.m_skeletonStart];
+	for (ndInt32 i = 0; i < island.m_skeletonCount; ++i)
+	{
+		skeletons[i]->CalculateReactionForces(internalForces);
+	}
+}
+
+void ndDynamicsUpdateIsland::UpdateFreeSkeletons()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndInt32 skeletonCount = ndInt32(m_islandSkeletons.GetCount());
+
+	ndAtomic<ndInt32> iterator(m_freeSkeletonStart);
+	auto UpdateFreeSkeletons = ndMakeObject::ndFunction([this, &iterator, skeletonCount](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(UpdateFreeSkeletons);
+		ndJacobian* const internalForces = &GetInternalForces()[0];
+		for (ndInt32 i = iterator++; i < skeletonCount; i = iterator++)
+		{
+			m_islandSkeletons[i]->CalculateReactionForces(internalForces);
+		}
+	});
+
+	if (m_freeSkeletonStart < skeletonCount)
+	{
+		scene->ParallelExecute(UpdateFreeSkeletons);
+	}
+}
+
+void ndDynamicsUpdateIsland::SolveLargeIsland(ndIslandTask& island)
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	ndFloat32 residualArray[D_MAX_THREADS_COUNT];
+	ndAtomic<ndInt32> iterator0(0);
+	auto SolveIslandJoints = ndMakeObject::ndFunction([this, &iterator0, &jointArray, &island, &residualArray](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(SolveIslandJoints);
+		ndFloat32 residual = ndFloat32(0.0f);
+		const ndInt32* const joints = &m_islandJoints[island.m_jointStart];
+		const ndInt32 jointCount = island.m_jointCount;
+		for (ndInt32 i = iterator0.fetch_add(D_WORKER_BATCH_SIZE); i < jointCount; i = iterator0.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((jointCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : jointCount - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				const ndInt32 index = joints[i + j];
+				residual = ndMax(residual, SolveJointForce(jointArray[index], index));
+			}
+		}
+		residualArray[threadIndex] = residual;
+	});
+
+	ndAtomic<ndInt32> iterator1(0);
+	auto AccumulateIslandForces = ndMakeObject::ndFunction([this, &iterator1, &island](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(AccumulateIslandForces);
+		const ndInt32* const bodies = &m_islandBodies[island.m_bodyStart];
+		const ndInt32 bodyCount = island.m_bodyCount;
+		for (ndInt32 i = iterator1.fetch_add(D_WORKER_BATCH_SIZE); i < bodyCount; i = iterator1.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((bodyCount - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : bodyCount - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				AccumulateBodyForce(bodies[i + j]);
+			}
+		}
+	});
+
+	const ndInt32 threadCount = scene->GetThreadCount();
+	ndInt32 passes = 0;
+	const ndFloat32 tolerance = GetIslandTolerance();
+	ndFloat32 residual = ndFloat32(1.0e10f);
+	while ((passes < island.m_maxPasses) && (residual >= tolerance))
+	{
+		iterator0 = 0;
+		iterator1 = 0;
+		for (ndInt32 i = 0; i < threadCount; ++i)
+		{
+			residualArray[i] = ndFloat32(0.0f);
+		}
+		scene->ParallelExecute(SolveIslandJoints);
+		scene->ParallelExecute(AccumulateIslandForces);
+
+		residual = ndFloat32(0.0f);
+		for (ndInt32 i = 0; i < threadCount; ++i)
+		{
+			residual = ndMax(residual, residualArray[i]);
+		}
+		passes++;
+	}
+	island.m_stepPasses = passes;
+	island.m_passes += passes;
+	island.m_residual = residual;
+
+	// the skeletons of this island are spread across the threads too
+	ndAtomic<ndInt32> iterator2(0);
+	auto SolveIslandSkeletons = ndMakeObject::ndFunction([this, &iterator2, &island](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(SolveIslandSkeletons);
+		ndJacobian* const internalForces = &GetInternalForces()[0];
+		ndSkeletonContainer** const skeletons = &m_islandSkeletons[island.m_skeletonStart];
+		for (ndInt32 i = iterator2++; i < island.m_skeletonCount; i = iterator2++)
+		{
+			skeletons[i]->CalculateReactionForces(internalForces);
+		}
+	});
+
+	if (island.m_skeletonCount)
+	{
+		scene->ParallelExecute(SolveIslandSkeletons);
+	}
+}
+
+void ndDynamicsUpdateIsland::CalculateJointsForce()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndInt32 islandCount = ndInt32(m_islandTasks.GetCount());
+
+	// large islands are split across all threads, one at a time.
+	ndInt32 smallIslandStart = 0;
+	if (scene->GetThreadCount() > 1)
+	{
+		for (; (smallIslandStart < islandCount) && (m_islandTasks[smallIslandStart].m_jointCount >= D_ISLAND_SPLIT_JOINT_COUNT); ++smallIslandStart)
+		{
+			SolveLargeIsland(m_islandTasks[smallIslandStart]);
+		}
+	}
+
+	// the rest are batched, each thread takes the next island.
+	ndAtomic<ndInt32> iterator(smallIslandStart);
+	auto SolveSmallIslands = ndMakeObject::ndFunction([this, &iterator, islandCount](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(SolveSmallIslands);
+		for (ndInt32 i = iterator.fetch_add(1); i < islandCount; i = iterator.fetch_add(1))
+		{
+			SolveIsland(m_islandTasks[i]);
+		}
+	});
+
+	if (smallIslandStart < islandCount)
+	{
+		scene->ParallelExecute(SolveSmallIslands);
+	}
+
+	// the stats report the island that needed the most passes.
+	ndInt32 budget = 0;
+	ndInt32 passes = 0;
+	ndFloat32 residual = ndFloat32(0.0f);
+	for (ndInt32 i = 0; i < islandCount; ++i)
+	{
+		const ndIslandTask& island = m_islandTasks[i];
+		budget = ndMax(budget, island.m_maxPasses);
+		passes = ndMax(passes, island.m_stepPasses);
+		residual = ndMax(residual, island.m_residual);
+	}
+	AddSolverPassBudget(budget);
+	AddSolverPasses(passes, residual);
+}
+
+void ndDynamicsUpdateIsland::CalculateForces()
+{
+	D_TRACKTIME();
+	if (m_world->GetScene()->GetActiveContactArray().GetCount())
+	{
+		m_firstPassCoef = ndFloat32(0.0f);
+
+		BuildIslandTasks();
+		InitSkeletons();
+		for (ndInt32 step = 0; step < 4; step++)
+		{
+			CalculateJointsAcceleration();
+			CalculateJointsForce();
+			UpdateFreeSkeletons();
+			IntegrateBodiesVelocity();
+		}
+		UpdateForceFeedback();
+	}
+}
+
+void ndDynamicsUpdateIsland::Update()
+{
+	D_TRACKTIME();
+	m_timestep = m_world->GetScene()->GetTimestep();
+
+	BuildIsland();
+	IntegrateUnconstrainedBodies();
+	InitWeights();
+	InitBodyArray();
+	InitJacobianMatrix();
+	CalculateForces();
+	IntegrateBodies();
+	DetermineSleepStates();
+}
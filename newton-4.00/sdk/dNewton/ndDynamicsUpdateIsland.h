@@ -0,0 +1,151 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef __ND_WORLD_DYNAMICS_UPDATE_ISLAND_H__
+#define __ND_WORLD_DYNAMICS_UPDATE_ISLAND_H__
+
+#include "ndNewtonStdafx.h"
+#include "ndDynamicsUpdate.h"
+
+// islands with at least this many joints are solved by all threads, 
+// smaller islands are batched and each one is solved by a single thread.
+#define D_ISLAND_SPLIT_JOINT_COUNT	256
+
+// jacobi solver that runs each independent island as a task with 
+// its own pass budget, so islands that converge early, or are at 
+// rest, do not pay the passes needed by the worst island.
+D_MSV_NEWTON_ALIGN_32
+class ndDynamicsUpdateIsland: public ndDynamicsUpdate
+{
+	public:
+	class ndIslandTask
+	{
+		public:
+		ndInt32 m_jointStart;
+		ndInt32 m_jointCount;
+		ndInt32 m_bodyStart;
+		ndInt32 m_bodyCount;
+		ndInt32 m_skeletonStart;
+		ndInt32 m_skeletonCount;
+		ndInt32 m_maxPasses;
+		ndInt32 m_stepPasses;
+		ndInt32 m_passes;
+		ndFloat32 m_residual;
+	};
+
+	ndDynamicsUpdateIsland(ndWorld* const world);
+	virtual ~ndDynamicsUpdateIsland();
+
+	virtual const char* GetStringId() const;
+	const ndArray<ndIslandTask>& GetIslandTasks() const;
+	ndInt32 GetFreeSkeletonCount() const;
+
+	protected:
+	virtual void Update();
+
+	private:
+	class ndIslandEntry
+	{
+		public:
+		ndInt32 m_island;
+		ndInt32 m_index;
+	};
+
+	void BuildIslandTasks();
+	void BuildSkeletonTasks();
+	void CalculateForces();
+	void UpdateFreeSkeletons();
+	void CalculateJointsForce();
+	void SolveIsland(ndIslandTask& island);
+	void SolveLargeIsland(ndIslandTask& island);
+	void SolveIslandSkeletons(const ndIslandTask& island);
+	void AccumulateBodyForce(ndInt32 bodyIndex);
+	ndFloat32 GetIslandTolerance() const;
+	ndInt32 FindIslandRoot(ndInt32 bodyIndex);
+	void LinkIslands(ndInt32 bodyIndex0, ndInt32 bodyIndex1);
+
+	ndArray<ndIslandTask> m_islandTasks;
+	ndArray<ndAtomic<ndInt32>> m_islandParent;
+	ndArray<ndInt32> m_islandJoints;
+	ndArray<ndInt32> m_islandBodies;
+	ndArray<ndInt32> m_islandIndex;
+	ndArray<ndSkeletonContainer*> m_islandSkeletons;
+	ndInt32 m_freeSkeletonStart;
+} D_GCC_NEWTON_ALIGN_32;
+
+inline const ndArray<ndDynamicsUpdateIsland::ndIslandTask>& ndDynamicsUpdateIsland::GetIslandTasks() const
+{
+	return m_islandTasks;
+}
+
+// skeletons of the last sub step solved after the island tasks
+inline ndInt32 ndDynamicsUpdateIsland::GetFreeSkeletonCount() const
+{
+	return ndInt32(m_islandSkeletons.GetCount()) - m_freeSkeletonStart;
+}
+
+// path halving, a failed swap only means that another 
+// thread already moved the node closer to its root.
+inline ndInt32 ndDynamicsUpdateIsland::FindIslandRoot(ndInt32 bodyIndex)
+{
+	ndArray<ndAtomic<ndInt32>>& parent = m_islandParent;
+	ndInt32 node = bodyIndex;
+	ndInt32 nodeParent = parent[node].load();
+	while (nodeParent != node)
+	{
+		const ndInt32 grandParent = parent[nodeParent].load();
+		if (grandParent != nodeParent)
+		{
+			ndInt32 expected = nodeParent;
+			parent[node].compare_exchange_weak(expected, grandParent);
+		}
+		node = grandParent;
+		nodeParent = parent[node].load();
+	}
+	return node;
+}
+
+// the larger root is linked to the smaller one, so parents only 
+// decrease and the root is always the lowest body index of the island.
+inline void ndDynamicsUpdateIsland::LinkIslands(ndInt32 bodyIndex0, ndInt32 bodyIndex1)
+{
+	ndArray<ndAtomic<ndInt32>>& parent = m_islandParent;
+	ndInt32 root0 = FindIslandRoot(bodyIndex0);
+	ndInt32 root1 = FindIslandRoot(bodyIndex1);
+	while (root0 != root1)
+	{
+		if (root0 < root1)
+		{
+			ndSwap(root0, root1);
+		}
+		ndInt32 expected = root0;
+		if (parent[root0].compare_exchange_weak(expected, root1))
+		{
+			break;
+		}
+		root0 = FindIslandRoot(root0);
+		root1 = FindIslandRoot(root1);
+	}
+}
+
+#endif
+
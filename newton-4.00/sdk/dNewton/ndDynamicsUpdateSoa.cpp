@@ -521,7 +521,16 @@ void ndDynamicsUpdateSoa::GetJacobianDerivatives(ndConstraint* const joint)
 	constraintParam.m_rowsCount = 0;
 	constraintParam.m_timestep = m_timestep;
 	constraintParam.m_invTimestep = m_invTimestep;
-	joint->JacobianDerivative(constraintParam);
+	ndJointBilateralConstraint* const bilateralJoint = joint->GetAsBilateral();
+	if (bilateralJoint)
+	{
+		// resting joints may reuse the rows of the last sub step
+		bilateralJoint->CachedJacobianDerivative(constraintParam);
+	}
+	else
+	{
+		joint->JacobianDerivative(constraintParam);
+	}
 	const ndInt32 dof = constraintParam.m_rowsCount;
 	ndAssert(dof <= joint->m_rowCount);
 
@@ -609,12 +618,14 @@ void ndDynamicsUpdateSoa::InitJacobianMatrix()
 	ndBodyKinematic** const bodyArray = &scene->GetActiveBodyArray()[0];
 	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
+	const ndFloat32 warmStart = scene->GetContactWarmStart();
+
 	ndAtomic<ndInt32> iterator(0);
-	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &iterator, &jointArray](ndInt32, ndInt32)
+	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &iterator, &jointArray, warmStart](ndInt32, ndInt32)
 	{
 		D_TRACKTIME_NAMED(InitJacobianMatrix);
 		ndJacobian* const internalForces = &GetTempInternalForces()[0];
-		auto BuildJacobianMatrix = [this, &internalForces](ndConstraint* const joint, ndInt32 jointIndex)
+		auto BuildJacobianMatrix = [this, &internalForces, warmStart](ndConstraint* const joint, ndInt32 jointIndex)
 		{
 			ndAssert(joint->GetBody0());
 			ndAssert(joint->GetBody1());
@@ -664,7 +675,7 @@ void ndDynamicsUpdateSoa::InitJacobianMatrix()
 				ndAssert(rhs->m_jointFeebackForce);
 				const ndFloat32 force = rhs->m_jointFeebackForce->GetInitialGuess();
 
-				rhs->m_force = isBilateral ? ndClamp(force, rhs->m_lowerBoundFrictionCoefficent, rhs->m_upperBoundFrictionCoefficent) : force;
+				rhs->m_force = isBilateral ? ndClamp(force, rhs->m_lowerBoundFrictionCoefficent, rhs->m_upperBoundFrictionCoefficent) : force * warmStart;
 				rhs->m_maxImpact = ndFloat32(0.0f);
 
 				const ndJacobian& JtM0 = row->m_Jt.m_jacobianM0;
@@ -1116,13 +1127,14 @@ void ndDynamicsUpdateSoa::InitSkeletons()
 		for (ndInt32 i = iterator++; i < count; i = iterator++)
 		{
 			ndSkeletonContainer* const skeleton = activeSkeletons[i];
-			skeleton->InitMassMatrix(&leftHandSide[0], &rightHandSide[0]);
+			skeleton->InitMassMatrix(&leftHandSide[0], &rightHandSide[0], true);
 		}
 	});
 
 	if (activeSkeletons.GetCount())
 	{
 		scene->ParallelExecute(InitSkeletons);
+		InitLargeLoopSkeletons();
 	}
 }
 
@@ -1316,8 +1328,9 @@ void ndDynamicsUpdateSoa::CalculateJointsForce()
 	ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
 	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
+	ndFloat32 residualArray[D_MAX_THREADS_COUNT];
 	ndAtomic<ndInt32> iterator0(0);
-	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &iterator0, &jointArray](ndInt32, ndInt32)
+	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &iterator0, &jointArray, &residualArray](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(CalculateJointsForce);
 		const ndInt32 jointCount = ndInt32 (jointArray.GetCount());
@@ -1551,6 +1564,7 @@ void ndDynamicsUpdateSoa::CalculateJointsForce()
 					}
 				}
 			}
+			const ndVector residual(accNorm & mask);
 
 			forceM0.m_linear.m_x = zero;
 			forceM0.m_linear.m_y = zero;
@@ -1648,8 +1662,10 @@ void ndDynamicsUpdateSoa::CalculateJointsForce()
 					outBody1.m_angular = force1[i].m_angular;
 				}
 			}
+			return residual.GetMax().GetScalar();
 		};
 
+		ndFloat32 residual = ndFloat32(0.0f);
 		const ndInt32 mask = -ndInt32(D_SSE_WORK_GROUP);
 		const ndInt32 soaJointCount = ((jointCount + D_SSE_WORK_GROUP - 1) & mask) / D_SSE_WORK_GROUP;
 		for (ndInt32 i = iterator0.fetch_add(D_WORKER_BATCH_SIZE); i < soaJointCount; i = iterator0.fetch_add(D_WORKER_BATCH_SIZE))
@@ -1658,9 +1674,10 @@ void ndDynamicsUpdateSoa::CalculateJointsForce()
 			for (ndInt32 j = 0; j < maxSpan; ++j)
 			{
 				const ndInt32 m = i + j;
-				JointForce(m, &soaMassMatrix[soaJointRows[m]]);
+				residual = ndMax(residual, JointForce(m, &soaMassMatrix[soaJointRows[m]]));
 			}
 		}
+		residualArray[threadIndex] = residual;
 	});
 
 	ndAtomic<ndInt32> iterator1(0);
@@ -1700,12 +1717,24 @@ void ndDynamicsUpdateSoa::CalculateJointsForce()
 		}
 	});
 
+	AddSolverPassBudget(ndInt32(passes));
+	const ndInt32 threadCount = scene->GetThreadCount();
 	for (ndUnsigned32 i = 0; i < passes; ++i)
 	{
 		iterator0 = 0;
 		iterator1 = 0;
 		scene->ParallelExecute(CalculateJointsForce);
 		scene->ParallelExecute(ApplyJacobianAccumulatePartialForces);
+
+		ndFloat32 residual = ndFloat32(0.0f);
+		for (ndInt32 j = 0; j < threadCount; ++j)
+		{
+			residual = ndMax(residual, residualArray[j]);
+		}
+		if (SolverPassConverged(residual))
+		{
+			break;
+		}
 	}
 }
 
@@ -29,6 +29,7 @@
 
 #include <ndNewtonStdafx.h>
 #include <ndWorld.h>
+#include <ndSensor.h>
 #include <ndJointList.h>
 #include <ndWorldScene.h>
 #include <ndConstraint.h>
@@ -42,6 +43,8 @@
 #include <ndDynamicsUpdate.h>
 #include <ndSkeletonContainer.h>
 #include <ndDynamicsUpdateSoa.h>
+#include <ndDynamicsUpdateColored.h>
+#include <ndDynamicsUpdateIsland.h>
 
 #include <dJoints/ndJointGear.h>
 #include <dJoints/ndJointHinge.h>
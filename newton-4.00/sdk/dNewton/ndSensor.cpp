@@ -0,0 +1,185 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndNewtonStdafx.h"
+#include "ndWorld.h"
+#include "ndSensor.h"
+
+ndSensor::ndSensor(ndBodyKinematic* const body, const ndMatrix& localMatrix, ndFloat32 maxRange)
+	:ndClassAlloc()
+	,m_localMatrix(localMatrix)
+	,m_beams()
+	,m_ranges()
+	,m_hits()
+	,m_rays()
+	,m_body(body)
+	,m_worldNode(nullptr)
+	,m_maxRange(ndMax(maxRange, ndFloat32(1.0e-3f)))
+	,m_enabled(true)
+{
+}
+
+ndSensor::~ndSensor()
+{
+	ndAssert(!m_worldNode);
+}
+
+ndBodyKinematic* ndSensor::GetBody() const
+{
+	return m_body;
+}
+
+ndMatrix ndSensor::GetGlobalMatrix() const
+{
+	return m_body ? m_localMatrix * m_body->GetMatrix() : m_localMatrix;
+}
+
+ndFloat32 ndSensor::GetMaxRange() const
+{
+	return m_maxRange;
+}
+
+ndInt32 ndSensor::GetBeamCount() const
+{
+	return ndInt32(m_beams.GetCount());
+}
+
+const ndArray<ndVector>& ndSensor::GetBeams() const
+{
+	return m_beams;
+}
+
+const ndArray<ndFloat32>& ndSensor::GetRanges() const
+{
+	return m_ranges;
+}
+
+const ndArray<ndRayCastHit>& ndSensor::GetHits() const
+{
+	return m_hits;
+}
+
+bool ndSensor::GetEnabled() const
+{
+	return m_enabled;
+}
+
+void ndSensor::SetEnabled(bool state)
+{
+	m_enabled = state;
+}
+
+void ndSensor::SetBeamPattern(const ndVector* const directions, ndInt32 count)
+{
+	m_beams.SetCount(0);
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		const ndVector dir(directions[i] & ndVector::m_triplexMask);
+		m_beams.PushBack(dir.Normalize());
+	}
+	m_ranges.SetCount(count);
+	m_hits.SetCount(count);
+	m_rays.SetCount(count);
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		m_ranges[i] = m_maxRange;
+		m_hits[i].m_body = nullptr;
+		m_hits[i].m_shapeInstance = nullptr;
+		m_hits[i].m_param = ndFloat32(1.2f);
+	}
+}
+
+void ndSensor::SetLidarPattern(ndInt32 channels, ndInt32 columns, ndFloat32 minPitch, ndFloat32 maxPitch)
+{
+	ndArray<ndVector> directions;
+	const ndFloat32 pitchStep = (channels > 1) ? (maxPitch - minPitch) / ndFloat32(channels - 1) : ndFloat32(0.0f);
+	const ndFloat32 yawStep = ndFloat32(2.0f) * ndPi / ndFloat32(ndMax(columns, 1));
+	for (ndInt32 i = 0; i < columns; ++i)
+	{
+		const ndFloat32 yaw = yawStep * ndFloat32(i);
+		for (ndInt32 j = 0; j < channels; ++j)
+		{
+			const ndFloat32 pitch = minPitch + pitchStep * ndFloat32(j);
+			directions.PushBack(ndVector(ndCos(pitch) * ndCos(yaw), ndSin(pitch), ndCos(pitch) * ndSin(yaw), ndFloat32(0.0f)));
+		}
+	}
+	SetBeamPattern(directions.GetCount() ? &directions[0] : nullptr, ndInt32(directions.GetCount()));
+}
+
+void ndSensor::SetDepthCameraPattern(ndInt32 width, ndInt32 height, ndFloat32 verticalFov)
+{
+	ndArray<ndVector> directions;
+	const ndFloat32 halfHeight = ndTan(verticalFov * ndFloat32(0.5f));
+	const ndFloat32 halfWidth = halfHeight * ndFloat32(width) / ndFloat32(ndMax(height, 1));
+	for (ndInt32 i = 0; i < height; ++i)
+	{
+		const ndFloat32 y = halfHeight * (ndFloat32(1.0f) - ndFloat32(2.0f) * (ndFloat32(i) + ndFloat32(0.5f)) / ndFloat32(height));
+		for (ndInt32 j = 0; j < width; ++j)
+		{
+			const ndFloat32 z = halfWidth * (ndFloat32(2.0f) * (ndFloat32(j) + ndFloat32(0.5f)) / ndFloat32(width) - ndFloat32(1.0f));
+			directions.PushBack(ndVector(ndFloat32(1.0f), y, z, ndFloat32(0.0f)));
+		}
+	}
+	SetBeamPattern(directions.GetCount() ? &directions[0] : nullptr, ndInt32(directions.GetCount()));
+}
+
+void ndSensor::OnScan(ndWorld* const)
+{
+}
+
+void ndSensor::Scan(ndWorld* const world, ndScene* const scene)
+{
+	D_TRACKTIME();
+	const ndInt32 count = ndInt32(m_beams.GetCount());
+	if (!m_enabled || !count)
+	{
+		return;
+	}
+
+	const ndMatrix matrix(GetGlobalMatrix());
+	ndAtomic<ndInt32> iterator0(0);
+	auto CalculateRays = ndMakeObject::ndFunction([this, &iterator0, &matrix, count](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(CalculateRays);
+		const ndVector origin(matrix.m_posit);
+		for (ndInt32 i = iterator0.fetch_add(D_WORKER_BATCH_SIZE); i < count; i = iterator0.fetch_add(D_WORKER_BATCH_SIZE))
+		{
+			const ndInt32 maxSpan = ((count - i) >= D_WORKER_BATCH_SIZE) ? D_WORKER_BATCH_SIZE : count - i;
+			for (ndInt32 j = 0; j < maxSpan; ++j)
+			{
+				ndRayCastQuery& ray = m_rays[i + j];
+				ray.m_origin = origin;
+				ray.m_dest = origin + matrix.RotateVector(m_beams[i + j]).Scale(m_maxRange);
+				ray.m_ignoreBody = m_body;
+			}
+		}
+	});
+	scene->ParallelExecute(CalculateRays);
+
+	scene->RayCastBatch(&m_rays[0], &m_hits[0], count);
+
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		m_ranges[i] = m_hits[i].m_body ? m_hits[i].m_param * m_maxRange : m_maxRange;
+	}
+	OnScan(world);
+}
@@ -0,0 +1,82 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_SENSOR_H__
+#define __ND_SENSOR_H__
+
+#include "ndNewtonStdafx.h"
+
+class ndWorld;
+
+// a ray sensor, lidar or depth camera, attached to a body or fixed in the world.
+// the world casts all the beams in one batch at the end of each update, after the 
+// transforms are updated and before PostUpdate, the ranges are read after Sync.
+D_MSV_NEWTON_ALIGN_32
+class ndSensor: public ndClassAlloc
+{
+	public:
+	D_NEWTON_API ndSensor(ndBodyKinematic* const body, const ndMatrix& localMatrix, ndFloat32 maxRange);
+	D_NEWTON_API virtual ~ndSensor();
+
+	// spinning lidar, channels rows of beams between minPitch and maxPitch, 
+	// columns beams around the x axis. beams of the same column are consecutive.
+	D_NEWTON_API void SetLidarPattern(ndInt32 channels, ndInt32 columns, ndFloat32 minPitch, ndFloat32 maxPitch);
+
+	// depth camera looking along the x axis, row major pixels, 
+	// the ranges are distances along each pixel beam.
+	D_NEWTON_API void SetDepthCameraPattern(ndInt32 width, ndInt32 height, ndFloat32 verticalFov);
+
+	// arbitrary beam directions in sensor space
+	D_NEWTON_API void SetBeamPattern(const ndVector* const directions, ndInt32 count);
+
+	D_NEWTON_API ndBodyKinematic* GetBody() const;
+	D_NEWTON_API ndMatrix GetGlobalMatrix() const;
+	D_NEWTON_API ndFloat32 GetMaxRange() const;
+	D_NEWTON_API ndInt32 GetBeamCount() const;
+	D_NEWTON_API const ndArray<ndVector>& GetBeams() const;
+
+	// distance to the first hit of each beam, maxRange for a miss
+	D_NEWTON_API const ndArray<ndFloat32>& GetRanges() const;
+	D_NEWTON_API const ndArray<ndRayCastHit>& GetHits() const;
+
+	D_NEWTON_API bool GetEnabled() const;
+	D_NEWTON_API void SetEnabled(bool state);
+
+	protected:
+	D_NEWTON_API virtual void OnScan(ndWorld* const world);
+
+	private:
+	void Scan(ndWorld* const world, ndScene* const scene);
+
+	ndMatrix m_localMatrix;
+	ndArray<ndVector> m_beams;
+	ndArray<ndFloat32> m_ranges;
+	ndArray<ndRayCastHit> m_hits;
+	ndArray<ndRayCastQuery> m_rays;
+	ndBodyKinematic* m_body;
+	ndSharedList<ndSensor>::ndNode* m_worldNode;
+	ndFloat32 m_maxRange;
+	bool m_enabled;
+
+	friend class ndWorld;
+} D_GCC_NEWTON_ALIGN_32;
+
+#endif
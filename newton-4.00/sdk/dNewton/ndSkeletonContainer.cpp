@@ -30,6 +30,40 @@
 
 #define D_MAX_SKELETON_LCP_VALUE (D_LCP_MAX_VALUE * ndFloat32 (0.25f))
 
+// loop systems with this many auxiliary rows are factored by all the worker threads
+#define D_SKELETON_PARALLEL_LOOP_ROWS	64
+#define D_SKELETON_CHOLESKY_BLOCK		16
+#define D_SKELETON_LCP_BLOCK			8
+
+template <typename Function>
+static inline void ndLoopParallelExecute(ndThreadPool* const threadPool, const Function& function)
+{
+	if (threadPool)
+	{
+		threadPool->ParallelExecute(function);
+	}
+	else
+	{
+		function(0, 1);
+	}
+}
+
+static inline ndFloat32 ndLoopDotProduct(ndInt32 size, const ndFloat32* const a, const ndFloat32* const b)
+{
+	ndInt32 i = 0;
+	ndVector acc(ndVector::m_zero);
+	for (; (i + 4) <= size; i += 4)
+	{
+		acc = acc.MulAdd(ndVector(&a[i]), ndVector(&b[i]));
+	}
+	ndFloat32 dot = acc.AddHorizontal().GetScalar();
+	for (; i < size; ++i)
+	{
+		dot += a[i] * b[i];
+	}
+	return dot;
+}
+
 ndSkeletonContainer::ndNode::ndNode()
 	:m_body(nullptr)
 	,m_joint(nullptr)
@@ -619,89 +653,97 @@ void ndSkeletonContainer::CalculateBufferSizeInBytes()
 	m_auxiliaryMemoryBuffer.SetCount((size + 1024) & -0x10);
 }
 
-void ndSkeletonContainer::CalculateLoopMassMatrixCoefficients(ndFloat32* const diagDamp)
+void ndSkeletonContainer::CalculateLoopMassMatrixCoefficients(ndThreadPool* const threadPool, ndFloat32* const diagDamp)
 {
 	D_TRACKTIME();
-	const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
+	ndAtomic<ndInt32> iterator(0);
+	auto CalculateCoefficients = ndMakeObject::ndFunction([this, &iterator, diagDamp](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(CalculateCoefficients);
+		const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
 
-	ndJacobian tempArray[3];
-	tempArray[0].m_linear = ndVector::m_zero;
-	tempArray[0].m_angular = ndVector::m_zero;
-	for (ndInt32 index = 0; index < m_auxiliaryRowCount; ++index) 
-	{
-		const ndInt32 ii = m_matrixRowsIndex[primaryCount + index];
-		const ndLeftHandSide* const row_i = &m_leftHandSide[ii];
-		const ndRightHandSide* const rhs_i = &m_rightHandSide[ii];
-		const ndJacobian JMinvM0(row_i->m_JMinv.m_jacobianM0);
-		const ndJacobian JMinvM1(row_i->m_JMinv.m_jacobianM1);
-		const ndVector element(
-			JMinvM0.m_linear * row_i->m_Jt.m_jacobianM0.m_linear + JMinvM0.m_angular * row_i->m_Jt.m_jacobianM0.m_angular +
-			JMinvM1.m_linear * row_i->m_Jt.m_jacobianM1.m_linear + JMinvM1.m_angular * row_i->m_Jt.m_jacobianM1.m_angular);
-
-		// I know I am doubling the matrix regularizer, but this makes the solution more robust.
-		ndFloat32* const matrixRow11 = &m_massMatrix11[m_auxiliaryRowCount * index];
-		ndFloat32 diagonal = element.AddHorizontal().GetScalar() + rhs_i->m_diagDamp;
-		matrixRow11[index] = diagonal + rhs_i->m_diagDamp;
-		diagDamp[index] = matrixRow11[index] * ndFloat32(4.0e-3f);
-
-		const ndInt32 m0_i = m_pairs[primaryCount + index].m_m0;
-		const ndInt32 m1_i = m_pairs[primaryCount + index].m_m1;
-
-		tempArray[1] = row_i->m_JMinv.m_jacobianM0;
-		tempArray[2] = row_i->m_JMinv.m_jacobianM1;
-		for (ndInt32 j = index + 1; j < m_auxiliaryRowCount; ++j)  
-		{
-			const ndInt32 jj = m_matrixRowsIndex[primaryCount + j];
-			const ndLeftHandSide* const row_j = &m_leftHandSide[jj];
-
-			const ndInt32 k = primaryCount + j;
-			const ndInt32 m0_j = m_pairs[k].m_m0;
-			const ndInt32 m1_j = m_pairs[k].m_m1;
-
-			const ndInt32 index_m0_j_m0_i_mask = -(m0_j == m0_i);
-			const ndInt32 index_m0_j_m1_i_mask = -(m0_j == m1_i);
-			const ndInt32 index_m1_j_m0_i_mask = -(m1_j == m0_i);
-			const ndInt32 index_m1_j_m1_i_mask = -(m1_j == m1_i);
-
-			const ndInt32 index_m0_j = (index_m0_j_m0_i_mask & 1) | (index_m0_j_m1_i_mask & 2);
-			const ndInt32 index_m1_j = (index_m1_j_m0_i_mask & 1) | (index_m1_j_m1_i_mask & 2);
-
-			ndVector acc(row_j->m_Jt.m_jacobianM0.m_linear * tempArray[index_m0_j].m_linear);
-			acc = acc.MulAdd(row_j->m_Jt.m_jacobianM0.m_angular, tempArray[index_m0_j].m_angular);
-			acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_linear, tempArray[index_m1_j].m_linear);
-			acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_angular, tempArray[index_m1_j].m_angular);
-			acc = acc.AddHorizontal();
-
-			ndFloat32 offDiagValue = acc.GetScalar();
-			matrixRow11[j] = offDiagValue;
-			m_massMatrix11[j * m_auxiliaryRowCount + index] = offDiagValue;
-		}
+		ndJacobian tempArray[3];
+		tempArray[0].m_linear = ndVector::m_zero;
+		tempArray[0].m_angular = ndVector::m_zero;
 
-		ndFloat32* const matrixRow10 = &m_massMatrix10[primaryCount * index];
-		for (ndInt32 j = 0; j < primaryCount; ++j)  
+		// rows only write their upper half and its mirrored column, so they never overlap
+		for (ndInt32 index = iterator++; index < m_auxiliaryRowCount; index = iterator++)
 		{
-			const ndInt32 jj = m_matrixRowsIndex[j];
-			const ndLeftHandSide* const row_j = &m_leftHandSide[jj];
-
-			const ndInt32 m0_j = m_pairs[j].m_m0;
-			const ndInt32 m1_j = m_pairs[j].m_m1;
-
-			const ndInt32 index_m0_j_m0_i_mask = -(m0_j == m0_i);
-			const ndInt32 index_m0_j_m1_i_mask = -(m0_j == m1_i);
-			const ndInt32 index_m1_j_m0_i_mask = -(m1_j == m0_i);
-			const ndInt32 index_m1_j_m1_i_mask = -(m1_j == m1_i);
-
-			const ndInt32 index_m0_j = (index_m0_j_m0_i_mask & 1) | (index_m0_j_m1_i_mask & 2);
-			const ndInt32 index_m1_j = (index_m1_j_m0_i_mask & 1) | (index_m1_j_m1_i_mask & 2);
-
-			ndVector acc(row_j->m_Jt.m_jacobianM0.m_linear * tempArray[index_m0_j].m_linear);
-			acc = acc.MulAdd(row_j->m_Jt.m_jacobianM0.m_angular, tempArray[index_m0_j].m_angular);
-			acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_linear, tempArray[index_m1_j].m_linear);
-			acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_angular, tempArray[index_m1_j].m_angular);
-			acc = acc.AddHorizontal();
-			matrixRow10[j] = acc.GetScalar();
+			const ndInt32 ii = m_matrixRowsIndex[primaryCount + index];
+			const ndLeftHandSide* const row_i = &m_leftHandSide[ii];
+			const ndRightHandSide* const rhs_i = &m_rightHandSide[ii];
+			const ndJacobian JMinvM0(row_i->m_JMinv.m_jacobianM0);
+			const ndJacobian JMinvM1(row_i->m_JMinv.m_jacobianM1);
+			const ndVector element(
+				JMinvM0.m_linear * row_i->m_Jt.m_jacobianM0.m_linear + JMinvM0.m_angular * row_i->m_Jt.m_jacobianM0.m_angular +
+				JMinvM1.m_linear * row_i->m_Jt.m_jacobianM1.m_linear + JMinvM1.m_angular * row_i->m_Jt.m_jacobianM1.m_angular);
+
+			// I know I am doubling the matrix regularizer, but this makes the solution more robust.
+			ndFloat32* const matrixRow11 = &m_massMatrix11[m_auxiliaryRowCount * index];
+			ndFloat32 diagonal = element.AddHorizontal().GetScalar() + rhs_i->m_diagDamp;
+			matrixRow11[index] = diagonal + rhs_i->m_diagDamp;
+			diagDamp[index] = matrixRow11[index] * ndFloat32(4.0e-3f);
+
+			const ndInt32 m0_i = m_pairs[primaryCount + index].m_m0;
+			const ndInt32 m1_i = m_pairs[primaryCount + index].m_m1;
+
+			tempArray[1] = row_i->m_JMinv.m_jacobianM0;
+			tempArray[2] = row_i->m_JMinv.m_jacobianM1;
+			for (ndInt32 j = index + 1; j < m_auxiliaryRowCount; ++j)  
+			{
+				const ndInt32 jj = m_matrixRowsIndex[primaryCount + j];
+				const ndLeftHandSide* const row_j = &m_leftHandSide[jj];
+
+				const ndInt32 k = primaryCount + j;
+				const ndInt32 m0_j = m_pairs[k].m_m0;
+				const ndInt32 m1_j = m_pairs[k].m_m1;
+
+				const ndInt32 index_m0_j_m0_i_mask = -(m0_j == m0_i);
+				const ndInt32 index_m0_j_m1_i_mask = -(m0_j == m1_i);
+				const ndInt32 index_m1_j_m0_i_mask = -(m1_j == m0_i);
+				const ndInt32 index_m1_j_m1_i_mask = -(m1_j == m1_i);
+
+				const ndInt32 index_m0_j = (index_m0_j_m0_i_mask & 1) | (index_m0_j_m1_i_mask & 2);
+				const ndInt32 index_m1_j = (index_m1_j_m0_i_mask & 1) | (index_m1_j_m1_i_mask & 2);
+
+				ndVector acc(row_j->m_Jt.m_jacobianM0.m_linear * tempArray[index_m0_j].m_linear);
+				acc = acc.MulAdd(row_j->m_Jt.m_jacobianM0.m_angular, tempArray[index_m0_j].m_angular);
+				acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_linear, tempArray[index_m1_j].m_linear);
+				acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_angular, tempArray[index_m1_j].m_angular);
+				acc = acc.AddHorizontal();
+
+				ndFloat32 offDiagValue = acc.GetScalar();
+				matrixRow11[j] = offDiagValue;
+				m_massMatrix11[j * m_auxiliaryRowCount + index] = offDiagValue;
+			}
+
+			ndFloat32* const matrixRow10 = &m_massMatrix10[primaryCount * index];
+			for (ndInt32 j = 0; j < primaryCount; ++j)  
+			{
+				const ndInt32 jj = m_matrixRowsIndex[j];
+				const ndLeftHandSide* const row_j = &m_leftHandSide[jj];
+
+				const ndInt32 m0_j = m_pairs[j].m_m0;
+				const ndInt32 m1_j = m_pairs[j].m_m1;
+
+				const ndInt32 index_m0_j_m0_i_mask = -(m0_j == m0_i);
+				const ndInt32 index_m0_j_m1_i_mask = -(m0_j == m1_i);
+				const ndInt32 index_m1_j_m0_i_mask = -(m1_j == m0_i);
+				const ndInt32 index_m1_j_m1_i_mask = -(m1_j == m1_i);
+
+				const ndInt32 index_m0_j = (index_m0_j_m0_i_mask & 1) | (index_m0_j_m1_i_mask & 2);
+				const ndInt32 index_m1_j = (index_m1_j_m0_i_mask & 1) | (index_m1_j_m1_i_mask & 2);
+
+				ndVector acc(row_j->m_Jt.m_jacobianM0.m_linear * tempArray[index_m0_j].m_linear);
+				acc = acc.MulAdd(row_j->m_Jt.m_jacobianM0.m_angular, tempArray[index_m0_j].m_angular);
+				acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_linear, tempArray[index_m1_j].m_linear);
+				acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_angular, tempArray[index_m1_j].m_angular);
+				acc = acc.AddHorizontal();
+				matrixRow10[j] = acc.GetScalar();
+			}
 		}
-	}
+	});
+	ndLoopParallelExecute(threadPool, CalculateCoefficients);
 }
 
 void ndSkeletonContainer::SolveForward(ndForcePair* const force, const ndForcePair* const accel, ndInt32 startNode) const
@@ -761,95 +803,181 @@ void ndSkeletonContainer::SolveBackward(ndForcePair* const force) const
 	}
 }
 
-void ndSkeletonContainer::ConditionMassMatrix() const
+void ndSkeletonContainer::ConditionMassMatrix(ndThreadPool* const threadPool) const
 {
 	D_TRACKTIME();
-	const ndInt32 nodeCount = m_nodeList.GetCount();
-	ndForcePair* const forcePair = ndAlloca(ndForcePair, nodeCount);
-	const ndSpatialVector zero(ndSpatialVector::m_zero);
-
-	const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
-	for (ndInt32 i = 0; i < m_auxiliaryRowCount; ++i) 
+	ndAtomic<ndInt32> iterator(0);
+	auto ConditionMassMatrix = ndMakeObject::ndFunction([this, &iterator](ndInt32, ndInt32)
 	{
-		ndInt32 entry0 = 0;
-		ndInt32 startjoint = nodeCount;
-		const ndFloat32* const matrixRow10 = &m_massMatrix10[i * primaryCount];
-		for (ndInt32 j = 0; j < nodeCount - 1; ++j)  
+		D_TRACKTIME_NAMED(ConditionMassMatrix);
+		const ndInt32 nodeCount = m_nodeList.GetCount();
+		ndForcePair* const forcePair = ndAlloca(ndForcePair, nodeCount);
+		const ndSpatialVector zero(ndSpatialVector::m_zero);
+
+		const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
+		for (ndInt32 i = iterator++; i < m_auxiliaryRowCount; i = iterator++)
 		{
-			const ndNode* const node = m_nodesOrder[j];
-			const ndInt32 index = node->m_index;
-			forcePair[index].m_body = zero;
-			ndSpatialVector& a = forcePair[index].m_joint;
+			ndInt32 entry0 = 0;
+			ndInt32 startjoint = nodeCount;
+			const ndFloat32* const matrixRow10 = &m_massMatrix10[i * primaryCount];
+			for (ndInt32 j = 0; j < nodeCount - 1; ++j)  
+			{
+				const ndNode* const node = m_nodesOrder[j];
+				const ndInt32 index = node->m_index;
+				forcePair[index].m_body = zero;
+				ndSpatialVector& a = forcePair[index].m_joint;
+
+				const ndInt32 count = node->m_dof;
+				for (ndInt32 k = 0; k < count; ++k) 
+				{
+					const ndFloat32 value = matrixRow10[entry0];
+					a[k] = value;
+					startjoint = (value == 0.0f) ? startjoint : ndMin(startjoint, index);
+					entry0++;
+				}
+			}
+
+			startjoint = (startjoint == nodeCount) ? 0 : startjoint;
+			ndAssert(startjoint < nodeCount);
+			forcePair[nodeCount - 1].m_body = zero;
+			forcePair[nodeCount - 1].m_joint = zero;
+			SolveForward(forcePair, forcePair, startjoint);
+			SolveBackward(forcePair);
 
-			const ndInt32 count = node->m_dof;
-			for (ndInt32 k = 0; k < count; ++k) 
+			ndInt32 entry1 = 0;
+			ndFloat32* const deltaForcePtr = &m_deltaForce[i * primaryCount];
+			for (ndInt32 j = 0; j < nodeCount - 1; ++j)  
 			{
-				const ndFloat32 value = matrixRow10[entry0];
-				a[k] = value;
-				startjoint = (value == 0.0f) ? startjoint : ndMin(startjoint, index);
-				entry0++;
+				const ndNode* const node = m_nodesOrder[j];
+				const ndInt32 index = node->m_index;
+				const ndSpatialVector& f = forcePair[index].m_joint;
+				const ndInt32 count = node->m_dof;
+				for (ndInt32 k = 0; k < count; ++k) 
+				{
+					deltaForcePtr[entry1] = ndFloat32(f[k]);
+					entry1++;
+				}
 			}
 		}
+	});
+	ndLoopParallelExecute(threadPool, ConditionMassMatrix);
+}
 
-		startjoint = (startjoint == nodeCount) ? 0 : startjoint;
-		ndAssert(startjoint < nodeCount);
-		forcePair[nodeCount - 1].m_body = zero;
-		forcePair[nodeCount - 1].m_joint = zero;
-		SolveForward(forcePair, forcePair, startjoint);
-		SolveBackward(forcePair);
-
-		ndInt32 entry1 = 0;
-		ndFloat32* const deltaForcePtr = &m_deltaForce[i * primaryCount];
-		for (ndInt32 j = 0; j < nodeCount - 1; ++j)  
+void ndSkeletonContainer::RebuildMassMatrix(ndThreadPool* const threadPool, const ndFloat32* const diagDamp) const
+{
+	D_TRACKTIME();
+	ndAtomic<ndInt32> iterator(0);
+	auto RebuildMassMatrix = ndMakeObject::ndFunction([this, &iterator, diagDamp](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(RebuildMassMatrix);
+		const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
+		ndInt16* const indexList = ndAlloca(ndInt16, primaryCount);
+		// a row reads only its own upper half, the other rows write below the diagonal
+		for (ndInt32 i = iterator++; i < m_auxiliaryRowCount; i = iterator++)
 		{
-			const ndNode* const node = m_nodesOrder[j];
-			const ndInt32 index = node->m_index;
-			const ndSpatialVector& f = forcePair[index].m_joint;
-			const ndInt32 count = node->m_dof;
-			for (ndInt32 k = 0; k < count; ++k) 
+			const ndFloat32* const matrixRow10 = &m_massMatrix10[i * primaryCount];
+			ndFloat32* const matrixRow11 = &m_massMatrix11[i * m_auxiliaryRowCount];
+
+			ndInt32 indexCount = 0;
+			for (ndInt32 k = 0; k < primaryCount; ++k) 
+			{
+				indexList[indexCount] = ndInt16(k);
+				indexCount += (matrixRow10[k] != ndFloat32(0.0f)) ? 1 : 0;
+			}
+
+			for (ndInt32 j = i; j < m_auxiliaryRowCount; ++j)  
 			{
-				deltaForcePtr[entry1] = ndFloat32(f[k]);
-				entry1++;
+				ndFloat32 offDiagonal = matrixRow11[j];
+				const ndFloat32* const row10 = &m_deltaForce[j * primaryCount];
+				for (ndInt32 k = 0; k < indexCount; ++k) 
+				{
+					ndInt32 index = indexList[k];
+					offDiagonal += matrixRow10[index] * row10[index];
+				}
+				matrixRow11[j] = offDiagonal;
+				m_massMatrix11[j * m_auxiliaryRowCount + i] = offDiagonal;
 			}
+
+			matrixRow11[i] = ndMax(matrixRow11[i], diagDamp[i]);
 		}
-	}
+	});
+	ndLoopParallelExecute(threadPool, RebuildMassMatrix);
 }
 
-void ndSkeletonContainer::RebuildMassMatrix(const ndFloat32* const diagDamp) const
+bool ndSkeletonContainer::CholeskyFactorization(ndThreadPool* const threadPool, ndInt32 size, ndInt32 stride, ndFloat32* const matrix) const
 {
-	D_TRACKTIME();
-	const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
-	ndInt16* const indexList = ndAlloca(ndInt16, primaryCount);
-	for (ndInt32 i = 0; i < m_auxiliaryRowCount; ++i) 
+	if (!threadPool)
 	{
-		const ndFloat32* const matrixRow10 = &m_massMatrix10[i * primaryCount];
-		ndFloat32* const matrixRow11 = &m_massMatrix11[i * m_auxiliaryRowCount];
+		return ndCholeskyFactorization(size, stride, matrix);
+	}
+
+	// right looking block factorization, the diagonal block is factored serially, 
+	// then the panel below it and the trailing matrix are split by rows.
+	// the sums are accumulated in a different order, so the factors differ 
+	// from the unblocked ones by rounding.
+	for (ndInt32 blockStart = 0; blockStart < size; blockStart += D_SKELETON_CHOLESKY_BLOCK)
+	{
+		const ndInt32 blockEnd = ndMin(blockStart + D_SKELETON_CHOLESKY_BLOCK, size);
+		ndFloat32* const diagonalBlock = &matrix[blockStart * stride + blockStart];
+		if (diagonalBlock[0] < ndFloat32(1.0e-6f))
+		{
+			return false;
+		}
+		if (!ndCholeskyFactorization(blockEnd - blockStart, stride, diagonalBlock))
+		{
+			return false;
+		}
+		if (blockEnd == size)
+		{
+			break;
+		}
 
-		ndInt32 indexCount = 0;
-		for (ndInt32 k = 0; k < primaryCount; ++k) 
+		// clear the upper triangle, like the unblocked factorization does
+		for (ndInt32 i = blockStart; i < blockEnd; ++i)
 		{
-			indexList[indexCount] = ndInt16(k);
-			indexCount += (matrixRow10[k] != ndFloat32(0.0f)) ? 1 : 0;
+			ndMemSet(&matrix[i * stride + blockEnd], ndFloat32(0.0f), size - blockEnd);
 		}
 
-		for (ndInt32 j = i; j < m_auxiliaryRowCount; ++j)  
+		auto FactorizePanel = ndMakeObject::ndFunction([matrix, size, stride, blockStart, blockEnd](ndInt32 threadIndex, ndInt32 threadCount)
 		{
-			ndFloat32 offDiagonal = matrixRow11[j];
-			const ndFloat32* const row10 = &m_deltaForce[j * primaryCount];
-			for (ndInt32 k = 0; k < indexCount; ++k) 
+			D_TRACKTIME_NAMED(FactorizePanel);
+			const ndStartEnd startEnd(size - blockEnd, threadIndex, threadCount);
+			for (ndInt32 i = blockEnd + startEnd.m_start; i < blockEnd + startEnd.m_end; ++i)
 			{
-				ndInt32 index = indexList[k];
-				offDiagonal += matrixRow10[index] * row10[index];
+				ndFloat32* const row = &matrix[i * stride + blockStart];
+				for (ndInt32 j = 0; j < blockEnd - blockStart; ++j)
+				{
+					const ndFloat32* const rowJ = &matrix[(blockStart + j) * stride + blockStart];
+					row[j] = (row[j] - ndLoopDotProduct(j, row, rowJ)) / rowJ[j];
+				}
 			}
-			matrixRow11[j] = offDiagonal;
-			m_massMatrix11[j * m_auxiliaryRowCount + i] = offDiagonal;
-		}
+		});
+		threadPool->ParallelExecute(FactorizePanel);
 
-		matrixRow11[i] = ndMax(matrixRow11[i], diagDamp[i]);
+		ndAtomic<ndInt32> iterator(0);
+		auto UpdateTrailingMatrix = ndMakeObject::ndFunction([matrix, size, stride, blockStart, blockEnd, &iterator](ndInt32, ndInt32)
+		{
+			D_TRACKTIME_NAMED(UpdateTrailingMatrix);
+			const ndInt32 count = size - blockEnd;
+			const ndInt32 blockSize = blockEnd - blockStart;
+			// the longest rows go first
+			for (ndInt32 k = iterator++; k < count; k = iterator++)
+			{
+				const ndInt32 i = size - 1 - k;
+				ndFloat32* const row = &matrix[i * stride];
+				const ndFloat32* const panel = &row[blockStart];
+				for (ndInt32 j = blockEnd; j <= i; ++j)
+				{
+					row[j] -= ndLoopDotProduct(blockSize, panel, &matrix[j * stride + blockStart]);
+				}
+			}
+		});
+		threadPool->ParallelExecute(UpdateTrailingMatrix);
 	}
+	return true;
 }
 
-void ndSkeletonContainer::FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat32* const matrix, ndFloat32* const diagDamp) const
+void ndSkeletonContainer::FactorizeMatrix(ndThreadPool* const threadPool, ndInt32 size, ndInt32 stride, ndFloat32* const matrix, ndFloat32* const diagDamp) const
 {
 	D_TRACKTIME();
 	// save the matrix 
@@ -863,7 +991,7 @@ void ndSkeletonContainer::FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat3
 		srcLine += stride;
 	}
 
-	while (!ndCholeskyFactorization(size, stride, matrix))
+	while (!CholeskyFactorization(threadPool, size, stride, matrix))
 	{
 		srcLine = 0;
 		dstLine = 0;
@@ -878,8 +1006,9 @@ void ndSkeletonContainer::FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat3
 	}
 }
 
-void ndSkeletonContainer::InitLoopMassMatrix()
+void ndSkeletonContainer::InitLoopMassMatrix(ndThreadPool* const threadPool)
 {
+	D_TRACKTIME();
 	CalculateBufferSizeInBytes();
 	ndInt8* const memoryBuffer = &m_auxiliaryMemoryBuffer[0];
 	const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
@@ -988,34 +1117,53 @@ void ndSkeletonContainer::InitLoopMassMatrix()
 	ndMemSet(m_massMatrix10, ndFloat32(0.0f), primaryCount * m_auxiliaryRowCount);
 	ndMemSet(m_massMatrix11, ndFloat32(0.0f), m_auxiliaryRowCount * m_auxiliaryRowCount);
 
-	CalculateLoopMassMatrixCoefficients(diagDamp);
-	ConditionMassMatrix();
-	RebuildMassMatrix(diagDamp);
+	CalculateLoopMassMatrixCoefficients(threadPool, diagDamp);
+	ConditionMassMatrix(threadPool);
+	RebuildMassMatrix(threadPool, diagDamp);
 
 	if (m_blockSize) 
 	{
-		FactorizeMatrix(m_blockSize, m_auxiliaryRowCount, m_massMatrix11, diagDamp);
+		FactorizeMatrix(threadPool, m_blockSize, m_auxiliaryRowCount, m_massMatrix11, diagDamp);
+		CalculateSchurComplement(threadPool, diagDamp);
+	}
+}
+
+void ndSkeletonContainer::CalculateSchurComplement(ndThreadPool* const threadPool, const ndFloat32* const diagDamp) const
+{
+	D_TRACKTIME();
+	const ndInt32 boundedSize = m_auxiliaryRowCount - m_blockSize;
+
+	// the bounded columns are independent, each thread solves a range of them
+	auto SolveBoundedColumns = ndMakeObject::ndFunction([this, boundedSize](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(SolveBoundedColumns);
+		const ndStartEnd startEnd(boundedSize, threadIndex, threadCount);
+		const ndInt32 columnStart = m_blockSize + startEnd.m_start;
+		const ndInt32 columnCount = startEnd.m_end - startEnd.m_start;
+		if (!columnCount)
+		{
+			return;
+		}
 
 		ndInt32 rowStart = 0;
-		const ndInt32 boundedSize = m_auxiliaryRowCount - m_blockSize;
-		ndFloat32* const acc = ndAlloca(ndFloat32, m_auxiliaryRowCount);
+		ndFloat32* const acc = ndAlloca(ndFloat32, columnCount);
 		for (ndInt32 i = 0; i < m_blockSize; ++i) 
 		{
-			ndMemSet(acc, ndFloat32(0.0f), boundedSize);
+			ndMemSet(acc, ndFloat32(0.0f), columnCount);
 			const ndFloat32* const row = &m_massMatrix11[rowStart];
 			for (ndInt32 j = 0; j < i; ++j)  
 			{
 				const ndFloat32 s = row[j];
-				const ndFloat32* const x = &m_massMatrix11[j * m_auxiliaryRowCount + m_blockSize];
-				for (ndInt32 k = 0; k < boundedSize; ++k) 
+				const ndFloat32* const x = &m_massMatrix11[j * m_auxiliaryRowCount + columnStart];
+				for (ndInt32 k = 0; k < columnCount; ++k) 
 				{
 					acc[k] += s * x[k];
 				}
 			}
 
-			ndFloat32* const x = &m_massMatrix11[rowStart + m_blockSize];
+			ndFloat32* const x = &m_massMatrix11[rowStart + columnStart];
 			const ndFloat32 den = -ndFloat32(1.0f) / row[i];
-			for (ndInt32 j = 0; j < boundedSize; ++j)  
+			for (ndInt32 j = 0; j < columnCount; ++j)  
 			{
 				x[j] = (x[j] + acc[j]) * den;
 			}
@@ -1024,26 +1172,32 @@ void ndSkeletonContainer::InitLoopMassMatrix()
 
 		for (ndInt32 i = m_blockSize - 1; i >= 0; i--) 
 		{
-			ndMemSet(acc, ndFloat32(0.0f), boundedSize);
+			ndMemSet(acc, ndFloat32(0.0f), columnCount);
 			for (ndInt32 j = i + 1; j < m_blockSize; ++j)  
 			{
 				const ndFloat32 s = m_massMatrix11[j * m_auxiliaryRowCount + i];
-				const ndFloat32* const x = &m_massMatrix11[j * m_auxiliaryRowCount + m_blockSize];
-				for (ndInt32 k = 0; k < boundedSize; ++k) 
+				const ndFloat32* const x = &m_massMatrix11[j * m_auxiliaryRowCount + columnStart];
+				for (ndInt32 k = 0; k < columnCount; ++k) 
 				{
 					acc[k] += s * x[k];
 				}
 			}
 
-			ndFloat32* const x = &m_massMatrix11[i * m_auxiliaryRowCount + m_blockSize];
+			ndFloat32* const x = &m_massMatrix11[i * m_auxiliaryRowCount + columnStart];
 			const ndFloat32 den = ndFloat32(1.0f) / m_massMatrix11[i * m_auxiliaryRowCount + i];
-			for (ndInt32 j = 0; j < boundedSize; ++j)  
+			for (ndInt32 j = 0; j < columnCount; ++j)  
 			{
 				x[j] = (x[j] - acc[j]) * den;
 			}
 		}
+	});
 
-		for (ndInt32 i = 0; i < boundedSize; ++i) 
+	ndAtomic<ndInt32> iterator(0);
+	auto CalculateComplement = ndMakeObject::ndFunction([this, &iterator, boundedSize, diagDamp](ndInt32, ndInt32)
+	{
+		D_TRACKTIME_NAMED(CalculateComplement);
+		ndFloat32* const acc = ndAlloca(ndFloat32, m_blockSize);
+		for (ndInt32 i = iterator++; i < boundedSize; i = iterator++)
 		{
 			for (ndInt32 j = 0; j < m_blockSize; ++j)  
 			{
@@ -1054,14 +1208,17 @@ void ndSkeletonContainer::InitLoopMassMatrix()
 			for (ndInt32 j = i; j < boundedSize; ++j)  
 			{
 				const ndFloat32* const row1 = &m_massMatrix11[(m_blockSize + j) * m_auxiliaryRowCount];
-				ndFloat32 elem = row1[m_blockSize + i] + ndDotProduct(m_blockSize, acc, row1);
+				ndFloat32 elem = row1[m_blockSize + i] + ndLoopDotProduct(m_blockSize, acc, row1);
 				arow[j] = elem;
 				m_massMatrix11[(m_blockSize + j) * m_auxiliaryRowCount + m_blockSize + i] = elem;
 			}
 			arow[i] += diagDamp[m_blockSize + i];
 		}
-		ndAssert(!boundedSize || ndTestPSDmatrix(m_auxiliaryRowCount - m_blockSize, m_auxiliaryRowCount, &m_massMatrix11[m_auxiliaryRowCount * m_blockSize + m_blockSize]));
-	}
+	});
+
+	ndLoopParallelExecute(threadPool, SolveBoundedColumns);
+	ndLoopParallelExecute(threadPool, CalculateComplement);
+	ndAssert(!boundedSize || ndTestPSDmatrix(m_auxiliaryRowCount - m_blockSize, m_auxiliaryRowCount, &m_massMatrix11[m_auxiliaryRowCount * m_blockSize + m_blockSize]));
 }
 
 void ndSkeletonContainer::CalculateJointAccel(const ndJacobian* const internalForces, ndForcePair* const accel) const
@@ -1253,6 +1410,7 @@ void ndSkeletonContainer::SolveLcp(ndInt32 stride, ndInt32 size, const ndFloat32
 	ndFloat32* const invDiag1 = ndAlloca(ndFloat32, size);
 	ndFloat32* const residual = ndAlloca(ndFloat32, size);
 	ndInt32* const tempNormalIndex = ndAlloca(ndInt32, size);
+	ndFloat32 deltaX[D_SKELETON_LCP_BLOCK];
 
 	ndInt32 base = 0;
 	for (ndInt32 i = 0; i < size; ++i)
@@ -1275,7 +1433,7 @@ void ndSkeletonContainer::SolveLcp(ndInt32 stride, ndInt32 size, const ndFloat32
 	for (ndInt32 i = 0; i < size; ++i)
 	{
 		const ndFloat32* const row = &matrix[base];
-		residual[i] = b[i] - ndDotProduct(size, row, x);
+		residual[i] = b[i] - ndLoopDotProduct(size, row, x);
 		base += stride;
 	}
 
@@ -1284,33 +1442,51 @@ void ndSkeletonContainer::SolveLcp(ndInt32 stride, ndInt32 size, const ndFloat32
 	const ndFloat32* const invDiag = invDiag1;
 	for (ndInt32 k = 0; (k < maxIterCount) && (tolerance > tol2); ++k)
 	{
-		base = 0;
 		iterCount++;
 		tolerance = ndFloat32(0.0f);
-		for (ndInt32 i = 0; i < size; ++i)
+		for (ndInt32 blockStart = 0; blockStart < size; blockStart += D_SKELETON_LCP_BLOCK)
 		{
-			const ndFloat32 r = residual[i];
-			const ndInt32 index = tempNormalIndex[i];
-			const ndFloat32 coefficient = x[index] + x0[index];
-
-			const ndFloat32 l = low[i] * coefficient - x0[i];
-			const ndFloat32 h = high[i] * coefficient - x0[i];
-
-			const ndFloat32* const row = &matrix[base];
-			const ndFloat32 f = ndClamp(x[i] + ((r + row[i] * x[i]) * invDiag[i] - x[i]) * sor, l, h);
-			const ndFloat32 dx = f - x[i];
-			const ndFloat32 dr = dx * row[i];
-			tolerance += dr * dr;
+			// gauss seidel inside the block only updates the block residuals, 
+			// the rest of the residual gets the block changes in one pass.
+			// the sweep order is the same, the residuals differ by rounding.
+			const ndInt32 blockEnd = ndMin(blockStart + D_SKELETON_LCP_BLOCK, size);
+			for (ndInt32 i = blockStart; i < blockEnd; ++i)
+			{
+				const ndFloat32 r = residual[i];
+				const ndInt32 index = tempNormalIndex[i];
+				const ndFloat32 coefficient = x[index] + x0[index];
+
+				const ndFloat32 l = low[i] * coefficient - x0[i];
+				const ndFloat32 h = high[i] * coefficient - x0[i];
+
+				const ndFloat32* const row = &matrix[i * stride];
+				const ndFloat32 f = ndClamp(x[i] + ((r + row[i] * x[i]) * invDiag[i] - x[i]) * sor, l, h);
+				const ndFloat32 dx = f - x[i];
+				const ndFloat32 dr = dx * row[i];
+				tolerance += dr * dr;
+
+				x[i] = f;
+				deltaX[i - blockStart] = ndFloat32(0.0f);
+				if (ndAbs(dx) > ndFloat32(1.0e-6f))
+				{
+					deltaX[i - blockStart] = dx;
+					for (ndInt32 j = blockStart; j < blockEnd; ++j)
+					{
+						residual[j] -= row[j] * dx;
+					}
+				}
+			}
 
-			x[i] = f;
-			if (ndAbs(dx) > ndFloat32(1.0e-6f))
+			for (ndInt32 i = blockStart; i < blockEnd; ++i)
 			{
-				for (ndInt32 j = 0; j < size; ++j) 
+				const ndFloat32 dx = deltaX[i - blockStart];
+				if (dx != ndFloat32(0.0f))
 				{
-					residual[j] -= row[j] * dx;
+					const ndFloat32* const row = &matrix[i * stride];
+					ndScaleAdd(blockStart, residual, row, -dx);
+					ndScaleAdd(size - blockEnd, &residual[blockEnd], &row[blockEnd], -dx);
 				}
 			}
-			base += stride;
 		}
 	}
 }
@@ -1433,7 +1609,12 @@ void ndSkeletonContainer::SolveAuxiliary(ndJacobian* const internalForces, const
 	}
 }
 
-void ndSkeletonContainer::InitMassMatrix(const ndLeftHandSide* const leftHandSide, ndRightHandSide* const rightHandSide)
+bool ndSkeletonContainer::HasLargeLoopSystem() const
+{
+	return !m_isResting && (m_auxiliaryRowCount >= D_SKELETON_PARALLEL_LOOP_ROWS);
+}
+
+void ndSkeletonContainer::InitMassMatrix(const ndLeftHandSide* const leftHandSide, ndRightHandSide* const rightHandSide, bool deferLargeLoops)
 {
 	D_TRACKTIME();
 	if (m_isResting)
@@ -1474,9 +1655,10 @@ void ndSkeletonContainer::InitMassMatrix(const ndLeftHandSide* const leftHandSid
 	m_rowCount += m_loopRowCount;
 	m_auxiliaryRowCount += m_loopRowCount;
 
-	if (m_auxiliaryRowCount)
+	// large loop systems are left for the caller to factor with all threads
+	if (m_auxiliaryRowCount && !(deferLargeLoops && HasLargeLoopSystem()))
 	{
-		InitLoopMassMatrix();
+		InitLoopMassMatrix(nullptr);
 	}
 }
 
@@ -152,17 +152,20 @@ class ndSkeletonContainer
 	ndNode* AddChild(ndJointBilateralConstraint* const joint, ndNode* const parent);
 	void Finalize(ndInt32 loopJoints, ndJointBilateralConstraint** const loopJointArray);
 
-	void InitLoopMassMatrix();
+	bool HasLargeLoopSystem() const;
 	void ClearCloseLoopJoints();
 	void AddCloseLoopJoint(ndConstraint* const joint);
+	void InitLoopMassMatrix(ndThreadPool* const threadPool);
 	void CalculateReactionForces(ndJacobian* const internalForces);
-	void InitMassMatrix(const ndLeftHandSide* const matrixRow, ndRightHandSide* const rightHandSide);
+	void InitMassMatrix(const ndLeftHandSide* const matrixRow, ndRightHandSide* const rightHandSide, bool deferLargeLoops = false);
 	void CalculateBufferSizeInBytes();
-	void ConditionMassMatrix() const;
+	void ConditionMassMatrix(ndThreadPool* const threadPool) const;
 	void SortGraph(ndNode* const root, ndInt32& index);
-	void RebuildMassMatrix(const ndFloat32* const diagDamp) const;
-	void CalculateLoopMassMatrixCoefficients(ndFloat32* const diagDamp);
-	void FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat32* const matrix, ndFloat32* const diagDamp) const;
+	void RebuildMassMatrix(ndThreadPool* const threadPool, const ndFloat32* const diagDamp) const;
+	void CalculateSchurComplement(ndThreadPool* const threadPool, const ndFloat32* const diagDamp) const;
+	void CalculateLoopMassMatrixCoefficients(ndThreadPool* const threadPool, ndFloat32* const diagDamp);
+	bool CholeskyFactorization(ndThreadPool* const threadPool, ndInt32 size, ndInt32 stride, ndFloat32* const matrix) const;
+	void FactorizeMatrix(ndThreadPool* const threadPool, ndInt32 size, ndInt32 stride, ndFloat32* const matrix, ndFloat32* const diagDamp) const;
 	void SolveAuxiliary(ndJacobian* const internalForces, const ndForcePair* const accel, ndForcePair* const force) const;
 	void SolveBlockLcp(ndInt32 size, ndInt32 blockSize, const ndFloat32* const x0, ndFloat32* const x, ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol) const;
 	void SolveLcp(ndInt32 stride, ndInt32 size, const ndFloat32* const matrix, const ndFloat32* const x0, ndFloat32* const x, const ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol) const;
@@ -208,7 +211,10 @@ class ndSkeletonContainer
 	friend class ndSkeletonQueue;
 	friend class ndDynamicsUpdate;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateColored;
+	friend class ndDynamicsUpdateIsland;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateSycl;
 	friend class ndDynamicsUpdateCuda;
 };
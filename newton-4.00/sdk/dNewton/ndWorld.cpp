@@ -28,14 +28,25 @@
 #include "dModels/ndModel.h"
 #include "ndDynamicsUpdate.h"
 #include "ndDynamicsUpdateSoa.h"
+#include "ndDynamicsUpdateColored.h"
+#include "ndDynamicsUpdateIsland.h"
+#include "ndSceneQuerySnapshot.h"
 #include "dModels/ndModelNotify.h"
 #include "ndJointBilateralConstraint.h"
 
+// how long the world waits for the readers of a snapshot when it is destroyed
+#define D_QUERY_SNAPSHOT_RELEASE_TIMEOUT	ndUnsigned64(1000000)
+
 #ifdef _D_USE_AVX2_SOLVER
 	#include "ndWorldSceneAvx2.h"
 	#include "ndDynamicsUpdateAvx2.h"
 #endif
 
+#ifdef _D_USE_AVX512_SOLVER
+	#include "ndWorldSceneAvx512.h"
+	#include "ndDynamicsUpdateAvx512.h"
+#endif
+
 #ifdef _D_NEWTON_CUDA
 	#include "ndCudaUtils.h"
 	#include "ndWorldSceneCuda.h"
@@ -95,16 +106,23 @@ class ndSkeletonQueue : public ndFixSizeArray<ndSkeletonContainer::ndNode*, 1024
 
 ndWorld::ndWorld()
 	:ndClassAlloc()
+	,m_originOffset(ndBigVector::m_zero)
 	,m_scene(nullptr)
 	,m_solver(nullptr)
+	,m_originFocusBody(nullptr)
 	,m_jointList()
 	,m_modelList()
 	,m_skeletonList()
+	,m_sensorList()
 	,m_deletedBodies()
 	,m_deletedModels()
 	,m_deletedJoints()
 	,m_activeSkeletons(256)
+	,m_querySnapshots()
+	,m_publishedSnapshot(nullptr)
+	,m_querySnapshotLock()
 	,m_deletedLock()
+	,m_querySnapshotVersion(0)
 	,m_timestep(ndFloat32 (0.0f))
 	,m_freezeAccel2(D_FREEZE_ACCEL2)
 	,m_freezeSpeed2(D_FREEZE_SPEED2)
@@ -112,16 +130,24 @@ ndWorld::ndWorld()
 	,m_averageTimestepAcc(ndFloat32(0.0f))
 	,m_averageFramesCount(ndFloat32(0.0f))
 	,m_lastExecutionTime(ndFloat32(0.0f))
+	,m_solverTolerance(ndFloat32(0.0f))
+	,m_originRebaseDistance(ndFloat32(0.0f))
 	,m_subSteps(1)
 	,m_solverMode(ndStandardSolver)
 	,m_solverIterations(4)
 	,m_inUpdate(false)
+	,m_querySnapshotEnabled(false)
+	,m_bodyStateBuffer(false)
 {
 	// start the engine thread;
 	ndBody::m_uniqueIdCount = 0;
 	m_solver = new ndDynamicsUpdate(this);
 	m_scene = new ndWorldScene(this);
 
+	m_solverStats.m_passes = 0;
+	m_solverStats.m_maxPasses = 0;
+	m_solverStats.m_residual = ndFloat32(0.0f);
+
 	ndInt32 steps = 1;
 	ndFloat32 freezeAccel2 = m_freezeAccel2;
 	//ndFloat32 freezeAlpha2 = m_freezeAlpha2;
@@ -167,6 +193,7 @@ void ndWorld::CleanUp()
 	Sync();
 	//m_scene->m_backgroundThread.Terminate();
 	m_scene->PrepareCleanup();
+	DeleteQuerySnapshots();
 
 	m_activeSkeletons.Resize(256);
 	while (m_skeletonList.GetFirst())
@@ -186,6 +213,12 @@ void ndWorld::CleanUp()
 		m_modelList.RemoveModel(model);
 	}
 
+	while (m_sensorList.GetFirst())
+	{
+		m_sensorList.GetFirst()->GetInfo()->m_worldNode = nullptr;
+		m_sensorList.Remove(m_sensorList.GetFirst());
+	}
+
 	while (m_scene->m_particleSetList.GetFirst())
 	{
 		ndSharedPtr<ndBody>& body = m_scene->m_particleSetList.GetFirst()->GetInfo();
@@ -200,6 +233,9 @@ void ndWorld::CleanUp()
 
 	ndBody::m_uniqueIdCount = 1;
 	m_scene->Cleanup();
+
+	m_originFocusBody = nullptr;
+	m_originOffset = ndBigVector::m_zero;
 }
 
 const char* ndWorld::GetSolverString() const
@@ -207,6 +243,11 @@ const char* ndWorld::GetSolverString() const
 	return m_solver->GetStringId();
 }
 
+const ndDynamicsUpdate* ndWorld::GetSolver() const
+{
+	return m_solver;
+}
+
 bool ndWorld::IsHighPerformanceCompute() const
 {
 	return m_scene->IsHighPerformanceCompute();
@@ -263,6 +304,27 @@ void ndWorld::SetSolverIterations(ndInt32 iterations)
 	m_solverIterations = ndInt32(ndMax(4, iterations));
 }
 
+ndFloat32 ndWorld::GetSolverTolerance() const
+{
+	return m_solverTolerance;
+}
+
+void ndWorld::SetSolverTolerance(ndFloat32 tolerance)
+{
+	// a zero tolerance runs all the solver passes.
+	m_solverTolerance = ndMax(tolerance, ndFloat32(0.0f));
+}
+
+const ndWorld::ndSolverStats& ndWorld::GetSolverStats() const
+{
+	return m_solverStats;
+}
+
+const ndScene::ndSleepStats& ndWorld::GetSleepStats() const
+{
+	return m_scene->GetSleepStats();
+}
+
 ndContactNotify* ndWorld::GetContactNotify() const
 {
 	return m_scene->GetContactNotify();
@@ -500,10 +562,17 @@ void ndWorld::ThreadFunction()
 	//m_inUpdate = true;
 	//m_scene->Begin();
 
+	RebaseOrigin();
 	m_scene->SetTimestep(m_timestep);
 
 	PreUpdate(m_timestep);
 
+	m_solverStats.m_passes = 0;
+	m_solverStats.m_maxPasses = 0;
+	m_solverStats.m_residual = ndFloat32(0.0f);
+	m_scene->m_sleepStats.m_wokenBodies = 0;
+	m_scene->m_sleepStats.m_deactivatedBodies = 0;
+
 	ndInt32 const steps = m_subSteps;
 	ndFloat32 timestep = m_timestep / (ndFloat32)steps;
 	for (ndInt32 i = 0; i < steps; ++i)
@@ -517,7 +586,12 @@ void ndWorld::ThreadFunction()
 		
 	UpdateTransforms();
 	PostModelTransform();
+	SensorUpdate();
 	PostUpdate(m_timestep);
+	if (m_querySnapshotEnabled)
+	{
+		PublishQuerySnapshot();
+	}
 	m_inUpdate = false;
 
 	m_scene->End();
@@ -564,6 +638,7 @@ void ndWorld::SubStepUpdate(ndFloat32 timestep)
 	m_scene->CreateNewContacts();
 	m_scene->CalculateContacts();
 	m_scene->DeleteDeadContacts();
+	m_scene->WakeTouchedIslands();
 
 	// update all special bodies.
 	m_scene->UpdateSpecial();
@@ -642,6 +717,23 @@ void ndWorld::ModelPostUpdate()
 	m_scene->ParallelExecute(ModelPostUpdate);
 }
 
+void ndWorld::SensorUpdate()
+{
+	D_TRACKTIME();
+	if (!m_sensorList.GetCount())
+	{
+		return;
+	}
+
+	// the sensors see the bodies where this update left them
+	m_scene->UpdateQueryAabbs();
+	for (ndSharedList<ndSensor>::ndNode* node = m_sensorList.GetFirst(); node; node = node->GetNext())
+	{
+		ndSensor* const sensor = *node->GetInfo();
+		sensor->Scan(this, m_scene);
+	}
+}
+
 void ndWorld::PostModelTransform()
 {
 	D_TRACKTIME();
@@ -951,6 +1043,12 @@ bool ndWorld::RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, c
 	return m_scene->RayCast(callback, globalOrigin, globalDest);
 }
 
+void ndWorld::RayCastBatch(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count)
+{
+	Sync();
+	m_scene->RayCastBatch(rays, hits, count);
+}
+
 bool ndWorld::ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const
 {
 	return m_scene->ConvexCast(callback, convexShape, globalOrigin, globalDest);
@@ -961,8 +1059,66 @@ void ndWorld::BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBo
 	m_scene->BodiesInAabb(callback, minBox, maxBox);
 }
 
+void ndWorld::ShapeOverlap(ndBodiesInAabbNotify& callback, const ndShapeInstance& shape, const ndMatrix& matrix) const
+{
+	m_scene->ShapeOverlap(callback, shape, matrix);
+}
+
+void ndWorld::ConvexCastBatch(const ndConvexCastQuery* const queries, ndConvexCastHit* const hits, ndInt32 count)
+{
+	Sync();
+	m_scene->ConvexCastBatch(queries, hits, count);
+}
+
+void ndWorld::BodiesInAabbBatch(const ndAabbQuery* const queries, ndInt32 count, ndOverlapBatchResult& result)
+{
+	Sync();
+	m_scene->BodiesInAabbBatch(queries, count, result);
+}
+
+void ndWorld::ShapeOverlapBatch(const ndShapeOverlapQuery* const queries, ndInt32 count, ndOverlapBatchResult& result)
+{
+	Sync();
+	m_scene->ShapeOverlapBatch(queries, count, result);
+}
+
+// the simd solvers live side by side in the binary, pick the widest 
+// one at or below the requested width that this cpu can run.
+static ndWorld::ndSolverModes ndClampSimdSolver(ndWorld::ndSolverModes solverMode)
+{
+	const ndUnsigned32 features = ndGetCpuSimdFeatures();
+	if (solverMode == ndWorld::ndSimdBestSolver)
+	{
+		solverMode = ndWorld::ndSimdAvx512Solver;
+	}
+
+	if (solverMode == ndWorld::ndSimdAvx512Solver)
+	{
+		#ifdef _D_USE_AVX512_SOLVER
+		if (features & ndCpuAvx512)
+		{
+			return solverMode;
+		}
+		#endif
+		solverMode = ndWorld::ndSimdAvx2Solver;
+	}
+
+	if (solverMode == ndWorld::ndSimdAvx2Solver)
+	{
+		#ifdef _D_USE_AVX2_SOLVER
+		if (features & ndCpuAvx2)
+		{
+			return solverMode;
+		}
+		#endif
+		solverMode = ndWorld::ndSimdSoaSolver;
+	}
+	return solverMode;
+}
+
 void ndWorld::SelectSolver(ndSolverModes solverMode)
 {
+	solverMode = ndClampSimdSolver(solverMode);
 	if (solverMode != m_solverMode)
 	{
 		Sync();
@@ -1000,6 +1156,26 @@ void ndWorld::SelectSolver(ndSolverModes solverMode)
 				break;
 			}
 
+			case ndSimdAvx512Solver:
+			{
+				#ifdef _D_USE_AVX512_SOLVER
+					ndWorldScene* const newScene = new ndWorldSceneAvx512(*((ndWorldScene*)m_scene));
+					delete m_scene;
+					m_scene = newScene;
+
+					m_solverMode = solverMode;
+					m_solver = new ndDynamicsUpdateAvx512(this);
+				#else
+					ndWorldScene* const newScene = new ndWorldScene(*((ndWorldScene*)m_scene));
+					delete m_scene;
+					m_scene = newScene;
+
+					m_solverMode = ndSimdSoaSolver;
+					m_solver = new ndDynamicsUpdateSoa(this);
+				#endif
+				break;
+			}
+
 			case ndCudaSolver:
 			{
 				#ifdef _D_NEWTON_CUDA
@@ -1032,6 +1208,28 @@ void ndWorld::SelectSolver(ndSolverModes solverMode)
 				break;
 			}
 
+			case ndGraphColoredSolver:
+			{
+				ndWorldScene* const newScene = new ndWorldScene(*((ndWorldScene*)m_scene));
+				delete m_scene;
+				m_scene = newScene;
+
+				m_solverMode = solverMode;
+				m_solver = new ndDynamicsUpdateColored(this);
+				break;
+			}
+
+			case ndIslandTaskSolver:
+			{
+				ndWorldScene* const newScene = new ndWorldScene(*((ndWorldScene*)m_scene));
+				delete m_scene;
+				m_scene = newScene;
+
+				m_solverMode = solverMode;
+				m_solver = new ndDynamicsUpdateIsland(this);
+				break;
+			}
+
 			case ndStandardSolver:
 			default:
 			{
@@ -1079,6 +1277,29 @@ void ndWorld::Update(ndFloat32 timestep)
 
 void ndWorld::RemoveBody(ndSharedPtr<ndBody>& body)
 {
+	if (*body == m_originFocusBody)
+	{
+		m_originFocusBody = nullptr;
+	}
+	for (ndSharedList<ndSensor>::ndNode* node = m_sensorList.GetFirst(); node; node = node->GetNext())
+	{
+		// the sensor stays where the body was
+		ndSensor* const sensor = *node->GetInfo();
+		if (*body == sensor->m_body)
+		{
+			sensor->m_localMatrix = sensor->GetGlobalMatrix();
+			sensor->m_body = nullptr;
+		}
+	}
+	for (ndInt32 i = 0; i < ndInt32(m_querySnapshots.GetCount()); ++i)
+	{
+		// a snapshot that can still be read keeps the body alive until it is rebuilt
+		ndSceneQuerySnapshot* const snapshot = m_querySnapshots[i];
+		if ((snapshot == m_publishedSnapshot) || snapshot->m_readers.load())
+		{
+			snapshot->m_retiredBodies.Append(body);
+		}
+	}
 	m_scene->RemoveBody(body);
 }
 
@@ -1146,6 +1367,31 @@ void ndWorld::RemoveModel(ndModel* const model)
 	}
 }
 
+void ndWorld::AddSensor(const ndSharedPtr<ndSensor>& sensor)
+{
+	Sync();
+	if (!sensor->m_worldNode)
+	{
+		sensor->m_worldNode = m_sensorList.Append(sensor);
+	}
+}
+
+void ndWorld::RemoveSensor(ndSensor* const sensor)
+{
+	Sync();
+	if (sensor->m_worldNode)
+	{
+		ndSharedList<ndSensor>::ndNode* const node = sensor->m_worldNode;
+		sensor->m_worldNode = nullptr;
+		m_sensorList.Remove(node);
+	}
+}
+
+const ndSharedList<ndSensor>& ndWorld::GetSensorList() const
+{
+	return m_sensorList;
+}
+
 void ndWorld::CalculateJointContacts(ndContact* const contact)
 {
 	ndBodyKinematic* const body0 = contact->GetBody0();
@@ -1156,7 +1402,162 @@ void ndWorld::CalculateJointContacts(ndContact* const contact)
 	m_scene->CalculateJointContacts(0, contact);
 }
 
+void ndWorld::ShiftOrigin(const ndVector& offset)
+{
+	Sync();
+	ApplyOriginShift(offset);
+}
+
+const ndBigVector& ndWorld::GetOriginOffset() const
+{
+	return m_originOffset;
+}
+
+void ndWorld::SetOriginRebase(ndBodyKinematic* const focusBody, ndFloat32 distance)
+{
+	Sync();
+	m_originFocusBody = focusBody;
+	m_originRebaseDistance = ndMax(distance, ndFloat32(0.0f));
+}
+
+void ndWorld::ApplyOriginShift(const ndVector& offset)
+{
+	const ndVector shift(m_scene->ShiftOrigin(offset));
+	if (shift.m_x || shift.m_y || shift.m_z)
+	{
+		// the published snapshot is in the old frame, the next step publishes a new one
+		ndScopeSpinLock lock(m_querySnapshotLock);
+		m_publishedSnapshot = nullptr;
+	}
+	m_originOffset += ndBigVector(shift);
+	for (ndSharedList<ndSensor>::ndNode* node = m_sensorList.GetFirst(); node; node = node->GetNext())
+	{
+		ndSensor* const sensor = *node->GetInfo();
+		if (!sensor->m_body)
+		{
+			sensor->m_localMatrix.m_posit -= shift & ndVector::m_triplexMask;
+		}
+	}
+}
+
+void ndWorld::RebaseOrigin()
+{
+	if (m_originFocusBody)
+	{
+		const ndVector posit(m_originFocusBody->GetMatrix().m_posit & ndVector::m_triplexMask);
+		const ndFloat32 dist2 = posit.DotProduct(posit).GetScalar();
+		if (dist2 > (m_originRebaseDistance * m_originRebaseDistance))
+		{
+			D_TRACKTIME();
+			ApplyOriginShift(posit);
+		}
+	}
+}
+
 bool ndWorld::ValidateScene() const
 {
 	return m_scene->ValidateScene();
-}
\ No newline at end of file
+}
+
+void ndWorld::SetQuerySnapshot(bool state)
+{
+	Sync();
+	m_querySnapshotEnabled = state;
+	if (state)
+	{
+		PublishQuerySnapshot();
+	}
+	else
+	{
+		ndScopeSpinLock lock(m_querySnapshotLock);
+		m_publishedSnapshot = nullptr;
+	}
+}
+
+bool ndWorld::GetQuerySnapshot() const
+{
+	return m_querySnapshotEnabled;
+}
+
+void ndWorld::SetBodyStateBuffer(bool state)
+{
+	m_bodyStateBuffer = state;
+}
+
+bool ndWorld::GetBodyStateBuffer() const
+{
+	return m_bodyStateBuffer;
+}
+
+const ndSceneQuerySnapshot* ndWorld::AcquireQuerySnapshot()
+{
+	ndScopeSpinLock lock(m_querySnapshotLock);
+	if (m_publishedSnapshot)
+	{
+		m_publishedSnapshot->m_readers.fetch_add(1);
+	}
+	return m_publishedSnapshot;
+}
+
+void ndWorld::ReleaseQuerySnapshot(const ndSceneQuerySnapshot* const snapshot)
+{
+	if (snapshot)
+	{
+		ndAssert(snapshot->m_readers.load() > 0);
+		snapshot->m_readers.fetch_add(-1);
+	}
+}
+
+void ndWorld::PublishQuerySnapshot()
+{
+	D_TRACKTIME();
+	// readers can only acquire the published snapshot, any other one 
+	// without readers is free to be rebuilt. Two are enough unless 
+	// a reader holds on to an old one.
+	ndSceneQuerySnapshot* snapshot = nullptr;
+	for (ndInt32 i = 0; i < ndInt32(m_querySnapshots.GetCount()); ++i)
+	{
+		ndSceneQuerySnapshot* const entry = m_querySnapshots[i];
+		if ((entry != m_publishedSnapshot) && !entry->m_readers.load())
+		{
+			snapshot = entry;
+			break;
+		}
+	}
+	if (!snapshot)
+	{
+		snapshot = new ndSceneQuerySnapshot();
+		m_querySnapshots.PushBack(snapshot);
+	}
+
+	m_querySnapshotVersion++;
+	snapshot->Build(m_scene, m_querySnapshotVersion);
+
+	ndScopeSpinLock lock(m_querySnapshotLock);
+	m_publishedSnapshot = snapshot;
+}
+
+void ndWorld::DeleteQuerySnapshots()
+{
+	{
+		ndScopeSpinLock lock(m_querySnapshotLock);
+		m_publishedSnapshot = nullptr;
+	}
+	for (ndInt32 i = 0; i < ndInt32(m_querySnapshots.GetCount()); ++i)
+	{
+		// a reader must release its snapshot before the world goes away,
+		// one that never does leaks the snapshot instead of hanging here.
+		ndSceneQuerySnapshot* const snapshot = m_querySnapshots[i];
+		const ndUnsigned64 timeout = ndGetTimeInMicroseconds() + D_QUERY_SNAPSHOT_RELEASE_TIMEOUT;
+		while (snapshot->m_readers.load() && (ndGetTimeInMicroseconds() < timeout))
+		{
+			ndThreadYield();
+		}
+		ndAssert(!snapshot->m_readers.load());
+		if (!snapshot->m_readers.load())
+		{
+			delete snapshot;
+		}
+	}
+	m_querySnapshots.SetCount(0);
+}
@@ -23,6 +23,7 @@
 #define __ND_WORLD_H__
 
 #include "ndNewtonStdafx.h"
+#include "ndSensor.h"
 #include "ndJointList.h"
 #include "ndSkeletonList.h"
 #include "dModels/ndModelList.h"
@@ -31,10 +32,18 @@ class ndWorld;
 class ndModel;
 class ndJointList;
 class ndBodyDynamic;
+class ndRayCastHit;
+class ndRayCastQuery;
 class ndRayCastNotify;
 class ndDynamicsUpdate;
 class ndConvexCastNotify;
+class ndAabbQuery;
+class ndConvexCastHit;
+class ndConvexCastQuery;
+class ndShapeOverlapQuery;
+class ndSceneQuerySnapshot;
 class ndBodiesInAabbNotify;
+class ndOverlapBatchResult;
 class ndJointBilateralConstraint;
 
 #define D_NEWTON_ENGINE_MAJOR_VERSION 4
@@ -52,6 +61,19 @@ class ndWorld: public ndClassAlloc
 		ndSimdSoaSolver,
 		ndSimdAvx2Solver,
 		ndCudaSolver,
+		ndGraphColoredSolver,
+		ndIslandTaskSolver,
+		ndSimdAvx512Solver,
+		ndSimdBestSolver,
+	};
+
+	// solver telemetry for the last update, all sub steps.
+	class ndSolverStats
+	{
+		public:
+		ndInt32 m_passes;
+		ndInt32 m_maxPasses;
+		ndFloat32 m_residual;
 	};
 
 	D_BASE_CLASS_REFLECTION(ndWorld)
@@ -79,6 +101,7 @@ class ndWorld: public ndClassAlloc
 	D_NEWTON_API ndScene* GetScene() const;
 	D_NEWTON_API bool IsHighPerformanceCompute() const;
 	D_NEWTON_API const char* GetSolverString() const;
+	D_NEWTON_API const ndDynamicsUpdate* GetSolver() const;
 	D_NEWTON_API ndBodyKinematic* GetSentinelBody() const;
 
 	D_NEWTON_API virtual bool AddBody(const ndSharedPtr<ndBody>& body);
@@ -102,6 +125,11 @@ class ndWorld: public ndClassAlloc
 
 	D_NEWTON_API ndInt32 GetSolverIterations() const;
 	D_NEWTON_API void SetSolverIterations(ndInt32 iterations);
+
+	D_NEWTON_API ndFloat32 GetSolverTolerance() const;
+	D_NEWTON_API void SetSolverTolerance(ndFloat32 tolerance);
+	D_NEWTON_API const ndSolverStats& GetSolverStats() const;
+	D_NEWTON_API const ndScene::ndSleepStats& GetSleepStats() const;
 	
 	D_NEWTON_API ndFloat32 GetUpdateTime() const;
 	D_NEWTON_API ndUnsigned32 GetFrameNumber() const;
@@ -117,13 +145,49 @@ class ndWorld: public ndClassAlloc
 	D_NEWTON_API void ClearCache();
 	D_NEWTON_API void BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const;
 	D_NEWTON_API bool RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, const ndVector& globalDest) const;
+	D_NEWTON_API void RayCastBatch(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count);
 	D_NEWTON_API bool ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
+	D_NEWTON_API void ShapeOverlap(ndBodiesInAabbNotify& callback, const ndShapeInstance& shape, const ndMatrix& matrix) const;
+	D_NEWTON_API void ConvexCastBatch(const ndConvexCastQuery* const queries, ndConvexCastHit* const hits, ndInt32 count);
+	D_NEWTON_API void BodiesInAabbBatch(const ndAabbQuery* const queries, ndInt32 count, ndOverlapBatchResult& result);
+	D_NEWTON_API void ShapeOverlapBatch(const ndShapeOverlapQuery* const queries, ndInt32 count, ndOverlapBatchResult& result);
 
 	D_NEWTON_API void CalculateJointContacts(ndContact* const contact);
 
+	// ray sensors are scanned by the world at the end of each update
+	D_NEWTON_API void AddSensor(const ndSharedPtr<ndSensor>& sensor);
+	D_NEWTON_API void RemoveSensor(ndSensor* const sensor);
+	D_NEWTON_API const ndSharedList<ndSensor>& GetSensorList() const;
+
+	// floating origin, the scene is shifted so that offset becomes the new origin.
+	// the accumulated offset maps the world back to absolute coordinates.
+	D_NEWTON_API void ShiftOrigin(const ndVector& offset);
+	D_NEWTON_API const ndBigVector& GetOriginOffset() const;
+
+	// shift the origin to the focus body at the start of an update when it
+	// moves farther than distance from the origin, a null body disables it.
+	D_NEWTON_API void SetOriginRebase(ndBodyKinematic* const focusBody, ndFloat32 distance);
+
+	// when enabled a read only copy of the broad phase and the body transforms is published
+	// at the end of each step. Any thread can acquire the latest copy and query it while the
+	// next step runs, each acquired snapshot must be released before the world is destroyed.
+	D_NEWTON_API void SetQuerySnapshot(bool state);
+	D_NEWTON_API bool GetQuerySnapshot() const;
+	D_NEWTON_API const ndSceneQuerySnapshot* AcquireQuerySnapshot();
+	D_NEWTON_API void ReleaseQuerySnapshot(const ndSceneQuerySnapshot* const snapshot);
+
+	// when enabled the scalar solvers gather the body data read by the joint loops
+	// into a structure of arrays each step, off by default.
+	D_NEWTON_API void SetBodyStateBuffer(bool state);
+	D_NEWTON_API bool GetBodyStateBuffer() const;
+
 	private:
 	void ThreadFunction();
+	void RebaseOrigin();
 	void DeleteDeferredObjects();
+	void ApplyOriginShift(const ndVector& offset);
+	void PublishQuerySnapshot();
+	void DeleteQuerySnapshots();
 	
 	protected:
 	D_NEWTON_API virtual void UpdateSkeletons();
@@ -158,6 +222,7 @@ class ndWorld: public ndClassAlloc
 
 	void ModelUpdate();
 	void ModelPostUpdate();
+	void SensorUpdate();
 	void CalculateAverageUpdateTime();
 	void SubStepUpdate(ndFloat32 timestep);
 	void ParticleUpdate(ndFloat32 timestep);
@@ -165,16 +230,23 @@ class ndWorld: public ndClassAlloc
 	bool SkeletonJointTest(ndJointBilateralConstraint* const jointA) const;
 	static ndInt32 CompareJointByInvMass(const ndJointBilateralConstraint* const jointA, const ndJointBilateralConstraint* const jointB, void* notUsed);
 
+	ndBigVector m_originOffset;
 	ndScene* m_scene;
 	ndDynamicsUpdate* m_solver;
+	ndBodyKinematic* m_originFocusBody;
 	ndJointList m_jointList;
 	ndModelList m_modelList;
 	ndSkeletonList m_skeletonList;
+	ndSharedList<ndSensor> m_sensorList;
 	ndSpecialList<ndBody> m_deletedBodies;
 	ndSpecialList<ndModel> m_deletedModels;
 	ndSpecialList<ndJointBilateralConstraint> m_deletedJoints;
 	ndArray<ndSkeletonContainer*> m_activeSkeletons;
+	ndArray<ndSceneQuerySnapshot*> m_querySnapshots;
+	ndSceneQuerySnapshot* m_publishedSnapshot;
+	ndSpinLock m_querySnapshotLock;
 	ndSpinLock m_deletedLock;
+	ndUnsigned64 m_querySnapshotVersion;
 
 	ndFloat32 m_timestep;
 	ndFloat32 m_freezeAccel2;
@@ -184,11 +256,16 @@ class ndWorld: public ndClassAlloc
 	ndFloat32 m_averageFramesCount;
 	ndFloat32 m_lastExecutionTime;
 	dgSolverProgressiveSleepEntry m_sleepTable[D_SLEEP_ENTRIES];
+	ndSolverStats m_solverStats;
+	ndFloat32 m_solverTolerance;
+	ndFloat32 m_originRebaseDistance;
 
 	ndInt32 m_subSteps;
 	ndSolverModes m_solverMode;
 	ndInt32 m_solverIterations;
 	bool m_inUpdate;
+	bool m_querySnapshotEnabled;
+	bool m_bodyStateBuffer;
 	
 	friend class ndScene;
 	friend class ndIkSolver;
@@ -198,7 +275,10 @@ class ndWorld: public ndClassAlloc
 	friend class ndSkeletonContainer;
 	friend class ndModelArticulation;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateColored;
+	friend class ndDynamicsUpdateIsland;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateCuda;
 } D_GCC_NEWTON_ALIGN_32;
 
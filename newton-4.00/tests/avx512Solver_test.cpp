@@ -0,0 +1,96 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+struct ndPileResult
+{
+	ndWorld::ndSolverModes m_mode;
+	ndFloat32 m_maxSag;
+	ndFloat32 m_maxDrift;
+};
+
+// a grid of short stacks, enough contacts to fill several 16 wide joint groups
+static ndPileResult SimulatePile(ndWorld::ndSolverModes mode)
+{
+	ndWorld world;
+	world.SelectSolver(mode);
+	world.SetSolverIterations(8);
+
+	ndSharedPtr<ndBody> floor(BuildFloor());
+	world.AddBody(floor);
+
+	const ndInt32 grid = 5;
+	const ndInt32 height = 4;
+	ndArray<ndBody*> boxes;
+	for (ndInt32 i = 0; i < grid; ++i)
+	{
+		for (ndInt32 j = 0; j < grid; ++j)
+		{
+			for (ndInt32 k = 0; k < height; ++k)
+			{
+				const ndVector posit(ndFloat32(i) * 2.0f, 0.25f + ndFloat32(k) * 0.5f, ndFloat32(j) * 2.0f, 1.0f);
+				ndSharedPtr<ndBody> box(BuildBox(posit));
+				world.AddBody(box);
+				boxes.PushBack(*box);
+			}
+		}
+	}
+
+	for (ndInt32 i = 0; i < 120; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+
+	ndPileResult result;
+	result.m_mode = world.GetSelectedSolver();
+	result.m_maxSag = 0.0f;
+	result.m_maxDrift = 0.0f;
+	for (ndInt32 i = 0; i < ndInt32(boxes.GetCount()); ++i)
+	{
+		const ndInt32 k = i % height;
+		const ndInt32 stack = i / height;
+		const ndVector posit(boxes[i]->GetMatrix().m_posit);
+		const ndFloat32 x0 = ndFloat32(stack / grid) * 2.0f;
+		const ndFloat32 z0 = ndFloat32(stack % grid) * 2.0f;
+		const ndFloat32 dx = posit.m_x - x0;
+		const ndFloat32 dz = posit.m_z - z0;
+		result.m_maxDrift = ndMax(result.m_maxDrift, ndSqrt(dx * dx + dz * dz));
+		result.m_maxSag = ndMax(result.m_maxSag, ndAbs(0.25f + ndFloat32(k) * 0.5f - posit.m_y));
+	}
+	return result;
+}
+
+/* the 16 wide solver must hold the same pile as the 4 wide one,
+ * on cpus without avx512 the world falls back to a narrower solver. */
+TEST(Avx512Solver, MatchesSoaSolver)
+{
+	const ndPileResult sse(SimulatePile(ndWorld::ndSimdSoaSolver));
+	const ndPileResult avx512(SimulatePile(ndWorld::ndSimdAvx512Solver));
+
+	#ifdef _D_USE_AVX512_SOLVER
+	if (ndGetCpuSimdFeatures() & ndCpuAvx512)
+	{
+		EXPECT_EQ(avx512.m_mode, ndWorld::ndSimdAvx512Solver);
+	}
+	else
+	#endif
+	{
+		EXPECT_NE(avx512.m_mode, ndWorld::ndSimdAvx512Solver);
+	}
+	EXPECT_LT(sse.m_maxSag, 0.05f);
+	EXPECT_LT(sse.m_maxDrift, 0.05f);
+	EXPECT_LT(avx512.m_maxSag, 0.05f);
+	EXPECT_LT(avx512.m_maxDrift, 0.05f);
+	EXPECT_NEAR(avx512.m_maxSag, sse.m_maxSag, 0.02f);
+}
@@ -0,0 +1,83 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+// two piles of boxes and a chain swinging into one of them, run with or without the body state buffer
+static void SimulateScene(ndWorld::ndSolverModes mode, ndInt32 threads, bool bodyState, ndArray<ndVector>& posit)
+{
+	ndWorld world;
+	world.SelectSolver(mode);
+	world.SetThreadCount(threads);
+	world.SetBodyStateBuffer(bodyState);
+	EXPECT_EQ(world.GetBodyStateBuffer(), bodyState);
+
+	ndSharedPtr<ndBody> floor(BuildFloor());
+	world.AddBody(floor);
+
+	ndArray<ndBody*> bodies;
+	for (ndInt32 i = 0; i < 2; ++i)
+	{
+		for (ndInt32 j = 0; j < 6; ++j)
+		{
+			ndSharedPtr<ndBody> box(BuildBox(ndVector(ndFloat32(i) * 3.0f, 0.25f + ndFloat32(j) * 0.5f, 0.0f, 1.0f)));
+			world.AddBody(box);
+			bodies.PushBack(*box);
+		}
+	}
+
+	ndShapeInstance sphere(new ndShapeSphere(0.2f));
+	ndBodyKinematic* parent = world.GetSentinelBody();
+	ndVector pivot(3.0f, 4.0f, 0.0f, 1.0f);
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		ndBodyDynamic* const link = BuildBody(sphere, pivot + ndVector(-0.6f, 0.0f, 0.0f, 0.0f));
+		ndSharedPtr<ndBody> linkPtr(link);
+		world.AddBody(linkPtr);
+		bodies.PushBack(link);
+
+		ndSharedPtr<ndJointBilateralConstraint> joint(new ndJointFixDistance(pivot, link->GetMatrix().m_posit, parent, link));
+		world.AddJoint(joint);
+		parent = link;
+		pivot = link->GetMatrix().m_posit;
+	}
+
+	Simulate(world, 120);
+	for (ndInt32 i = 0; i < ndInt32(bodies.GetCount()); ++i)
+	{
+		posit.PushBack(bodies[i]->GetMatrix().m_posit);
+	}
+}
+
+/* the buffer holds copies of the body data, the scalar solvers give the same bits with it */
+TEST(BodyStateBuffer, SameResults)
+{
+	const ndWorld::ndSolverModes modes[] = { ndWorld::ndStandardSolver, ndWorld::ndGraphColoredSolver, ndWorld::ndIslandTaskSolver };
+	const char* const names[] = { "default", "colored", "islands" };
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		for (ndInt32 threads = 1; threads <= 4; threads += 3)
+		{
+			ndArray<ndVector> reference;
+			ndArray<ndVector> buffered;
+			SimulateScene(modes[i], threads, false, reference);
+			SimulateScene(modes[i], threads, true, buffered);
+			ASSERT_EQ(reference.GetCount(), buffered.GetCount());
+			for (ndInt32 j = 0; j < ndInt32(reference.GetCount()); ++j)
+			{
+				EXPECT_EQ(reference[j].m_x, buffered[j].m_x) << names[i] << " solver, " << threads << " threads";
+				EXPECT_EQ(reference[j].m_y, buffered[j].m_y) << names[i] << " solver, " << threads << " threads";
+				EXPECT_EQ(reference[j].m_z, buffered[j].m_z) << names[i] << " solver, " << threads << " threads";
+			}
+		}
+	}
+}
@@ -0,0 +1,110 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+static ndBodyDynamic* BuildMeshFloor()
+{
+	ndPolygonSoupBuilder meshBuilder;
+	meshBuilder.Begin();
+	const ndInt32 cells = 16;
+	const ndFloat32 cellSize = 1.0f;
+	const ndFloat32 origin = -ndFloat32(cells) * cellSize * 0.5f;
+	for (ndInt32 i = 0; i < cells; ++i)
+	{
+		for (ndInt32 j = 0; j < cells; ++j)
+		{
+			const ndFloat32 x0 = origin + ndFloat32(i) * cellSize;
+			const ndFloat32 z0 = origin + ndFloat32(j) * cellSize;
+			const ndFloat32 x1 = x0 + cellSize;
+			const ndFloat32 z1 = z0 + cellSize;
+
+			ndVector face[3];
+			face[0] = ndVector(x0, 0.0f, z0, 0.0f);
+			face[1] = ndVector(x0, 0.0f, z1, 0.0f);
+			face[2] = ndVector(x1, 0.0f, z1, 0.0f);
+			meshBuilder.AddFace(&face[0].m_x, sizeof(ndVector), 3, 0);
+
+			face[0] = ndVector(x0, 0.0f, z0, 0.0f);
+			face[1] = ndVector(x1, 0.0f, z1, 0.0f);
+			face[2] = ndVector(x1, 0.0f, z0, 0.0f);
+			meshBuilder.AddFace(&face[0].m_x, sizeof(ndVector), 3, 0);
+		}
+	}
+	meshBuilder.End(false);
+
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	ndShapeInstance shape(new ndShapeStatic_bvh(meshBuilder));
+	body->SetMatrix(ndGetIdentityMatrix());
+	body->SetCollisionShape(shape);
+	return body;
+}
+
+static ndBodyDynamic* BuildCompound(ndInt32 size)
+{
+	// a flat slab made of size x size small boxes
+	ndShapeInstance compoundInstance(new ndShapeCompound());
+	ndShapeCompound* const compound = compoundInstance.GetShape()->GetAsShapeCompound();
+	compound->BeginAddRemove();
+	for (ndInt32 i = 0; i < size; ++i)
+	{
+		for (ndInt32 j = 0; j < size; ++j)
+		{
+			ndShapeInstance box(new ndShapeBox(0.25f, 0.25f, 0.25f));
+			ndMatrix matrix(ndGetIdentityMatrix());
+			matrix.m_posit = ndVector(ndFloat32(i - size / 2) * 0.25f, 0.0f, ndFloat32(j - size / 2) * 0.25f, 1.0f);
+			box.SetLocalMatrix(matrix);
+			compound->AddCollision(&box);
+		}
+	}
+	compound->EndAddRemove();
+
+	return BuildBody(compoundInstance, ndVector(0.1f, 0.5f, 0.2f, 1.0f), 10.0f, true);
+}
+
+static ndVector SimulateCompound(ndInt32 threadCount)
+{
+	ndWorld world;
+	world.SetThreadCount(threadCount);
+
+	ndSharedPtr<ndBody> floor(BuildMeshFloor());
+	ndSharedPtr<ndBody> slab(BuildCompound(12));
+	world.AddBody(floor);
+	world.AddBody(slab);
+
+	for (ndInt32 i = 0; i < 90; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+	return slab->GetMatrix().m_posit;
+}
+
+/* a compound with many children against a static mesh is split into
+ * sub tasks when there are worker threads, the result must match the
+ * single threaded narrow phase. */
+TEST(CompoundMesh, SplitPairContacts)
+{
+	const ndVector posit1(SimulateCompound(1));
+	const ndVector posit4(SimulateCompound(4));
+
+	EXPECT_NEAR(posit1.m_y, 0.125f, 0.02f);
+	EXPECT_NEAR(posit4.m_y, 0.125f, 0.02f);
+	EXPECT_NEAR(posit1.m_x, posit4.m_x, 0.02f);
+	EXPECT_NEAR(posit1.m_z, posit4.m_z, 0.02f);
+
+	// the thread manifolds merge in a fixed order, runs are reproducible
+	const ndVector repeat4(SimulateCompound(4));
+	EXPECT_EQ(posit4.m_x, repeat4.m_x);
+	EXPECT_EQ(posit4.m_y, repeat4.m_y);
+	EXPECT_EQ(posit4.m_z, repeat4.m_z);
+}
@@ -0,0 +1,105 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+// a flat slab made of size x size boxes of half a meter
+static ndShapeInstance BuildSlab(ndInt32 size)
+{
+	ndShapeInstance compoundInstance(new ndShapeCompound());
+	ndShapeCompound* const compound = compoundInstance.GetShape()->GetAsShapeCompound();
+	compound->BeginAddRemove();
+	for (ndInt32 i = 0; i < size; ++i)
+	{
+		for (ndInt32 j = 0; j < size; ++j)
+		{
+			ndShapeInstance box(new ndShapeBox(0.5f, 0.5f, 0.5f));
+			ndMatrix matrix(ndGetIdentityMatrix());
+			matrix.m_posit = ndVector(ndFloat32(i - size / 2) * 0.5f, 0.0f, ndFloat32(j - size / 2) * 0.5f, 1.0f);
+			box.SetLocalMatrix(matrix);
+			compound->AddCollision(&box);
+		}
+	}
+	compound->EndAddRemove();
+	return compoundInstance;
+}
+
+// a small compound resting on a large static one
+static ndBodyDynamic* BuildStack(ndWorld& world, ndBodyDynamic** const base)
+{
+	ndSharedPtr<ndBody> basePtr(BuildBody(BuildSlab(16), ndVector(0.0f, -0.25f, 0.0f, 1.0f), 0.0f));
+	ndSharedPtr<ndBody> slabPtr(BuildBody(BuildSlab(3), ndVector(0.1f, 0.75f, 0.2f, 1.0f), 10.0f));
+	world.AddBody(basePtr);
+	world.AddBody(slabPtr);
+	*base = basePtr->GetAsBodyDynamic();
+	return slabPtr->GetAsBodyDynamic();
+}
+
+/* a compound dropped on a static compound comes to rest on its top face */
+TEST(CompoundShape, CompoundOnCompound)
+{
+	ndWorld world;
+	ndBodyDynamic* base;
+	ndBodyDynamic* const slab = BuildStack(world, &base);
+	Simulate(world, 90);
+
+	EXPECT_NE(slab->FindContact(base), nullptr);
+	EXPECT_NEAR(slab->GetMatrix().m_posit.m_y, 0.25f, 0.02f);
+	EXPECT_NEAR(slab->GetMatrix().m_posit.m_x, 0.1f, 0.02f);
+	EXPECT_NEAR(slab->GetMatrix().m_posit.m_z, 0.2f, 0.02f);
+}
+
+/* a compound that loses all its children touches nothing, and collides again once it has one */
+TEST(CompoundShape, RemoveAllChildren)
+{
+	ndWorld world;
+	ndBodyDynamic* base;
+	ndBodyDynamic* const slab = BuildStack(world, &base);
+	Simulate(world, 60);
+	ASSERT_NEAR(slab->GetMatrix().m_posit.m_y, 0.25f, 0.02f);
+
+	ndShapeCompound* const compound = slab->GetCollisionShape().GetShape()->GetAsShapeCompound();
+	ndArray<ndShapeCompound::ndTreeArray::ndNode*> nodes;
+	ndShapeCompound::ndTreeArray::Iterator it(compound->GetTree());
+	for (it.Begin(); it; it++)
+	{
+		nodes.PushBack(it.GetNode());
+	}
+	compound->BeginAddRemove();
+	for (ndInt32 i = 0; i < ndInt32(nodes.GetCount()); ++i)
+	{
+		compound->RemoveNode(nodes[i]);
+	}
+	compound->EndAddRemove();
+	EXPECT_EQ(compound->GetTree().GetCount(), 0);
+
+	// editing the shape in place neither wakes the body nor refreshes its cached contacts
+	slab->SetVelocity(ndVector::m_zero);
+	slab->SetOmega(ndVector::m_zero);
+	slab->SetSleepState(false);
+
+	// the empty compound falls through the base
+	Simulate(world, 30);
+	EXPECT_LT(slab->GetMatrix().m_posit.m_y, -0.5f);
+
+	// with a child again it lands back on the base
+	ndShapeInstance box(new ndShapeBox(0.5f, 0.5f, 0.5f));
+	compound->BeginAddRemove();
+	compound->AddCollision(&box);
+	compound->EndAddRemove();
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit = ndVector(0.1f, 0.75f, 0.2f, 1.0f);
+	slab->SetMatrix(matrix);
+	slab->SetVelocity(ndVector::m_zero);
+	Simulate(world, 60);
+	EXPECT_NEAR(slab->GetMatrix().m_posit.m_y, 0.25f, 0.02f);
+}
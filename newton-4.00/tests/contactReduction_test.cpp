@@ -0,0 +1,101 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+static ndBodyDynamic* BuildDenseFloor(ndInt32 cells, ndFloat32 cellSize)
+{
+	// a flat grid of small triangles, not optimized, so that a box
+	// resting on it touches many coplanar faces.
+	ndPolygonSoupBuilder meshBuilder;
+	meshBuilder.Begin();
+	const ndFloat32 origin = -ndFloat32(cells) * cellSize * 0.5f;
+	for (ndInt32 i = 0; i < cells; ++i)
+	{
+		for (ndInt32 j = 0; j < cells; ++j)
+		{
+			const ndFloat32 x0 = origin + ndFloat32(i) * cellSize;
+			const ndFloat32 z0 = origin + ndFloat32(j) * cellSize;
+			const ndFloat32 x1 = x0 + cellSize;
+			const ndFloat32 z1 = z0 + cellSize;
+
+			ndVector face[3];
+			face[0] = ndVector(x0, 0.0f, z0, 0.0f);
+			face[1] = ndVector(x0, 0.0f, z1, 0.0f);
+			face[2] = ndVector(x1, 0.0f, z1, 0.0f);
+			meshBuilder.AddFace(&face[0].m_x, sizeof(ndVector), 3, 0);
+
+			face[0] = ndVector(x0, 0.0f, z0, 0.0f);
+			face[1] = ndVector(x1, 0.0f, z1, 0.0f);
+			face[2] = ndVector(x1, 0.0f, z0, 0.0f);
+			meshBuilder.AddFace(&face[0].m_x, sizeof(ndVector), 3, 0);
+		}
+	}
+	meshBuilder.End(false);
+
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	ndShapeInstance shape(new ndShapeStatic_bvh(meshBuilder));
+	body->SetMatrix(ndGetIdentityMatrix());
+	body->SetCollisionShape(shape);
+	return body;
+}
+
+static ndInt32 MaxContactPoints(ndWorld& world, bool reduce)
+{
+	world.GetScene()->SetContactReduction(reduce ? 4 : 0, 25.0f * ndDegreeToRad);
+
+	ndSharedPtr<ndBody> floor(BuildDenseFloor(32, 0.125f));
+	ndSharedPtr<ndBody> box(BuildBox(ndVector(0.03f, 0.3f, 0.07f, 1.0f), true));
+	world.AddBody(floor);
+	world.AddBody(box);
+
+	ndInt32 maxPoints = 0;
+	for (ndInt32 i = 0; i < 60; ++i)
+	{
+		Simulate(world, 1);
+
+		const ndBodyKinematic::ndContactMap& contactMap = box->GetAsBodyKinematic()->GetContactMap();
+		ndBodyKinematic::ndContactMap::Iterator it(contactMap);
+		for (it.Begin(); it; it++)
+		{
+			const ndContact* const contact = it.GetNode()->GetInfo();
+			if (contact->IsActive())
+			{
+				maxPoints = ndMax(maxPoints, ndInt32(contact->GetContactPoints().GetCount()));
+			}
+		}
+	}
+
+	// the box must come to rest on the floor either way
+	EXPECT_NEAR(box->GetMatrix().m_posit.m_y, 0.25f, 0.02f);
+	return maxPoints;
+}
+
+TEST(ContactReduction, DenseMeshManifold)
+{
+	ndInt32 fullCount = 0;
+	{
+		ndWorld world;
+		EXPECT_EQ(world.GetScene()->GetContactReductionPoints(), 0);
+		fullCount = MaxContactPoints(world, false);
+	}
+
+	ndInt32 reducedCount = 0;
+	{
+		ndWorld world;
+		reducedCount = MaxContactPoints(world, true);
+	}
+
+	EXPECT_GT(fullCount, 4);
+	EXPECT_LE(reducedCount, 4);
+	EXPECT_GT(reducedCount, 0);
+}
@@ -0,0 +1,79 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+struct ndWarmStartResult
+{
+	ndInt32 m_passes;
+	ndFloat32 m_topError;
+	ndFloat32 m_maxDrift;
+};
+
+static ndWarmStartResult SimulateStack(ndFloat32 warmStart, ndInt32 height)
+{
+	ndWorld world;
+	world.SetSolverIterations(16);
+	world.SetSolverTolerance(0.5f);
+	world.GetScene()->SetContactWarmStart(warmStart);
+
+	ndSharedPtr<ndBody> floor(BuildFloor(20.0f));
+	world.AddBody(floor);
+
+	ndArray<ndBody*> stack;
+	for (ndInt32 i = 0; i < height; ++i)
+	{
+		ndSharedPtr<ndBody> box(BuildBox(ndVector(0.0f, 0.25f + ndFloat32(i) * 0.5f, 0.0f, 1.0f)));
+		world.AddBody(box);
+		stack.PushBack(*box);
+	}
+
+	ndWarmStartResult result;
+	result.m_passes = 0;
+	for (ndInt32 i = 0; i < 180; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+		// only count the passes once the stack has settled
+		if (i >= 60)
+		{
+			result.m_passes += world.GetSolverStats().m_passes;
+		}
+	}
+
+	result.m_maxDrift = 0.0f;
+	for (ndInt32 i = 0; i < height; ++i)
+	{
+		const ndVector posit(stack[i]->GetMatrix().m_posit);
+		const ndFloat32 drift = ndSqrt(posit.m_x * posit.m_x + posit.m_z * posit.m_z);
+		result.m_maxDrift = ndMax(result.m_maxDrift, drift);
+	}
+	const ndFloat32 topY = stack[height - 1]->GetMatrix().m_posit.m_y;
+	result.m_topError = 0.25f + ndFloat32(height - 1) * 0.5f - topY;
+	return result;
+}
+
+/* a resting stack reuses the contact forces of the previous frame when the
+ * contact points match, the warm started solver must hold the stack and
+ * reach the tolerance in no more passes than a cold started one. */
+TEST(ContactWarmStart, RestingStackPasses)
+{
+	const ndInt32 height = 12;
+	const ndWarmStartResult cold(SimulateStack(0.0f, height));
+	const ndWarmStartResult warm(SimulateStack(1.0f, height));
+
+	EXPECT_LT(ndAbs(warm.m_topError), 0.25f);
+	EXPECT_LT(warm.m_maxDrift, 0.05f);
+	EXPECT_LT(cold.m_maxDrift, 0.05f);
+	EXPECT_LT(warm.m_passes, cold.m_passes);
+	EXPECT_LE(ndAbs(warm.m_topError), ndAbs(cold.m_topError));
+}
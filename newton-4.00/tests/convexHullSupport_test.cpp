@@ -0,0 +1,63 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndVector RandomUnitVector()
+{
+	ndVector dir(ndVector::m_zero);
+	do
+	{
+		dir = ndVector(ndRand() * 2.0f - 1.0f, ndRand() * 2.0f - 1.0f, ndRand() * 2.0f - 1.0f, 0.0f);
+	} while (dir.DotProduct(dir).GetScalar() < 1.0e-3f);
+	return dir.Normalize();
+}
+
+/* support vertex of hulls of increasing vertex count against a brute
+ * force search over the input points, in many directions. */
+TEST(ConvexHull, SupportVertex)
+{
+	const ndInt32 queryCount = 4000;
+	const ndInt32 vertexCounts[] = { 16, 32, 64, 128, 256, 512, 1024, 2048 };
+
+	ndSetRandSeed(12345);
+	ndArray<ndVector> directions;
+	for (ndInt32 i = 0; i < queryCount; ++i)
+	{
+		directions.PushBack(RandomUnitVector());
+	}
+
+	for (ndInt32 k = 0; k < ndInt32(sizeof(vertexCounts) / sizeof(vertexCounts[0])); ++k)
+	{
+		// points on a sphere are all extreme points of the hull
+		ndArray<ndVector> points;
+		for (ndInt32 i = 0; i < vertexCounts[k]; ++i)
+		{
+			points.PushBack(RandomUnitVector());
+		}
+		ndShapeInstance hull(new ndShapeConvexHull(vertexCounts[k], sizeof(ndVector), 0.0f, &points[0].m_x));
+
+		ndFloat32 maxError = 0.0f;
+		for (ndInt32 i = 0; i < queryCount; ++i)
+		{
+			const ndVector& dir = directions[i];
+			ndFloat32 maxProj = -1.0e10f;
+			for (ndInt32 j = 0; j < points.GetCount(); ++j)
+			{
+				maxProj = ndMax(maxProj, points[j].DotProduct(dir).GetScalar());
+			}
+			const ndVector support(hull.SupportVertex(dir));
+			maxError = ndMax(maxError, maxProj - support.DotProduct(dir).GetScalar());
+		}
+		EXPECT_LT(maxError, 1.0e-3f) << vertexCounts[k] << " hull vertices";
+	}
+}
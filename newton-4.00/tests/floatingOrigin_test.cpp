@@ -0,0 +1,119 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+// a pile of boxes on a floor and a pendulum hanging from the world
+static void BuildScene(ndWorld& world, const ndVector& origin, ndArray<ndBodyDynamic*>& bodies)
+{
+	ndSharedPtr<ndBody> floor(BuildFloor(40.0f, origin));
+	world.AddBody(floor);
+
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		ndBodyDynamic* const body = BuildBox(origin + ndVector(0.0f, 0.25f + ndFloat32(i) * 0.5f, 0.0f, 1.0f), true);
+		ndSharedPtr<ndBody> bodyPtr(body);
+		world.AddBody(bodyPtr);
+		bodies.PushBack(body);
+	}
+
+	ndShapeInstance sphere(new ndShapeSphere(0.2f));
+	ndBodyDynamic* const bob = BuildBody(sphere, origin + ndVector(6.0f, 5.0f, 0.0f, 1.0f));
+	ndSharedPtr<ndBody> bobPtr(bob);
+	world.AddBody(bobPtr);
+	bodies.PushBack(bob);
+
+	const ndVector pivot(origin + ndVector(4.0f, 5.0f, 0.0f, 1.0f));
+	ndSharedPtr<ndJointBilateralConstraint> joint(new ndJointFixDistance(bob->GetMatrix().m_posit, pivot, bob, world.GetSentinelBody()));
+	world.AddJoint(joint);
+}
+
+/* shifting the origin in the middle of a run must not change the simulation,
+ * the pile keeps resting, the world joint keeps its pivot and the broad phase still works. */
+TEST(FloatingOrigin, ShiftKeepsSimulation)
+{
+	const ndVector origin(1000.0f, 0.0f, -2000.0f, 0.0f);
+
+	ndArray<ndBodyDynamic*> reference;
+	ndWorld referenceWorld;
+	BuildScene(referenceWorld, ndVector::m_zero, reference);
+	Simulate(referenceWorld, 120);
+
+	ndArray<ndBodyDynamic*> shifted;
+	ndWorld world;
+	BuildScene(world, origin, shifted);
+	Simulate(world, 60);
+	world.ShiftOrigin(origin);
+	Simulate(world, 60);
+
+	const ndBigVector& offset = world.GetOriginOffset();
+	EXPECT_EQ(offset.m_x, 1000.0f);
+	EXPECT_EQ(offset.m_z, -2000.0f);
+
+	ndFloat32 maxError = 0.0f;
+	for (ndInt32 i = 0; i < ndInt32(shifted.GetCount()); ++i)
+	{
+		const ndVector diff(shifted[i]->GetMatrix().m_posit - reference[i]->GetMatrix().m_posit);
+		maxError = ndMax(maxError, ndSqrt(diff.DotProduct(diff & ndVector::m_triplexMask).GetScalar()));
+	}
+	EXPECT_LT(maxError, 0.02f);
+
+	// the pendulum is still two meters from the world pivot
+	const ndVector arm(shifted[4]->GetMatrix().m_posit - ndVector(4.0f, 5.0f, 0.0f, 1.0f));
+	EXPECT_NEAR(ndSqrt(arm.DotProduct(arm & ndVector::m_triplexMask).GetScalar()), 2.0f, 0.02f);
+
+	// the broad phase boxes moved with the bodies
+	ndRayCastClosestHitCallback ray;
+	EXPECT_TRUE(world.RayCast(ray, ndVector(0.0f, 10.0f, 0.0f, 1.0f), ndVector(0.0f, -10.0f, 0.0f, 1.0f)));
+	EXPECT_EQ(ray.m_contact.m_body0, shifted[3]);
+}
+
+/* a sleeping pile is shifted too, and wakes up in the right place */
+TEST(FloatingOrigin, ShiftSleepingIslands)
+{
+	ndArray<ndBodyDynamic*> bodies;
+	ndWorld world;
+	BuildScene(world, ndVector::m_zero, bodies);
+	Simulate(world, 240);
+	ASSERT_TRUE(bodies[0]->GetIslandSleepState());
+
+	const ndVector posit0(bodies[3]->GetMatrix().m_posit);
+	world.ShiftOrigin(ndVector(0.0f, 0.0f, 500.0f, 0.0f));
+	const ndVector posit1(bodies[3]->GetMatrix().m_posit);
+	EXPECT_NEAR(posit1.m_z, posit0.m_z - 500.0f, 1.0e-3f);
+
+	bodies[3]->SetVelocity(ndVector(0.0f, 1.0f, 0.0f, 0.0f));
+	Simulate(world, 60);
+	EXPECT_NEAR(bodies[0]->GetMatrix().m_posit.m_y, 0.25f, 0.02f);
+	EXPECT_NEAR(bodies[3]->GetMatrix().m_posit.m_z, -500.0f, 0.05f);
+}
+
+/* the world rebases itself on a fast body, absolute positions are kept in double */
+TEST(FloatingOrigin, AutomaticRebase)
+{
+	ndWorld world;
+	ndShapeInstance sphere(new ndShapeSphere(0.5f));
+	ndBodyDynamic* const body = BuildBody(sphere, ndVector(0.0f, 0.0f, 0.0f, 1.0f));
+	body->SetNotifyCallback(new ndBodyNotify(ndVector::m_zero));
+	body->SetVelocity(ndVector(50.0f, 0.0f, 0.0f, 0.0f));
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+
+	world.SetOriginRebase(body, 100.0f);
+	Simulate(world, 180);
+
+	const ndBigVector& offset = world.GetOriginOffset();
+	const ndFloat64 absolute = offset.m_x + body->GetMatrix().m_posit.m_x;
+	EXPECT_GE(offset.m_x, 100.0f);
+	EXPECT_LT(body->GetMatrix().m_posit.m_x, 100.0f);
+	EXPECT_NEAR(absolute, 150.0f, 0.5f);
+}
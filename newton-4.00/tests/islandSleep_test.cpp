@@ -0,0 +1,170 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+// two separate piles of boxes, each one its own island
+static ndBodyDynamic* BuildPiles(ndWorld& world, ndArray<ndBodyDynamic*>& boxes)
+{
+	ndBodyDynamic* const floor = BuildFloor();
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	ndShapeInstance box(new ndShapeBox(1.0f, 0.5f, 1.0f));
+	for (ndInt32 i = 0; i < 2; ++i)
+	{
+		for (ndInt32 j = 0; j < 4; ++j)
+		{
+			ndBodyDynamic* const body = BuildBody(box, ndVector(ndFloat32(i) * 10.0f, 0.25f + ndFloat32(j) * 0.5f, 0.0f, 1.0f), 1.0f, true);
+			ndSharedPtr<ndBody> bodyPtr(body);
+			world.AddBody(bodyPtr);
+			boxes.PushBack(body);
+		}
+	}
+	return floor;
+}
+
+/* resting piles leave the scene arrays, touching one wakes only its island */
+TEST(IslandSleep, DeactivateAndWake)
+{
+	ndWorld world;
+	ndArray<ndBodyDynamic*> boxes;
+	BuildPiles(world, boxes);
+
+	Simulate(world, 240);
+	const ndScene::ndSleepStats& stats = world.GetSleepStats();
+	EXPECT_EQ(stats.m_activeBodies, 1);
+	EXPECT_EQ(stats.m_sleepingBodies, ndInt32(boxes.GetCount()));
+	EXPECT_GT(stats.m_parkedContacts, 0);
+	for (ndInt32 i = 0; i < ndInt32(boxes.GetCount()); ++i)
+	{
+		EXPECT_TRUE(boxes[i]->GetIslandSleepState());
+	}
+
+	// kick the top box of the first pile
+	boxes[3]->SetVelocity(ndVector(2.0f, 0.0f, 0.0f, 0.0f));
+	Simulate(world, 1);
+	EXPECT_EQ(stats.m_wokenBodies, 4);
+	EXPECT_EQ(stats.m_sleepingBodies, 4);
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		EXPECT_FALSE(boxes[i]->GetIslandSleepState());
+		EXPECT_TRUE(boxes[i + 4]->GetIslandSleepState());
+	}
+
+	Simulate(world, 30);
+	EXPECT_GT(boxes[3]->GetMatrix().m_posit.m_x, 0.1f);
+	EXPECT_NEAR(boxes[4]->GetMatrix().m_posit.m_x, 10.0f, 1.0e-3f);
+}
+
+/* a body falling on a sleeping pile wakes it through the broad phase */
+TEST(IslandSleep, WakeOnNewContact)
+{
+	ndWorld world;
+	ndArray<ndBodyDynamic*> boxes;
+	BuildPiles(world, boxes);
+	Simulate(world, 240);
+	ASSERT_TRUE(boxes[7]->GetIslandSleepState());
+
+	ndShapeInstance sphere(new ndShapeSphere(0.25f));
+	ndSharedPtr<ndBody> ball(BuildBody(sphere, ndVector(10.0f, 4.0f, 0.0f, 1.0f), 1.0f, true));
+	world.AddBody(ball);
+	Simulate(world, 60);
+
+	EXPECT_FALSE(boxes[7]->GetIslandSleepState());
+	EXPECT_TRUE(boxes[0]->GetIslandSleepState());
+	EXPECT_GT(ball->GetMatrix().m_posit.m_y, 2.0f);
+}
+
+/* a body placed on a sleeping pile wakes it and collides in the same step */
+TEST(IslandSleep, WakeInSameStep)
+{
+	ndWorld world;
+	ndArray<ndBodyDynamic*> boxes;
+	BuildPiles(world, boxes);
+	Simulate(world, 240);
+	ASSERT_TRUE(boxes[7]->GetIslandSleepState());
+
+	ndShapeInstance sphere(new ndShapeSphere(0.25f));
+	ndBodyDynamic* const ball = BuildBody(sphere, ndVector(10.0f, 2.24f, 0.0f, 1.0f), 1.0f, true);
+	ndSharedPtr<ndBody> ballPtr(ball);
+	world.AddBody(ballPtr);
+	Simulate(world, 1);
+
+	EXPECT_EQ(world.GetSleepStats().m_wokenBodies, 4);
+	EXPECT_FALSE(boxes[7]->GetIslandSleepState());
+	EXPECT_TRUE(boxes[0]->GetIslandSleepState());
+	const ndContact* const contact = ball->FindContact(boxes[7]);
+	ASSERT_NE(contact, nullptr);
+	EXPECT_TRUE(contact->IsActive());
+	EXPECT_GT(ball->GetVelocity().m_y, -0.05f);
+}
+
+/* moving a static body wakes only the islands it touched or now overlaps */
+TEST(IslandSleep, StaticBodyWakesTouchedIslands)
+{
+	ndWorld world;
+	ndArray<ndBodyDynamic*> boxes;
+	ndBodyDynamic* const floor = BuildPiles(world, boxes);
+
+	ndBodyDynamic* const wall = new ndBodyDynamic();
+	ndShapeInstance wallShape(new ndShapeBox(1.0f, 2.0f, 1.0f));
+	ndMatrix wallMatrix(ndGetIdentityMatrix());
+	wallMatrix.m_posit = ndVector(12.0f, 1.0f, 0.0f, 1.0f);
+	wall->SetMatrix(wallMatrix);
+	wall->SetCollisionShape(wallShape);
+	ndSharedPtr<ndBody> wallPtr(wall);
+	world.AddBody(wallPtr);
+
+	Simulate(world, 240);
+	const ndScene::ndSleepStats& stats = world.GetSleepStats();
+	ASSERT_EQ(stats.m_sleepingBodies, ndInt32(boxes.GetCount()));
+
+	// the floor under both piles set to the same transform
+	floor->SetMatrix(floor->GetMatrix());
+	Simulate(world, 1);
+	EXPECT_EQ(stats.m_wokenBodies, 0);
+
+	// the wall moves away from both piles
+	wallMatrix.m_posit.m_x = 13.0f;
+	wall->SetMatrix(wallMatrix);
+	Simulate(world, 1);
+	EXPECT_EQ(stats.m_wokenBodies, 0);
+
+	// the wall moves into the second pile
+	wallMatrix.m_posit.m_x = 10.9f;
+	wall->SetMatrix(wallMatrix);
+	Simulate(world, 1);
+	EXPECT_EQ(stats.m_wokenBodies, 4);
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		EXPECT_TRUE(boxes[i]->GetIslandSleepState());
+		EXPECT_FALSE(boxes[i + 4]->GetIslandSleepState());
+	}
+}
+
+/* removing sleeping bodies and the floor under them must leave a valid scene */
+TEST(IslandSleep, RemoveSleepingBodies)
+{
+	ndWorld world;
+	ndArray<ndBodyDynamic*> boxes;
+	BuildPiles(world, boxes);
+	Simulate(world, 240);
+
+	world.RemoveBody(boxes[0]);
+	world.RemoveBody(boxes[5]);
+	Simulate(world, 60);
+	EXPECT_LT(boxes[1]->GetMatrix().m_posit.m_y, 0.5f);
+
+	world.CleanUp();
+	EXPECT_EQ(world.GetSleepStats().m_parkedContacts, 0);
+}
@@ -0,0 +1,240 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+// a tall stack and many short ones, each one is an independent island.
+static void SimulateStacks(ndWorld::ndSolverModes mode, ndArray<ndVector>& posits)
+{
+	ndWorld world;
+	world.SelectSolver(mode);
+
+	ndSharedPtr<ndBody> floor(BuildFloor(100.0f));
+	world.AddBody(floor);
+
+	ndArray<ndBody*> boxes;
+	for (ndInt32 i = 0; i < 8; ++i)
+	{
+		const ndInt32 height = i ? 2 : 12;
+		for (ndInt32 j = 0; j < height; ++j)
+		{
+			ndSharedPtr<ndBody> box(BuildBox(ndVector(ndFloat32(i) * 3.0f, 0.25f + ndFloat32(j) * 0.5f, 0.0f, 1.0f), true));
+			world.AddBody(box);
+			boxes.PushBack(*box);
+		}
+	}
+
+	for (ndInt32 i = 0; i < 120; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+
+	posits.SetCount(0);
+	for (ndInt32 i = 0; i < boxes.GetCount(); ++i)
+	{
+		posits.PushBack(boxes[i]->GetMatrix().m_posit);
+	}
+}
+
+/* islands solved as separate tasks with their own pass budget 
+ * must hold every stack standing just like the global solver. */
+TEST(IslandSolver, IndependentStacks)
+{
+	ndArray<ndVector> standard;
+	ndArray<ndVector> islands;
+	SimulateStacks(ndWorld::ndStandardSolver, standard);
+	SimulateStacks(ndWorld::ndIslandTaskSolver, islands);
+
+	ASSERT_EQ(standard.GetCount(), islands.GetCount());
+	for (ndInt32 i = 0; i < islands.GetCount(); ++i)
+	{
+		EXPECT_NEAR(islands[i].m_y, standard[i].m_y, 0.05f);
+		EXPECT_NEAR(islands[i].m_x, standard[i].m_x, 0.1f);
+		EXPECT_NEAR(islands[i].m_z, standard[i].m_z, 0.1f);
+	}
+}
+
+// a grid of short stacks, hundreds of islands built by all threads at once.
+static ndFloat32 SimulateGrid(ndInt32 threadCount, ndArray<ndVector>& posits)
+{
+	ndWorld world;
+	world.SetThreadCount(threadCount);
+	world.SelectSolver(ndWorld::ndIslandTaskSolver);
+
+	ndSharedPtr<ndBody> floor(BuildFloor(100.0f));
+	world.AddBody(floor);
+
+	ndArray<ndBody*> boxes;
+	for (ndInt32 i = 0; i < 16; ++i)
+	{
+		for (ndInt32 j = 0; j < 16; ++j)
+		{
+			for (ndInt32 k = 0; k < 3; ++k)
+			{
+				ndSharedPtr<ndBody> box(BuildBox(ndVector(ndFloat32(i) * 2.0f - 16.0f, 0.25f + ndFloat32(k) * 0.5f, ndFloat32(j) * 2.0f - 16.0f, 1.0f), true));
+				world.AddBody(box);
+				boxes.PushBack(*box);
+			}
+		}
+	}
+
+	for (ndInt32 i = 0; i < 90; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+
+	ndFloat32 maxSag = 0.0f;
+	posits.SetCount(0);
+	for (ndInt32 i = 0; i < boxes.GetCount(); ++i)
+	{
+		const ndVector posit(boxes[i]->GetMatrix().m_posit);
+		maxSag = ndMax(maxSag, ndAbs(0.25f + ndFloat32(i % 3) * 0.5f - posit.m_y));
+		posits.PushBack(posit);
+	}
+	return maxSag;
+}
+
+/* the concurrent union find must build the same islands on any number of threads */
+TEST(IslandSolver, ConcurrentIslandBuild)
+{
+	ndArray<ndVector> serial;
+	ndArray<ndVector> threaded;
+	const ndFloat32 sag0 = SimulateGrid(1, serial);
+	const ndFloat32 sag1 = SimulateGrid(4, threaded);
+
+	EXPECT_LT(sag0, 0.05f);
+	EXPECT_LT(sag1, 0.05f);
+	ASSERT_EQ(serial.GetCount(), threaded.GetCount());
+	for (ndInt32 i = 0; i < threaded.GetCount(); ++i)
+	{
+		EXPECT_NEAR(threaded[i].m_x, serial[i].m_x, 0.02f);
+		EXPECT_NEAR(threaded[i].m_y, serial[i].m_y, 0.02f);
+		EXPECT_NEAR(threaded[i].m_z, serial[i].m_z, 0.02f);
+	}
+}
+
+// pendulum chains are skeletons, each one shares its island with a pile of boxes.
+// each of the six chains is a skeleton, while they swing every one 
+// of them must be solved by the task of the island that owns it.
+static void SimulateChains(ndWorld::ndSolverModes mode, ndInt32 threadCount, ndArray<ndVector>& posits, ndInt32* const unassignedSteps = nullptr)
+{
+	ndWorld world;
+	world.SetThreadCount(threadCount);
+	world.SelectSolver(mode);
+
+	ndSharedPtr<ndBody> floor(BuildFloor(100.0f));
+	world.AddBody(floor);
+
+	ndArray<ndBody*> bodies;
+	ndShapeInstance sphere(new ndShapeSphere(0.2f));
+	for (ndInt32 i = 0; i < 6; ++i)
+	{
+		const ndFloat32 x = ndFloat32(i) * 4.0f;
+		for (ndInt32 j = 0; j < 3; ++j)
+		{
+			ndSharedPtr<ndBody> box(BuildBox(ndVector(x, 0.25f + ndFloat32(j) * 0.5f, 0.0f, 1.0f), true));
+			world.AddBody(box);
+			bodies.PushBack(*box);
+		}
+
+		ndBodyDynamic* const anchor = new ndBodyDynamic();
+		ndMatrix anchorMatrix(ndGetIdentityMatrix());
+		anchorMatrix.m_posit = ndVector(x, 3.0f, 0.0f, 1.0f);
+		anchor->SetMatrix(anchorMatrix);
+		anchor->SetCollisionShape(ndShapeInstance(new ndShapeNull()));
+		ndSharedPtr<ndBody> anchorPtr(anchor);
+		world.AddBody(anchorPtr);
+
+		// the chain swings down onto the pile under the anchor
+		ndBodyKinematic* parent = anchor;
+		for (ndInt32 j = 0; j < 4; ++j)
+		{
+			ndBodyDynamic* const link = new ndBodyDynamic();
+			ndMatrix matrix(ndGetIdentityMatrix());
+			matrix.m_posit = ndVector(x, 3.0f, ndFloat32(j + 1) * 0.5f, 1.0f);
+			link->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, -10.0f, 0.0f, 0.0f)));
+			link->SetMatrix(matrix);
+			link->SetCollisionShape(sphere);
+			link->SetMassMatrix(1.0f, sphere);
+			ndSharedPtr<ndBody> linkPtr(link);
+			world.AddBody(linkPtr);
+			bodies.PushBack(link);
+
+			ndMatrix pivot(ndGetIdentityMatrix());
+			pivot.m_posit = parent->GetMatrix().m_posit;
+			ndJointSpherical* const joint = new ndJointSpherical(pivot, link, parent);
+			joint->SetSolverModel(m_jointkinematicOpenLoop);
+			ndSharedPtr<ndJointBilateralConstraint> jointPtr(joint);
+			world.AddJoint(jointPtr);
+			parent = link;
+		}
+	}
+
+	for (ndInt32 i = 0; i < 120; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+
+		if (unassignedSteps && (i < 30))
+		{
+			const ndDynamicsUpdateIsland* const solver = (ndDynamicsUpdateIsland*)world.GetSolver();
+			const ndArray<ndDynamicsUpdateIsland::ndIslandTask>& tasks = solver->GetIslandTasks();
+			ndInt32 skeletons = 0;
+			for (ndInt32 j = 0; j < tasks.GetCount(); ++j)
+			{
+				skeletons += tasks[j].m_skeletonCount;
+			}
+			*unassignedSteps += ((skeletons != 6) || solver->GetFreeSkeletonCount()) ? 1 : 0;
+		}
+	}
+
+	posits.SetCount(0);
+	for (ndInt32 i = 0; i < bodies.GetCount(); ++i)
+	{
+		posits.PushBack(bodies[i]->GetMatrix().m_posit);
+	}
+}
+
+/* each skeleton is solved by the task of its island, concurrently with the other 
+ * islands, the result must not depend on which thread picked the island. */
+TEST(IslandSolver, SkeletonsInIslandTasks)
+{
+	ndArray<ndVector> serial;
+	ndArray<ndVector> threaded;
+	ndInt32 unassignedSteps = 0;
+	SimulateChains(ndWorld::ndIslandTaskSolver, 1, serial);
+	SimulateChains(ndWorld::ndIslandTaskSolver, 4, threaded, &unassignedSteps);
+	EXPECT_EQ(unassignedSteps, 0);
+
+	ASSERT_EQ(serial.GetCount(), threaded.GetCount());
+	for (ndInt32 i = 0; i < threaded.GetCount(); ++i)
+	{
+		EXPECT_NEAR(threaded[i].m_x, serial[i].m_x, 0.02f);
+		EXPECT_NEAR(threaded[i].m_y, serial[i].m_y, 0.02f);
+		EXPECT_NEAR(threaded[i].m_z, serial[i].m_z, 0.02f);
+		EXPECT_GT(threaded[i].m_y, 0.0f);
+	}
+
+	// every chain is 7 bodies, 3 boxes and 4 links, the links must stay half a meter apart
+	ndFloat32 maxStretch = 0.0f;
+	for (ndInt32 i = 0; i < threaded.GetCount(); i += 7)
+	{
+		for (ndInt32 j = 4; j < 7; ++j)
+		{
+			const ndVector dist(threaded[i + j] - threaded[i + j - 1]);
+			maxStretch = ndMax(maxStretch, ndAbs(ndSqrt(dist.DotProduct(dist & ndVector::m_triplexMask).GetScalar()) - 0.5f));
+		}
+	}
+	EXPECT_LT(maxStretch, 0.02f);
+}
@@ -0,0 +1,198 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+static ndBodyDynamic* BuildPart(ndWorld& world, const ndShapeInstance& shape, const ndVector& posit, ndFloat32 mass)
+{
+	ndBodyDynamic* const body = BuildBody(shape, posit, mass);
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+	return body;
+}
+
+// a ragdoll lying along x, torso, head, two arms and two legs
+static void BuildRagdoll(ndWorld& world, const ndVector& origin, bool reuse, ndArray<ndBodyDynamic*>& parts, ndArray<ndJointBilateralConstraint*>& joints)
+{
+	ndShapeInstance torsoShape(new ndShapeBox(0.6f, 0.2f, 0.4f));
+	ndShapeInstance headShape(new ndShapeSphere(0.12f));
+	ndShapeInstance limbShape(new ndShapeCapsule(0.07f, 0.07f, 0.4f));
+
+	ndBodyDynamic* const torso = BuildPart(world, torsoShape, origin, 10.0f);
+	parts.PushBack(torso);
+
+	const ndVector offsets[] = {
+		ndVector(0.45f, 0.0f, 0.0f, 0.0f),
+		ndVector(0.1f, 0.0f, 0.3f, 0.0f),
+		ndVector(0.1f, 0.0f, -0.3f, 0.0f),
+		ndVector(-0.6f, 0.0f, 0.1f, 0.0f),
+		ndVector(-0.6f, 0.0f, -0.1f, 0.0f),
+	};
+	const ndVector pivots[] = {
+		ndVector(0.32f, 0.0f, 0.0f, 0.0f),
+		ndVector(0.3f, 0.0f, 0.3f, 0.0f),
+		ndVector(0.3f, 0.0f, -0.3f, 0.0f),
+		ndVector(-0.3f, 0.0f, 0.1f, 0.0f),
+		ndVector(-0.3f, 0.0f, -0.1f, 0.0f),
+	};
+	for (ndInt32 i = 0; i < 5; ++i)
+	{
+		const ndShapeInstance& shape = i ? limbShape : headShape;
+		ndBodyDynamic* const part = BuildPart(world, shape, origin + offsets[i], 2.0f);
+		parts.PushBack(part);
+
+		ndMatrix pivot(ndGetIdentityMatrix());
+		pivot.m_posit = origin + pivots[i];
+		ndJointSpherical* const joint = new ndJointSpherical(pivot, part, torso);
+		joint->SetJacobianReuse(reuse);
+		ndSharedPtr<ndJointBilateralConstraint> jointPtr(joint);
+		world.AddJoint(jointPtr);
+		joints.PushBack(joint);
+	}
+}
+
+static void BuildPile(ndWorld& world, ndInt32 size, bool reuse, ndArray<ndBodyDynamic*>& parts, ndArray<ndJointBilateralConstraint*>& joints)
+{
+	ndSharedPtr<ndBody> floor(BuildFloor(60.0f));
+	world.AddBody(floor);
+	for (ndInt32 i = 0; i < size; ++i)
+	{
+		for (ndInt32 j = 0; j < size; ++j)
+		{
+			for (ndInt32 k = 0; k < 3; ++k)
+			{
+				const ndVector origin(ndFloat32(i) * 2.5f, 0.2f + ndFloat32(k) * 0.45f, ndFloat32(j) * 1.5f, 1.0f);
+				BuildRagdoll(world, origin, reuse, parts, joints);
+			}
+		}
+	}
+}
+
+static ndInt32 CountReused(const ndArray<ndJointBilateralConstraint*>& joints)
+{
+	ndInt32 count = 0;
+	for (ndInt32 i = 0; i < ndInt32(joints.GetCount()); ++i)
+	{
+		count += joints[i]->GetJacobianReused() ? 1 : 0;
+	}
+	return count;
+}
+
+/* a settled ragdoll reuses its rows and ends where the rebuilt one does */
+TEST(JacobianReuse, RestingRagdoll)
+{
+	ndArray<ndBodyDynamic*> reference;
+	ndArray<ndBodyDynamic*> cached;
+	ndArray<ndJointBilateralConstraint*> referenceJoints;
+	ndArray<ndJointBilateralConstraint*> cachedJoints;
+
+	ndWorld referenceWorld;
+	ndSharedPtr<ndBody> floor0(BuildFloor(60.0f));
+	referenceWorld.AddBody(floor0);
+	BuildRagdoll(referenceWorld, ndVector(0.0f, 0.2f, 0.0f, 1.0f), false, reference, referenceJoints);
+	Simulate(referenceWorld, 240);
+
+	ndWorld world;
+	ndSharedPtr<ndBody> floor1(BuildFloor(60.0f));
+	world.AddBody(floor1);
+	BuildRagdoll(world, ndVector(0.0f, 0.2f, 0.0f, 1.0f), true, cached, cachedJoints);
+	Simulate(world, 240);
+
+	const ndInt32 reused = CountReused(cachedJoints);
+	EXPECT_EQ(CountReused(referenceJoints), 0);
+	EXPECT_GE(reused, 3);
+
+	for (ndInt32 i = 0; i < ndInt32(cached.GetCount()); ++i)
+	{
+		const ndVector diff(cached[i]->GetMatrix().m_posit - reference[i]->GetMatrix().m_posit);
+		EXPECT_LT(ndSqrt(diff.DotProduct(diff & ndVector::m_triplexMask).GetScalar()), 0.02f);
+	}
+
+	// a kick moves the bodies past the tolerance and the rows are rebuilt
+	cached[0]->SetVelocity(ndVector(0.0f, 3.0f, 0.0f, 0.0f));
+	Simulate(world, 1);
+	EXPECT_EQ(CountReused(cachedJoints), 0);
+	Simulate(world, 120);
+	for (ndInt32 i = 0; i < ndInt32(cachedJoints.GetCount()); ++i)
+	{
+		ndMatrix matrix0;
+		ndMatrix matrix1;
+		cachedJoints[i]->CalculateGlobalMatrix(matrix0, matrix1);
+		const ndVector error(matrix1.m_posit - matrix0.m_posit);
+		EXPECT_LT(ndSqrt(error.DotProduct(error & ndVector::m_triplexMask).GetScalar()), 0.02f);
+	}
+}
+
+// a bar spinning slowly about a hinge to the world, no gravity
+static ndJointHinge* BuildSpinningBar(ndWorld& world, bool reuse)
+{
+	ndShapeInstance shape(new ndShapeBox(0.2f, 1.0f, 0.2f));
+	ndBodyDynamic* const bar = BuildPart(world, shape, ndVector(0.0f, 0.5f, 0.0f, 1.0f), 1.0f);
+	bar->SetNotifyCallback(new ndBodyNotify(ndVector::m_zero));
+	bar->SetOmega(ndVector(0.02f, 0.0f, 0.0f, 0.0f));
+	bar->SetVelocity(ndVector(0.0f, 0.0f, 0.01f, 0.0f));
+
+	ndJointHinge* const joint = new ndJointHinge(ndGetIdentityMatrix(), bar, world.GetSentinelBody());
+	joint->SetJacobianReuse(reuse);
+	ndSharedPtr<ndJointBilateralConstraint> jointPtr(joint);
+	world.AddJoint(jointPtr);
+	return joint;
+}
+
+/* a hinge reports its current angle on the steps that reuse its rows */
+TEST(JacobianReuse, HingeAngleOnReusedSteps)
+{
+	ndWorld referenceWorld;
+	ndWorld world;
+	ndJointHinge* const reference = BuildSpinningBar(referenceWorld, false);
+	ndJointHinge* const hinge = BuildSpinningBar(world, true);
+
+	ndInt32 reusedSteps = 0;
+	for (ndInt32 i = 0; i < 120; ++i)
+	{
+		Simulate(referenceWorld, 1);
+		Simulate(world, 1);
+		reusedSteps += hinge->GetJacobianReused() ? 1 : 0;
+		EXPECT_NEAR(hinge->GetAngle(), reference->GetAngle(), 1.0e-4f);
+		EXPECT_NEAR(hinge->GetOmega(), reference->GetOmega(), 1.0e-4f);
+	}
+	EXPECT_GT(reusedSteps, 60);
+	EXPECT_GT(ndAbs(hinge->GetAngle()), 0.002f);
+}
+
+/* a pile of resting ragdolls reuses the rows of many joints and none falls through the floor */
+TEST(JacobianReuse, RestingRagdollPile)
+{
+	for (ndInt32 m = 0; m < 2; ++m)
+	{
+		ndWorld world;
+		world.SetThreadCount(2);
+		ndArray<ndBodyDynamic*> parts;
+		ndArray<ndJointBilateralConstraint*> joints;
+		BuildPile(world, 4, m ? true : false, parts, joints);
+		Simulate(world, 240);
+
+		const ndInt32 reused = CountReused(joints);
+		if (m)
+		{
+			EXPECT_GT(reused, ndInt32(joints.GetCount()) / 3);
+		}
+		else
+		{
+			EXPECT_EQ(reused, 0);
+		}
+		for (ndInt32 i = 0; i < ndInt32(parts.GetCount()); ++i)
+		{
+			EXPECT_GT(parts[i]->GetMatrix().m_posit.m_y, -0.1f);
+		}
+	}
+}
@@ -0,0 +1,104 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#ifndef __ND_TEST_UTILS_H__
+#define __ND_TEST_UTILS_H__
+
+#include "ndNewton.h"
+
+// scene factories shared by the solver and scene tests
+constexpr ndFloat32 TIME_STEP = (1.0f / 60.0f);
+constexpr ndInt32 GRID_SIZE = 16;
+constexpr ndFloat32 GRID_SPACING = 2.0f;
+
+// a body without mass, the floors and props of the tests
+inline ndBodyDynamic* BuildStatic(const ndShapeInstance& shape, const ndVector& posit)
+{
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit = posit;
+	body->SetMatrix(matrix);
+	body->SetCollisionShape(shape);
+	return body;
+}
+
+// a static slab with its top face at y = 0, offset by origin
+inline ndBodyDynamic* BuildFloor(ndFloat32 size = 40.0f, const ndVector& origin = ndVector::m_zero)
+{
+	ndShapeInstance shape(new ndShapeBox(size, 1.0f, size));
+	return BuildStatic(shape, origin + ndVector(0.0f, -0.5f, 0.0f, 1.0f));
+}
+
+// a dynamic body under gravity, awake unless auto sleep is asked for,
+// the body can be of a class of the caller
+inline ndBodyDynamic* BuildBody(ndBodyDynamic* const body, const ndShapeInstance& shape, const ndVector& posit, ndFloat32 mass = 1.0f, bool autoSleep = false)
+{
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit = posit;
+	body->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, -10.0f, 0.0f, 0.0f)));
+	body->SetMatrix(matrix);
+	body->SetCollisionShape(shape);
+	body->SetMassMatrix(mass, shape);
+	body->SetAutoSleep(autoSleep);
+	return body;
+}
+
+inline ndBodyDynamic* BuildBody(const ndShapeInstance& shape, const ndVector& posit, ndFloat32 mass = 1.0f, bool autoSleep = false)
+{
+	return BuildBody(new ndBodyDynamic(), shape, posit, mass, autoSleep);
+}
+
+// the 1 x 0.5 x 1 brick of the stack tests
+inline ndBodyDynamic* BuildBox(ndBodyDynamic* const body, const ndVector& posit, bool autoSleep = false)
+{
+	ndShapeInstance shape(new ndShapeBox(1.0f, 0.5f, 1.0f));
+	return BuildBody(body, shape, posit, 1.0f, autoSleep);
+}
+
+inline ndBodyDynamic* BuildBox(const ndVector& posit, bool autoSleep = false)
+{
+	return BuildBox(new ndBodyDynamic(), posit, autoSleep);
+}
+
+inline void Simulate(ndWorld& world, ndInt32 steps)
+{
+	for (ndInt32 i = 0; i < steps; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+}
+
+// an 80 wide floor and a grid of weightless boxes and spheres on it, the floor is the first body
+inline void BuildGrid(ndWorld& world, ndArray<ndBodyDynamic*>& bodies)
+{
+	ndSharedPtr<ndBody> floor(BuildFloor(80.0f));
+	world.AddBody(floor);
+	bodies.PushBack(floor->GetAsBodyDynamic());
+
+	ndShapeInstance box(new ndShapeBox(1.0f, 1.0f, 1.0f));
+	ndShapeInstance sphere(new ndShapeSphere(0.5f));
+	for (ndInt32 i = 0; i < GRID_SIZE; ++i)
+	{
+		for (ndInt32 j = 0; j < GRID_SIZE; ++j)
+		{
+			const ndShapeInstance& shape = ((i + j) & 1) ? sphere : box;
+			ndBodyDynamic* const body = BuildStatic(shape, ndVector(ndFloat32(i) * GRID_SPACING, 0.5f, ndFloat32(j) * GRID_SPACING, 1.0f));
+			body->SetMassMatrix(1.0f, shape);
+			ndSharedPtr<ndBody> bodyPtr(body);
+			world.AddBody(bodyPtr);
+			bodies.PushBack(body);
+		}
+	}
+	Simulate(world, 1);
+}
+
+#endif
@@ -0,0 +1,139 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+// a flat procedural grid at y = 0 that counts the calls to the face callback
+class ndCountingProceduralGrid : public ndShapeStaticProceduralMesh
+{
+	public:
+	ndCountingProceduralGrid(ndFloat32 gridSize)
+		:ndShapeStaticProceduralMesh(200.0f, 1.0f, 200.0f)
+		,m_gridSize(gridSize)
+		,m_calls(0)
+		,m_invalidateOnCall(-1)
+	{
+	}
+
+	virtual void GetCollidingFaces(const ndVector& minBox, const ndVector& maxBox, ndArray<ndVector>& vertex, ndArray<ndInt32>& faceList, ndArray<ndInt32>& faceMaterial, ndArray<ndInt32>& indexListList) const
+	{
+		// emulate another thread changing the geometry while a region is built
+		if (m_calls.fetch_add(1) == m_invalidateOnCall)
+		{
+			((ndCountingProceduralGrid*)this)->InvalidateFaceCache();
+		}
+
+		const ndFloat32 invGridSize = ndFloat32(1.0f) / m_gridSize;
+		const ndVector p0(minBox.Scale(invGridSize).Floor());
+		const ndVector p1(maxBox.Scale(invGridSize).Floor() + ndVector::m_one);
+		ndVector origin(p0.Scale(m_gridSize) & ndVector::m_triplexMask);
+		const ndInt32 count_x = ndInt32(p1.m_x - p0.m_x);
+		const ndInt32 count_z = ndInt32(p1.m_z - p0.m_z);
+
+		origin.m_y = 0.0f;
+		for (ndInt32 iz = 0; iz <= count_z; iz++)
+		{
+			ndVector point(origin);
+			for (ndInt32 ix = 0; ix <= count_x; ix++)
+			{
+				vertex.PushBack(point);
+				point.m_x += m_gridSize;
+			}
+			origin.m_z += m_gridSize;
+		}
+
+		const ndInt32 stride = count_x + 1;
+		for (ndInt32 iz = 0; iz < count_z; iz++)
+		{
+			for (ndInt32 ix = 0; ix < count_x; ix++)
+			{
+				faceList.PushBack(4);
+				indexListList.PushBack((iz + 0) * stride + ix + 0);
+				indexListList.PushBack((iz + 1) * stride + ix + 0);
+				indexListList.PushBack((iz + 1) * stride + ix + 1);
+				indexListList.PushBack((iz + 0) * stride + ix + 1);
+				faceMaterial.PushBack(0);
+			}
+		}
+	}
+
+	ndFloat32 m_gridSize;
+	mutable ndAtomic<ndInt32> m_calls;
+	ndInt32 m_invalidateOnCall;
+};
+
+static ndCountingProceduralGrid* AddGrid(ndWorld& world, ndFloat32 cacheCellSize)
+{
+	ndCountingProceduralGrid* const grid = new ndCountingProceduralGrid(0.5f);
+	grid->SetFaceCache(cacheCellSize);
+	ndShapeInstance shape(grid);
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	body->SetMatrix(ndGetIdentityMatrix());
+	body->SetCollisionShape(shape);
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+	return (ndCountingProceduralGrid*)body->GetCollisionShape().GetShape();
+}
+
+/* boxes resting on a cached grid build each region once and rest like on the uncached grid */
+TEST(ProceduralMesh, FaceCacheReusesRegions)
+{
+	ndVector posit[2][4];
+	ndInt32 calls[2];
+	for (ndInt32 pass = 0; pass < 2; ++pass)
+	{
+		ndWorld world;
+		ndCountingProceduralGrid* const grid = AddGrid(world, pass ? 4.0f : 0.0f);
+		ndBodyDynamic* boxes[4];
+		for (ndInt32 i = 0; i < 4; ++i)
+		{
+			boxes[i] = BuildBox(ndVector(ndFloat32(i) * 3.0f + 0.3f, 0.75f, 0.7f, 1.0f), true);
+			ndSharedPtr<ndBody> boxPtr(boxes[i]);
+			world.AddBody(boxPtr);
+		}
+		Simulate(world, 120);
+		for (ndInt32 i = 0; i < 4; ++i)
+		{
+			posit[pass][i] = boxes[i]->GetMatrix().m_posit;
+		}
+		// with the cache every miss builds and inserts one region
+		calls[pass] = grid->m_calls.load();
+		EXPECT_EQ(grid->GetFaceCacheCount(), pass ? calls[pass] : 0);
+	}
+
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		EXPECT_NEAR(posit[0][i].m_y, 0.25f, 0.01f);
+		EXPECT_NEAR(posit[1][i].m_y, 0.25f, 0.01f);
+	}
+	EXPECT_GT(calls[0], 100);
+	EXPECT_LT(calls[1], 16);
+}
+
+/* faces built while the cache is invalidated serve the query but are not inserted */
+TEST(ProceduralMesh, InvalidateDuringMiss)
+{
+	ndWorld world;
+	ndCountingProceduralGrid* const grid = AddGrid(world, 4.0f);
+	ndSharedPtr<ndBody> box(BuildBox(ndVector(0.3f, 0.75f, 0.7f, 1.0f), true));
+	world.AddBody(box);
+	grid->m_invalidateOnCall = 0;
+
+	Simulate(world, 1);
+	ASSERT_EQ(grid->m_calls.load(), 1);
+	EXPECT_EQ(grid->GetFaceCacheCount(), 0);
+
+	// later misses are inserted again
+	Simulate(world, 60);
+	EXPECT_GT(grid->m_calls.load(), 1);
+	EXPECT_EQ(grid->GetFaceCacheCount(), grid->m_calls.load() - 1);
+}
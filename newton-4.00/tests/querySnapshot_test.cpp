@@ -0,0 +1,211 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include <thread>
+#include <atomic>
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+constexpr ndInt32 COLUMNS = 6;
+
+class ndTrackedBody : public ndBodyDynamic
+{
+	public:
+	ndTrackedBody(bool* const deleted)
+		:ndBodyDynamic()
+		,m_deleted(deleted)
+	{
+		*m_deleted = false;
+	}
+
+	~ndTrackedBody()
+	{
+		*m_deleted = true;
+	}
+
+	bool* m_deleted;
+};
+
+// a grid of boxes falling from different heights onto a floor
+static void BuildScene(ndWorld& world, ndArray<ndBodyDynamic*>& boxes)
+{
+	ndSharedPtr<ndBody> floor(BuildFloor());
+	world.AddBody(floor);
+	for (ndInt32 i = 0; i < COLUMNS; ++i)
+	{
+		for (ndInt32 j = 0; j < COLUMNS; ++j)
+		{
+			ndBodyDynamic* const body = BuildBox(ndVector(ndFloat32(i) * 2.0f, 2.0f + ndFloat32(i + j), ndFloat32(j) * 2.0f, 1.0f), true);
+			ndSharedPtr<ndBody> bodyPtr(body);
+			world.AddBody(bodyPtr);
+			boxes.PushBack(body);
+		}
+	}
+}
+
+static ndInt32 FindBody(const ndSceneQuerySnapshot* const snapshot, const ndBody* const body)
+{
+	for (ndInt32 i = 0; i < snapshot->GetBodyCount(); ++i)
+	{
+		if (snapshot->GetBody(i) == body)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* once the bodies rest a snapshot answers queries like the synchronized scene */
+TEST(QuerySnapshot, MatchesScene)
+{
+	ndWorld world;
+	ndArray<ndBodyDynamic*> boxes;
+	BuildScene(world, boxes);
+	EXPECT_EQ(world.AcquireQuerySnapshot(), nullptr);
+
+	world.SetQuerySnapshot(true);
+	Simulate(world, 300);
+
+	const ndSceneQuerySnapshot* const snapshot = world.AcquireQuerySnapshot();
+	ASSERT_NE(snapshot, nullptr);
+	EXPECT_EQ(snapshot->GetVersion(), 301u);
+	EXPECT_EQ(snapshot->GetBodyCount(), COLUMNS * COLUMNS + 1);
+
+	ndSetRandSeed(3);
+	for (ndInt32 i = 0; i < 500; ++i)
+	{
+		const ndVector origin(ndRand() * 12.0f - 1.0f, 15.0f, ndRand() * 12.0f - 1.0f, 1.0f);
+		const ndVector dest(origin + ndVector(ndRand() * 4.0f - 2.0f, -20.0f, ndRand() * 4.0f - 2.0f, 0.0f));
+		ndRayCastClosestHitCallback sceneRay;
+		ndRayCastClosestHitCallback snapshotRay;
+		const bool sceneHit = world.RayCast(sceneRay, origin, dest);
+		const bool snapshotHit = snapshot->RayCast(snapshotRay, origin, dest);
+		ASSERT_EQ(sceneHit, snapshotHit);
+		if (sceneHit)
+		{
+			EXPECT_EQ(sceneRay.m_contact.m_body0, snapshotRay.m_contact.m_body0);
+			EXPECT_NEAR(sceneRay.m_param, snapshotRay.m_param, 1.0e-4f);
+			EXPECT_NEAR(sceneRay.m_contact.m_normal.m_y, snapshotRay.m_contact.m_normal.m_y, 1.0e-4f);
+		}
+
+		const ndVector size(ndRand() * 3.0f, ndRand() * 3.0f, ndRand() * 3.0f, 0.0f);
+		ndBodiesInAabbNotify sceneBoxes;
+		ndBodiesInAabbNotify snapshotBoxes;
+		world.BodiesInAabb(sceneBoxes, origin - size - ndVector(0.0f, 12.0f, 0.0f, 0.0f), origin + size - ndVector(0.0f, 12.0f, 0.0f, 0.0f));
+		snapshot->BodiesInAabb(snapshotBoxes, origin - size - ndVector(0.0f, 12.0f, 0.0f, 0.0f), origin + size - ndVector(0.0f, 12.0f, 0.0f, 0.0f));
+		EXPECT_EQ(sceneBoxes.m_bodyArray.GetCount(), snapshotBoxes.m_bodyArray.GetCount());
+	}
+	world.ReleaseQuerySnapshot(snapshot);
+
+	// an origin shift withdraws the snapshot until the next step
+	world.ShiftOrigin(ndVector(10.0f, 0.0f, 0.0f, 0.0f));
+	EXPECT_EQ(world.AcquireQuerySnapshot(), nullptr);
+	Simulate(world, 1);
+	const ndSceneQuerySnapshot* const shifted = world.AcquireQuerySnapshot();
+	ASSERT_NE(shifted, nullptr);
+	EXPECT_NEAR(shifted->GetMatrix(FindBody(shifted, boxes[0])).m_posit.m_x, -10.0f, 1.0e-3f);
+	world.ReleaseQuerySnapshot(shifted);
+}
+
+/* a game thread ray casts the snapshots while the world runs the next steps,
+ * every hit lands on the top face of the box where the snapshot has it. */
+TEST(QuerySnapshot, ConcurrentRayCasts)
+{
+	ndWorld world;
+	world.SetThreadCount(2);
+	ndArray<ndBodyDynamic*> boxes;
+	BuildScene(world, boxes);
+	world.SetQuerySnapshot(true);
+
+	std::atomic<bool> done(false);
+	std::atomic<ndInt32> queries(0);
+	std::atomic<ndInt32> errors(0);
+	std::atomic<ndInt32> regressions(0);
+	auto GameThread = [&world, &boxes, &done, &queries, &errors, &regressions]()
+	{
+		ndUnsigned64 lastVersion = 0;
+		while (!done.load())
+		{
+			const ndSceneQuerySnapshot* const snapshot = world.AcquireQuerySnapshot();
+			if (!snapshot)
+			{
+				continue;
+			}
+			regressions += (snapshot->GetVersion() < lastVersion) ? 1 : 0;
+			lastVersion = snapshot->GetVersion();
+			for (ndInt32 i = 0; i < ndInt32(boxes.GetCount()); ++i)
+			{
+				const ndInt32 index = FindBody(snapshot, boxes[i]);
+				const ndVector posit(snapshot->GetMatrix(index).m_posit);
+				ndRayCastClosestHitCallback ray;
+				if (!snapshot->RayCast(ray, posit + ndVector(0.0f, 30.0f, 0.0f, 0.0f), posit - ndVector(0.0f, 30.0f, 0.0f, 0.0f)))
+				{
+					errors++;
+				}
+				else if ((ray.m_contact.m_body0 != boxes[i]) || (ndAbs(ray.m_contact.m_point.m_y - posit.m_y - 0.25f) > 1.0e-3f))
+				{
+					errors++;
+				}
+				queries++;
+			}
+			world.ReleaseQuerySnapshot(snapshot);
+		}
+	};
+
+	std::thread gameThread(GameThread);
+	for (ndInt32 step = 0; step < 120; ++step)
+	{
+		world.Update(TIME_STEP);
+		std::this_thread::yield();
+		world.Sync();
+	}
+	done.store(true);
+	gameThread.join();
+
+	EXPECT_GT(queries.load(), 0);
+	EXPECT_EQ(errors.load(), 0);
+	EXPECT_EQ(regressions.load(), 0);
+	EXPECT_NEAR(boxes[0]->GetMatrix().m_posit.m_y, 0.25f, 0.05f);
+}
+
+/* a removed body lives as long as a snapshot that can still report it */
+TEST(QuerySnapshot, RemovedBodyOutlivesSnapshot)
+{
+	ndWorld world;
+	ndArray<ndBodyDynamic*> boxes;
+	BuildScene(world, boxes);
+
+	bool deleted = false;
+	ndTrackedBody* const body = new ndTrackedBody(&deleted);
+	// the world holds the only reference
+	world.AddBody(ndSharedPtr<ndBody>(BuildBox(body, ndVector(-5.0f, 0.25f, -5.0f, 1.0f), true)));
+	world.SetQuerySnapshot(true);
+
+	const ndSceneQuerySnapshot* const snapshot = world.AcquireQuerySnapshot();
+	ASSERT_NE(snapshot, nullptr);
+	world.RemoveBody(body);
+	Simulate(world, 4);
+	EXPECT_FALSE(deleted);
+
+	ndRayCastClosestHitCallback ray;
+	EXPECT_TRUE(snapshot->RayCast(ray, ndVector(-5.0f, 10.0f, -5.0f, 1.0f), ndVector(-5.0f, -10.0f, -5.0f, 1.0f)));
+	EXPECT_EQ(ray.m_contact.m_body0, body);
+	world.ReleaseQuerySnapshot(snapshot);
+
+	Simulate(world, 2);
+	EXPECT_TRUE(deleted);
+
+	const ndSceneQuerySnapshot* const latest = world.AcquireQuerySnapshot();
+	ASSERT_NE(latest, nullptr);
+	EXPECT_EQ(FindBody(latest, body), -1);
+	EXPECT_EQ(latest->GetBodyCount(), COLUMNS * COLUMNS + 1);
+	world.ReleaseQuerySnapshot(latest);
+}
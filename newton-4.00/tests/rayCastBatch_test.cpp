@@ -0,0 +1,245 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+// rays from random points above the grid to random points below the floor and past its edge
+static void BuildRays(ndArray<ndRayCastQuery>& rays, ndInt32 count)
+{
+	ndSetRandSeed(17);
+	const ndFloat32 size = ndFloat32(GRID_SIZE) * GRID_SPACING;
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		const ndVector origin(ndRand() * size - 2.0f, 3.0f + ndRand() * 2.0f, ndRand() * size - 2.0f, 1.0f);
+		const ndVector dest(origin + ndVector(ndRand() * 8.0f - 4.0f, -6.0f, ndRand() * 8.0f - 4.0f, 0.0f));
+		rays.PushBack(ndRayCastQuery(origin, dest));
+	}
+}
+
+/* every ray of the batch finds the same closest hit as a single ray cast */
+TEST(RayCastBatch, MatchesSingleRayCast)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+	ndArray<ndBodyDynamic*> bodies;
+	BuildGrid(world, bodies);
+
+	ndArray<ndRayCastQuery> rays;
+	BuildRays(rays, 2000);
+	// a ray that misses everything and a degenerated one
+	rays.PushBack(ndRayCastQuery(ndVector(0.0f, 10.0f, 0.0f, 1.0f), ndVector(0.0f, 20.0f, 0.0f, 1.0f)));
+	rays.PushBack(ndRayCastQuery(ndVector(0.0f, 10.0f, 0.0f, 1.0f), ndVector(0.0f, 10.0f, 0.0f, 1.0f)));
+
+	ndArray<ndRayCastHit> hits;
+	hits.SetCount(rays.GetCount());
+	world.RayCastBatch(&rays[0], &hits[0], ndInt32(rays.GetCount()));
+
+	ndInt32 hitCount = 0;
+	for (ndInt32 i = 0; i < ndInt32(rays.GetCount()); ++i)
+	{
+		ndRayCastClosestHitCallback callback;
+		const bool state = world.RayCast(callback, rays[i].m_origin, rays[i].m_dest);
+		if (state)
+		{
+			hitCount++;
+			ASSERT_EQ(hits[i].m_body, callback.m_contact.m_body0);
+			EXPECT_NEAR(hits[i].m_param, callback.m_param, 1.0e-5f);
+			EXPECT_NEAR(hits[i].m_point.m_y, callback.m_contact.m_point.m_y, 1.0e-4f);
+			EXPECT_NEAR(hits[i].m_normal.m_y, callback.m_contact.m_normal.m_y, 1.0e-4f);
+		}
+		else
+		{
+			EXPECT_EQ(hits[i].m_body, nullptr);
+			EXPECT_GE(hits[i].m_param, 1.0f);
+		}
+	}
+	EXPECT_GT(hitCount, 1500);
+	EXPECT_EQ(hits[hits.GetCount() - 2].m_body, nullptr);
+	EXPECT_EQ(hits[hits.GetCount() - 1].m_body, nullptr);
+}
+
+/* a ray ignores its own body and hits what is behind it */
+TEST(RayCastBatch, IgnoreBody)
+{
+	ndWorld world;
+	ndArray<ndBodyDynamic*> bodies;
+	BuildGrid(world, bodies);
+
+	ndBodyDynamic* const box = bodies[1];
+	const ndVector origin(box->GetMatrix().m_posit + ndVector(0.0f, 5.0f, 0.0f, 0.0f));
+	const ndVector dest(origin - ndVector(0.0f, 10.0f, 0.0f, 0.0f));
+
+	ndRayCastQuery rays[2];
+	ndRayCastHit hits[2];
+	rays[0] = ndRayCastQuery(origin, dest);
+	rays[1] = ndRayCastQuery(origin, dest, box);
+	world.RayCastBatch(rays, hits, 2);
+
+	EXPECT_EQ(hits[0].m_body, box);
+	EXPECT_NEAR(hits[0].m_point.m_y, 1.0f, 1.0e-3f);
+	EXPECT_EQ(hits[1].m_body, bodies[0]);
+	EXPECT_NEAR(hits[1].m_point.m_y, 0.0f, 1.0e-3f);
+}
+
+/* a large batch split over the workers finds the same body as the single ray casts */
+TEST(RayCastBatch, LargeBatch)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+	ndArray<ndBodyDynamic*> bodies;
+	BuildGrid(world, bodies);
+
+	ndArray<ndRayCastQuery> rays;
+	BuildRays(rays, 100000);
+	const ndInt32 count = ndInt32(rays.GetCount());
+	ndArray<ndRayCastHit> hits;
+	hits.SetCount(count);
+	world.RayCastBatch(&rays[0], &hits[0], count);
+
+	ndInt32 mismatches = 0;
+	ndInt32 batchHits = 0;
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		ndRayCastClosestHitCallback callback;
+		const ndBody* const body = world.RayCast(callback, rays[i].m_origin, rays[i].m_dest) ? callback.m_contact.m_body0 : nullptr;
+		mismatches += (hits[i].m_body != body) ? 1 : 0;
+		batchHits += hits[i].m_body ? 1 : 0;
+	}
+	EXPECT_EQ(mismatches, 0);
+	EXPECT_GT(batchHits, count / 2);
+}
+
+// a rolling terrain mesh, rotated and moved away from the origin
+static ndBodyDynamic* BuildTerrain(ndWorld& world, ndInt32 cells)
+{
+	ndPolygonSoupBuilder meshBuilder;
+	meshBuilder.Begin();
+	auto Height = [](ndFloat32 x, ndFloat32 z)
+	{
+		return ndSin(x * 0.3f) * ndCos(z * 0.2f) * 1.5f;
+	};
+	for (ndInt32 i = 0; i < cells; ++i)
+	{
+		for (ndInt32 j = 0; j < cells; ++j)
+		{
+			const ndFloat32 x0 = ndFloat32(i);
+			const ndFloat32 z0 = ndFloat32(j);
+			const ndFloat32 x1 = x0 + 1.0f;
+			const ndFloat32 z1 = z0 + 1.0f;
+
+			ndVector face[3];
+			face[0] = ndVector(x0, Height(x0, z0), z0, 0.0f);
+			face[1] = ndVector(x0, Height(x0, z1), z1, 0.0f);
+			face[2] = ndVector(x1, Height(x1, z1), z1, 0.0f);
+			meshBuilder.AddFace(&face[0].m_x, sizeof(ndVector), 3, 0);
+
+			face[0] = ndVector(x0, Height(x0, z0), z0, 0.0f);
+			face[1] = ndVector(x1, Height(x1, z1), z1, 0.0f);
+			face[2] = ndVector(x1, Height(x1, z0), z0, 0.0f);
+			meshBuilder.AddFace(&face[0].m_x, sizeof(ndVector), 3, 0);
+		}
+	}
+	meshBuilder.End(false);
+
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	ndShapeInstance shape(new ndShapeStatic_bvh(meshBuilder));
+	ndMatrix matrix(ndYawMatrix(0.3f));
+	matrix.m_posit = ndVector(-20.0f, 1.5f, -10.0f, 1.0f);
+	body->SetMatrix(matrix);
+	body->SetCollisionShape(shape);
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+	Simulate(world, 1);
+	return body;
+}
+
+// a lidar like fan of rays, neighbor rays are almost parallel
+static void BuildScanRays(ndArray<ndRayCastQuery>& rays, ndInt32 rows, ndInt32 columns)
+{
+	const ndVector origin(10.0f, 12.0f, 12.0f, 1.0f);
+	for (ndInt32 i = 0; i < rows; ++i)
+	{
+		for (ndInt32 j = 0; j < columns; ++j)
+		{
+			const ndFloat32 pitch = -0.3f - 1.0f * ndFloat32(i) / ndFloat32(rows);
+			const ndFloat32 yaw = 2.0f * ndPi * ndFloat32(j) / ndFloat32(columns);
+			const ndVector dir(ndCos(pitch) * ndCos(yaw), ndSin(pitch), ndCos(pitch) * ndSin(yaw), 0.0f);
+			rays.PushBack(ndRayCastQuery(origin, origin + dir.Scale(60.0f)));
+		}
+	}
+}
+
+/* coherent rays are traced in packets through the scene and the terrain mesh,
+ * each one must still find the closest hit of a single ray cast */
+TEST(RayCastBatch, PacketsOnTerrain)
+{
+	ndWorld world;
+	ndArray<ndBodyDynamic*> bodies;
+	BuildGrid(world, bodies);
+	ndBodyDynamic* const terrain = BuildTerrain(world, 64);
+
+	ndArray<ndRayCastQuery> rays;
+	BuildScanRays(rays, 32, 360);
+	ndArray<ndRayCastHit> hits;
+	hits.SetCount(rays.GetCount());
+	world.RayCastBatch(&rays[0], &hits[0], ndInt32(rays.GetCount()));
+
+	ndInt32 terrainHits = 0;
+	for (ndInt32 i = 0; i < ndInt32(rays.GetCount()); ++i)
+	{
+		ndRayCastClosestHitCallback callback;
+		if (world.RayCast(callback, rays[i].m_origin, rays[i].m_dest))
+		{
+			ASSERT_EQ(hits[i].m_body, callback.m_contact.m_body0);
+			EXPECT_NEAR(hits[i].m_param, callback.m_param, 1.0e-5f);
+			const ndVector error(hits[i].m_point - callback.m_contact.m_point);
+			EXPECT_LT(error.DotProduct(error & ndVector::m_triplexMask).GetScalar(), 1.0e-6f);
+			EXPECT_GT(hits[i].m_normal.DotProduct(callback.m_contact.m_normal & ndVector::m_triplexMask).GetScalar(), 0.999f);
+			terrainHits += (hits[i].m_body == terrain) ? 1 : 0;
+		}
+		else
+		{
+			EXPECT_EQ(hits[i].m_body, nullptr);
+		}
+	}
+	EXPECT_GT(terrainHits, 1000);
+}
+
+/* on one thread the packets are traced by the calling thread, a denser scan
+ * over a finer terrain must still find the body of each single ray cast */
+TEST(RayCastBatch, PacketsOnOneThread)
+{
+	ndWorld world;
+	world.SetThreadCount(1);
+	ndArray<ndBodyDynamic*> bodies;
+	BuildGrid(world, bodies);
+	ndBodyDynamic* const terrain = BuildTerrain(world, 128);
+
+	ndArray<ndRayCastQuery> rays;
+	BuildScanRays(rays, 64, 1440);
+	const ndInt32 count = ndInt32(rays.GetCount());
+	ndArray<ndRayCastHit> hits;
+	hits.SetCount(count);
+	world.RayCastBatch(&rays[0], &hits[0], count);
+
+	ndInt32 mismatches = 0;
+	ndInt32 terrainHits = 0;
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		ndRayCastClosestHitCallback callback;
+		const ndBody* const body = world.RayCast(callback, rays[i].m_origin, rays[i].m_dest) ? callback.m_contact.m_body0 : nullptr;
+		mismatches += (hits[i].m_body != body) ? 1 : 0;
+		terrainHits += (hits[i].m_body == terrain) ? 1 : 0;
+	}
+	EXPECT_EQ(mismatches, 0);
+	EXPECT_GT(terrainHits, count / 4);
+}
@@ -0,0 +1,325 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+class ndClosestConvexCast : public ndConvexCastNotify
+{
+	public:
+	ndUnsigned32 OnRayPrecastAction(const ndBody* const, const ndShapeInstance* const)
+	{
+		return 1;
+	}
+};
+
+static ndVector RandomPoint(ndFloat32 height)
+{
+	const ndFloat32 size = ndFloat32(GRID_SIZE) * GRID_SPACING;
+	return ndVector(ndRand() * size - 2.0f, height, ndRand() * size - 2.0f, 1.0f);
+}
+
+static bool Contains(const ndOverlapBatchResult& result, ndInt32 query, const ndBody* const body)
+{
+	const ndOverlapBatchResult::ndRange& range = result.m_ranges[query];
+	for (ndInt32 i = 0; i < range.m_count; ++i)
+	{
+		if (result.m_bodies[range.m_start + i] == body)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/* every sweep of the batch finds the same closest hit as a single convex cast */
+TEST(SceneQueryBatch, ConvexCastMatchesSingle)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+	ndArray<ndBodyDynamic*> bodies;
+	BuildGrid(world, bodies);
+
+	ndSetRandSeed(23);
+	ndShapeInstance sphere(new ndShapeSphere(0.3f));
+	ndShapeInstance box(new ndShapeBox(0.5f, 0.4f, 0.6f));
+	ndArray<ndConvexCastQuery> queries;
+	for (ndInt32 i = 0; i < 500; ++i)
+	{
+		ndMatrix origin(ndGetIdentityMatrix());
+		origin.m_posit = RandomPoint(4.0f);
+		const ndVector dest(origin.m_posit + ndVector(ndRand() * 4.0f - 2.0f, -6.0f, ndRand() * 4.0f - 2.0f, 0.0f));
+		queries.PushBack(ndConvexCastQuery((i & 1) ? &box : &sphere, origin, dest));
+	}
+	// the last sweep ignores the box it starts over
+	ndMatrix origin(ndGetIdentityMatrix());
+	origin.m_posit = bodies[1]->GetMatrix().m_posit + ndVector(0.0f, 4.0f, 0.0f, 0.0f);
+	queries.PushBack(ndConvexCastQuery(&sphere, origin, origin.m_posit - ndVector(0.0f, 6.0f, 0.0f, 0.0f), bodies[1]));
+
+	ndArray<ndConvexCastHit> hits;
+	hits.SetCount(queries.GetCount());
+	world.ConvexCastBatch(&queries[0], &hits[0], ndInt32(queries.GetCount()));
+
+	ndInt32 hitCount = 0;
+	for (ndInt32 i = 0; i < ndInt32(queries.GetCount()) - 1; ++i)
+	{
+		const ndConvexCastQuery& query = queries[i];
+		ndClosestConvexCast callback;
+		if (world.ConvexCast(callback, *query.m_shape, query.m_origin, query.m_dest) && callback.m_contacts.GetCount())
+		{
+			hitCount++;
+			ASSERT_EQ(hits[i].m_body, callback.m_contacts[0].m_body1);
+			EXPECT_NEAR(hits[i].m_param, callback.m_param, 1.0e-5f);
+			EXPECT_NEAR(hits[i].m_point.m_y, callback.m_contacts[0].m_point.m_y, 1.0e-4f);
+		}
+		else
+		{
+			EXPECT_EQ(hits[i].m_body, nullptr);
+			EXPECT_GE(hits[i].m_param, 1.0f);
+		}
+	}
+	EXPECT_GT(hitCount, 450);
+
+	const ndConvexCastHit& last = hits[hits.GetCount() - 1];
+	EXPECT_EQ(last.m_body, bodies[0]);
+	EXPECT_NEAR(last.m_point.m_y, 0.0f, 1.0e-2f);
+}
+
+/* sweeps against a static mesh run concurrently, each worker uses its own mesh face buffers */
+TEST(SceneQueryBatch, ConvexCastAgainstMesh)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+
+	const ndInt32 cells = 32;
+	ndPolygonSoupBuilder meshBuilder;
+	meshBuilder.Begin();
+	auto Height = [](ndFloat32 x, ndFloat32 z)
+	{
+		return ndSin(x * 0.3f) * ndCos(z * 0.2f) * 1.5f;
+	};
+	for (ndInt32 i = 0; i < cells; ++i)
+	{
+		for (ndInt32 j = 0; j < cells; ++j)
+		{
+			const ndFloat32 x0 = ndFloat32(i);
+			const ndFloat32 z0 = ndFloat32(j);
+			const ndFloat32 x1 = x0 + 1.0f;
+			const ndFloat32 z1 = z0 + 1.0f;
+
+			ndVector face[3];
+			face[0] = ndVector(x0, Height(x0, z0), z0, 0.0f);
+			face[1] = ndVector(x0, Height(x0, z1), z1, 0.0f);
+			face[2] = ndVector(x1, Height(x1, z1), z1, 0.0f);
+			meshBuilder.AddFace(&face[0].m_x, sizeof(ndVector), 3, 0);
+
+			face[0] = ndVector(x0, Height(x0, z0), z0, 0.0f);
+			face[1] = ndVector(x1, Height(x1, z1), z1, 0.0f);
+			face[2] = ndVector(x1, Height(x1, z0), z0, 0.0f);
+			meshBuilder.AddFace(&face[0].m_x, sizeof(ndVector), 3, 0);
+		}
+	}
+	meshBuilder.End(false);
+
+	ndBodyDynamic* const floor = new ndBodyDynamic();
+	ndShapeInstance floorShape(new ndShapeStatic_bvh(meshBuilder));
+	floor->SetMatrix(ndGetIdentityMatrix());
+	floor->SetCollisionShape(floorShape);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+	Simulate(world, 1);
+
+	ndSetRandSeed(53);
+	ndShapeInstance sphere(new ndShapeSphere(0.3f));
+	ndShapeInstance box(new ndShapeBox(0.5f, 0.4f, 0.6f));
+	ndArray<ndConvexCastQuery> queries;
+	for (ndInt32 i = 0; i < 2000; ++i)
+	{
+		ndMatrix origin(ndGetIdentityMatrix());
+		origin.m_posit = ndVector(2.0f + ndRand() * 28.0f, 4.0f, 2.0f + ndRand() * 28.0f, 1.0f);
+		const ndVector dest(origin.m_posit + ndVector(ndRand() * 2.0f - 1.0f, -8.0f, ndRand() * 2.0f - 1.0f, 0.0f));
+		queries.PushBack(ndConvexCastQuery((i & 1) ? &box : &sphere, origin, dest));
+	}
+
+	ndArray<ndConvexCastHit> hits;
+	hits.SetCount(queries.GetCount());
+	world.ConvexCastBatch(&queries[0], &hits[0], ndInt32(queries.GetCount()));
+
+	ndInt32 hitCount = 0;
+	for (ndInt32 i = 0; i < ndInt32(queries.GetCount()); ++i)
+	{
+		const ndConvexCastQuery& query = queries[i];
+		ndClosestConvexCast callback;
+		if (world.ConvexCast(callback, *query.m_shape, query.m_origin, query.m_dest) && callback.m_contacts.GetCount())
+		{
+			hitCount++;
+			ASSERT_EQ(hits[i].m_body, floor);
+			EXPECT_NEAR(hits[i].m_param, callback.m_param, 1.0e-5f);
+			EXPECT_NEAR(hits[i].m_point.m_y, callback.m_contacts[0].m_point.m_y, 1.0e-4f);
+			EXPECT_NEAR(hits[i].m_point.m_y, Height(hits[i].m_point.m_x, hits[i].m_point.m_z), 0.1f);
+		}
+		else
+		{
+			EXPECT_EQ(hits[i].m_body, nullptr);
+		}
+	}
+	EXPECT_GT(hitCount, 1900);
+}
+
+/* shape overlaps report only the bodies the shape touches, box overlaps report every box */
+TEST(SceneQueryBatch, ShapeOverlapIsExact)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+	ndArray<ndBodyDynamic*> bodies;
+	BuildGrid(world, bodies);
+
+	// bodies[2] is the sphere at (0, 0.5, 2), the query sphere sits off its
+	// diagonal corner, the boxes overlap but the spheres do not touch.
+	ndShapeInstance sphere(new ndShapeSphere(0.3f));
+	const ndBodyDynamic* const target = bodies[2];
+	const ndVector center(target->GetMatrix().m_posit);
+	ndMatrix corner(ndGetIdentityMatrix());
+	corner.m_posit = center + ndVector(0.6f, 0.6f, 0.6f, 0.0f);
+	ndMatrix inside(ndGetIdentityMatrix());
+	inside.m_posit = center + ndVector(0.3f, 0.3f, 0.3f, 0.0f);
+
+	ndShapeOverlapQuery shapeQueries[2];
+	shapeQueries[0] = ndShapeOverlapQuery(&sphere, corner);
+	shapeQueries[1] = ndShapeOverlapQuery(&sphere, inside);
+	ndOverlapBatchResult shapeResult;
+	world.ShapeOverlapBatch(shapeQueries, 2, shapeResult);
+
+	ndVector minBox;
+	ndVector maxBox;
+	sphere.CalculateAabb(corner, minBox, maxBox);
+	const ndAabbQuery boxQuery(minBox, maxBox);
+	ndOverlapBatchResult boxResult;
+	world.BodiesInAabbBatch(&boxQuery, 1, boxResult);
+
+	EXPECT_TRUE(Contains(boxResult, 0, target));
+	EXPECT_FALSE(Contains(shapeResult, 0, target));
+	EXPECT_TRUE(Contains(shapeResult, 1, target));
+	EXPECT_FALSE(Contains(shapeResult, 1, bodies[0]));
+
+	ndBodiesInAabbNotify notify;
+	world.ShapeOverlap(notify, sphere, inside);
+	ASSERT_EQ(notify.m_bodyArray.GetCount(), 1);
+	EXPECT_EQ(notify.m_bodyArray[0], target);
+}
+
+/* batched overlaps find the same bodies as the single queries, in disjoint ranges */
+TEST(SceneQueryBatch, OverlapMatchesSingle)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+	ndArray<ndBodyDynamic*> bodies;
+	BuildGrid(world, bodies);
+
+	ndSetRandSeed(31);
+	ndShapeInstance capsule(new ndShapeCapsule(0.4f, 0.4f, 2.0f));
+	ndArray<ndAabbQuery> boxQueries;
+	ndArray<ndShapeOverlapQuery> shapeQueries;
+	for (ndInt32 i = 0; i < 1000; ++i)
+	{
+		ndMatrix matrix(ndPitchMatrix(ndRand() * ndPi) * ndYawMatrix(ndRand() * ndPi));
+		matrix.m_posit = RandomPoint(0.5f + ndRand());
+		shapeQueries.PushBack(ndShapeOverlapQuery(&capsule, matrix, (i & 7) ? nullptr : bodies[0]));
+
+		const ndVector size(ndVector(1.0f) + ndVector(ndRand(), ndRand(), ndRand(), 0.0f) * ndVector(3.0f));
+		boxQueries.PushBack(ndAabbQuery(matrix.m_posit - size, matrix.m_posit + size));
+	}
+
+	ndOverlapBatchResult boxResult;
+	ndOverlapBatchResult shapeResult;
+	world.BodiesInAabbBatch(&boxQueries[0], ndInt32(boxQueries.GetCount()), boxResult);
+	world.ShapeOverlapBatch(&shapeQueries[0], ndInt32(shapeQueries.GetCount()), shapeResult);
+	ASSERT_EQ(boxResult.m_ranges.GetCount(), boxQueries.GetCount());
+	ASSERT_EQ(shapeResult.m_ranges.GetCount(), shapeQueries.GetCount());
+
+	ndInt32 boxTotal = 0;
+	ndInt32 shapeTotal = 0;
+	for (ndInt32 i = 0; i < ndInt32(boxQueries.GetCount()); ++i)
+	{
+		ndBodiesInAabbNotify boxNotify;
+		world.BodiesInAabb(boxNotify, boxQueries[i].m_minBox, boxQueries[i].m_maxBox);
+		ASSERT_EQ(boxResult.m_ranges[i].m_count, ndInt32(boxNotify.m_bodyArray.GetCount()));
+		for (ndInt32 j = 0; j < ndInt32(boxNotify.m_bodyArray.GetCount()); ++j)
+		{
+			EXPECT_TRUE(Contains(boxResult, i, boxNotify.m_bodyArray[j]));
+		}
+		boxTotal += boxResult.m_ranges[i].m_count;
+
+		const ndShapeOverlapQuery& query = shapeQueries[i];
+		ndBodiesInAabbNotify shapeNotify;
+		world.ShapeOverlap(shapeNotify, *query.m_shape, query.m_matrix);
+		ndInt32 expected = 0;
+		for (ndInt32 j = 0; j < ndInt32(shapeNotify.m_bodyArray.GetCount()); ++j)
+		{
+			if (shapeNotify.m_bodyArray[j] != query.m_ignoreBody)
+			{
+				expected++;
+				EXPECT_TRUE(Contains(shapeResult, i, shapeNotify.m_bodyArray[j]));
+			}
+		}
+		ASSERT_EQ(shapeResult.m_ranges[i].m_count, expected);
+		shapeTotal += shapeResult.m_ranges[i].m_count;
+	}
+	EXPECT_EQ(boxTotal, ndInt32(boxResult.m_bodies.GetCount()));
+	EXPECT_EQ(shapeTotal, ndInt32(shapeResult.m_bodies.GetCount()));
+	EXPECT_GT(shapeTotal, 500);
+	EXPECT_LT(shapeTotal, boxTotal);
+}
+
+/* large batches split over the workers find what the same queries run one at a time find */
+TEST(SceneQueryBatch, LargeBatches)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+	ndArray<ndBodyDynamic*> bodies;
+	BuildGrid(world, bodies);
+
+	ndSetRandSeed(41);
+	const ndInt32 count = 20000;
+	ndShapeInstance sphere(new ndShapeSphere(0.4f));
+	ndArray<ndConvexCastQuery> castQueries;
+	ndArray<ndShapeOverlapQuery> overlapQueries;
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		ndMatrix matrix(ndGetIdentityMatrix());
+		matrix.m_posit = RandomPoint(3.0f);
+		castQueries.PushBack(ndConvexCastQuery(&sphere, matrix, matrix.m_posit - ndVector(0.0f, 4.0f, 0.0f, 0.0f)));
+		matrix.m_posit.m_y = 0.5f;
+		overlapQueries.PushBack(ndShapeOverlapQuery(&sphere, matrix));
+	}
+
+	ndArray<ndConvexCastHit> hits;
+	hits.SetCount(count);
+	ndOverlapBatchResult result;
+	world.ConvexCastBatch(&castQueries[0], &hits[0], count);
+	world.ShapeOverlapBatch(&overlapQueries[0], count, result);
+
+	ndInt32 sweepMismatches = 0;
+	ndInt32 overlapMismatches = 0;
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		ndClosestConvexCast callback;
+		const bool hit = world.ConvexCast(callback, sphere, castQueries[i].m_origin, castQueries[i].m_dest) && callback.m_contacts.GetCount();
+		sweepMismatches += (hits[i].m_body != (hit ? callback.m_contacts[0].m_body1 : nullptr)) ? 1 : 0;
+
+		ndBodiesInAabbNotify notify;
+		world.ShapeOverlap(notify, sphere, overlapQueries[i].m_matrix);
+		overlapMismatches += (result.m_ranges[i].m_count != ndInt32(notify.m_bodyArray.GetCount())) ? 1 : 0;
+	}
+	EXPECT_EQ(sweepMismatches, 0);
+	EXPECT_EQ(overlapMismatches, 0);
+	EXPECT_GT(ndInt32(result.m_bodies.GetCount()), count / 4);
+}
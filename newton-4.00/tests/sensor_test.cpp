@@ -0,0 +1,174 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+static ndBodyDynamic* BuildCarrier(ndWorld& world, const ndVector& posit, const ndVector& veloc)
+{
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	ndShapeInstance shape(new ndShapeSphere(0.25f));
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit = posit;
+	body->SetNotifyCallback(new ndBodyNotify(ndVector::m_zero));
+	body->SetMatrix(matrix);
+	body->SetCollisionShape(shape);
+	body->SetMassMatrix(1.0f, shape);
+	body->SetAutoSleep(false);
+	body->SetVelocity(veloc);
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+	return body;
+}
+
+/* a lidar two meters over a flat floor, every beam reads the slant distance to the floor */
+TEST(Sensor, LidarOverFloor)
+{
+	ndWorld world;
+	ndSharedPtr<ndBody> floor(BuildFloor(100.0f));
+	world.AddBody(floor);
+	ndBodyDynamic* const carrier = BuildCarrier(world, ndVector(0.0f, 2.0f, 0.0f, 1.0f), ndVector::m_zero);
+
+	const ndInt32 channels = 16;
+	const ndInt32 columns = 360;
+	ndSensor* const lidar = new ndSensor(carrier, ndGetIdentityMatrix(), 40.0f);
+	lidar->SetLidarPattern(channels, columns, -0.6f, -0.15f);
+	ndSharedPtr<ndSensor> lidarPtr(lidar);
+	world.AddSensor(lidarPtr);
+	ASSERT_EQ(lidar->GetBeamCount(), channels * columns);
+
+	Simulate(world, 2);
+	const ndArray<ndFloat32>& ranges = lidar->GetRanges();
+	const ndFloat32 height = carrier->GetMatrix().m_posit.m_y;
+	for (ndInt32 i = 0; i < columns; ++i)
+	{
+		for (ndInt32 j = 0; j < channels; ++j)
+		{
+			const ndFloat32 pitch = -0.6f + 0.45f * ndFloat32(j) / ndFloat32(channels - 1);
+			EXPECT_NEAR(ranges[i * channels + j], height / ndSin(-pitch), 1.0e-3f);
+		}
+	}
+
+	// a disabled sensor keeps its last scan
+	lidar->SetEnabled(false);
+	carrier->SetVelocity(ndVector(0.0f, 1.0f, 0.0f, 0.0f));
+	Simulate(world, 30);
+	EXPECT_NEAR(ranges[0], height / ndSin(0.6f), 1.0e-3f);
+
+	world.RemoveSensor(lidar);
+	EXPECT_EQ(world.GetSensorList().GetCount(), 0);
+}
+
+/* a depth camera riding a body toward a wall, and staying put when the body is removed */
+TEST(Sensor, DepthCameraFollowsBody)
+{
+	ndWorld world;
+	ndSharedPtr<ndBody> wall(BuildStatic(ndShapeInstance(new ndShapeBox(1.0f, 10.0f, 10.0f)), ndVector(10.5f, 0.0f, 0.0f, 1.0f)));
+	world.AddBody(wall);
+	ndBodyDynamic* const carrier = BuildCarrier(world, ndVector(0.0f, 0.0f, 0.0f, 1.0f), ndVector(1.0f, 0.0f, 0.0f, 0.0f));
+
+	ndSensor* const camera = new ndSensor(carrier, ndGetIdentityMatrix(), 50.0f);
+	camera->SetDepthCameraPattern(3, 3, 0.5f);
+	ndSharedPtr<ndSensor> cameraPtr(camera);
+	world.AddSensor(cameraPtr);
+
+	Simulate(world, 1);
+	const ndFloat32 range0 = camera->GetRanges()[4];
+	EXPECT_NEAR(range0, 10.0f - carrier->GetMatrix().m_posit.m_x, 1.0e-3f);
+	EXPECT_GT(camera->GetRanges()[0], range0);
+
+	Simulate(world, 60);
+	const ndFloat32 range1 = camera->GetRanges()[4];
+	EXPECT_NEAR(range1, 10.0f - carrier->GetMatrix().m_posit.m_x, 1.0e-3f);
+	EXPECT_NEAR(range0 - range1, 1.0f, 0.02f);
+
+	world.RemoveBody(carrier);
+	Simulate(world, 2);
+	EXPECT_EQ(camera->GetBody(), nullptr);
+	EXPECT_NEAR(camera->GetRanges()[4], range1 - TIME_STEP, 0.02f);
+}
+
+/* a 64 channel lidar over a field of boxes, every beam hits the floor or
+ * the top or sides of a box, and never the body that carries it */
+TEST(Sensor, LidarOverBoxField)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+	ndBodyDynamic* const floor = BuildFloor(200.0f);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+	ndShapeInstance box(new ndShapeBox(1.0f, 2.0f, 1.0f));
+	for (ndInt32 i = 0; i < 20; ++i)
+	{
+		for (ndInt32 j = 0; j < 20; ++j)
+		{
+			ndSharedPtr<ndBody> boxPtr(BuildStatic(box, ndVector(ndFloat32(i) * 4.0f - 38.0f, 1.0f, ndFloat32(j) * 4.0f - 38.0f, 1.0f)));
+			world.AddBody(boxPtr);
+		}
+	}
+	ndBodyDynamic* const carrier = BuildCarrier(world, ndVector(1.0f, 3.0f, 1.0f, 1.0f), ndVector(0.5f, 0.0f, 0.0f, 0.0f));
+
+	ndSensor* const lidar = new ndSensor(carrier, ndGetIdentityMatrix(), 80.0f);
+	lidar->SetLidarPattern(64, 2048, -0.4f, 0.2f);
+	ndSharedPtr<ndSensor> lidarPtr(lidar);
+	world.AddSensor(lidarPtr);
+	Simulate(world, 10);
+
+	ndInt32 hitCount = 0;
+	ndInt32 errors = 0;
+	const ndArray<ndRayCastHit>& hits = lidar->GetHits();
+	const ndArray<ndFloat32>& ranges = lidar->GetRanges();
+	for (ndInt32 i = 0; i < lidar->GetBeamCount(); ++i)
+	{
+		const ndRayCastHit& hit = hits[i];
+		if (hit.m_body)
+		{
+			hitCount++;
+			const bool onFloor = (hit.m_body == floor) && (ndAbs(hit.m_point.m_y) < 1.0e-3f);
+			const bool onBox = (hit.m_body != floor) && (hit.m_point.m_y > -1.0e-3f) && (hit.m_point.m_y < 2.0f + 1.0e-3f);
+			errors += (hit.m_body == carrier) || !(onFloor || onBox) || (ranges[i] > 80.0f) ? 1 : 0;
+		}
+		else
+		{
+			errors += (ranges[i] != 80.0f) ? 1 : 0;
+		}
+	}
+	EXPECT_EQ(errors, 0);
+	EXPECT_GT(hitCount, lidar->GetBeamCount() / 2);
+}
+
+/* a fixed sensor tracking a body flying away from it, every scan reads where
+ * the body is after the update, not where the previous update left it */
+TEST(Sensor, MovingTarget)
+{
+	ndWorld world;
+	ndBodyDynamic* const target = BuildCarrier(world, ndVector(2.0f, 0.0f, 0.0f, 1.0f), ndVector(6.0f, 0.0f, 0.0f, 0.0f));
+
+	const ndVector beam(1.0f, 0.0f, 0.0f, 0.0f);
+	ndSensor* const sensor = new ndSensor(nullptr, ndGetIdentityMatrix(), 50.0f);
+	sensor->SetBeamPattern(&beam, 1);
+	ndSharedPtr<ndSensor> sensorPtr(sensor);
+	world.AddSensor(sensorPtr);
+
+	for (ndInt32 i = 0; i < 30; ++i)
+	{
+		Simulate(world, 1);
+		EXPECT_EQ(sensor->GetHits()[0].m_body, target);
+		EXPECT_NEAR(sensor->GetRanges()[0], target->GetMatrix().m_posit.m_x - 0.25f, 1.0e-3f);
+	}
+
+	// once it leaves the beam nothing is hit
+	target->SetVelocity(ndVector(0.0f, 30.0f, 0.0f, 0.0f));
+	Simulate(world, 1);
+	EXPECT_GT(target->GetMatrix().m_posit.m_y, 0.25f);
+	EXPECT_EQ(sensor->GetHits()[0].m_body, nullptr);
+	EXPECT_EQ(sensor->GetRanges()[0], 50.0f);
+}
@@ -0,0 +1,126 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndVector RandomUnitVector()
+{
+	ndVector dir(ndVector::m_zero);
+	do
+	{
+		dir = ndVector(ndRand() * 2.0f - 1.0f, ndRand() * 2.0f - 1.0f, ndRand() * 2.0f - 1.0f, 0.0f);
+	} while (dir.DotProduct(dir).GetScalar() < 1.0e-3f);
+	return dir.Normalize();
+}
+
+/* small hulls use the dispatched brute force support kernel, every
+ * level the cpu can run must find the same support distance. */
+TEST(SimdDispatch, SupportVertexKernels)
+{
+	const ndSimdLevel best = ndGetBestSimdLevel();
+	const ndInt32 vertexCounts[] = { 5, 8, 11, 16, 21, 24 };
+	const ndSimdLevel levels[] = { ndSimdSse, ndSimdAvx2, ndSimdAvx512 };
+
+	ndSetRandSeed(4321);
+	for (ndInt32 k = 0; k < ndInt32(sizeof(vertexCounts) / sizeof(vertexCounts[0])); ++k)
+	{
+		ndArray<ndVector> points;
+		for (ndInt32 i = 0; i < vertexCounts[k]; ++i)
+		{
+			points.PushBack(RandomUnitVector());
+		}
+		ndShapeInstance hull(new ndShapeConvexHull(vertexCounts[k], sizeof(ndVector), 0.0f, &points[0].m_x));
+
+		for (ndInt32 i = 0; i < 500; ++i)
+		{
+			const ndVector dir(RandomUnitVector());
+			ndFloat32 maxProj = -1.0e10f;
+			for (ndInt32 j = 0; j < points.GetCount(); ++j)
+			{
+				maxProj = ndMax(maxProj, points[j].DotProduct(dir).GetScalar());
+			}
+
+			for (ndInt32 j = 0; j < ndInt32(sizeof(levels) / sizeof(levels[0])); ++j)
+			{
+				const ndSimdLevel level = ndSetSimdKernels(levels[j]);
+				EXPECT_LE(level, best);
+				const ndVector support(hull.SupportVertex(dir));
+				EXPECT_NEAR(support.DotProduct(dir).GetScalar(), maxProj, 1.0e-4f);
+			}
+		}
+	}
+	EXPECT_EQ(ndSetSimdKernels(best), best);
+	EXPECT_EQ(ndGetSimdKernels().m_level, best);
+}
+
+/* two rings of vertices, looking along the axis every vertex of a ring
+ * ties, all the levels must break the tie on the same vertex. */
+TEST(SimdDispatch, SupportVertexTies)
+{
+	const ndSimdLevel best = ndGetBestSimdLevel();
+	const ndSimdLevel levels[] = { ndSimdSse, ndSimdAvx2, ndSimdAvx512 };
+
+	ndArray<ndVector> points;
+	for (ndInt32 i = 0; i < 12; ++i)
+	{
+		const ndFloat32 angle = ndFloat32(i) * ndFloat32(2.0f) * ndPi / ndFloat32(12.0f);
+		points.PushBack(ndVector(ndCos(angle), ndFloat32(0.5f), ndSin(angle), ndFloat32(0.0f)));
+		points.PushBack(ndVector(ndCos(angle), ndFloat32(-0.5f), ndSin(angle), ndFloat32(0.0f)));
+	}
+	ndShapeInstance hull(new ndShapeConvexHull(ndInt32(points.GetCount()), sizeof(ndVector), 0.0f, &points[0].m_x));
+
+	const ndVector dirs[] = { ndVector(0.0f, 1.0f, 0.0f, 0.0f), ndVector(0.0f, -1.0f, 0.0f, 0.0f) };
+	for (ndInt32 i = 0; i < 2; ++i)
+	{
+		ndSetSimdKernels(ndSimdSse);
+		const ndVector reference(hull.SupportVertex(dirs[i]));
+		for (ndInt32 j = 1; j < ndInt32(sizeof(levels) / sizeof(levels[0])); ++j)
+		{
+			ndSetSimdKernels(levels[j]);
+			const ndVector support(hull.SupportVertex(dirs[i]));
+			EXPECT_EQ(support.m_x, reference.m_x);
+			EXPECT_EQ(support.m_y, reference.m_y);
+			EXPECT_EQ(support.m_z, reference.m_z);
+		}
+	}
+	ndSetSimdKernels(best);
+}
+
+/* the best solver request resolves to the widest solver the cpu can run */
+TEST(SimdDispatch, BestSolver)
+{
+	ndWorld world;
+	world.SelectSolver(ndWorld::ndSimdBestSolver);
+	const ndWorld::ndSolverModes mode = world.GetSelectedSolver();
+
+	// the avx solvers are optional in the build
+	ndUnsigned32 features = ndGetCpuSimdFeatures();
+	#ifndef _D_USE_AVX512_SOLVER
+	features &= ~ndUnsigned32(ndCpuAvx512);
+	#endif
+	#ifndef _D_USE_AVX2_SOLVER
+	features &= ~ndUnsigned32(ndCpuAvx2);
+	#endif
+
+	if (features & ndCpuAvx512)
+	{
+		EXPECT_EQ(mode, ndWorld::ndSimdAvx512Solver);
+	}
+	else if (features & ndCpuAvx2)
+	{
+		EXPECT_EQ(mode, ndWorld::ndSimdAvx2Solver);
+	}
+	else
+	{
+		EXPECT_EQ(mode, ndWorld::ndSimdSoaSolver);
+	}
+}
@@ -0,0 +1,138 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+constexpr ndFloat32 TIME_STEP = (1.0f / 60.0f);
+constexpr ndInt32 NET_SIZE = 6;
+constexpr ndFloat32 NET_SPACING = 0.6f;
+
+static ndBodyDynamic* BuildNode(const ndShapeInstance& shape, const ndVector& posit)
+{
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit = posit;
+	body->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, -10.0f, 0.0f, 0.0f)));
+	body->SetMatrix(matrix);
+	body->SetCollisionShape(shape);
+	body->SetMassMatrix(1.0f, shape);
+	body->SetAutoSleep(false);
+	return body;
+}
+
+static void Connect(ndWorld& world, ndBodyKinematic* const child, ndBodyKinematic* const parent)
+{
+	ndMatrix pivot(ndGetIdentityMatrix());
+	pivot.m_posit = child->GetMatrix().m_posit;
+	ndJointSpherical* const joint = new ndJointSpherical(pivot, child, parent);
+	joint->SetSolverModel(m_jointkinematicOpenLoop);
+	ndSharedPtr<ndJointBilateralConstraint> jointPtr(joint);
+	world.AddJoint(jointPtr);
+}
+
+// a horizontal net of balls hanging from one edge, every
+// cell of the net closes a loop of the skeleton.
+static ndFloat32 SimulateNet(ndInt32 threadCount, ndArray<ndVector>& posits)
+{
+	ndWorld world;
+	world.SetThreadCount(threadCount);
+
+	ndBodyDynamic* const anchor = new ndBodyDynamic();
+	anchor->SetCollisionShape(ndShapeInstance(new ndShapeNull()));
+	ndSharedPtr<ndBody> anchorPtr(anchor);
+	world.AddBody(anchorPtr);
+
+	ndArray<ndBodyDynamic*> nodes;
+	ndShapeInstance sphere(new ndShapeSphere(0.1f));
+	for (ndInt32 i = 0; i < NET_SIZE; ++i)
+	{
+		for (ndInt32 j = 0; j < NET_SIZE; ++j)
+		{
+			ndBodyDynamic* const node = BuildNode(sphere, ndVector(ndFloat32(i) * NET_SPACING, 10.0f, ndFloat32(j) * NET_SPACING, 1.0f));
+			ndSharedPtr<ndBody> nodePtr(node);
+			world.AddBody(nodePtr);
+			nodes.PushBack(node);
+		}
+	}
+
+	for (ndInt32 i = 0; i < NET_SIZE; ++i)
+	{
+		for (ndInt32 j = 0; j < NET_SIZE; ++j)
+		{
+			ndBodyDynamic* const node = nodes[i * NET_SIZE + j];
+			if (i == 0)
+			{
+				Connect(world, node, anchor);
+			}
+			else
+			{
+				Connect(world, node, nodes[(i - 1) * NET_SIZE + j]);
+			}
+			if (j > 0)
+			{
+				Connect(world, node, nodes[i * NET_SIZE + j - 1]);
+			}
+		}
+	}
+
+	for (ndInt32 i = 0; i < 120; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+
+	// largest stretch of the net links
+	ndFloat32 maxStretch = 0.0f;
+	posits.SetCount(0);
+	for (ndInt32 i = 0; i < NET_SIZE; ++i)
+	{
+		for (ndInt32 j = 0; j < NET_SIZE; ++j)
+		{
+			const ndVector posit(nodes[i * NET_SIZE + j]->GetMatrix().m_posit);
+			posits.PushBack(posit);
+			if (i > 0)
+			{
+				const ndVector dist(posit - nodes[(i - 1) * NET_SIZE + j]->GetMatrix().m_posit);
+				maxStretch = ndMax(maxStretch, ndAbs(ndSqrt(dist.DotProduct(dist & ndVector::m_triplexMask).GetScalar()) - NET_SPACING));
+			}
+			if (j > 0)
+			{
+				const ndVector dist(posit - nodes[i * NET_SIZE + j - 1]->GetMatrix().m_posit);
+				maxStretch = ndMax(maxStretch, ndAbs(ndSqrt(dist.DotProduct(dist & ndVector::m_triplexMask).GetScalar()) - NET_SPACING));
+			}
+		}
+	}
+	return maxStretch;
+}
+
+/* the loop rows of the net are factored by all the threads,
+ * the links must hold and the result must not depend on the thread count. */
+TEST(SkeletonLoops, ParallelLoopFactorization)
+{
+	ndArray<ndVector> serial;
+	ndArray<ndVector> threaded;
+	const ndFloat32 stretch0 = SimulateNet(1, serial);
+	const ndFloat32 stretch1 = SimulateNet(4, threaded);
+
+	EXPECT_LT(stretch0, 0.02f);
+	EXPECT_LT(stretch1, 0.02f);
+	ASSERT_EQ(serial.GetCount(), threaded.GetCount());
+
+	// the net swung down under the anchored edge
+	EXPECT_LT(threaded[threaded.GetCount() - 1].m_y, 9.5f);
+	for (ndInt32 i = 0; i < threaded.GetCount(); ++i)
+	{
+		EXPECT_NEAR(threaded[i].m_x, serial[i].m_x, 0.02f);
+		EXPECT_NEAR(threaded[i].m_y, serial[i].m_y, 0.02f);
+		EXPECT_NEAR(threaded[i].m_z, serial[i].m_z, 0.02f);
+	}
+}
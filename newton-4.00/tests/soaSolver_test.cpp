@@ -0,0 +1,195 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+// the soa solver is written against the 4 wide ndVector,
+// sse3 on x86 and neon on arm, these tests run on both.
+
+// a chain of distance joints hanging from a static body, plus a stack of boxes
+static void BuildScene(ndWorld& world, ndArray<ndBody*>& bodies)
+{
+	ndSharedPtr<ndBody> floor(BuildFloor());
+	world.AddBody(floor);
+
+	ndShapeInstance box(new ndShapeBox(1.0f, 0.5f, 1.0f));
+	for (ndInt32 i = 0; i < 8; ++i)
+	{
+		ndSharedPtr<ndBody> body(BuildBody(box, ndVector(0.0f, 0.25f + ndFloat32(i) * 0.5f, 0.0f, 1.0f)));
+		world.AddBody(body);
+		bodies.PushBack(*body);
+	}
+
+	ndBodyDynamic* const anchor = new ndBodyDynamic();
+	ndMatrix anchorMatrix(ndGetIdentityMatrix());
+	anchorMatrix.m_posit = ndVector(6.0f, 10.0f, 0.0f, 1.0f);
+	anchor->SetMatrix(anchorMatrix);
+	anchor->SetCollisionShape(ndShapeInstance(new ndShapeNull()));
+	ndSharedPtr<ndBody> anchorPtr(anchor);
+	world.AddBody(anchorPtr);
+
+	ndShapeInstance sphere(new ndShapeSphere(0.2f));
+	ndBodyKinematic* parent = anchor;
+	for (ndInt32 i = 0; i < 6; ++i)
+	{
+		// the chain starts horizontal so it swings
+		ndBodyDynamic* const link = BuildBody(sphere, ndVector(6.0f + ndFloat32(i + 1) * 0.6f, 10.0f, 0.0f, 1.0f));
+		ndSharedPtr<ndBody> linkPtr(link);
+		world.AddBody(linkPtr);
+		bodies.PushBack(link);
+
+		ndSharedPtr<ndJointBilateralConstraint> joint(new ndJointFixDistance(parent->GetMatrix().m_posit, link->GetMatrix().m_posit, parent, link));
+		world.AddJoint(joint);
+		parent = link;
+	}
+}
+
+TEST(SoaSolver, VectorLaneOps)
+{
+	const ndVector a(-2.0f, 1.0f, -0.5f, 3.0f);
+	const ndVector b(1.0f, -1.0f, -0.5f, 4.0f);
+
+	// compares on negative floats catch integer compares of the bit patterns
+	const ndVector gt(a > b);
+	EXPECT_EQ(gt.m_ix, 0);
+	EXPECT_EQ(gt.m_iy, -1);
+	EXPECT_EQ(gt.m_iz, 0);
+	EXPECT_EQ(gt.m_iw, 0);
+	const ndVector ge(a >= b);
+	EXPECT_EQ(ge.m_iz, -1);
+	const ndVector lt(a < b);
+	EXPECT_EQ(lt.m_ix, -1);
+	EXPECT_EQ(lt.m_iw, -1);
+
+	const ndVector select(a.Select(b, gt));
+	EXPECT_EQ(select.m_x, -2.0f);
+	EXPECT_EQ(select.m_y, -1.0f);
+	EXPECT_EQ(select.m_w, 3.0f);
+
+	const ndVector andNot(ndVector::m_one.AndNot(gt));
+	EXPECT_EQ(andNot.m_x, 1.0f);
+	EXPECT_EQ(andNot.m_y, 0.0f);
+
+	EXPECT_EQ(a.GetMax().GetScalar(), 3.0f);
+	EXPECT_EQ(a.AddHorizontal().GetScalar(), 1.5f);
+	EXPECT_EQ(a.MulAdd(b, b).m_w, 19.0f);
+	EXPECT_EQ(a.MulSub(b, b).m_x, -3.0f);
+	EXPECT_EQ(a.Floor().m_z, -1.0f);
+	EXPECT_EQ(a.Divide(b).m_w, 0.75f);
+	EXPECT_EQ(a.Scale(2.0f).m_z, -1.0f);
+
+	const ndVector shift(a.ShiftRight());
+	EXPECT_EQ(shift.m_x, 3.0f);
+	EXPECT_EQ(shift.m_y, -2.0f);
+
+	const ndVector bits(ndInt32(-1), ndInt32(8), ndInt32(16), ndInt32(0));
+	const ndVector shr(bits.ShiftRightLogical(2));
+	EXPECT_EQ(shr.m_ix, 0x3fffffff);
+	EXPECT_EQ(shr.m_iy, 2);
+
+	ndVector r0;
+	ndVector r1;
+	ndVector r2;
+	ndVector r3;
+	const ndVector c(5.0f, 6.0f, 7.0f, 8.0f);
+	const ndVector d(9.0f, 10.0f, 11.0f, 12.0f);
+	ndVector::Transpose4x4(r0, r1, r2, r3, a, b, c, d);
+	EXPECT_EQ(r0.m_y, 1.0f);
+	EXPECT_EQ(r1.m_x, 1.0f);
+	EXPECT_EQ(r2.m_w, 11.0f);
+	EXPECT_EQ(r3.m_z, 8.0f);
+}
+
+static void SimulateScene(ndWorld::ndSolverModes mode, ndArray<ndVector>& positions)
+{
+	ndWorld world;
+	world.SelectSolver(mode);
+	world.SetSolverIterations(8);
+
+	ndArray<ndBody*> bodies;
+	BuildScene(world, bodies);
+	for (ndInt32 i = 0; i < 90; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+
+	positions.SetCount(0);
+	for (ndInt32 i = 0; i < ndInt32(bodies.GetCount()); ++i)
+	{
+		positions.PushBack(bodies[i]->GetMatrix().m_posit);
+	}
+}
+
+/* the soa solver must follow the scalar reference solver on joints and contacts */
+TEST(SoaSolver, ParityWithStandard)
+{
+	ndArray<ndVector> reference;
+	ndArray<ndVector> soa;
+	SimulateScene(ndWorld::ndStandardSolver, reference);
+	SimulateScene(ndWorld::ndSimdSoaSolver, soa);
+
+	ASSERT_EQ(reference.GetCount(), soa.GetCount());
+	ndFloat32 maxError = 0.0f;
+	for (ndInt32 i = 0; i < ndInt32(soa.GetCount()); ++i)
+	{
+		const ndVector diff(reference[i] - soa[i]);
+		maxError = ndMax(maxError, ndSqrt(diff.DotProduct(diff & ndVector::m_triplexMask).GetScalar()));
+	}
+	EXPECT_LT(maxError, 0.05f);
+}
+
+/* stacks of boxes on a grid stay where they were placed, with either solver */
+TEST(SoaSolver, RestingStacks)
+{
+	const ndWorld::ndSolverModes modes[] = { ndWorld::ndStandardSolver, ndWorld::ndSimdSoaSolver };
+	for (ndInt32 m = 0; m < 2; ++m)
+	{
+		ndWorld world;
+		world.SelectSolver(modes[m]);
+
+		ndSharedPtr<ndBody> floor(BuildFloor());
+		world.AddBody(floor);
+
+		ndArray<ndBody*> bodies;
+		ndArray<ndVector> posits;
+		ndShapeInstance box(new ndShapeBox(1.0f, 0.5f, 1.0f));
+		for (ndInt32 i = 0; i < 8; ++i)
+		{
+			for (ndInt32 j = 0; j < 8; ++j)
+			{
+				for (ndInt32 k = 0; k < 4; ++k)
+				{
+					const ndVector posit(ndFloat32(i) * 1.5f, 0.25f + ndFloat32(k) * 0.5f, ndFloat32(j) * 1.5f, 1.0f);
+					ndSharedPtr<ndBody> body(BuildBody(box, posit));
+					world.AddBody(body);
+					bodies.PushBack(*body);
+					posits.PushBack(posit);
+				}
+			}
+		}
+
+		for (ndInt32 i = 0; i < 60; ++i)
+		{
+			world.Update(TIME_STEP);
+			world.Sync();
+		}
+
+		ndFloat32 maxError = 0.0f;
+		for (ndInt32 i = 0; i < ndInt32(bodies.GetCount()); ++i)
+		{
+			const ndVector diff(bodies[i]->GetMatrix().m_posit - posits[i]);
+			maxError = ndMax(maxError, ndSqrt(diff.DotProduct(diff & ndVector::m_triplexMask).GetScalar()));
+		}
+		EXPECT_LT(maxError, 0.02f) << (m ? "soa" : "standard") << " solver";
+	}
+}
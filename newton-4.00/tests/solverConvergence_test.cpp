@@ -0,0 +1,75 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+struct ndStackResult
+{
+	ndFloat32 m_maxDrift;
+	ndFloat32 m_topError;
+};
+
+static ndStackResult SimulateStack(ndWorld::ndSolverModes mode, ndInt32 height, ndInt32 iterations)
+{
+	ndWorld world;
+	world.SelectSolver(mode);
+	world.SetSolverIterations(iterations);
+
+	ndSharedPtr<ndBody> floor(BuildFloor(20.0f));
+	world.AddBody(floor);
+
+	ndArray<ndBody*> stack;
+	for (ndInt32 i = 0; i < height; ++i)
+	{
+		ndSharedPtr<ndBody> box(BuildBox(ndVector(0.0f, 0.25f + ndFloat32(i) * 0.5f, 0.0f, 1.0f)));
+		world.AddBody(box);
+		stack.PushBack(*box);
+	}
+
+	for (ndInt32 i = 0; i < 120; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+
+	ndStackResult result;
+	result.m_maxDrift = 0.0f;
+	for (ndInt32 i = 0; i < height; ++i)
+	{
+		const ndVector posit(stack[i]->GetMatrix().m_posit);
+		const ndFloat32 drift = ndSqrt(posit.m_x * posit.m_x + posit.m_z * posit.m_z);
+		result.m_maxDrift = ndMax(result.m_maxDrift, drift);
+	}
+	const ndFloat32 topY = stack[height - 1]->GetMatrix().m_posit.m_y;
+	result.m_topError = 0.25f + ndFloat32(height - 1) * 0.5f - topY;
+	return result;
+}
+
+/* a tall stack at a fixed iteration count, the colored Gauss-Seidel
+ * solver must hold the stack upright and sag no more than the jacobi solver.
+ * the sag of the top box measures how far each solver is from convergence. */
+TEST(SolverConvergence, StackHeight)
+{
+	const ndInt32 height = 16;
+	const ndInt32 iterations = 4;
+	const ndWorld::ndSolverModes modes[] = { ndWorld::ndStandardSolver, ndWorld::ndSimdSoaSolver, ndWorld::ndGraphColoredSolver };
+	const char* const names[] = { "default", "sse", "colored" };
+
+	ndStackResult results[3];
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		results[i] = SimulateStack(modes[i], height, iterations);
+		EXPECT_LT(ndAbs(results[i].m_topError), 0.25f) << names[i] << " solver";
+	}
+	EXPECT_LT(results[2].m_maxDrift, 0.05f);
+	EXPECT_LE(ndAbs(results[2].m_topError), ndAbs(results[0].m_topError) + 0.01f);
+}
@@ -0,0 +1,92 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "ndTestUtils.h"
+#include <gtest/gtest.h>
+
+// runs a short stack and returns the solver stats of the last frame.
+static ndWorld::ndSolverStats SimulateStack(ndWorld::ndSolverModes mode, ndFloat32 tolerance, ndFloat32& topY)
+{
+	ndWorld world;
+	world.SelectSolver(mode);
+	world.SetSolverTolerance(tolerance);
+
+	ndSharedPtr<ndBody> floor(BuildFloor(20.0f));
+	world.AddBody(floor);
+
+	ndBody* top = nullptr;
+	for (ndInt32 i = 0; i < 6; ++i)
+	{
+		ndSharedPtr<ndBody> box(BuildBox(ndVector(0.0f, 0.25f + ndFloat32(i) * 0.5f, 0.0f, 1.0f)));
+		world.AddBody(box);
+		top = *box;
+	}
+
+	for (ndInt32 i = 0; i < 90; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+	topY = top->GetMatrix().m_posit.m_y;
+	return world.GetSolverStats();
+}
+
+TEST(SolverResidual, FixedPasses)
+{
+	const ndWorld::ndSolverModes modes[] = { ndWorld::ndStandardSolver, ndWorld::ndSimdSoaSolver, ndWorld::ndGraphColoredSolver, ndWorld::ndIslandTaskSolver };
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		ndFloat32 topY;
+		const ndWorld::ndSolverStats stats(SimulateStack(modes[i], 0.0f, topY));
+		EXPECT_GT(stats.m_maxPasses, 0);
+		EXPECT_EQ(stats.m_passes, stats.m_maxPasses);
+		EXPECT_GE(stats.m_residual, 0.0f);
+	}
+}
+
+/* with a tolerance the solver stops as soon as the largest joint residual 
+ * is below it, a resting stack must converge in fewer passes and still stand. */
+TEST(SolverResidual, AdaptivePasses)
+{
+	const ndWorld::ndSolverModes modes[] = { ndWorld::ndStandardSolver, ndWorld::ndSimdSoaSolver, ndWorld::ndGraphColoredSolver, ndWorld::ndIslandTaskSolver };
+	const char* const names[] = { "default", "sse", "colored", "islands" };
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		ndFloat32 fixedY;
+		ndFloat32 adaptiveY;
+		const ndWorld::ndSolverStats fixedStats(SimulateStack(modes[i], 0.0f, fixedY));
+		const ndWorld::ndSolverStats adaptiveStats(SimulateStack(modes[i], 0.5f, adaptiveY));
+		EXPECT_LT(adaptiveStats.m_passes, adaptiveStats.m_maxPasses) << names[i] << " solver";
+		EXPECT_LE(adaptiveStats.m_passes, fixedStats.m_passes) << names[i] << " solver";
+		EXPECT_GE(adaptiveStats.m_residual, 0.0f) << names[i] << " solver";
+		EXPECT_NEAR(adaptiveY, fixedY, 0.05f);
+	}
+}
+
+/* the avx2 solver reports its passes and stops early like the others */
+TEST(SolverResidual, Avx2Passes)
+{
+	ndWorld world;
+	world.SelectSolver(ndWorld::ndSimdAvx2Solver);
+	if (world.GetSelectedSolver() != ndWorld::ndSimdAvx2Solver)
+	{
+		GTEST_SKIP();
+	}
+
+	ndFloat32 fixedY;
+	ndFloat32 adaptiveY;
+	const ndWorld::ndSolverStats fixedStats(SimulateStack(ndWorld::ndSimdAvx2Solver, 0.0f, fixedY));
+	const ndWorld::ndSolverStats adaptiveStats(SimulateStack(ndWorld::ndSimdAvx2Solver, 0.5f, adaptiveY));
+	EXPECT_GT(fixedStats.m_maxPasses, 0);
+	EXPECT_EQ(fixedStats.m_passes, fixedStats.m_maxPasses);
+	EXPECT_LT(adaptiveStats.m_passes, adaptiveStats.m_maxPasses);
+	EXPECT_NEAR(adaptiveY, fixedY, 0.05f);
+}
@@ -47,3 +47,34 @@ TEST(Extremes, OrbitalDistances)
 
 	world.CleanUp();
 }
+
+/* at orbital distances a float position has half a meter of precision,
+ * a slow body must still cover the distance of its velocity. */
+TEST(Extremes, SlowBodyFarFromOrigin)
+{
+	ndWorld world;
+	ndShapeInstance shapeinst(new ndShapeSphere(ndFloat32(0.5f)));
+
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit.m_x = ndFloat32(7378140.0f);
+
+	ndBodyDynamic* movingbody = new ndBodyDynamic();
+	movingbody->SetNotifyCallback(new ndBodyNotify(ndBigVector(ndFloat32(0), ndFloat32(0), ndFloat32(0), ndFloat32(0))));
+	movingbody->SetCollisionShape(shapeinst);
+	movingbody->SetMatrix(matrix);
+	movingbody->SetMassMatrix(ndFloat32(10), shapeinst);
+	movingbody->SetAutoSleep(false);
+	movingbody->SetVelocity(ndVector(ndFloat32(0.3f), ndFloat32(0), ndFloat32(0), ndFloat32(0)));
+	ndSharedPtr<ndBody> movingPtr(movingbody);
+	world.AddBody(movingPtr);
+
+	for (int i = 0; i < 600; i++)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+
+	const ndFloat32 distance = movingbody->GetMatrix().m_posit.m_x - matrix.m_posit.m_x;
+	EXPECT_NEAR(distance, ndFloat32(3.0f), ndFloat32(0.6f));
+	world.CleanUp();
+}